@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "header.h"
+
+// -----------------------------------------------
+// ONLINE ADMISSION CONTROL (RUNTIME TASK CHANGES)
+// -----------------------------------------------
+
+// Tasks can be added, removed or changed while the taskset is simulated. The changes are queued in the context and applied in order at a
+// decision point before the scheduler executes at it (safe point: the jobs of the decision point are not yet released or dispatched).
+// A change is only applied at the lowest criticality level, where every core accepts all jobs and orders its ready queue by virtual
+// deadlines, so that a new threshold criticality of a core does not affect its queued jobs. A task is only released on an ACTIVE core
+// (the wakeup time of a SHUTDOWN core was calculated without the task's jobs), otherwise the change waits for a later decision point.
+// The allocation is not re-run: the core of a task is selected by WFD/FFD with the EDF-VD test on incrementally maintained core loads, and
+// only the cores the task leaves/joins get a new threshold criticality and new virtual deadlines. No new core is opened at runtime.
+// The released jobs of a removed/changed task complete with their parameters; the first job of an added/changed task is released at the
+// first integer time after the change, offset by the task's phase (the job numbers of a task continue across its changes).
+
+// Check the parameters of a runtime task change and derive its task fields (utilizations, LPD condition)
+// Returns -1 if invalid
+
+int prepare_task_change (Sim_context *ctx, Task_change *change) {
+
+    Tasks *task = &change->task;     // New task parameters
+
+    if (change->type == TASK_CHANGE_REMOVE)
+        return 0;
+
+    if (task->phase < 0 || task->period <= 0 || task->deadline <= 0)
+        return -1;
+    if (task->criticality < 1 || task->criticality > ctx->max_criticality)
+        return -1;
+
+    // Wcets must be positive and non-decreasing with criticality level
+    for (int j = 0; j < task->criticality; j++) {
+        if (change->wcet[j] <= 0 || (j > 0 && change->wcet[j] < change->wcet[j - 1]))
+            return -1;
+        task->utilization[j] = (double)(change->wcet[j]) / task->period;
+    }
+    for (int j = task->criticality; j < ctx->max_criticality; j++)
+        task->utilization[j] = task->utilization[task->criticality - 1];
+
+    // Account the scheduling overheads like the offline allocation
+    task->wcet = change->wcet;
+    if (get_job_overhead (&ctx->config) > 0)
+        add_scheduling_overheads (task, 1, ctx->max_criticality, get_job_overhead (&ctx->config));
+    derive_task_fields (task, 1);
+
+    task->allocated_core = NOT_ALLOCATED;
+    task->virtual_deadline = task->deadline;
+    return 0;
+}
+
+// Build the utilization sums of the cores from the allocation (once, at the first task change; then updated incrementally)
+
+void build_core_loads (Sim_context *ctx) {
+
+    memset (ctx->core_load, 0, sizeof (ctx->core_load));
+    for (int i = 0; i < ctx->num_tasks; i++) {
+        if (ctx->tasks_arr[i].allocated_core > 0)
+            add_task_load (&ctx->core_load[ctx->tasks_arr[i].allocated_core - 1], &ctx->tasks_arr[i], 1);
+    }
+    ctx->core_loads_valid = 1;
+}
+
+// Check if a core can take a task (EDF-VD test on the core load with the task added, side-effect free)
+// LPD tasks only join NON_SHUTDOWNABLE cores (the core type of a core is not changed at runtime)
+
+int check_core_admission (Sim_context *ctx, int core_idx, Tasks *task) {
+
+    Core_load load = ctx->core_load[core_idx];     // Core load with the task added
+    double x = 0.0;                                // Deadline shortening factor
+
+    // Cores with split task portions are not considered (their load is not tracked)
+    if (ctx->core[core_idx].split_portions > 0 || (task->lpd && ctx->core[core_idx].core_type != NON_SHUTDOWNABLE))
+        return 0;
+
+    add_task_load (&load, task, 1);
+    return (get_load_threshold (&load, ctx->max_criticality, &x) > 0);
+}
+
+// Select the core for a task among the open cores (the given core excluded), -1 if no core can take it
+// Tasks above the WFD threshold criticality are allocated to the worst-fitting core, the others to the first-fitting core
+// (WFD threshold as in the offline allocation: WFD + FFD if the HI criticality tasks have at most 40% of the utilization, else FFD only)
+
+int select_admission_core (Sim_context *ctx, Tasks *task, int exclude_idx) {
+
+    int hi_level_threshold = (ctx->max_criticality / 2) + (ctx->max_criticality % 2);    // HI criticality tasks: criticality above this level
+    int wfd_threshold_crit = ctx->max_criticality;                                        // Tasks above this level are allocated by WFD
+    double hi_crit_util = 0.0;                                                            // Utilization of the HI criticality tasks
+    double total_util = task->own_utilization;                                            // Utilization of all tasks
+    double max_remaining_capacity = -1.0;                                                 // Remaining capacity of the worst-fitting core
+    int core_idx = -1;                                                                    // Selected core
+
+    // HI criticality utilization proportion of the taskset with the task (from the core loads)
+    if (task->criticality > hi_level_threshold)
+        hi_crit_util = task->own_utilization;
+    for (int j = 0; j < ctx->num_cores; j++) {
+        total_util = total_util + ctx->core_load[j].utilization;
+        for (int c = hi_level_threshold + 1; c <= ctx->max_criticality; c++)
+            hi_crit_util = hi_crit_util + ctx->core_load[j].own_util[c - 1];
+    }
+    if (hi_crit_util > 0.0 && hi_crit_util / total_util <= 0.40)
+        wfd_threshold_crit = hi_level_threshold;
+
+    for (int j = 0; j < ctx->num_cores; j++) {
+        if (j == exclude_idx || !check_core_admission (ctx, j, task))
+            continue;
+
+        // FFD: first core that can take the task
+        if (task->criticality <= wfd_threshold_crit)
+            return j;
+
+        // WFD: core with the maximum remaining capacity after taking the task
+        if (1.0 - ctx->core_load[j].utilization - task->own_utilization > max_remaining_capacity) {
+            max_remaining_capacity = 1.0 - ctx->core_load[j].utilization - task->own_utilization;
+            core_idx = j;
+        }
+    }
+
+    return core_idx;
+}
+
+// Recalculate the EDF-VD threshold criticality of a core and the virtual deadlines of its tasks from its load
+// (The absolute virtual deadlines of the released jobs are kept)
+
+void update_core_deadlines (Sim_context *ctx, int core_idx) {
+
+    Cores *core = &ctx->core[core_idx];     // Core structure
+    Tasks *task_arr = ctx->tasks_arr;       // Task structure array
+    double x = 1.0;                         // Deadline shortening factor
+    int threshold = 0;                      // Threshold criticality of the core
+
+    // (Removing a task never breaks the schedulability of a core, the threshold is only kept for rounding errors of the load sums)
+    threshold = get_load_threshold (&ctx->core_load[core_idx], ctx->max_criticality, &x);
+    if (threshold <= 0)
+        return;
+
+    core->threshold_criticality = threshold;
+    for (int i = 0; i < ctx->num_tasks; i++) {
+        if (task_arr[i].allocated_core == core->core_no) {
+
+            // For HI criticality tasks (criticality > threshold) virtual deadlines are set to x * original deadlines
+            if (task_arr[i].criticality > threshold)
+                task_arr[i].virtual_deadline = x * task_arr[i].deadline;
+            else
+                task_arr[i].virtual_deadline = task_arr[i].deadline;
+        }
+    }
+
+    trace_threshold_event (ctx, core);
+    SCHED_PRINT (ctx, " Core %d: threshold criticality %d (x = %lf) after task change\n", core->core_no, threshold, x);
+}
+
+// Get the super-hyperperiod of the taskset with a task of the given period added
+// Returns -1 if it exceeds INT_MAX (job arrival times are integers)
+
+int get_admission_hyperperiod (Sim_context *ctx, int period) {
+
+    long long hyperperiod = (long long) ctx->hyperperiod / hcf (ctx->hyperperiod, period) * period;
+
+    return (hyperperiod > INT_MAX) ? -1 : (int) hyperperiod;
+}
+
+// Get the time at which a task's first job is released after the current decision point (first integer time after it + task phase)
+// Returns -1 if it exceeds INT_MAX
+
+int get_admission_release (Sim_context *ctx, Tasks *task) {
+
+    double release = floor (ctx->timecount) + 1 + task->phase;
+
+    return (release > INT_MAX) ? -1 : (int) release;
+}
+
+// Store a task's new parameters in the task structure array (task_idx = num_tasks appends the task)
+// The task structure array and wcet arena are replaced by copies holding the new parameters (the wcet arrays of a snapshot are copied too)
+// Returns -1 if out of memory
+
+int store_task (Sim_context *ctx, int task_idx, Tasks *task) {
+
+    int num_tasks = (task_idx < ctx->num_tasks) ? ctx->num_tasks : ctx->num_tasks + 1;    // Number of tasks after the change
+    Tasks *tasks_arr;                                                                     // New task structure array
+    int *wcet_arena;                                                                      // New wcet arena
+    int *wcet_ptr;                                                                        // Next free slot in the wcet arena
+    int num_wcets = 0;                                                                    // Number of wcets of all tasks
+
+    tasks_arr = malloc (num_tasks * sizeof (Tasks));
+    if (tasks_arr == NULL)
+        return -1;
+    memcpy (tasks_arr, ctx->tasks_arr, ctx->num_tasks * sizeof (Tasks));
+    tasks_arr[task_idx] = *task;
+
+    for (int i = 0; i < num_tasks; i++)
+        num_wcets = num_wcets + tasks_arr[i].criticality;
+    wcet_arena = malloc (num_wcets * sizeof (int));
+    if (wcet_arena == NULL) {
+        free (tasks_arr);
+        return -1;
+    }
+
+    // (The wcet pointers of the copied tasks still point to the old storage, released below)
+    wcet_ptr = wcet_arena;
+    for (int i = 0; i < num_tasks; i++) {
+        memcpy (wcet_ptr, tasks_arr[i].wcet, tasks_arr[i].criticality * sizeof (int));
+        tasks_arr[i].wcet = wcet_ptr;
+        wcet_ptr = wcet_ptr + tasks_arr[i].criticality;
+    }
+
+    free_taskset (&ctx->taskset);
+    ctx->taskset.tasks_arr = tasks_arr;
+    ctx->taskset.wcet_arena = wcet_arena;
+    ctx->taskset.num_tasks = num_tasks;
+    ctx->tasks_arr = tasks_arr;
+    ctx->num_tasks = num_tasks;
+
+    return 0;
+}
+
+// Apply an add task change
+// A removed task can be added again with the same task number (its job numbers continue)
+// Returns TASK_CHANGE_APPLIED, TASK_CHANGE_REJECTED or TASK_CHANGE_DEFERRED
+
+int apply_add_task (Sim_context *ctx, Tasks *task) {
+
+    int task_idx = get_task_array_index (ctx->tasks_arr, ctx->num_tasks, task->task_no);    // Index of the task (num_tasks: new task)
+    int job_no = 0;                                                                          // Job number of the task's first job
+    int core_idx = -1;                                                                       // Core selected for the task
+    int hyperperiod = 0;                                                                     // Super-hyperperiod with the task
+    int release = 0;                                                                         // Release time of the task's first job
+
+    if (task_idx < ctx->num_tasks) {
+        if (ctx->tasks_arr[task_idx].allocated_core != NOT_ALLOCATED)
+            return TASK_CHANGE_REJECTED;
+        job_no = (int)((get_next_job_arrival (ctx->tasks_arr, task_idx, ctx->timecount) - ctx->tasks_arr[task_idx].phase) / ctx->tasks_arr[task_idx].period);
+    }
+
+    core_idx = select_admission_core (ctx, task, -1);
+    if (core_idx < 0)
+        return TASK_CHANGE_REJECTED;
+    if (ctx->core[core_idx].status != ACTIVE)
+        return TASK_CHANGE_DEFERRED;
+
+    hyperperiod = get_admission_hyperperiod (ctx, task->period);
+    release = get_admission_release (ctx, task);
+    if (hyperperiod < 0 || release < 0 || store_task (ctx, task_idx, task) < 0)
+        return TASK_CHANGE_REJECTED;
+
+    // Release pattern: job job_no of the task is released at the release time
+    ctx->tasks_arr[task_idx].phase = release - job_no * task->period;
+    ctx->hyperperiod = hyperperiod;
+
+    allocate_task_to_core (ctx->core, ctx->tasks_arr, core_idx, task_idx);
+    add_task_load (&ctx->core_load[core_idx], &ctx->tasks_arr[task_idx], 1);
+    update_core_deadlines (ctx, core_idx);
+
+    SCHED_PRINT (ctx, " Task %d added to core %d at %lf (first job released at %d)\n", task->task_no, ctx->core[core_idx].core_no, ctx->timecount, release);
+    return TASK_CHANGE_APPLIED;
+}
+
+// Apply a remove task change (split tasks and the tasks of cores with split task portions cannot be removed)
+// Returns TASK_CHANGE_APPLIED or TASK_CHANGE_REJECTED
+
+int apply_remove_task (Sim_context *ctx, int task_no) {
+
+    int task_idx = get_task_array_index (ctx->tasks_arr, ctx->num_tasks, task_no);    // Index of the task
+    int core_idx = 0;                                                                  // Core of the task
+
+    if (task_idx >= ctx->num_tasks || ctx->tasks_arr[task_idx].allocated_core <= 0)
+        return TASK_CHANGE_REJECTED;
+    core_idx = ctx->tasks_arr[task_idx].allocated_core - 1;
+    if (ctx->core[core_idx].split_portions > 0)
+        return TASK_CHANGE_REJECTED;
+
+    // The task stays in the task structure array (the released jobs refer to it) without a core
+    add_task_load (&ctx->core_load[core_idx], &ctx->tasks_arr[task_idx], -1);
+    deallocate_task_from_core (ctx->core, ctx->tasks_arr, core_idx, task_idx);
+    update_core_deadlines (ctx, core_idx);
+
+    SCHED_PRINT (ctx, " Task %d removed from core %d at %lf\n", task_no, ctx->core[core_idx].core_no, ctx->timecount);
+    return TASK_CHANGE_APPLIED;
+}
+
+// Apply a modify task change (the task stays on its core if it is still schedulable there, else it moves to the core selected by WFD/FFD)
+// Returns TASK_CHANGE_APPLIED, TASK_CHANGE_REJECTED or TASK_CHANGE_DEFERRED
+
+int apply_modify_task (Sim_context *ctx, Tasks *task) {
+
+    int task_idx = get_task_array_index (ctx->tasks_arr, ctx->num_tasks, task->task_no);    // Index of the task
+    int old_idx = 0;                                                                         // Current core of the task
+    int core_idx = -1;                                                                       // Core selected for the new parameters
+    int job_no = 0;                                                                          // Job number of the next job
+    int hyperperiod = 0;                                                                     // Super-hyperperiod with the new period
+    int release = 0;                                                                         // Release time of the next job
+
+    if (task_idx >= ctx->num_tasks || ctx->tasks_arr[task_idx].allocated_core <= 0)
+        return TASK_CHANGE_REJECTED;
+    old_idx = ctx->tasks_arr[task_idx].allocated_core - 1;
+    if (ctx->core[old_idx].split_portions > 0)
+        return TASK_CHANGE_REJECTED;
+
+    // Select the core without the task's current load
+    add_task_load (&ctx->core_load[old_idx], &ctx->tasks_arr[task_idx], -1);
+    core_idx = check_core_admission (ctx, old_idx, task) ? old_idx : select_admission_core (ctx, task, old_idx);
+    add_task_load (&ctx->core_load[old_idx], &ctx->tasks_arr[task_idx], 1);
+    if (core_idx < 0)
+        return TASK_CHANGE_REJECTED;
+    if (ctx->core[core_idx].status != ACTIVE)
+        return TASK_CHANGE_DEFERRED;
+
+    hyperperiod = get_admission_hyperperiod (ctx, task->period);
+    release = get_admission_release (ctx, task);
+    if (hyperperiod < 0 || release < 0)
+        return TASK_CHANGE_REJECTED;
+    job_no = (int)((get_next_job_arrival (ctx->tasks_arr, task_idx, ctx->timecount) - ctx->tasks_arr[task_idx].phase) / ctx->tasks_arr[task_idx].period);
+
+    // Take the task off its core with its current parameters
+    add_task_load (&ctx->core_load[old_idx], &ctx->tasks_arr[task_idx], -1);
+    deallocate_task_from_core (ctx->core, ctx->tasks_arr, old_idx, task_idx);
+    if (store_task (ctx, task_idx, task) < 0) {
+        allocate_task_to_core (ctx->core, ctx->tasks_arr, old_idx, task_idx);
+        add_task_load (&ctx->core_load[old_idx], &ctx->tasks_arr[task_idx], 1);
+        return TASK_CHANGE_REJECTED;
+    }
+
+    // Release pattern: job job_no of the task is released at the release time
+    ctx->tasks_arr[task_idx].phase = release - job_no * task->period;
+    ctx->hyperperiod = hyperperiod;
+
+    allocate_task_to_core (ctx->core, ctx->tasks_arr, core_idx, task_idx);
+    add_task_load (&ctx->core_load[core_idx], &ctx->tasks_arr[task_idx], 1);
+    update_core_deadlines (ctx, core_idx);
+    if (core_idx != old_idx)
+        update_core_deadlines (ctx, old_idx);
+
+    SCHED_PRINT (ctx, " Task %d changed on core %d at %lf (next job released at %d)\n", task->task_no, ctx->core[core_idx].core_no, ctx->timecount, release);
+    return TASK_CHANGE_APPLIED;
+}
+
+// Apply the pending runtime task changes in order at the current decision point (before the scheduler executes at it)
+// The changes wait while the system is above the lowest criticality level; a deferred change also holds back the changes after it
+
+void apply_task_changes (Sim_context *ctx) {
+
+    Task_change *change;     // Task change being applied
+    int applied = 0;         // Number of changes applied/rejected
+    int changed = 0;         // Set if the taskset changed
+    int status = 0;          // Status of the change
+
+    if (ctx->num_task_changes == 0 || ctx->current_level > 1)
+        return;
+
+    if (!ctx->core_loads_valid)
+        build_core_loads (ctx);
+
+    for (applied = 0; applied < ctx->num_task_changes; applied++) {
+        change = &ctx->task_change[applied];
+        change->task.wcet = change->wcet;
+
+        if (change->type == TASK_CHANGE_ADD)
+            status = apply_add_task (ctx, &change->task);
+        else if (change->type == TASK_CHANGE_REMOVE)
+            status = apply_remove_task (ctx, change->task.task_no);
+        else
+            status = apply_modify_task (ctx, &change->task);
+
+        if (status == TASK_CHANGE_DEFERRED)
+            break;
+        changed = changed || (status == TASK_CHANGE_APPLIED);
+
+        if (status == TASK_CHANGE_REJECTED) {
+            ctx->stats.task_changes_rejected++;
+            SCHED_PRINT (ctx, " Task change (task %d) rejected at %lf\n", change->task.task_no, ctx->timecount);
+        }
+        else if (change->type == TASK_CHANGE_ADD)
+            ctx->stats.tasks_added++;
+        else if (change->type == TASK_CHANGE_REMOVE)
+            ctx->stats.tasks_removed++;
+        else
+            ctx->stats.tasks_modified++;
+    }
+
+    // The super-hyperperiods before the change do not repeat: no steady state is fast-forwarded afterwards
+    if (changed)
+        ctx->steady_state_found = 1;
+
+    memmove (ctx->task_change, ctx->task_change + applied, (ctx->num_task_changes - applied) * sizeof (Task_change));
+    ctx->num_task_changes = ctx->num_task_changes - applied;
+}
+
+// Queue a runtime task change (applied at the next safe decision point of the simulation)
+// task: new task parameters (task number, phase = release offset after the change, period, deadline, criticality, wcets)
+// Returns -1 if the taskset is not allocated, the simulation is complete, the change is invalid or too many changes are pending,
+// or if the change could never be applied (the system is above the lowest criticality level and never de-escalates)
+
+int queue_task_change (Sim_context *ctx, int type, Tasks *task) {
+
+    Task_change *change;     // Queued task change
+
+    if (ctx->num_cores <= 0 || (ctx->scheduler_initialized && ctx->timecount >= ctx->end_time) || ctx->num_task_changes >= MAX_TASK_CHANGES)
+        return -1;
+    if (ctx->current_level > 1 && ctx->config.deescalation == DEESCALATION_NONE)
+        return -1;
+    if (type != TASK_CHANGE_REMOVE && (task->criticality < 1 || task->criticality > ctx->max_criticality || task->wcet == NULL))
+        return -1;
+
+    change = &ctx->task_change[ctx->num_task_changes];
+    change->type = type;
+    change->task = *task;
+    if (type != TASK_CHANGE_REMOVE)
+        memcpy (change->wcet, task->wcet, task->criticality * sizeof (int));
+    if (prepare_task_change (ctx, change) < 0)
+        return -1;
+
+    ctx->num_task_changes++;
+    return 0;
+}
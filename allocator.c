@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "header.h"
 
@@ -40,99 +41,194 @@ double calculate_utilization_ull (Tasks *tasks_arr, int num_tasks, int lower_lim
 
             // Add task utilizations (at their own criticality levels) for all tasks having criticality level between lower and upper limits
             if (tasks_arr[i].criticality >= lower_limit && tasks_arr[i].criticality <= upper_limit) {
-                utilization_ull = utilization_ull + tasks_arr[i].utilization[(tasks_arr[i].criticality - 1)];
+                utilization_ull = utilization_ull + tasks_arr[i].own_utilization;
             }
         }
     }
     return utilization_ull;
 }
 
-// Check if the EDF-VD Schedulability condition holds for given core, assuming we add the new task to it 
+// EDF-VD schedulability test for the given core, assuming we add the new task to it (side-effect free: no task or core is modified)
+// Returns the threshold criticality for which the EDF (max criticality) or EDF-VD condition holds (-73 if none), and the deadline shortening factor x
 
-int edfvd_schedulability_check (Tasks* tasks_arr, int num_tasks, int max_criticality, int core_no, int new_task_no) {
+int edfvd_schedulability_probe (Tasks* tasks_arr, int num_tasks, int max_criticality, int core_no, int new_task_no, double *x) {
 
     int threshold_criticality = 0;     // EDF-VD threshold criticality
                                        // All tasks with criticality greater than this threshold are HI criticality tasks
-    double x = 0.0;                    // Deadline shortening factor (0.0 < x <= 1.0)
     double x_ub = 0.0;                 // Upper bound on deadline shortening factor --> to ensure HI mode schedulability
     double x_lb = 0.0;                 // Lower bound on deadline shortening factor --> to ensure LO mode schedulability
 
+    *x = 1.0;
+
     // Sum of all task utilizations (at their own criticality level) < 1 --> EDF schedulable
-    if (calculate_utilization_ull (tasks_arr, num_tasks, 1, max_criticality, core_no, new_task_no) <= 1.0) {
+    // (Scheduling is done as per original deadlines for all tasks --> criticality agnostic EDF)
+    if (calculate_utilization_ull (tasks_arr, num_tasks, 1, max_criticality, core_no, new_task_no) <= 1.0)
+        return max_criticality;
 
-        // Scheduling is done as per original deadlines for all tasks --> criticality agnostic EDF
+    // Else the taskset is not EDF schedulable, so we check for EDF-VD schedulability condition for all possible threshold criticalities
+    // All tasks having criticality > threshold criticality --> HI criticality, else LO criticality
+    for (threshold_criticality = max_criticality - 1 ; threshold_criticality > 0 ; threshold_criticality--) {
 
-        // For all tasks
-        for (int i = 0 ; i < num_tasks; i++) {
+        // EDFVD schedulability condition (part 1)
+        // --> Sum of LO-criticality (criticality < threshold) tasks at their own levels must be less than 1.0
+        if (calculate_utilization_ull (tasks_arr, num_tasks, 1, threshold_criticality, core_no, new_task_no) < 1.0) {
 
-            // If task is already allocated to the given core/ is the new task being considered for allocation
-            if ((tasks_arr[i].allocated_core == core_no) || (tasks_arr[i].task_no == new_task_no))
+            // Calculate lower bound on deadline shortening factor to ensure schedulability in LO mode
+            x_lb = calculate_utilization_ulk (tasks_arr, num_tasks, threshold_criticality + 1, max_criticality, core_no, new_task_no) /
+                   (1.0 - calculate_utilization_ull (tasks_arr, num_tasks, 1, threshold_criticality, core_no, new_task_no));
 
-                // Update virtual deadlines
-                tasks_arr[i].virtual_deadline = tasks_arr[i].deadline;
-        }
+            // Calculate upper bound on deadline shortening factor to ensure schedulability in HI mode
+            x_ub = (1.0 - calculate_utilization_ull (tasks_arr, num_tasks, threshold_criticality + 1, max_criticality, core_no, new_task_no)) /
+                   calculate_utilization_ull (tasks_arr, num_tasks, 1, threshold_criticality, core_no, new_task_no);
 
-        // EDF condition holds, so EDF-VD threshold criticality is set to highest criticality level defined for the system
-        return max_criticality;
-    }
+            // EDFVD schedulability condition (part 2) --> If a non-empty feasible range for x exists such that x_lb <= x <= x_ub
+            if (x_lb <= x_ub) {
 
-    // Else the taskset is not EDF schedulable, so we check for EDF-VD schedulability condition for all possible threshold criticalities
-    else {
+                // TODO: TEMPORARY CODE - set x
+                // --> To be implemented after DVFS offline part when x_optimal is determined
 
-        // Check EDFVD conditions at each criticality level and set threshold criticality level for the core
-        // All tasks having criticality > threshold criticality --> HI criticality, else LO criticality
-        for (threshold_criticality = max_criticality - 1 ; threshold_criticality > 0 ; threshold_criticality--) {
+                // Choose any x value that lies within the feasible range determined (set to mid for now)
+                *x = (x_lb + x_ub) / 2;
 
-            // EDFVD schedulability condition (part 1)
-            // --> Sum of LO-criticality (criticality < threshold) tasks at their own levels must be less than 1.0
-            if (calculate_utilization_ull (tasks_arr, num_tasks, 1, threshold_criticality, core_no, new_task_no) < 1.0) {
+                // Return the threshold criticality value for which the EDF-VD condition holds
+                return threshold_criticality;
+            }
+        }
+    }
 
-                // Calculate lower bound on deadline shortening factor to ensure schedulability in LO mode
-                x_lb = calculate_utilization_ulk (tasks_arr, num_tasks, threshold_criticality + 1, max_criticality, core_no, new_task_no) /
-                       (1.0 - calculate_utilization_ull (tasks_arr, num_tasks, 1, threshold_criticality, core_no, new_task_no));
+    // No schedulability condition (EDF or EDF-VD) holds, return INVALID threshold criticality to indicate that the task cannot be allocated
+    return -73;
+}
 
-                // Calculate upper bound on deadline shortening factor to ensure schedulability in HI mode
-                x_ub = (1.0 - calculate_utilization_ull (tasks_arr, num_tasks, threshold_criticality + 1, max_criticality, core_no, new_task_no)) /
-                       calculate_utilization_ull (tasks_arr, num_tasks, 1, threshold_criticality, core_no, new_task_no);
+// Set the virtual deadlines of the tasks of the given core and the new task for the given threshold criticality and deadline shortening factor
+// For HI criticality (criticality > threshold) tasks virtual deadlines are set to x * original deadlines
+// For LO criticality (criticality <= threshold) tasks, and all tasks of an EDF schedulable core, virtual deadlines are set to original deadlines
 
-                // EDFVD schedulability condition (part 2) --> If a non-empty feasible range for x exists such that x_lb <= x <= x_ub
-                if (x_lb <= x_ub) {
+void set_virtual_deadlines (Tasks *tasks_arr, int num_tasks, int core_no, int new_task_no, int threshold_criticality, double x) {
 
-                    // TODO: TEMPORARY CODE - set x, update virtual deadlines
-                    // --> To be implemented after DVFS offline part when x_optimal is determined
+    // For all tasks
+    for (int i = 0 ; i < num_tasks; i++) {
 
-                    // Choose any x value that lies within the feasible range determined (set to mid for now)
-                    x = (x_lb + x_ub) / 2;
+        // Check if task is already allocated to the given core/ or is the new task being considered for allocation in the given core
+        if ((tasks_arr[i].allocated_core == core_no) || (tasks_arr[i].task_no == new_task_no)) {
 
-                    // Scheduling is done as per the virtual deadline field
-                    // For HI criticality (criticality > threshold) tasks virtual deadlines are set to x * original deadlines
-                    // For LO criticality (criticality <= threshold) tasks virtual deadlines are set to original deadlines
+            // Update virtual deadlines
+            if (tasks_arr[i].criticality <= threshold_criticality)
+                tasks_arr[i].virtual_deadline = tasks_arr[i].deadline;
+            else
+                tasks_arr[i].virtual_deadline = x * tasks_arr[i].deadline;
+        }
+    }
+}
+
+// Check if the EDF-VD Schedulability condition holds for given core, assuming we add the new task to it 
+// The virtual deadlines of the core's tasks and the new task are updated if it holds
+
+int edfvd_schedulability_check (Tasks* tasks_arr, int num_tasks, int max_criticality, int core_no, int new_task_no) {
 
-                    // For all tasks
-                    for (int i = 0 ; i < num_tasks; i++) {
+    double x = 1.0;                    // Deadline shortening factor (0.0 < x <= 1.0)
+    int threshold_criticality = edfvd_schedulability_probe (tasks_arr, num_tasks, max_criticality, core_no, new_task_no, &x);
 
-                        // Check if task is already allocated to the given core/ or is the new task being considered for allocation in the given core
-                        if ((tasks_arr[i].allocated_core == core_no) || (tasks_arr[i].task_no == new_task_no)) {
+    if (threshold_criticality > 0)
+        set_virtual_deadlines (tasks_arr, num_tasks, core_no, new_task_no, threshold_criticality, x);
+    return threshold_criticality;
+}
 
-                            // Update virtual deadlines
-                            if (tasks_arr[i].criticality <= threshold_criticality)
-                                tasks_arr[i].virtual_deadline = tasks_arr[i].deadline;
-                            else
-                                tasks_arr[i].virtual_deadline = x * tasks_arr[i].deadline;
-                        }
-                    }
+// Evaluate all open cores as candidates for the given task in one batch (side-effect free)
+// probe[j].threshold_criticality: -1 if core j cannot accommodate the task, max criticality if it stays EDF schedulable (bin-packing utilization
+// at most 1.0), else the EDF-VD threshold criticality (below max criticality) with the deadline shortening factor probe[j].x
+// Instead of one edfvd_schedulability_probe per core (a pass over the task array per utilization sum), the utilization sums of all candidate
+// cores are accumulated in a single pass over the task array. Each sum still gets its terms in task array order, so the results are bit-identical
+
+void probe_candidate_cores (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality, Core_probe *probe) {
+
+    double ull_lo[MAX_LEVELS + 1][MAX_CORES];   // ull_lo[k][j]: utilization of core j's tasks of criticality <= k at their own levels
+    double ull_hi[MAX_LEVELS + 1][MAX_CORES];   // ull_hi[k][j]: utilization of core j's tasks of criticality > k at their own levels
+    double ulk_hi[MAX_LEVELS + 1][MAX_CORES];   // ulk_hi[k][j]: utilization of core j's tasks of criticality > k at level k
+    double own_util = tasks_arr[task_idx].own_utilization;
+    double x_lb = 0.0, x_ub = 0.0;              // Bounds on the deadline shortening factor
+    int num_probes = 0;                         // Number of cores requiring the EDF-VD test
+    int first = 0, last = 0;                    // Range of cores a task's utilizations are added to
+
+    // Candidate cores: cores with enough remaining capacity (cores with split task portions and cores holding MAX_TASKS tasks are not considered)
+    for (int j = 0; j < num_cores; j++) {
+        probe[j].x = 1.0;
+        if (core[j].split_portions > 0 || core[j].tasks_alloc_count >= MAX_TASKS || core[j].remaining_capacity < own_util)
+            probe[j].threshold_criticality = -1;
+        else if (own_util + core[j].utilization > 1.00) {
+            probe[j].threshold_criticality = 0;
+            num_probes++;
+        }
+        else
+            probe[j].threshold_criticality = max_criticality;
+    }
+    if (num_probes == 0)
+        return;
+
+    memset (ull_lo, 0, sizeof (ull_lo));
+    memset (ull_hi, 0, sizeof (ull_hi));
+    memset (ulk_hi, 0, sizeof (ulk_hi));
+
+    // Accumulate the utilization sums of all cores (the new task is added to every core)
+    for (int i = 0; i < num_tasks; i++) {
+        if (i == task_idx) {
+            first = 0;
+            last = num_cores;
+        }
+        else if (tasks_arr[i].allocated_core >= 1 && tasks_arr[i].allocated_core <= num_cores) {
+            first = tasks_arr[i].allocated_core - 1;
+            last = first + 1;
+        }
+        else
+            continue;
 
-                    // Return the threshold criticality value for which the EDF-VD condition holds
-                    return threshold_criticality;
+        for (int k = 1; k <= max_criticality; k++) {
+            if (tasks_arr[i].criticality <= k) {
+                for (int j = first; j < last; j++)
+                    ull_lo[k][j] = ull_lo[k][j] + tasks_arr[i].own_utilization;
+            }
+            else {
+                for (int j = first; j < last; j++) {
+                    ull_hi[k][j] = ull_hi[k][j] + tasks_arr[i].own_utilization;
+                    ulk_hi[k][j] = ulk_hi[k][j] + tasks_arr[i].utilization[k - 1];
                 }
             }
         }
+    }
+
+    // EDF-VD conditions of the cores (same conditions as edfvd_schedulability_probe)
+    for (int j = 0; j < num_cores; j++) {
+        if (probe[j].threshold_criticality != 0)
+            continue;
+
+        // EDF schedulable by the exact sum although not by the bin-packing utilization: not accepted (threshold must be below max criticality)
+        probe[j].threshold_criticality = -1;
+        if (ull_lo[max_criticality][j] <= 1.0)
+            continue;
 
-        // No schedulability condition (EDF or EDF-VD) holds, return INVALID threshold criticality to indicate that the task cannot be allocated
-        return -73;
+        for (int k = max_criticality - 1; k > 0; k--) {
+            if (ull_lo[k][j] < 1.0) {
+                x_lb = ulk_hi[k][j] / (1.0 - ull_lo[k][j]);
+                x_ub = (1.0 - ull_hi[k][j]) / ull_lo[k][j];
+                if (x_lb <= x_ub) {
+                    probe[j].threshold_criticality = k;
+                    probe[j].x = (x_lb + x_ub) / 2;
+                    break;
+                }
+            }
+        }
     }
 }
 
+// Commit the probe result of the core selected for the given task: set the core's threshold criticality, and the virtual deadlines if EDF-VD is used
+
+void commit_core_probe (Cores *core, Tasks *tasks_arr, int num_tasks, int core_idx, int task_idx, Core_probe *probe, int max_criticality) {
+
+    core[core_idx].threshold_criticality = probe->threshold_criticality;
+    if (probe->threshold_criticality < max_criticality)
+        set_virtual_deadlines (tasks_arr, num_tasks, core[core_idx].core_no, tasks_arr[task_idx].task_no, probe->threshold_criticality, probe->x);
+}
+
 // ---------------------------------
 // OFFLINE TASK ALLOCATION FUNCTIONS
 // ---------------------------------
@@ -147,6 +243,7 @@ void initialize_cores_offline (Cores *core, int max_criticality) {
         core[i].utilization = 0.0;                               // Initialize core utilization to 0.0
         core[i].remaining_capacity = 1.0;                        // Initialize remaining capacity (for bin-packing) to 1.0
         core[i].tasks_alloc_count = 0;                           // Initialize tasks allocated count as 0
+        core[i].split_portions = 0;                              // Initialize split task portions count as 0
         for (int j = 0; j < MAX_TASKS; j++)                      // Initialize all allocated task ids to 0
             core[i].tasks_alloc_ids[j] = 0;
         core[i].threshold_criticality = max_criticality + 1;     // Initialize core threshold criticality to max criticality + 1
@@ -176,91 +273,140 @@ void reset_core_capacities (Cores *core, int num_cores, Tasks *tasks_arr, int cr
 }
 
 // Find the worst-fitting core (i.e. with maximum remaining capacity) that can accommodate the given task
+// The candidate cores are evaluated by probe_candidate_cores, and only the selected core's threshold criticality/virtual deadlines are updated
 
 int get_worst_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality) {
 
     int worst_fit_idx = -1;                             // Worst-fitting core's index
     double max_remaining_capacity = -1;                 // To maintain maximum remaining capacity among all cores
-    int idx = tasks_arr[task_idx].criticality - 1;      // Temp variable to store utilization array's index value for a task
-    int new_threshold_crit = max_criticality;           // Core's newly calculated threshold criticality value
+    Core_probe probe[MAX_CORES];                        // Schedulability of the task on each core
+
+    probe_candidate_cores (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality, probe);
 
     // For all (open) cores
     for (int j = 0 ; j < num_cores ; j++) {
 
-        // Check if the core can accommodate the given task and has more remaining capacity (after accommodating the task) than previously considered cores
-        if (core[j].remaining_capacity >= tasks_arr[task_idx].utilization[idx] && core[j].remaining_capacity - tasks_arr[task_idx].utilization[idx] > max_remaining_capacity) {
-
-            // If core utilization is going to exceed 1.0 by accommodating the given task, check EDFVD schedulability
-            if (tasks_arr[task_idx].utilization[idx] + core[j].utilization > 1.00) {
-
-                // Check if the EDFVD schedulability condition is satisfied by accommodating given task and determine the new threshold criticality for the core
-                new_threshold_crit = edfvd_schedulability_check (tasks_arr, num_tasks, max_criticality, core[j].core_no, tasks_arr[task_idx].task_no);
-
-                // If the new threshold criticality lies in valid range for EDF-VD schedulability
-                // Update the core threshold criticality, maximum remaining capacity and the worst fitting index
-                if (new_threshold_crit > 0 && new_threshold_crit < max_criticality) {
-                    core[j].threshold_criticality = new_threshold_crit;
-                    worst_fit_idx = j;
-                    max_remaining_capacity = core[j].remaining_capacity - tasks_arr[task_idx].utilization[idx];
-                }
-                // Else, core cannot accomodate the given task in current core, move on to next core (i.e. next for loop iteration)
-            }
-
-            // Else, the core utilization is less than or equal to 1.0 by accommodating the given task --> EDF schedulable
-            else {
-                core[j].threshold_criticality = max_criticality;
-                worst_fit_idx = j;
-                max_remaining_capacity = core[j].remaining_capacity - tasks_arr[task_idx].utilization[idx];
-            }
+        // Check if the core can accommodate the given task (EDF or EDF-VD) and has more remaining capacity (after accommodating the task) than previously considered cores
+        if (probe[j].threshold_criticality > 0 && core[j].remaining_capacity - tasks_arr[task_idx].own_utilization > max_remaining_capacity) {
+            worst_fit_idx = j;
+            max_remaining_capacity = core[j].remaining_capacity - tasks_arr[task_idx].own_utilization;
         }
     }
 
-    // Return worst-fitting core's index
-    // If no such core found, index returned is num_cores (out of valid range)
+    if (worst_fit_idx >= 0)
+        commit_core_probe (core, tasks_arr, num_tasks, worst_fit_idx, task_idx, &probe[worst_fit_idx], max_criticality);
+
+    // Return worst-fitting core's index (-1 if no such core found)
     return worst_fit_idx;
 }
 
 // Find the first-fitting core (i.e. first core with remaining capacity > task utilization) that can accommodate the given task
+// (The first core accommodating the task with EDF-VD ends the search, otherwise the last core that stays EDF schedulable is selected)
 
 int get_first_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality) {
 
     int first_fit_idx = -1;                             // First fitting core's index
-    int idx = tasks_arr[task_idx].criticality - 1;      // Temp variable to store utilization array's index value for a task
-    int new_threshold_crit = max_criticality;           // Core's newly calculated threshold criticality value
+    Core_probe probe[MAX_CORES];                        // Schedulability of the task on each core
+
+    probe_candidate_cores (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality, probe);
+
+    // For all (open) cores
+    for (int j = 0 ; j < num_cores ; j++) {
+        if (probe[j].threshold_criticality > 0) {
+            first_fit_idx = j;
+            if (probe[j].threshold_criticality < max_criticality)
+                break;
+        }
+    }
+
+    if (first_fit_idx >= 0)
+        commit_core_probe (core, tasks_arr, num_tasks, first_fit_idx, task_idx, &probe[first_fit_idx], max_criticality);
+
+    // Return first-fitting core's index (-1 if no such core found)
+    return first_fit_idx; 
+}
+
+// Find the best-fitting core (i.e. with minimum remaining capacity after accommodating the task) that can accommodate the given task
+
+int get_best_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality) {
+
+    int best_fit_idx = -1;                              // Best-fitting core's index
+    double min_remaining_capacity = 2.0;                // To maintain minimum remaining capacity among all cores
+    Core_probe probe[MAX_CORES];                        // Schedulability of the task on each core
+
+    probe_candidate_cores (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality, probe);
 
     // For all (open) cores
     for (int j = 0 ; j < num_cores ; j++) {
 
-        // Check if the core can accommodate the given task
-        if (core[j].remaining_capacity >= tasks_arr[task_idx].utilization[idx]) {
+        // Check if the core can accommodate the given task and has less remaining capacity (after accommodating the task) than previously considered cores
+        if (probe[j].threshold_criticality > 0 && core[j].remaining_capacity - tasks_arr[task_idx].own_utilization < min_remaining_capacity) {
+            best_fit_idx = j;
+            min_remaining_capacity = core[j].remaining_capacity - tasks_arr[task_idx].own_utilization;
+        }
+    }
 
-            // If core utilization is going to exceed 1.0 by accommodating the given task, check EDFVD schedulability
-            if (tasks_arr[task_idx].utilization[idx] + core[j].utilization > 1.00) {
+    if (best_fit_idx >= 0)
+        commit_core_probe (core, tasks_arr, num_tasks, best_fit_idx, task_idx, &probe[best_fit_idx], max_criticality);
 
-                // Check if the EDFVD schedulability condition is satisfied by accommodating given task and determine the new threshold criticality
-                new_threshold_crit = edfvd_schedulability_check (tasks_arr, num_tasks, max_criticality, core[j].core_no, tasks_arr[task_idx].task_no);
+    // Return best-fitting core's index (-1 if no such core found)
+    return best_fit_idx;
+}
 
-                // If the new threshold criticality lies in valid range for EDF-VD schedulability
-                // Update the core threshold criticality and the first fitting index
-                if (new_threshold_crit > 0 && new_threshold_crit < max_criticality) {
-                    core[j].threshold_criticality = new_threshold_crit;
-                    first_fit_idx = j;
-                    break;
-                }
-                // Else, core cannot accomodate the given task in current core, move on to next core (i.e. next for loop iteration)
-            }
+// Find the first core that can accommodate the given task, preferring the cores that already host tasks of the same criticality level
+// (Keeps the tasks of each criticality level together, so fewer cores change their threshold criticality/are affected by a mode switch)
+
+int get_criticality_first_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality) {
+
+    int first_fit_idx = -1;                             // First fitting core's index
+    int same_criticality[MAX_CORES];                    // Set if the core hosts a task of the same criticality level
+    Core_probe probe[MAX_CORES];                        // Schedulability of the task on each core
 
-            // Else, the core utilization is less than or equal to 1.0 by accommodating the given task --> EDF schedulable 
-            else { 
-                core[j].threshold_criticality = max_criticality;
+    probe_candidate_cores (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality, probe);
+
+    for (int j = 0; j < num_cores; j++)
+        same_criticality[j] = 0;
+    for (int k = 0; k < task_idx; k++) {
+        if (tasks_arr[k].allocated_core >= 1 && tasks_arr[k].allocated_core <= num_cores && tasks_arr[k].criticality == tasks_arr[task_idx].criticality)
+            same_criticality[tasks_arr[k].allocated_core - 1] = 1;
+    }
+
+    // Pass 0: cores hosting tasks of the same criticality level, pass 1: all the other cores
+    for (int pass = 0; pass < 2 && first_fit_idx < 0; pass++) {
+        for (int j = 0 ; j < num_cores ; j++) {
+            if (probe[j].threshold_criticality > 0 && same_criticality[j] == (pass == 0)) {
                 first_fit_idx = j;
+                break;
             }
         }
     }
 
-    // Return first-fitting core's index
-    // If no such core found, index returned is num_cores (out of valid range)
-    return first_fit_idx; 
+    if (first_fit_idx >= 0)
+        commit_core_probe (core, tasks_arr, num_tasks, first_fit_idx, task_idx, &probe[first_fit_idx], max_criticality);
+
+    // Return first-fitting core's index (-1 if no such core found)
+    return first_fit_idx;
+}
+
+// Find the core for the given task with the allocation heuristic (HEURISTIC_*)
+// Tasks of criticality above wfd_threshold_crit are allocated by WFD with the adaptive and WFD + FFD heuristics
+
+int get_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality, int heuristic, int wfd_threshold_crit) {
+
+    switch (heuristic) {
+        case HEURISTIC_FFD:
+            return get_first_fit_core_idx (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality);
+        case HEURISTIC_WFD:
+            return get_worst_fit_core_idx (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality);
+        case HEURISTIC_BFD:
+            return get_best_fit_core_idx (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality);
+        case HEURISTIC_CRITICALITY_FFD:
+            return get_criticality_first_fit_core_idx (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality);
+        default:
+            if (tasks_arr[task_idx].criticality > wfd_threshold_crit)
+                return get_worst_fit_core_idx (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality);
+            return get_first_fit_core_idx (core, num_cores, tasks_arr, num_tasks, task_idx, max_criticality);
+    }
 }
 
 // Allocate the given task to the core with index obtained from the allocation algorithm 
@@ -268,13 +414,11 @@ int get_first_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int nu
 
 void allocate_task_to_core (Cores *core, Tasks *tasks_arr, int core_idx, int task_idx) {
 
-    int idx = tasks_arr[task_idx].criticality - 1;       // Temp variable to store utilization array's index value for a task
-
     // Update remaining core capacity
-    core[core_idx].remaining_capacity = core[core_idx].remaining_capacity - tasks_arr[task_idx].utilization[idx];
+    core[core_idx].remaining_capacity = core[core_idx].remaining_capacity - tasks_arr[task_idx].own_utilization;
 
     // Update total core utilization
-    core[core_idx].utilization = core[core_idx].utilization + tasks_arr[task_idx].utilization[idx];
+    core[core_idx].utilization = core[core_idx].utilization + tasks_arr[task_idx].own_utilization;
 
     // Increment the count of tasks allocated to this core by 1
     core[core_idx].tasks_alloc_count++;
@@ -288,10 +432,33 @@ void allocate_task_to_core (Cores *core, Tasks *tasks_arr, int core_idx, int tas
     // Core criticality is already updated at the time of EDFVD schedulability check
 }
 
+// Deallocate the given task from its core (inverse of allocate_task_to_core, used by the runtime task changes)
+// The threshold criticality of the core is recalculated by the caller
+
+void deallocate_task_from_core (Cores *core, Tasks *tasks_arr, int core_idx, int task_idx) {
+
+    int k = 0;     // Index of the task's id in the core's list of allocated task ids
+
+    // Release the task's utilization
+    core[core_idx].remaining_capacity = core[core_idx].remaining_capacity + tasks_arr[task_idx].own_utilization;
+    core[core_idx].utilization = core[core_idx].utilization - tasks_arr[task_idx].own_utilization;
+
+    // Remove the task's id from the list of task ids allocated to the core (keeping the order of the others)
+    while (k < core[core_idx].tasks_alloc_count && core[core_idx].tasks_alloc_ids[k] != tasks_arr[task_idx].task_no)
+        k++;
+    for (; k < core[core_idx].tasks_alloc_count - 1; k++)
+        core[core_idx].tasks_alloc_ids[k] = core[core_idx].tasks_alloc_ids[k + 1];
+    core[core_idx].tasks_alloc_count--;
+
+    // The task is no longer allocated
+    tasks_arr[task_idx].allocated_core = NOT_ALLOCATED;
+}
+
 // Offline task allocation driver code
 
-int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int min_cores, int max_criticality) {
+int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int min_cores, int max_criticality, Split_task *split_arr, int *num_splits, Sim_config *config) {
 
+    int verbose = config->verbose;       // Print the allocation
     int num_cores = 0;                   // Number of cores required to schedule the given task set
     int min_LPD_cores = 0;               // Minimum number of cores reqd for low period tasks' allocation
     int wfd_threshold_crit = 0;          // All tasks above this level will be allocated using WFD bin-packing
@@ -299,34 +466,46 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
     int i = 0;                           // Index to traverse through task structure array
 
     // Get taskset info
-    Taskset_info* tasks_info;
-    tasks_info = malloc (sizeof (Taskset_info));
+    Taskset_info taskset_info;
+    Taskset_info* tasks_info = &taskset_info;
     get_taskset_info (tasks_arr, num_tasks, tasks_info, ((max_criticality / 2) + (max_criticality % 2)));
 
     // Initialize all the core structures
     initialize_cores_offline (core, max_criticality);
+    if (split_arr != NULL)
+        *num_splits = 0;
 
     // LOW PERIOD TASK ALLOCATION
 
     // Determine the minimum number of cores required to accommodate all low period tasks
     // (Ceiling of total low period tasks utilization)
-    if ((tasks_info->lpd_hi_crit_util + tasks_info->lpd_lo_crit_util) > 0.0) {
+    // (With LPD_MIXED_CORES, the low period tasks are allocated with the remaining tasks instead)
+    if (config->lpd_allocation == LPD_DEDICATED_CORES && (tasks_info->lpd_hi_crit_util + tasks_info->lpd_lo_crit_util) > 0.0) {
         min_LPD_cores = ceil(tasks_info->lpd_hi_crit_util + tasks_info->lpd_lo_crit_util);
-        printf(" Minimum number of cores reqd for LPD task allocation: %d\n", min_LPD_cores);
+        if (verbose)
+            printf(" Minimum number of cores reqd for LPD task allocation: %d\n", min_LPD_cores);
 
         // Determine allocation scheme for low period tasks
+        // (A fixed heuristic selected in the configuration uses the WFD threshold of the WFD + FFD scheme)
+        if (config->allocation_heuristic != HEURISTIC_ADAPTIVE) {
+            wfd_threshold_crit = (max_criticality / 2) + (max_criticality % 2);
+            if (verbose)
+                printf("\n Allocation scheme selected for LPD task allocation is %s\n", get_heuristic_name (config->allocation_heuristic));
+        }
+
         // If the HI criticality utilization is at most 40% of the total utilization - WFD + FFD scheme for balanced HI criticality load
-        if ((tasks_info->lpd_hi_crit_util > 0.0) && (tasks_info->lpd_hi_crit_util / (tasks_info->lpd_hi_crit_util + tasks_info->lpd_lo_crit_util) <= 0.40)) {
+        else if ((tasks_info->lpd_hi_crit_util > 0.0) && (tasks_info->lpd_hi_crit_util / (tasks_info->lpd_hi_crit_util + tasks_info->lpd_lo_crit_util) <= 0.40)) {
             wfd_threshold_crit = (max_criticality / 2) + (max_criticality % 2);
-            printf("\n Proportion of HI criticality LPD tasks <= 0.40\n Allocation scheme selected for LPD task allocation is WFD + FFD\n");
+            if (verbose)
+                printf("\n Proportion of HI criticality LPD tasks <= 0.40\n Allocation scheme selected for LPD task allocation is WFD + FFD\n");
         }
 
         // Else, only FFD scheme is followed to accommodate all the tasks in minimum number of cores
         else {
             wfd_threshold_crit = max_criticality;
-            if (tasks_info->lpd_hi_crit_util > 0.0)
+            if (verbose && tasks_info->lpd_hi_crit_util > 0.0)
                 printf("\n Proportion of HI criticality LPD tasks > 0.40\n Allocation scheme selected for LPD task allocation is FFD\n");
-            else
+            else if (verbose)
                 printf("\n Proportion of HI criticality LPD tasks = 0.00\n Allocation scheme selected for LPD task allocation is FFD\n");
         }
 
@@ -336,17 +515,14 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
         // For all low period tasks
         for (i = 0; i < num_tasks; i++) {
 
-            if (2 * (tasks_arr[i].period - tasks_arr[i].wcet[0]) < LPD_THRESHOLD) {
+            if (tasks_arr[i].lpd) {
 
                 // When moving on to tasks of next (lower) criticality level, reset bin capacities to maintain MCS feasibility condition in each core
                 if (i != 0 && tasks_arr[i-1].criticality > tasks_arr[i].criticality)
                     reset_core_capacities (core, num_cores, tasks_arr, tasks_arr[i].criticality, i);
 
-                // Find the worst-fitting core that can accommodate the given task
-                if (tasks_arr[i].criticality > wfd_threshold_crit)
-                    core_idx = get_worst_fit_core_idx (core, num_cores, tasks_arr, num_tasks, i, max_criticality);
-                else
-                    core_idx = get_first_fit_core_idx (core, num_cores, tasks_arr, num_tasks, i, max_criticality);
+                // Find the core that can accommodate the given task (worst/first-fitting core with the adaptive heuristic)
+                core_idx = get_fit_core_idx (core, num_cores, tasks_arr, num_tasks, i, max_criticality, config->allocation_heuristic, wfd_threshold_crit);
 
                 // If such worst-fitting core exists, allocate task to this core
                 if (core_idx >= 0 && core_idx < num_cores) {
@@ -373,22 +549,31 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
         }
     }
 
-    printf(" LPD task allocation complete..\n\n");
+    if (verbose)
+        printf(" LPD task allocation complete..\n\n");
 
     // DETERMINE ALLOCATION SCHEME FOR THE REMAINING TASKS
 
+    // A fixed heuristic selected in the configuration
+    if (config->allocation_heuristic != HEURISTIC_ADAPTIVE) {
+        wfd_threshold_crit = (max_criticality / 2) + (max_criticality % 2);
+        if (verbose)
+            printf("\n Allocation scheme selected for remaining task allocations is %s\n", get_heuristic_name (config->allocation_heuristic));
+    }
+
     // If the HI criticality utilization is at most 40% of the total utilization - WFD + FFD scheme for balanced HI criticality load
-    if ((tasks_info->hi_crit_util > 0.0) && (tasks_info->hi_crit_util / (tasks_info->hi_crit_util + tasks_info->lo_crit_util) <= 0.40)) {
+    else if ((tasks_info->hi_crit_util > 0.0) && (tasks_info->hi_crit_util / (tasks_info->hi_crit_util + tasks_info->lo_crit_util) <= 0.40)) {
         wfd_threshold_crit = (max_criticality / 2) + (max_criticality % 2);
-        printf("\n Proportion of HI criticality tasks <= 0.40\n Allocation scheme selected for remaining task allocations is WFD + FFD\n");
+        if (verbose)
+            printf("\n Proportion of HI criticality tasks <= 0.40\n Allocation scheme selected for remaining task allocations is WFD + FFD\n");
     }
 
     // Else, only FFD scheme is followed to accommodate all the tasks in minimum number of cores
     else {
         wfd_threshold_crit = max_criticality;
-        if (tasks_info->hi_crit_util > 0.0)
+        if (verbose && tasks_info->hi_crit_util > 0.0)
             printf("\n Proportion of HI criticality LPD tasks > 0.40\n Allocation scheme selected for remaining task allocations is FFD\n");
-        else
+        else if (verbose)
             printf("\n Proportion of HI criticality LPD tasks = 0.00\n Allocation scheme selected for remaining task allocations is FFD\n");
     }
 
@@ -399,7 +584,8 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
     if (num_cores < min_cores)
         num_cores = min_cores;
 
-    printf(" Beginning remaining task allocations with %d cores...\n", num_cores);
+    if (verbose)
+        printf(" Beginning remaining task allocations with %d cores...\n", num_cores);
 
     // For all the remaining tasks
     for (i = 0; i < num_tasks; i++) {
@@ -409,16 +595,20 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
             if (i != 0 && tasks_arr[i - 1].criticality > tasks_arr[i].criticality)
                 reset_core_capacities (core, num_cores, tasks_arr, tasks_arr[i].criticality, i);
 
-            // Find the worst-fitting core that can accommodate the given task
-            if (tasks_arr[i].criticality > wfd_threshold_crit)
-                core_idx = get_worst_fit_core_idx (core, num_cores, tasks_arr, num_tasks, i, max_criticality);
-            else
-                core_idx = get_first_fit_core_idx (core, num_cores, tasks_arr, num_tasks, i, max_criticality);
+            // Find the core that can accommodate the given task (worst/first-fitting core with the adaptive heuristic)
+            core_idx = get_fit_core_idx (core, num_cores, tasks_arr, num_tasks, i, max_criticality, config->allocation_heuristic, wfd_threshold_crit);
 
-            // If such worst-fitting core exists, allocate task to this core
+            // If such core exists, allocate task to this core
             if (core_idx >= 0 && core_idx < num_cores)
                 allocate_task_to_core (core, tasks_arr, core_idx, i);
 
+            // Semi-partitioned allocation: else split the task across the open cores (if possible) instead of opening a new core
+            // (Low period tasks are not split, their cores must not be SHUTDOWN)
+            else if (split_arr != NULL && !tasks_arr[i].lpd && split_task_across_cores (core, num_cores, tasks_arr, num_tasks, i, max_criticality, split_arr, num_splits, config) == 0) {
+                if (verbose)
+                    printf(" Task %d split across %d cores\n", tasks_arr[i].task_no, split_arr[*num_splits - 1].num_portions);
+            }
+
             // Else open a new core, and allocate the task to the newly opened core
             else {
                 num_cores++;                                             // Inrement the number of cores required for allocation
@@ -429,6 +619,10 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
                 core[core_idx].threshold_criticality = max_criticality;  // Initialize core's threshold criticality to max_criticality (EDF schedulable)
                 allocate_task_to_core (core, tasks_arr, core_idx, i);
             }
+
+            // Low period tasks allocated with the remaining tasks (LPD_MIXED_CORES) make their core NON_SHUTDOWNABLE
+            if (tasks_arr[i].lpd && tasks_arr[i].allocated_core > 0)
+                core[tasks_arr[i].allocated_core - 1].core_type = NON_SHUTDOWNABLE;
             
             // print_task_allocations (core, num_cores);
         }
@@ -438,6 +632,244 @@ int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int mi
     return num_cores;
 }
 
+// --------------------------------------------
+// SEMI-PARTITIONED ALLOCATION (TASK SPLITTING)
+// --------------------------------------------
+
+// A task that fits no open core is split into n portions (n = 2 .. MAX_PORTIONS) executed one after the other on different cores (C=D scheme):
+// every portion but the last has a window (relative deadline) equal to its budget, i.e. it is released with zero laxity and executes at once,
+// and the last portion gets the rest of the deadline. The budgets of the non-last portions are the same at every criticality level (a fixed split
+// point within the lowest criticality wcet); the last portion gets the rest of the task's wcets at all levels, so a job's budget overruns (and the
+// resulting criticality level changes) are detected exactly as for the task that is not split.
+// Utilization based tests cannot accommodate zero laxity portions, so the cores receiving portions are checked with the EDF processor demand
+// criterion with worst-case reservations (every task at its own criticality level wcet, real deadlines): such cores are scheduled by plain EDF
+// (threshold criticality = max criticality) and are not considered by the bin-packing afterwards
+// With scheduling overheads, the window of every portion also holds the worst-case job and migration overheads (the only laxity of the portion)
+
+// Get the EDF demand parameters of the tasks and split task portions allocated to a core (worst-case reservations)
+// Every job is charged the worst-case job overhead, and the portions executed after a migration also the migration overhead
+// Returns the number of demand tasks, -1 if the core holds more than MAX_TASKS tasks
+
+int get_core_demand_tasks (Demand_task *demand, Cores *core, Tasks *tasks_arr, int num_tasks, Split_task *split_arr, int num_splits, int job_overhead, int migration_overhead) {
+
+    int count = 0;                     // Number of demand tasks
+
+    for (int i = 0; i < num_tasks; i++) {
+        if (tasks_arr[i].allocated_core == core->core_no) {
+            if (count == MAX_TASKS)
+                return -1;
+            demand[count].wcet = tasks_arr[i].wcet[tasks_arr[i].criticality - 1] + job_overhead;
+            demand[count].deadline = tasks_arr[i].deadline;
+            demand[count].period = tasks_arr[i].period;
+            count++;
+        }
+    }
+
+    // (A core holds at most one portion of each split task)
+    for (int s = 0; s < num_splits; s++) {
+        for (int p = 0; p < split_arr[s].num_portions; p++) {
+            if (split_arr[s].core_no[p] == core->core_no) {
+                demand[count].wcet = split_arr[s].budget[p][tasks_arr[split_arr[s].task_idx].criticality - 1] + job_overhead + ((p > 0) ? migration_overhead : 0);
+                demand[count].deadline = split_arr[s].window[p];
+                demand[count].period = tasks_arr[split_arr[s].task_idx].period;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+// EDF processor demand criterion: the tasks are schedulable iff the demand bound function dbf(t) <= t at every absolute deadline t up to
+// L = max (D_max, sum ((T_i - D_i) * U_i) / (1 - U)) (or the hyperperiod of the tasks if U = 1)
+// Returns 1 if schedulable, 0 otherwise (also if the interval to be checked exceeds DEMAND_MAX_HORIZON)
+
+int check_processor_demand (Demand_task *demand, int count) {
+
+    double utilization = 0.0;          // Total utilization of the demand tasks
+    double busy_bound = 0.0;           // sum ((T_i - D_i) * U_i)
+    long long horizon = 0;             // Length of the interval to be checked
+    long long dbf = 0;                 // Demand bound function at a deadline
+
+    for (int i = 0; i < count; i++) {
+        utilization = utilization + (double) demand[i].wcet / demand[i].period;
+        busy_bound = busy_bound + (double)(demand[i].period - demand[i].deadline) * demand[i].wcet / demand[i].period;
+        if (demand[i].deadline > horizon)
+            horizon = demand[i].deadline;
+    }
+
+    if (utilization > 1.0 + 1e-9)
+        return 0;
+
+    // Checking interval
+    if (utilization < 1.0 - 1e-9) {
+        if (busy_bound / (1.0 - utilization) > horizon)
+            horizon = (long long) ceil (busy_bound / (1.0 - utilization));
+    }
+    else {
+        horizon = 1;
+        for (int i = 0; i < count && horizon <= DEMAND_MAX_HORIZON; i++)
+            horizon = horizon / hcf ((int) horizon, demand[i].period) * demand[i].period;
+    }
+    if (horizon > DEMAND_MAX_HORIZON)
+        return 0;
+
+    // Check the demand at every absolute deadline in the interval
+    for (int i = 0; i < count; i++) {
+        for (long long t = demand[i].deadline; t <= horizon; t = t + demand[i].period) {
+            dbf = 0;
+            for (int j = 0; j < count; j++) {
+                if (t >= demand[j].deadline)
+                    dbf = dbf + ((t - demand[j].deadline) / demand[j].period + 1) * demand[j].wcet;
+            }
+            if (dbf > t)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Find the largest budget (<= max_budget) of a zero laxity portion that keeps the core EDF schedulable (binary search)
+// The window of the portion is its budget plus the reserved overhead, which is executed in the window as well
+// (demand holds the count demand tasks of the core and room for the portion)
+
+int get_max_portion_budget (Demand_task *demand, int count, int period, int max_budget, int reserve) {
+
+    int low = 0, high = max_budget;    // Search interval (budget low is schedulable)
+    int mid = 0;
+
+    demand[count].period = period;
+    while (low < high) {
+        mid = (low + high + 1) / 2;
+        demand[count].wcet = mid + reserve;
+        demand[count].deadline = mid + reserve;
+        if (check_processor_demand (demand, count + 1))
+            low = mid;
+        else
+            high = mid - 1;
+    }
+
+    return low;
+}
+
+// Split a task that fits no open core into portions across the open cores (fewest portions first)
+// Returns 0 if the task was split (the split task is added to the split task array), -1 otherwise
+
+int split_task_across_cores (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality, Split_task *split_arr, int *num_splits, Sim_config *config) {
+
+    Tasks *task = &tasks_arr[task_idx];                                 // Task to be split
+    int c = task->criticality - 1;                                      // Index of the task's criticality level
+    Demand_task demand[MAX_CORES][MAX_TASKS + MAX_SPLIT_TASKS + 1];     // Demand tasks of each open core (and room for a portion)
+    int demand_count[MAX_CORES];                                        // Number of demand tasks of each open core (-1: core not considered)
+    int max_budget[MAX_CORES];                                          // Maximum budget of a zero laxity portion on each core
+    int order[MAX_CORES];                                               // Cores in decreasing order of their maximum portion budgets
+    Split_task split;                                                   // Split being constructed
+    int job_overhead = get_job_overhead (config);                       // Worst-case overhead charged to every job (preemption, blocking)
+    int reserve = job_overhead + config->migration_overhead;            // Overhead reserved in the window of every portion (executed after a migration)
+    int total_budget = 0;                                               // Sum of the budgets of the non-last portions
+    int total_window = 0;                                               // Sum of the windows of the non-last portions
+    int budget = 0;                                                     // Budget of a portion
+    int last = 0;                                                       // Index of the core of the last portion
+    int core_idx = 0;                                                   // Index of the core of a portion
+    int p = 0, tmp = 0;
+
+    // LPD tasks are not split, and the lowest criticality wcet must leave a budget for each portion
+    if (*num_splits >= MAX_SPLIT_TASKS || is_lpd_task (task) || task->wcet[0] < 2)
+        return -1;
+
+    // Maximum budget of a zero laxity portion on each core (at least one time unit of the lowest criticality wcet is left for the last portion)
+    for (int j = 0; j < num_cores; j++) {
+        demand_count[j] = get_core_demand_tasks (demand[j], &core[j], tasks_arr, num_tasks, split_arr, *num_splits, job_overhead, config->migration_overhead);
+        max_budget[j] = 0;
+        if (demand_count[j] >= 0 && check_processor_demand (demand[j], demand_count[j]))
+            max_budget[j] = get_max_portion_budget (demand[j], demand_count[j], task->period, task->wcet[0] - 1, reserve);
+        order[j] = j;
+    }
+    for (int j = 1; j < num_cores; j++) {
+        for (int m = j; m > 0 && max_budget[order[m]] > max_budget[order[m - 1]]; m--) {
+            tmp = order[m];
+            order[m] = order[m - 1];
+            order[m - 1] = tmp;
+        }
+    }
+
+    // Try splitting the task into n portions (on n different cores)
+    for (int n = 2; n <= MAX_PORTIONS && n <= num_cores; n++) {
+
+        // Try each core as the core of the last portion (least spare capacity first), the other portions on the cores with the largest budgets
+        for (int l = num_cores - 1; l >= 0; l--) {
+
+            last = order[l];
+            if (demand_count[last] < 0)
+                continue;
+
+            memset (&split, 0, sizeof (Split_task));
+            split.task_idx = task_idx;
+            split.num_portions = n;
+            total_budget = 0;
+            total_window = 0;
+            p = 0;
+
+            for (int m = 0; m < num_cores && p < n - 1; m++) {
+                budget = max_budget[order[m]];
+                if (budget > task->wcet[0] - 1 - total_budget)
+                    budget = task->wcet[0] - 1 - total_budget;
+                if (m == l || budget <= 0)
+                    continue;
+                split.core_no[p] = core[order[m]].core_no;
+                split.offset[p] = total_window;
+                split.window[p] = budget + reserve;
+                for (int k = 0; k < MAX_LEVELS; k++)
+                    split.budget[p][k] = budget;
+                total_budget = total_budget + budget;
+                total_window = total_window + split.window[p];
+                p++;
+            }
+
+            // Not enough cores with spare capacity for the non-last portions
+            if (p < n - 1)
+                continue;
+
+            // Last portion: the rest of the deadline and of the wcets at all levels
+            split.core_no[p] = core[last].core_no;
+            split.offset[p] = total_window;
+            split.window[p] = task->deadline - total_window;
+            for (int k = 0; k < MAX_LEVELS; k++)
+                split.budget[p][k] = task->wcet[(k < c) ? k : c] - total_budget;
+            if (split.window[p] <= 0)
+                continue;
+
+            demand[last][demand_count[last]].wcet = split.budget[p][c] + reserve;
+            demand[last][demand_count[last]].deadline = split.window[p];
+            demand[last][demand_count[last]].period = task->period;
+            if (!check_processor_demand (demand[last], demand_count[last] + 1))
+                continue;
+
+            // Allocate the portions to their cores (plain EDF: original deadlines as virtual deadlines)
+            split_arr[*num_splits] = split;
+            (*num_splits)++;
+            task->allocated_core = SPLIT_TASK;
+            for (p = 0; p < n; p++) {
+                core_idx = split.core_no[p] - 1;
+                split_arr[*num_splits - 1].virtual_window[p] = split.window[p];
+                core[core_idx].split_portions++;
+                core[core_idx].threshold_criticality = max_criticality;
+                core[core_idx].utilization = core[core_idx].utilization + (double) split.budget[p][c] / task->period;
+                core[core_idx].remaining_capacity = core[core_idx].remaining_capacity - (double) split.budget[p][c] / task->period;
+                for (int i = 0; i < num_tasks; i++) {
+                    if (tasks_arr[i].allocated_core == core[core_idx].core_no)
+                        tasks_arr[i].virtual_deadline = tasks_arr[i].deadline;
+                }
+            }
+
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
 // -----------------
 // HELPER FUNCTIONS
 // -----------------
@@ -467,3 +899,24 @@ void print_task_allocations (Cores *core, int num_cores) {
 
     printf(" ------------------------------------------------------------------------------\n");
 }
+
+// Helper function to print the portions of the split tasks
+
+void print_split_tasks (Tasks *tasks_arr, Split_task *split_arr, int num_splits) {
+
+    Tasks *task;
+
+    for (int s = 0; s < num_splits; s++) {
+        task = &tasks_arr[split_arr[s].task_idx];
+        printf(" Task %d split into %d portions:\n", task->task_no, split_arr[s].num_portions);
+        for (int p = 0; p < split_arr[s].num_portions; p++) {
+            printf("   Portion %d: core %d, window [%d, %d), virtual window %lf, budgets:", p + 1, split_arr[s].core_no[p],
+                   split_arr[s].offset[p], split_arr[s].offset[p] + split_arr[s].window[p], split_arr[s].virtual_window[p]);
+            for (int k = 0; k < task->criticality; k++)
+                printf(" %d", split_arr[s].budget[p][k]);
+            printf("\n");
+        }
+    }
+    if (num_splits > 0)
+        printf("\n");
+}
@@ -7,34 +7,46 @@
 // SLACK CALCULATION FUNCTIONS
 // ---------------------------
 
-// Copies all non-DISCARDED jobs present in the run queue to a dummy queue
+// Copies all non-DISCARDED jobs present in the ready queue (and the currently executing job) to a dummy queue
+// At the current criticality level, the discarded jobs already scheduled in the core (below the accepted level) execute too, so they are copied as well
 
-void copy_jobs_to_dummy_queue (RQ_HEAD *head, RQ_HEAD *dummy_head, int threshold_criticality, int level) {
+void copy_jobs_to_dummy_queue (Ready_queue *rq, Jobs *curr_exe_job, RQ_HEAD *dummy_head, int threshold_criticality, int level, int current_level) {
 
-    RQ_NODE *temp;    // Temporary node variable
+    RQ_NODE *temp;                                                                    // Temporary node variable
+    int accept_level = accept_above_criticality_level (level, threshold_criticality);  // Lowest non-DISCARDED criticality level at the given level
 
-    // Traverse the entire run queue
-    temp = head->head_node;
-    while (temp != NULL) {
-    
-        // Copy all non-DISCARDED jobs from run queue to dummy queue
-        // * NOTE: This check is required when the slack calculation is being done for criticality levels > current criticality level of the system 
-        if (temp->job->job_criticality >= accept_above_criticality_level (level, threshold_criticality))
+    if (level == current_level)
+        accept_level = 1;
+
+    // The currently executing job is not present in the ready queue (lazy preemption), it must be accounted for separately
+    if (curr_exe_job->task_no != IDLE_TASK_NO && curr_exe_job->job_criticality >= accept_level)
+        update_run_queue (dummy_head, curr_exe_job);
+
+    // Copy all non-DISCARDED jobs from the ready queue to dummy queue
+    // * NOTE: Buckets below the accepted level are skipped when the slack calculation is being done for criticality levels > current criticality level of the system 
+    // (The scheduling deadline of each job is refreshed from the active order of the ready queue)
+    for (int i = accept_level - 1; i < MAX_LEVELS; i++) {
+        temp = rq->bucket[rq->deadline_type][i].head_node;
+        while (temp != NULL) {
+            temp->job->sched_deadline = get_job_deadline (temp->job, rq->deadline_type);
             update_run_queue (dummy_head, temp->job);
-        temp = temp->next;
+            temp = temp->next;
+        }
     }
 }
 
 // Anticipates jobs arriving before the specified max_arrival_time and adds them to the dummy queue in EDF order
 
-void add_anticipated_arrivals (RQ_HEAD *dummy_head, double max_arrival_time, Tasks *task_ptr, int num_tasks, int threshold_criticality, int level, int core_no, int current_time) {
+void add_anticipated_arrivals (Sim_context *ctx, RQ_HEAD *dummy_head, double max_arrival_time, int threshold_criticality, int level, int core_no, double current_time) {
 
-    double next_arrival = 0;    // Time-instant at which the next job arrives
+    Tasks *task_ptr = ctx->tasks_arr;    // Task structure array
+    double next_arrival = 0;             // Time-instant at which the next job arrives
+    Jobs *j;                             // Anticipated job
 
     // Adding anticipated non-DISCARDED job arrivals: arrivals starting from current_time till max_arrival_time
     
     // For all tasks 
-    for (int i = 0 ; i < num_tasks ; i++) {
+    for (int i = 0 ; i < ctx->num_tasks ; i++) {
 
         // Check if the task belongs to the given core and is a non-DISCARDED job at the specified criticality level 
         if (task_ptr[i].allocated_core == core_no && task_ptr[i].criticality >= accept_above_criticality_level (level, threshold_criticality)) {
@@ -46,12 +58,9 @@ void add_anticipated_arrivals (RQ_HEAD *dummy_head, double max_arrival_time, Tas
             // TODO: Verify that it is strictly less than and not less than or equal to
             while (next_arrival < max_arrival_time) {
 
-                // Allocate memory for a new job structure 
-                Jobs *j;
-                j = malloc (sizeof (Jobs));
-
                 // Create a new job structure and set the job parameter values
-                j = create_job_structure (task_ptr, i, threshold_criticality, core_no, next_arrival);
+                j = create_job_structure (ctx, i, threshold_criticality, core_no, next_arrival);
+                j->status_flag = ANTICIPATED;
 
                 // print_run_queue (dummy_head);
 
@@ -65,12 +74,65 @@ void add_anticipated_arrivals (RQ_HEAD *dummy_head, double max_arrival_time, Tas
             }
         }
     }
+
+    // Anticipated non-DISCARDED releases of the split task portions allocated to the core (semi-partitioned allocation)
+    for (int s = 0; s < ctx->num_splits; s++) {
+        if (task_ptr[ctx->split[s].task_idx].criticality < accept_above_criticality_level (level, threshold_criticality))
+            continue;
+
+        for (int p = 0; p < ctx->split[s].num_portions; p++) {
+            if (ctx->split[s].core_no[p] == core_no) {
+                next_arrival = get_next_portion_arrival (task_ptr, ctx->split[s].task_idx, ctx->split[s].offset[p], current_time);
+                while (next_arrival < max_arrival_time) {
+                    j = create_portion_job (ctx, &ctx->split[s], p, threshold_criticality, core_no, next_arrival);
+                    j->status_flag = ANTICIPATED;
+                    update_run_queue (dummy_head, j);
+                    next_arrival = next_arrival + task_ptr[ctx->split[s].task_idx].period;
+                }
+            }
+        }
+    }
+}
+
+// Delete the tail node of the dummy queue
+// (The dummy queue may hold more than one node for the same job, so the node is unlinked directly instead of searching by job number)
+// Anticipated jobs belong to the dummy queue and are freed with their node, the jobs copied from the ready queue are left untouched
+
+void delete_tail_node (RQ_HEAD *dummy_head, RQ_NODE *tail) {
+
+    if (tail->prev != NULL)
+        tail->prev->next = NULL;
+    else
+        dummy_head->head_node = NULL;
+
+    dummy_head->size = dummy_head->size - 1;
+    if (tail->job->status_flag == ANTICIPATED)
+        free (tail->job);
+    free (tail);
+}
+
+// Free a dummy queue once the slack calculations are complete (the slack calculation empties it, any node left is freed here)
+
+void free_dummy_queue (RQ_HEAD *dummy_head) {
+
+    RQ_NODE *temp = dummy_head->head_node;      // Node being freed
+    RQ_NODE *next;
+
+    while (temp != NULL) {
+        next = temp->next;
+        if (temp->job->status_flag == ANTICIPATED)
+            free (temp->job);
+        free (temp);
+        temp = next;
+    }
+    free (dummy_head);
 }
 
 // Slack calculation (using Dynamic Procrastination): 
 // Slack = (latest time by which run queue jobs must start executing in order to guarantee completion by deadline) - (window time consumed by the anticipated jobs)
+// Every job also reserves the worst-case job overhead (preemption overhead, non-preemptive blocking) accounted by the schedulability analysis
 
-double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, double max_deadline, int current_time, int level) {
+double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, double max_deadline, double current_time, int level, int job_overhead) {
 
     RQ_NODE *temp;                                // Temporary node pointer to traverse through the dummy queue 
     RQ_NODE *temp1;                               // Temporary node pointer to hold temp->prev when deleting job at temp
@@ -91,11 +153,11 @@ double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, do
 
         // Case 1: Jobs arriving after latest arrival time having deadlines > max deadline --> need to partially execute by max deadline
         if (temp->job->sched_deadline > max_deadline) { 
-            latest_start_time = latest_start_time - (double)((max_deadline - temp->job->arrival_time) * temp->job->wcet_budget [level - 1]) /(double)(temp->job->sched_deadline - temp->job->arrival_time);
+            latest_start_time = latest_start_time - (double)((max_deadline - temp->job->arrival_time) * (temp->job->wcet_budget [level - 1] + job_overhead)) /(double)(temp->job->sched_deadline - temp->job->arrival_time);
             
             // Remove this job from dummy queue
             temp1 = temp->prev;
-            delete_job_from_queue (dummy_head, temp->job);
+            delete_tail_node (dummy_head, temp);
         }
      
         // Case 2: Jobs (arriving before or after latest arrival time) with deadlines (di) such that: latest arrival time < di < max deadline --> need to execute completely
@@ -107,15 +169,15 @@ double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, do
 
             // If the job has not yet arrived, reserve wcet at given level
             if (temp->job->arrival_time > current_time)
-                latest_start_time = latest_start_time - temp->job->wcet_budget [level - 1];
+                latest_start_time = latest_start_time - temp->job->wcet_budget [level - 1] - job_overhead;
             
             // If the job has already arrived, reserve time for remaining execution time 
             else 
-                latest_start_time = latest_start_time - temp->job->execution_time;
+                latest_start_time = latest_start_time - temp->job->execution_time - job_overhead;
 
             // Remove this job from dummy queue
             temp1 = temp->prev;
-            delete_job_from_queue (dummy_head, temp->job);
+            delete_tail_node (dummy_head, temp);
         }
 
         // Case 3: Jobs with deadlines < latest arrival time --> need to execute completely, taking up time from the discarded job's execution window
@@ -124,15 +186,15 @@ double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, do
         
             // If the job has not yet arrived, reserve wcet at given level 
             if (temp->job->arrival_time > current_time)
-                window_time_consumed = window_time_consumed + temp->job->wcet_budget [level - 1]; 
+                window_time_consumed = window_time_consumed + temp->job->wcet_budget [level - 1] + job_overhead; 
                 
             // If the job has already arrived, reserve time for remaining execution 
             else
-                window_time_consumed = window_time_consumed + temp->job->execution_time;
+                window_time_consumed = window_time_consumed + temp->job->execution_time + job_overhead;
                 
             // Remove this job from dummy queue
             temp1 = temp->prev;
-            delete_job_from_queue (dummy_head, temp->job);
+            delete_tail_node (dummy_head, temp);
         }  
         
         // Move to the previous node (temp = temp->prev)  
@@ -157,8 +219,24 @@ double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, do
 // DYNAMIC PROCRASTINATOR TO CALCULATE SHUTDOWN TIME
 // --------------------------------------------------
 
-void get_dynamic_procrastination_slack (Cores *core, int core_idx, Tasks *task_arr, int num_tasks, double next_job_deadline, int max_criticality, int current_level, int hyperperiod, double current_time) {
+// Get the latest time up to which the slack calculations anticipate job arrivals (one super-hyperperiod ahead, at most the end of the simulation)
+// (the end of the super-hyperperiod for a single super-hyperperiod simulation)
+
+double get_anticipation_horizon (Sim_context *ctx, double current_time) {
 
+    double horizon = current_time + ctx->hyperperiod;     // One super-hyperperiod ahead
+
+    if (horizon > ctx->end_time)
+        horizon = ctx->end_time;
+    return horizon;
+}
+
+void get_dynamic_procrastination_slack (Sim_context *ctx, int core_idx, double next_job_deadline, double current_time) {
+
+    Cores *core = ctx->core;                                     // Core structure array
+    int max_criticality = ctx->max_criticality;                  // Maximum criticality level defined for the taskset
+    int current_level = ctx->current_level;                      // Current criticality level of the system
+    double horizon = get_anticipation_horizon (ctx, current_time);    // Latest anticipated job arrival
     double max_deadline[max_criticality - current_level + 1];    // Maximum deadline among all jobs arriving before latest_arrival
     RQ_NODE *temp;                                               // Temporary node to traverse through the dummy queue
 
@@ -172,8 +250,8 @@ void get_dynamic_procrastination_slack (Cores *core, int core_idx, Tasks *task_a
     for (int i = 0; i < (max_criticality - current_level + 1); i++) {
          
         // Add all jobs arriving before next arrival to dummy queue in EDF order
-        copy_jobs_to_dummy_queue (core[core_idx].qhead, dummy_head[i], core[core_idx].threshold_criticality, current_level + i);
-        add_anticipated_arrivals (dummy_head[i], next_job_deadline, task_arr, num_tasks, core[core_idx].threshold_criticality, current_level + i , core[core_idx].core_no, current_time);
+        copy_jobs_to_dummy_queue (core[core_idx].ready_queue, core[core_idx].curr_exe_job, dummy_head[i], core[core_idx].threshold_criticality, current_level + i, current_level);
+        add_anticipated_arrivals (ctx, dummy_head[i], next_job_deadline, core[core_idx].threshold_criticality, current_level + i , core[core_idx].core_no, current_time);
 
         // Get maximum deadline among all dummy queue jobs 
         temp = dummy_head[i]->head_node;
@@ -183,27 +261,84 @@ void get_dynamic_procrastination_slack (Cores *core, int core_idx, Tasks *task_a
             max_deadline[i] = temp->job->sched_deadline;
         }
         else 
-            max_deadline[i] = hyperperiod;
+            max_deadline[i] = horizon;
             
-        if (max_deadline[i] > hyperperiod)
-            max_deadline[i] = hyperperiod;
+        if (max_deadline[i] > horizon)
+            max_deadline[i] = horizon;
 
         // Add anticipated all non-DISCARDED job arrivals (such that latest_arrival <= job arrival < max deadline at to the dummy queue in EDF order
-        add_anticipated_arrivals (dummy_head[i], max_deadline[i], task_arr, num_tasks, core[core_idx].threshold_criticality, current_level + i, core[core_idx].core_no, next_job_deadline -  TIME_GRANULARITY);
+        add_anticipated_arrivals (ctx, dummy_head[i], max_deadline[i], core[core_idx].threshold_criticality, current_level + i, core[core_idx].core_no, next_job_deadline -  TIME_GRANULARITY);
 
         // Calculate the slack obtained by dynamically procrastinating jobs
-        core[core_idx].slack_available[i] = calculate_slack_available (dummy_head[i], next_job_deadline, max_deadline[i], current_time, current_level + i); 
+        core[core_idx].slack_available[i] = calculate_slack_available (dummy_head[i], next_job_deadline, max_deadline[i], current_time, current_level + i, get_job_overhead (&ctx->config)); 
         
     }
+
+    for (int i = 0; i < (max_criticality - current_level + 1); i++)
+        free_dummy_queue (dummy_head[i]);
 }
 
 // -----------------------
 // DISCARDED JOB SCHEDULER
 // -----------------------
 
+// Slack cache: within one decision point, the slack available in a core (and the expected completion time of a discarded job)
+// depends only on the core's run queue, the criticality level and the discarded job's deadline (horizon)
+// So it is calculated once per (core, level, horizon) and reused for all discarded job candidates, until the core's run queue changes
+
+// Invalidate all cached slack values of a core
+
+void invalidate_slack_cache (Slack_cache *cache) {
+    cache->size = 0;
+    cache->next = 0;
+}
+
+// Look up the cached slack values for the given level and horizon (returns NULL on a cache miss)
+
+Slack_cache_entry* lookup_slack_cache (Slack_cache *cache, int level, double horizon) {
+
+    for (int i = 0; i < cache->size; i++) {
+        if (cache->entry[i].level == level && cache->entry[i].horizon == horizon)
+            return &cache->entry[i];
+    }
+
+    return NULL;
+}
+
+// Cache the slack values calculated for the given level and horizon (the oldest entry is replaced if the cache is full)
+
+void insert_slack_cache (Slack_cache *cache, int level, double horizon, double slack_available, double optimal_slack, double expected_completion_time) {
+
+    Slack_cache_entry *entry = &cache->entry[cache->next];
+
+    entry->level = level;
+    entry->horizon = horizon;
+    entry->slack_available = slack_available;
+    entry->optimal_slack = optimal_slack;
+    entry->expected_completion_time = expected_completion_time;
+
+    cache->next = (cache->next + 1) % SLACK_CACHE_SIZE;
+    if (cache->size < SLACK_CACHE_SIZE)
+        cache->size++;
+}
+
 // Schedules discarded job if enough slack is available for it to execute
 
-void schedule_discarded_job (RQ_HEAD *head, RQ_HEAD **dhead, Tasks *task_ptr, int num_tasks, int threshold_criticality, int max_criticality, int current_level, int core_no, int hyperperiod, double current_time) {
+void schedule_discarded_job (Sim_context *ctx, int core_idx, double current_time) {
+
+    Ready_queue *rq = ctx->core[core_idx].ready_queue;                     // Core's ready queue
+    Jobs *curr_exe_job = ctx->core[core_idx].curr_exe_job;                 // Job currently executing on the core (not in the run queue)
+    Discarded_queue *dhead = ctx->dhead;                                   // Discarded queues (per criticality level)
+    Tasks *task_ptr = ctx->tasks_arr;                                      // Task structure array
+    int num_tasks = ctx->num_tasks;                                        // Number of tasks
+    int threshold_criticality = ctx->core[core_idx].threshold_criticality; // Core's EDF-VD threshold criticality
+    int max_criticality = ctx->max_criticality;                            // Maximum criticality level defined for the taskset
+    int current_level = ctx->current_level;                                // Current criticality level of the system
+    int core_no = ctx->core[core_idx].core_no;                             // Core number
+    double horizon = get_anticipation_horizon (ctx, current_time);         // Latest anticipated job arrival
+    int job_overhead = get_job_overhead (&ctx->config);                    // Worst-case overhead reserved for every job
+    int migration_cost = 0;                                                // Migration overhead of the discarded job (if executed on another core)
+    int expired = 0;                                                       // Number of discarded jobs expired in a discarded queue
     
     // Arrays to store parameter values required for slack calculation at different criticality levels (>= current level)
 
@@ -211,18 +346,22 @@ void schedule_discarded_job (RQ_HEAD *head, RQ_HEAD **dhead, Tasks *task_ptr, in
     double slack_available[max_criticality - current_level + 1];           // Slack available for discarded job execution 
                                                                            // (as determined by proposed algorithm)
     double optimal_slack[max_criticality - current_level + 1];             // Optimal slack available for discarded job execution 
-                                                                           // (as determined by anticipating all job arrivals till hyperperiod)
+                                                                           // (as determined by anticipating all job arrivals till the horizon)
     double expected_completion_time[max_criticality - current_level + 1];  // If discarded job is scheduled, the expected time by which it will complete
     
     int next_arrival = 0;                                                  // Temporary variable to store next arrival times
     int i = 0;                                                             // Index to traverse through discarded queue heads (for different criticality levels) 
     int temp_count = 0;                                                    // Temporary count variable -- used to check if slack is available at all criticality levels
-    RQ_NODE *temp;                                                         // Temporary variable to traverse through discarded queues
+    RQ_NODE *temp;                                                         // Temporary variable to traverse through run/dummy queues
     
     // Discarded job struct
-    Jobs *discarded_job;
-    discarded_job = malloc (sizeof (Jobs));
-    discarded_job->task_no = IDLE_TASK_NO;
+    Jobs *discarded_job = NULL;
+
+    // Cached slack values (for candidates with the same deadline)
+    Slack_cache_entry *cache_entry;
+
+    // New decision point -- slack values cached at earlier decision points are stale
+    invalidate_slack_cache (&ctx->core[core_idx].slack_cache);
 
     // Create dummy queues (for each criticality level >= current level) -- required for slack calculation 
     // Maintains all non-DISCARDED (already arrived + anticipated arrivals) jobs at given criticality level in EDF order
@@ -231,22 +370,21 @@ void schedule_discarded_job (RQ_HEAD *head, RQ_HEAD **dhead, Tasks *task_ptr, in
         dummy_head[i] = create_run_queue ();
 
     // Delete all jobs that are going to exceed/have already exceeded their deadlines
-
-    // For all discarded job queues
-    for (i = 0; i < current_level - 1; i++) {
-        temp = dhead[i]->head_node;
-        while (temp != NULL) {
-        
-            // Delete all jobs satisfying the condition (deadline + wcet [current_level]) < current_time
-            if ((temp->job->sched_deadline - temp->job->wcet_budget[current_level - 1]) < current_time) 
-                delete_job_from_queue (dhead[i], temp->job);
-            temp = temp->next; 
-        }
+    // i.e. all jobs satisfying the condition (deadline - wcet) < current_time -- these are always at the top of the discarded queues
+
+    // For all discarded job queues (including those at/above the current level after a criticality de-escalation)
+    // (Job lists spliced into the discarded queues on mode change are added to the heaps first)
+    for (i = 0; i < max_criticality - 1; i++) {
+        absorb_staged_jobs (ctx, i);
+        expired = expire_discarded_jobs (&dhead[i], current_time);
+        ctx->stats.discarded_jobs_expired += expired;
+        if (expired > 0)
+            trace_instant (ctx, 0, "Discarded jobs expired", "discard", current_time, NULL, "jobs", expired);
     }
  
     // Consider the highest criticality non-empty discarded queue for scheduling 
-    for (i = current_level - 2; i >= 0 ; i--) { 
-        if (dhead[i]->head_node != NULL)
+    for (i = max_criticality - 2; i >= 0 ; i--) { 
+        if (dhead[i].size > 0)
             break;
     }
    
@@ -254,70 +392,94 @@ void schedule_discarded_job (RQ_HEAD *head, RQ_HEAD **dhead, Tasks *task_ptr, in
     if (i >= 0) {
 
         // Schedule discarded job from the given queue
-        while (dhead[i]->head_node != NULL) {
+        while (dhead[i].size > 0) {
         
-            // Pick the first (earliest deadline) job from discarded queue 
-            discarded_job = schedule_next_job (dhead[i]);         // *** NOTE - schedule_next_job (head) is a misnomer, this fn only dequeues the first job in the queue, does NOT schedule it
+            // Pick the first (earliest latest start time) job from discarded queue 
+            discarded_job = remove_discarded_job (&dhead[i]);
+            temp_count = 0;
             
             // For all criticality levels >= current level
             // Calculate slack, if job slack > discarded_job wcet for all levels ---> add to given core's run queue
             for (int ii = 0; ii < (max_criticality - current_level + 1); ii++) {
 
-                // Add all jobs arriving before discarded job deadline to dummy queue in EDF order for slack calculation
-                copy_jobs_to_dummy_queue (head, dummy_head[ii], threshold_criticality, current_level + ii);
-                add_anticipated_arrivals (dummy_head[ii], discarded_job->sched_deadline, task_ptr, num_tasks, threshold_criticality, current_level + ii , core_no, current_time);
-            
-                // Get maximum deadline 
-                temp = dummy_head[ii]->head_node;
-                if (temp != NULL) {
-                    while (temp->next != NULL)
-                        temp = temp->next;
-                    max_deadline[ii] = temp->job->sched_deadline;
-                }
-                
-                // TODO: Confirm the slack calculation for this case
-                // When no jobs present in dummy queue -- calculate optimal slack
-                else {
-                    max_deadline[ii] = hyperperiod;
+                // Reuse the slack calculated for an earlier candidate with the same deadline at this level (run queue unchanged)
+                cache_entry = lookup_slack_cache (&ctx->core[core_idx].slack_cache, current_level + ii, discarded_job->sched_deadline);
+                if (cache_entry != NULL) {
+                    slack_available[ii] = cache_entry->slack_available;
+                    optimal_slack[ii] = cache_entry->optimal_slack;
+                    expected_completion_time[ii] = cache_entry->expected_completion_time;
+                    ctx->stats.slack_cache_hits++;
                 }
- 
-                if (max_deadline[ii] > hyperperiod)
-                    max_deadline[ii] = hyperperiod;
-
-                // Add anticipated all non-DISCARDED job arrivals (such that job arrival >= discarded job deadline) at to the dummy queue in EDF order
-                add_anticipated_arrivals (dummy_head[ii], max_deadline[ii], task_ptr, num_tasks, threshold_criticality, current_level + ii, core_no, discarded_job->sched_deadline -  TIME_GRANULARITY);
 
-                // Calculate the slack available for execution of discarded job at given level
-                slack_available[ii] = calculate_slack_available (dummy_head[ii], discarded_job->sched_deadline, max_deadline[ii], current_time, current_level + ii);
+                else {
 
-                // Calculate the optimal slack available for execution of discarded job at given level
-                // (Optimal slack is calculated by reserving execution times for all jobs arriving till hyperperiod)
-                copy_jobs_to_dummy_queue (head, dummy_head[ii], threshold_criticality, current_level + ii);
-                add_anticipated_arrivals (dummy_head[ii], hyperperiod, task_ptr, num_tasks, threshold_criticality, current_level + ii, core_no, current_time);
-                optimal_slack[ii] = calculate_slack_available (dummy_head[ii], discarded_job->sched_deadline, hyperperiod, current_time, current_level + ii);
+                    // Add all jobs arriving before discarded job deadline to dummy queue in EDF order for slack calculation
+                    copy_jobs_to_dummy_queue (rq, curr_exe_job, dummy_head[ii], threshold_criticality, current_level + ii, current_level);
+                    add_anticipated_arrivals (ctx, dummy_head[ii], discarded_job->sched_deadline, threshold_criticality, current_level + ii , core_no, current_time);
+                
+                    // Get maximum deadline 
+                    temp = dummy_head[ii]->head_node;
+                    if (temp != NULL) {
+                        while (temp->next != NULL)
+                            temp = temp->next;
+                        max_deadline[ii] = temp->job->sched_deadline;
+                    }
+                    
+                    // TODO: Confirm the slack calculation for this case
+                    // When no jobs present in dummy queue -- calculate optimal slack
+                    else {
+                        max_deadline[ii] = horizon;
+                    }
+     
+                    if (max_deadline[ii] > horizon)
+                        max_deadline[ii] = horizon;
+
+                    // Add anticipated all non-DISCARDED job arrivals (such that job arrival >= discarded job deadline) at to the dummy queue in EDF order
+                    add_anticipated_arrivals (ctx, dummy_head[ii], max_deadline[ii], threshold_criticality, current_level + ii, core_no, discarded_job->sched_deadline -  TIME_GRANULARITY);
+
+                    // Calculate the slack available for execution of discarded job at given level
+                    slack_available[ii] = calculate_slack_available (dummy_head[ii], discarded_job->sched_deadline, max_deadline[ii], current_time, current_level + ii, job_overhead);
+
+                    // Calculate the optimal slack available for execution of discarded job at given level
+                    // (Optimal slack is calculated by reserving execution times for all jobs arriving till the horizon -- only required for printing)
+                    optimal_slack[ii] = NA;
+                    if (ctx->config.verbose) {
+                        copy_jobs_to_dummy_queue (rq, curr_exe_job, dummy_head[ii], threshold_criticality, current_level + ii, current_level);
+                        add_anticipated_arrivals (ctx, dummy_head[ii], horizon, threshold_criticality, current_level + ii, core_no, current_time);
+                        optimal_slack[ii] = calculate_slack_available (dummy_head[ii], discarded_job->sched_deadline, horizon, current_time, current_level + ii, job_overhead);
+                    }
 
-                printf("\n Slack calculated: %lf\t Optimal slack: %lf for discarded job (Task %d Job %d) at level %d in core %d\n", slack_available [ii], optimal_slack [ii], discarded_job->task_no, discarded_job->job_no, current_level + ii, core_no);
+                    // Ensure that scheduling the discarded job in consideration does not delay the completion of any higher criticality discarded job 
+                    // arriving in near future (that can be scheduled in the available slack time) 
 
-                // Ensure that scheduling the discarded job in consideration does not delay the completion of any higher criticality discarded job 
-                // arriving in near future (that can be scheduled in the available slack time) 
+                    // 1. Get expected time of completion of the discarded job to be scheduled
 
-                // 1. Get expected time of completion of the discarded job to be scheduled
+                    expected_completion_time[ii] = current_time;   // Initialize expected completion time to current current_time
 
-                temp = head->head_node;
-                expected_completion_time[ii] = current_time;   // Initialize expected completion time to current current_time
-                
-                // Traverse through the core's local run queue                
-                while (temp != NULL) {
-                
-                    // Consider all run queue jobs with deadlines <= discarded job deadlines
-                    if (temp->job->sched_deadline > discarded_job->sched_deadline) 
-                        break;
+                    // Account for the currently executing job (not in the run queue)
+                    if (curr_exe_job->task_no != IDLE_TASK_NO && curr_exe_job->sched_deadline <= discarded_job->sched_deadline)
+                        expected_completion_time[ii] = expected_completion_time[ii] + curr_exe_job->wcet_budget[current_level + ii - 1];
                     
-                    // Expected time of completion = (current_time + summation of wcets of all such jobs) 
-                    // (No need to anticipate special cases - can be optimistic at the time of discarded job scheduling)   
-                    expected_completion_time[ii] = expected_completion_time[ii] + temp->job->wcet_budget[current_level + ii - 1]; 
-                    temp=temp->next;                                                                                  
+                    // Traverse through the core's local ready queue (each bucket is in EDF order)
+                    for (int b = 0; b < MAX_LEVELS; b++) {
+                        temp = rq->bucket[rq->deadline_type][b].head_node;
+                        while (temp != NULL) {
+                        
+                            // Consider all ready jobs with deadlines <= discarded job deadlines
+                            if (get_job_deadline (temp->job, rq->deadline_type) > discarded_job->sched_deadline) 
+                                break;
+                            
+                            // Expected time of completion = (current_time + summation of wcets of all such jobs) 
+                            // (No need to anticipate special cases - can be optimistic at the time of discarded job scheduling)   
+                            expected_completion_time[ii] = expected_completion_time[ii] + temp->job->wcet_budget[current_level + ii - 1]; 
+                            temp=temp->next;                                                                                  
+                        }
+                    }
+
+                    insert_slack_cache (&ctx->core[core_idx].slack_cache, current_level + ii, discarded_job->sched_deadline, slack_available[ii], optimal_slack[ii], expected_completion_time[ii]);
                 }
+
+                SCHED_PRINT (ctx, "\n Slack calculated: %lf\t Optimal slack: %lf for discarded job (Task %d Job %d) at level %d in core %d\n", slack_available [ii], optimal_slack [ii], discarded_job->task_no, discarded_job->job_no, current_level + ii, core_no);
               
                 // 2. Anticipating higher criticality discarded job arrivals
 
@@ -328,45 +490,48 @@ void schedule_discarded_job (RQ_HEAD *head, RQ_HEAD **dhead, Tasks *task_ptr, in
                     if (task_ptr[j].criticality < current_level && task_ptr[j].criticality > i + 1) {
 
                         // Anticipate next job arrival
-                        next_arrival = get_next_job_arrival (task_ptr, i, current_time);
+                        next_arrival = get_next_job_arrival (task_ptr, j, current_time);
                         
-                        // If  job arrival time < expected time of completion for discarded job, subtract its wcet from slack available
+                        // If  job arrival time < expected time of completion for discarded job, subtract its wcet (at its own criticality level) from slack available
                         if (next_arrival < expected_completion_time[ii]) 
-                            slack_available[ii] = slack_available[ii] - task_ptr[j].wcet[current_level + ii - 1];
+                            slack_available[ii] = slack_available[ii] - task_ptr[j].wcet[task_ptr[j].criticality - 1];
                     }
                 }
             }
 
+            trace_slack (ctx, core_no, "Discarded job slack", slack_available, current_time);
+
+            // A discarded job executed on another core pays the migration overhead
+            migration_cost = (discarded_job->allocated_core != core_no) ? ctx->config.migration_overhead : 0;
+
             // Temp_count incremented for each criticality level in which enough slack is available for discarded job to execute
             for (int ii = 0; ii < max_criticality - current_level + 1; ii++) {
-                if (slack_available[ii] >= discarded_job->wcet_budget[(discarded_job->job_criticality) - 1]) 
+                if (slack_available[ii] >= discarded_job->wcet_budget[(discarded_job->job_criticality) - 1] + job_overhead + migration_cost) 
                     temp_count++;
             }
 
             // If slack available in all criticality levels > discarded job wcet, add it to run queue and break; 
             if (temp_count == max_criticality - current_level + 1) {
+                charge_job_overhead (ctx, &ctx->core[core_idx], discarded_job, migration_cost);
                 discarded_job->allocated_core = core_no;
                 // print_run_queue(head);
-                update_run_queue (head, discarded_job);
-                printf(" Enough slack available. Scheduling the discarded job!\n\n");
+                add_ready_job (rq, discarded_job);
+                trace_job_event (ctx, TRACE_EVENT_RELEASE, core_no, discarded_job, current_time, 0);
+                invalidate_slack_cache (&ctx->core[core_idx].slack_cache);     // Run queue changed -- cached slack values are stale
+                SCHED_PRINT (ctx, " Enough slack available. Scheduling the discarded job!\n\n");
+                ctx->stats.discarded_jobs_scheduled++;
+                trace_instant (ctx, core_no, "Discarded job scheduled", "discard", current_time, discarded_job, NULL, 0);
                 // print_run_queue(head);
                 // break;
             }
             
-            // Else remove from discarded queue (already done by schedule_next_job), consider next discarded job for scheduling
-
-            // If all jobs from current queue are discarded due to not enough slack available (i.e. current queue empty)  
-            if (dhead[i]->head_node == NULL && discarded_job->task_no == IDLE_TASK_NO) {
-                
-                // Move on to next (lower criticlality) non-empty discarded queue
-                while (dhead[i]->head_node == NULL && i >= 0) 
-                    i--;
-                
-                // If all queues are empty, break out of the loop
-                if (i < 0) 
-                    break;        
-            }
+            // Else the job is dropped (already removed from the discarded queue), consider next discarded job for scheduling
+            else 
+                free (discarded_job);
         }
     }
+
+    for (i = 0; i < (max_criticality - current_level + 1); i++)
+        free_dummy_queue (dummy_head[i]);
 }
 
@@ -1,79 +1,323 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "header.h"
 
 int main (int argc, char *argv[]) {
 
-    Tasks *tasks_arr;              // Pointer to task structure array
-    FILE *fptr;                    // Input file pointer
-    int num_tasks = 0;             // Number of tasks in the input task set
-    int max_criticality = 0;       // Maximum criticality level defined for the given task set    
-    Cores core[MAX_CORES];         // Core structure array; MAX_CORES is the maximum number of cores available in the system
-    int min_cores = 0;             // Minimum number of cores required for accommodating taskset as per the MCS feasibility condition
-    int num_cores_reqd = 0;        // Number of cores required to accommodate the given task set as per the proposed task allocation algorithm
-    int superhyperperiod = 0;      // Hyperperiod of the entire input task set (hyperperiod of tasks in all cores)
-    
-    // Open and read input file
-    fptr = fopen("input.txt","r");
-    if (fptr == NULL) {
-        printf(" ERROR: Could not open the input file containing taskset parameters\n");
-        return -1; 
-    } 
-
-    // Read number of tasks and maximum criticality level from input file
-    fscanf(fptr,"%d\n%d", &num_tasks, &max_criticality);
-    
-    // Allocate memory for task structure array
-    tasks_arr = malloc(num_tasks * sizeof (Tasks));
-
-    // Fetch task set parameters from the input file and populate the task structure array
-    fetch_task_parameters(fptr, tasks_arr, num_tasks, max_criticality);
+    Taskset_file input_file;                 // Memory-mapped input file
+    Taskset taskset;                         // Taskset parsed from the input file
+    Sim_context *ctx;                        // Simulation context for the current taskset
+    Sim_config config;                       // Simulation configuration
+    Exec_config exec_config;                 // Real-time executor configuration
+    Exec_stats exec_stats;                   // Real-time executor measurements
+    Sim_stats sim_stats;                     // Simulation statistics
+    long long time_unit_us = 0;              // Time unit of the real-time executor in microseconds (the schedule is simulated if 0)
+    const char *input_path = "input.txt";    // Input file path (default: input.txt)
+    const char *snapshot_prefix = NULL;      // Snapshot file path prefix (snapshots are not used if NULL)
+    char snapshot_path[4096];                // Snapshot file path for the current taskset: <snapshot_prefix>.<taskset number>
+    const char *trace_prefix = NULL;         // Schedule trace file path prefix (the schedule is not traced if NULL)
+    char trace_path[4096];                   // Schedule trace file path for the current taskset: <trace_prefix>.<taskset number>.json
+    const char *verify_path = NULL;          // Schedule trace file to verify (no simulation if set)
+    const char *server_path = NULL;          // Socket path of the scheduling server (the input file is not read if set)
+    int verify = 0;                          // Set to verify the schedule while it is simulated
+    int num_cores_reqd = 0;                  // Number of cores required to accommodate the given task set
+    int loaded = 0;                          // Set if the preprocessed taskset is loaded from its snapshot
+    int parse_rval = 0;                      // Return value of the taskset parser
+    int opt = 0;                             // Command line option
+
+    // Simulation configuration (defaults)
+    config.seed = time(0);                                    // Seed of the random number generator for simulating actual execution time values
+    config.exec_distribution = EXEC_UNIFORM;                  // Actual execution time distribution
+    config.overrun_probability = DEFAULT_OVERRUN_PROBABILITY; // Probability of overrunning the lowest criticality wcet (bimodal distribution)
+    config.deescalation = DEESCALATION_IDLE_INSTANT;          // Return to the lowest criticality level at system-wide idle instants
+    config.allocation = ALLOCATION_PARTITIONED;               // Every task is allocated to a single core
+    config.preemption_mode = PREEMPTION_FULL;                 // Earlier deadline jobs preempt the running job at once
+    config.npr_length = 0;                                    // Length of the floating non-preemptive regions (limited-preemptive mode)
+    config.preemption_overhead = 0;                           // Preemptions are free
+    config.migration_overhead = 0;                            // Migrations are free
+    config.shutdown_policy = SHUTDOWN_INDEPENDENT;            // Every core decides to SHUTDOWN on its own
+    config.domain_size = 1;                                   // Every core is a power domain of its own
+    config.num_sleep_states[SHUTDOWNABLE] = 0;                // Default sleep state (break-even SHUTDOWN_THRESHOLD)
+    config.num_sleep_states[NON_SHUTDOWNABLE] = 0;            // Default sleep state (break-even SHUTDOWN_THRESHOLD)
+    config.num_hyperperiods = 1;                              // Simulate a single super-hyperperiod
+    config.fast_forward = 1;                                  // Fast-forward across repeated super-hyperperiods once a steady state is detected
+    config.optimizer_iterations = 0;                          // Iterations of each allocation optimizer chain (greedy allocation only if 0)
+    config.optimizer_time_budget = 0;                         // Time budget of the allocation optimizer in ms (unlimited if 0)
+    config.optimizer_threads = 0;                             // Allocation optimizer/portfolio threads (one per online CPU if 0)
+    config.allocation_heuristic = HEURISTIC_ADAPTIVE;         // WFD + FFD or FFD, selected by the proportion of HI criticality utilization
+    config.lpd_allocation = LPD_DEDICATED_CORES;              // Low period tasks are allocated first, to dedicated NON_SHUTDOWNABLE cores
+    config.allocation_portfolio = 0;                          // Single allocation heuristic
+    config.portfolio_objective = PORTFOLIO_FEWEST_CORES;      // The portfolio keeps the allocation with the fewest cores
+    config.verbose = 1;                                       // Print the schedule
+
+    // Read command line options
+    while ((opt = getopt (argc, argv, "i:s:t:vk:u:r:d:p:e:m:l:c:g:a:w:z:y:n:f:x:o:b:j:h:q:")) != -1) {
+        switch (opt) {
+            case 'i':
+                input_path = optarg;
+                break;
+            case 's':
+                snapshot_prefix = optarg;
+                break;
+            case 't':
+                trace_prefix = optarg;
+                break;
+            case 'v':
+                verify = 1;
+                break;
+            case 'k':
+                verify_path = optarg;
+                break;
+            case 'u':
+                server_path = optarg;
+                break;
+            case 'r':
+                config.seed = strtoull (optarg, NULL, 10);
+                break;
+            case 'd':
+                if ((config.exec_distribution = parse_exec_distribution (optarg)) < 0) {
+                    printf(" ERROR: Unknown execution time distribution (%s): expected uniform/normal/bimodal/lo\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'p':
+                config.overrun_probability = atof (optarg);
+                if (config.overrun_probability < 0 || config.overrun_probability > 1) {
+                    printf(" ERROR: Overrun probability must lie in [0, 1]\n");
+                    return -1;
+                }
+                break;
+            case 'e':
+                if (strcmp (optarg, "none") == 0)
+                    config.deescalation = DEESCALATION_NONE;
+                else if (strcmp (optarg, "idle") == 0)
+                    config.deescalation = DEESCALATION_IDLE_INSTANT;
+                else {
+                    printf(" ERROR: Unknown de-escalation policy (%s): expected none/idle\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'm':
+                if (strcmp (optarg, "partitioned") == 0)
+                    config.allocation = ALLOCATION_PARTITIONED;
+                else if (strcmp (optarg, "semi") == 0)
+                    config.allocation = ALLOCATION_SEMI_PARTITIONED;
+                else {
+                    printf(" ERROR: Unknown allocation mode (%s): expected partitioned/semi\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'l':
+                config.npr_length = atoi (optarg);
+                if (config.npr_length < 0) {
+                    printf(" ERROR: Non-preemptive region length must be a non-negative number of time units\n");
+                    return -1;
+                }
+                config.preemption_mode = (config.npr_length > 0) ? PREEMPTION_LIMITED : PREEMPTION_FULL;
+                break;
+            case 'c':
+                config.preemption_overhead = atoi (optarg);
+                if (config.preemption_overhead < 0) {
+                    printf(" ERROR: Preemption overhead must be a non-negative number of time units\n");
+                    return -1;
+                }
+                break;
+            case 'g':
+                config.migration_overhead = atoi (optarg);
+                if (config.migration_overhead < 0) {
+                    printf(" ERROR: Migration overhead must be a non-negative number of time units\n");
+                    return -1;
+                }
+                break;
+            case 'a':
+                if (strcmp (optarg, "independent") == 0)
+                    config.shutdown_policy = SHUTDOWN_INDEPENDENT;
+                else if (strcmp (optarg, "coordinated") == 0)
+                    config.shutdown_policy = SHUTDOWN_COORDINATED;
+                else {
+                    printf(" ERROR: Unknown shutdown policy (%s): expected independent/coordinated\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'w':
+                config.domain_size = atoi (optarg);
+                if (config.domain_size < 1 || config.domain_size > MAX_CORES) {
+                    printf(" ERROR: Power domain size must lie in [1, %d] cores\n", MAX_CORES);
+                    return -1;
+                }
+                break;
+            case 'z':
+                if ((config.num_sleep_states[SHUTDOWNABLE] = parse_sleep_states (optarg, config.sleep_states[SHUTDOWNABLE])) < 0)
+                    return -1;
+                break;
+            case 'y':
+                if ((config.num_sleep_states[NON_SHUTDOWNABLE] = parse_sleep_states (optarg, config.sleep_states[NON_SHUTDOWNABLE])) < 0)
+                    return -1;
+                break;
+            case 'n':
+                config.num_hyperperiods = atoi (optarg);
+                if (config.num_hyperperiods < 1) {
+                    printf(" ERROR: Number of super-hyperperiods must be a positive number\n");
+                    return -1;
+                }
+                break;
+            case 'f':
+                if (strcmp (optarg, "on") == 0)
+                    config.fast_forward = 1;
+                else if (strcmp (optarg, "off") == 0)
+                    config.fast_forward = 0;
+                else {
+                    printf(" ERROR: Unknown fast-forward setting (%s): expected on/off\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'x':
+                time_unit_us = atoll (optarg);
+                if (time_unit_us <= 0) {
+                    printf(" ERROR: Executor time unit must be a positive number of microseconds\n");
+                    return -1;
+                }
+                break;
+            case 'o':
+                config.optimizer_iterations = atoi (optarg);
+                if (config.optimizer_iterations < 0) {
+                    printf(" ERROR: Optimizer iterations must be a non-negative number\n");
+                    return -1;
+                }
+                break;
+            case 'b':
+                config.optimizer_time_budget = atof (optarg);
+                if (config.optimizer_time_budget < 0) {
+                    printf(" ERROR: Optimizer time budget must be a non-negative number of milliseconds\n");
+                    return -1;
+                }
+                break;
+            case 'j':
+                config.optimizer_threads = atoi (optarg);
+                break;
+            case 'h':
+                if (strcmp (optarg, "portfolio") == 0)
+                    config.allocation_portfolio = 1;
+                else if ((config.allocation_heuristic = parse_allocation_heuristic (optarg)) < 0) {
+                    printf(" ERROR: Unknown allocation heuristic (%s): expected adaptive/wfd-ffd/ffd/wfd/bfd/cffd/portfolio\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'q':
+                if ((config.portfolio_objective = parse_portfolio_objective (optarg)) < 0) {
+                    printf(" ERROR: Unknown portfolio objective (%s): expected cores/shutdown/energy\n", optarg);
+                    return -1;
+                }
+                break;
+            default:
+                printf(" Usage: %s [-i input_file] [-s snapshot_prefix] [-t trace_prefix] [-v] [-k trace_file] [-u socket_path] [-r seed] [-d uniform|normal|bimodal|lo] [-p overrun_probability] [-e none|idle] [-m partitioned|semi] [-l npr_length] [-c preemption_overhead] [-g migration_overhead] [-a independent|coordinated] [-w domain_size] [-z sleep_states] [-y sleep_states] [-n hyperperiods] [-f on|off] [-x time_unit_us] [-o optimizer_iterations] [-b optimizer_budget_ms] [-j optimizer_threads] [-h adaptive|wfd-ffd|ffd|wfd|bfd|cffd|portfolio] [-q cores|shutdown|energy]\n", argv[0]);
+                return -1;
+        }
+    }
+
+    // Verify a schedule trace file written by an earlier run (no simulation)
+    if (verify_path != NULL) {
+        printf(" Verifying the schedule trace %s ...\n\n", verify_path);
+        return (verify_trace_file (verify_path) == 0) ? 0 : -1;
+    }
+
+    // Serve allocation/simulation queries on a Unix domain socket until a stop request (the simulation options apply to all queries)
+    if (server_path != NULL)
+        return (run_server (server_path, &config) == 0) ? 0 : -1;
+
+    // The seed is printed so that the run can be reproduced (-r)
+    printf(" Random seed: %llu\n\n", config.seed);
+
+    // Open and map input file
+    if (open_taskset_file (&input_file, input_path) < 0)
+        return -1;
+
+    // Allocate and simulate each taskset in the input file
+    while (1) {
+
+        ctx = eemcs_create (&config);
+        if (ctx == NULL) {
+            printf(" ERROR: Could not create the simulation context\n");
+            parse_rval = -1;
+            break;
+        }
+
+        // Skip preprocessing if a valid snapshot exists for the next taskset
+        loaded = 0;
+        if (snapshot_prefix != NULL && skip_to_next_token (&input_file)) {
+            snprintf (snapshot_path, sizeof (snapshot_path), "%s.%d", snapshot_prefix, input_file.taskset_count + 1);
+            loaded = eemcs_load_snapshot (ctx, snapshot_path, &input_file);
+        }
+
+        if (loaded) {
+            printf(" ==================== Taskset %d ====================\n\n Preprocessed taskset loaded from snapshot %s\n\n", input_file.taskset_count, snapshot_path);
+            num_cores_reqd = eemcs_allocate (ctx);
+        }
+
+        // Else parse and preprocess the next taskset
+        else {
+            if ((parse_rval = parse_next_taskset (&input_file, &taskset)) <= 0) {
+                eemcs_destroy (ctx);
+                break;
+            }
+
+            printf(" ==================== Taskset %d ====================\n\n", input_file.taskset_count);
+            eemcs_load (ctx, &taskset);
+            num_cores_reqd = eemcs_allocate (ctx);
+
+            // Save the preprocessed taskset for subsequent runs (snapshots do not record split tasks and scheduling overheads)
+            if (num_cores_reqd > 0 && snapshot_prefix != NULL && ctx->num_splits == 0 && get_job_overhead (&config) == 0 && is_default_allocation (&config) && write_snapshot (snapshot_path, &input_file, &ctx->taskset, ctx->core, num_cores_reqd, ctx->hyperperiod) == 0)
+                printf(" Preprocessed taskset saved to snapshot %s\n\n", snapshot_path);
+        }
+
+        if (num_cores_reqd > 0) {
 
-    // Close input file
-    fclose(fptr);
-    
-    // Sort task structure array in decreasing order of task criticality and utilization 
-    quick_sort(tasks_arr, 0, num_tasks - 1);
-    print_sorted_array(tasks_arr, num_tasks);
-
-    // Determine the minimum number of cores required to schedule the given taskset as per the MCS Feasibility Condition
-    min_cores = get_min_cores_reqd(tasks_arr, num_tasks, max_criticality);
-    printf("\n Minimum number of cores required to satisfy the MCS feasibility condition for the given taskset: %d\n\n", min_cores); 
-    
-    // If the minimum number of cores required is less than the MAXIMUM CORES available, proceed with allocation and scheduling
-    if (min_cores <= MAX_CORES) {
-        
-        // Allocate tasks to cores
-        num_cores_reqd = offline_task_allocator(core, tasks_arr, num_tasks, min_cores, max_criticality);
-        
-        // If the allocation is done successfully (i.e all tasks are accommodated within the available number of cores)
-        if(num_cores_reqd > 0 && num_cores_reqd <= MAX_CORES){
-        
             // Print task allocations
             printf(" Task allocation complete ...\n\n Total number of cores required for allocation: %d\n", num_cores_reqd);
-            print_task_allocations(core, num_cores_reqd);
+            print_task_allocations(ctx->core, num_cores_reqd);
+            print_split_tasks (ctx->tasks_arr, ctx->split, ctx->num_splits);
+            printf(" Super-hyperperiod: %d\n\n", ctx->hyperperiod);
 
-            // Calculate the superhyeperperiod (hyperperiod of tasks in all cores)
-            superhyperperiod = calculate_superhyperperiod (tasks_arr, num_tasks);
-            printf(" Super-hyperperiod: %d\n\n", superhyperperiod);
-            
-             // Call runtime scheduler
-             srand(time(0));    // Initializes random number generator for simulating actual execution time values    
-             run_scheduler_loop (core, num_cores_reqd, tasks_arr, num_tasks, superhyperperiod, max_criticality);
+            // Run the schedule on real cores
+            if (time_unit_us > 0) {
+                initialize_executor_config (&exec_config, time_unit_us * 1000);
+                printf(" Executing the schedule on real cores (1 time unit = %lld us) ...\n", time_unit_us);
+                if (eemcs_execute (ctx, &exec_config, &exec_stats) == 0)
+                    print_executor_stats (&exec_stats);
+            }
 
+            // Call runtime scheduler (tracing the schedule if requested)
+            else {
+                if (trace_prefix != NULL) {
+                    snprintf (trace_path, sizeof (trace_path), "%s.%d.json", trace_prefix, input_file.taskset_count);
+                    if (eemcs_open_trace (ctx, trace_path) == 0)
+                        printf(" Schedule trace: %s (Chrome trace event format)\n\n", trace_path);
+                }
+                if (verify)
+                    eemcs_verify (ctx);
+                eemcs_run (ctx);
+                eemcs_get_stats (ctx, &sim_stats);
+                print_sleep_times (ctx, &sim_stats);
+                if (sim_stats.fast_forwarded_hyperperiods > 0)
+                    printf(" Steady state detected: %d of %d super-hyperperiods fast-forwarded\n\n", sim_stats.fast_forwarded_hyperperiods, config.num_hyperperiods);
+                if (verify && ctx->trace != NULL && ctx->trace->verifier != NULL)
+                    print_verifier_report (ctx->trace->verifier);
+            }
         }
-        else
-            printf(" Number of cores required exceeds the maximum limit ...\n Input taskset cannot be scheduled.\n");
+
+        // Free all dynamically allocated memory
+        eemcs_destroy (ctx);
     }
-    else
-        printf(" MCS feasibility condition cannot be satisfied with the given number of cores.\n Input taskset cannot be scheduled.\n");    
-    
 
-    // Free all dynamically allocated memory
-    free_wcet_mallocs(tasks_arr, num_tasks); 
-    free(tasks_arr);
+    // Close input file
+    close_taskset_file (&input_file);
+
+    // Malformed taskset
+    if (parse_rval < 0)
+        return -1;
 
     return 0;
 }
-
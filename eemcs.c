@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "header.h"
+
+// ---------------------------------------------
+// LIBRARY API (libeemcs) -- SIMULATION CONTEXTS
+// ---------------------------------------------
+
+// Create a simulation context with the given configuration
+
+Sim_context *eemcs_create (Sim_config *config) {
+
+    // Allocate memory for the context (all parameters initialized to 0/NULL)
+    Sim_context *ctx;
+    ctx = calloc (1, sizeof (Sim_context));
+    if (ctx == NULL)
+        return NULL;
+
+    // Copy the configuration (including the seed of the counter-based random number generator)
+    ctx->config = *config;
+
+    // Core types without a sleep state table get the default sleep state
+    initialize_sleep_states (&ctx->config);
+
+    return ctx;
+}
+
+// Load a parsed taskset into the context (the context takes ownership of the taskset)
+
+int eemcs_load (Sim_context *ctx, Taskset *taskset) {
+
+    // A context simulates exactly one taskset
+    if (ctx->tasks_arr != NULL)
+        return -1;
+
+    ctx->taskset = *taskset;
+    ctx->tasks_arr = taskset->tasks_arr;
+    ctx->num_tasks = taskset->num_tasks;
+    ctx->max_criticality = taskset->max_criticality;
+
+    // Taskset now belongs to the context
+    taskset->tasks_arr = NULL;
+    taskset->wcet_arena = NULL;
+    taskset->snapshot_map = NULL;
+
+    return 0;
+}
+
+// Load a preprocessed (sorted + allocated) taskset from its snapshot into the context
+// Returns 1 if loaded, 0 if there is no valid snapshot for the taskset at the current input file cursor
+
+int eemcs_load_snapshot (Sim_context *ctx, const char *path, Taskset_file *file) {
+
+    // Snapshots hold allocations made by the default heuristic without scheduling overheads
+    if (ctx->tasks_arr != NULL || get_job_overhead (&ctx->config) > 0 || !is_default_allocation (&ctx->config))
+        return 0;
+
+    if (!load_snapshot (path, file, &ctx->taskset, ctx->core, &ctx->num_cores, &ctx->hyperperiod))
+        return 0;
+
+    ctx->tasks_arr = ctx->taskset.tasks_arr;
+    ctx->num_tasks = ctx->taskset.num_tasks;
+    ctx->max_criticality = ctx->taskset.max_criticality;
+
+    return 1;
+}
+
+// Sort, allocate the loaded taskset to cores and calculate the super-hyperperiod
+// Returns the number of cores required for allocation (0 if the taskset cannot be scheduled)
+
+int eemcs_allocate (Sim_context *ctx) {
+
+    int min_cores = 0;             // Minimum number of cores required for accommodating taskset as per the MCS feasibility condition
+    int num_cores_reqd = 0;        // Number of cores required to accommodate the given task set as per the proposed task allocation algorithm
+
+    if (ctx->tasks_arr == NULL)
+        return 0;
+
+    // Already allocated (e.g. loaded from a snapshot)
+    if (ctx->num_cores > 0)
+        return ctx->num_cores;
+
+    // Account the worst-case preemption overhead and non-preemptive blocking of every job in the task utilizations
+    if (get_job_overhead (&ctx->config) > 0)
+        add_scheduling_overheads (ctx->tasks_arr, ctx->num_tasks, ctx->max_criticality, get_job_overhead (&ctx->config));
+
+    // Derive the task fields used by the allocation and sort the task structure array in decreasing order of task criticality and utilization
+    preprocess_tasks (ctx->tasks_arr, ctx->num_tasks);
+    if (ctx->config.verbose)
+        print_sorted_array (ctx->tasks_arr, ctx->num_tasks);
+
+    // Determine the minimum number of cores required to schedule the given taskset as per the MCS Feasibility Condition
+    min_cores = get_min_cores_reqd (ctx->tasks_arr, ctx->num_tasks, ctx->max_criticality, ctx->config.verbose);
+    SCHED_PRINT (ctx, "\n Minimum number of cores required to satisfy the MCS feasibility condition for the given taskset: %d\n\n", min_cores);
+
+    // If the minimum number of cores required is more than the MAXIMUM CORES available, the taskset cannot be scheduled
+    if (min_cores > MAX_CORES) {
+        SCHED_PRINT (ctx, " MCS feasibility condition cannot be satisfied with the given number of cores.\n Input taskset cannot be scheduled.\n");
+        return 0;
+    }
+
+    // Allocate tasks to cores (with the configured heuristic, or the best heuristic of the portfolio)
+    // (Semi-partitioned allocation: tasks that fit no open core may be split across the open cores instead of opening a new core)
+    if (ctx->config.allocation_portfolio)
+        num_cores_reqd = run_allocation_portfolio (ctx->core, ctx->tasks_arr, ctx->num_tasks, min_cores, ctx->max_criticality,
+                                                   (ctx->config.allocation == ALLOCATION_SEMI_PARTITIONED) ? ctx->split : NULL, &ctx->num_splits, &ctx->config);
+    else
+        num_cores_reqd = offline_task_allocator (ctx->core, ctx->tasks_arr, ctx->num_tasks, min_cores, ctx->max_criticality,
+                                                 (ctx->config.allocation == ALLOCATION_SEMI_PARTITIONED) ? ctx->split : NULL, &ctx->num_splits, &ctx->config);
+
+    // If the allocation failed (i.e all tasks cannot be accommodated within the available number of cores)
+    if (num_cores_reqd <= 0 || num_cores_reqd > MAX_CORES) {
+        SCHED_PRINT (ctx, " Number of cores required exceeds the maximum limit ...\n Input taskset cannot be scheduled.\n");
+        return 0;
+    }
+
+    // Improve the greedy allocation with the local search optimizer (fewer cores / more SHUTDOWNABLE cores)
+    // (The optimizer moves whole tasks between cores, so it is not used if any task is split)
+    if (ctx->config.optimizer_iterations > 0 && ctx->num_splits == 0)
+        num_cores_reqd = optimize_allocation (ctx->core, ctx->tasks_arr, ctx->num_tasks, num_cores_reqd, ctx->max_criticality, &ctx->config);
+
+    // Calculate the superhyeperperiod (hyperperiod of tasks in all cores)
+    ctx->num_cores = num_cores_reqd;
+    ctx->hyperperiod = calculate_superhyperperiod (ctx->tasks_arr, ctx->num_tasks);
+
+    return num_cores_reqd;
+}
+
+// Create a context with the given configuration holding a copy of the taskset and allocation of an allocated context
+// The allocation is reused as is, so the configuration should only differ in the simulation parameters (seed, execution times,
+// number of super-hyperperiods ...), not in the allocation or overhead settings
+// Returns NULL if the context is not allocated, its simulation has started or out of memory
+
+Sim_context *eemcs_clone (Sim_context *ctx, Sim_config *config) {
+
+    Sim_context *clone;
+
+    if (ctx->num_cores <= 0 || ctx->scheduler_initialized)
+        return NULL;
+
+    clone = eemcs_create (config);
+    if (clone == NULL)
+        return NULL;
+
+    if (copy_taskset (&clone->taskset, &ctx->taskset) < 0) {
+        free (clone);
+        return NULL;
+    }
+    clone->tasks_arr = clone->taskset.tasks_arr;
+    clone->num_tasks = clone->taskset.num_tasks;
+    clone->max_criticality = clone->taskset.max_criticality;
+
+    // The core and split task structures hold no pointers before the runtime scheduler is initialized
+    memcpy (clone->core, ctx->core, sizeof (ctx->core));
+    memcpy (clone->split, ctx->split, sizeof (ctx->split));
+    clone->num_cores = ctx->num_cores;
+    clone->num_splits = ctx->num_splits;
+    clone->hyperperiod = ctx->hyperperiod;
+
+    return clone;
+}
+
+// Run the simulation up to (but excluding) the decision points at/after the given time
+// Returns 1 if the simulation has not yet reached its end (num_hyperperiods super-hyperperiods), 0 if complete, -1 if the taskset is not allocated
+
+int eemcs_step_until (Sim_context *ctx, double time) {
+
+    if (ctx->num_cores <= 0)
+        return -1;
+
+    // Initialize the runtime scheduler at the first step
+    if (!ctx->scheduler_initialized) {
+        initialize_scheduler (ctx);
+        ctx->scheduler_initialized = 1;
+    }
+
+    // Execute the scheduler at every decision point before the given time (fast-forwarding a steady state at the super-hyperperiod boundaries)
+    // Pending runtime task changes are applied at a decision point before the scheduler executes at it (safe point)
+    while (ctx->timecount < time) {
+        apply_task_changes (ctx);
+        if (!scheduler_step (ctx))
+            break;
+        fast_forward_steady_state (ctx, time);
+    }
+
+    // Complete the schedule event stream at the end of the simulation (trace file, verifier)
+    if (ctx->timecount >= ctx->end_time)
+        finish_trace (ctx);
+
+    return (ctx->timecount < ctx->end_time);
+}
+
+// Run the simulation till its end (num_hyperperiods super-hyperperiods)
+
+void eemcs_run (Sim_context *ctx) {
+    eemcs_step_until (ctx, INT_MAX);    // The end of the simulation is at most INT_MAX (integer job arrival times)
+}
+
+// Add a task to the running simulation (online admission control), applied at the next safe decision point (see admission.c)
+// task: task number (not in the taskset, or removed), phase (release offset after the change), period, deadline, criticality and wcets
+// The task is rejected (counted in the statistics) if no open core can take it; eemcs_get_task_core returns its core once admitted
+// Returns 0 if the change is pending, -1 if the taskset is not allocated, the simulation is complete, the task is invalid, too many changes are pending
+// or the system is above the lowest criticality level without de-escalation (the change could never be applied)
+
+int eemcs_add_task (Sim_context *ctx, Tasks *task) {
+    return queue_task_change (ctx, TASK_CHANGE_ADD, task);
+}
+
+// Remove a task from the running simulation, applied at the next safe decision point (its released jobs complete)
+// Returns 0 if the change is pending, -1 if the taskset is not allocated, the simulation is complete, too many changes are pending
+// or the system is above the lowest criticality level without de-escalation
+
+int eemcs_remove_task (Sim_context *ctx, int task_no) {
+
+    Tasks task;     // Task number of the removed task
+
+    memset (&task, 0, sizeof (Tasks));
+    task.task_no = task_no;
+    return queue_task_change (ctx, TASK_CHANGE_REMOVE, &task);
+}
+
+// Change the parameters of a task of the running simulation, applied at the next safe decision point
+// (same parameters as eemcs_add_task; the task keeps its core if it is still schedulable there, its released jobs keep their parameters)
+// Returns 0 if the change is pending, -1 if the taskset is not allocated, the simulation is complete, the task is invalid, too many changes are pending
+// or the system is above the lowest criticality level without de-escalation
+
+int eemcs_modify_task (Sim_context *ctx, Tasks *task) {
+    return queue_task_change (ctx, TASK_CHANGE_MODIFY, task);
+}
+
+// Get the core number a task is allocated to (NOT_ALLOCATED if the task is not in the taskset or was removed, SPLIT_TASK if split)
+
+int eemcs_get_task_core (Sim_context *ctx, int task_no) {
+
+    int task_idx = get_task_array_index (ctx->tasks_arr, ctx->num_tasks, task_no);     // Index of the task
+
+    return (task_idx < ctx->num_tasks) ? ctx->tasks_arr[task_idx].allocated_core : NOT_ALLOCATED;
+}
+
+// Query the simulation statistics
+
+void eemcs_get_stats (Sim_context *ctx, Sim_stats *stats) {
+
+    *stats = ctx->stats;
+    stats->timecount = ctx->timecount;
+    stats->current_level = ctx->current_level;
+    stats->num_cores = ctx->num_cores;
+    stats->task_changes_pending = ctx->num_task_changes;
+    for (int i = 0; i < ctx->num_cores; i++) {
+        stats->idle_time[i] = ctx->core[i].idle_time;
+        stats->sleep_time[i] = ctx->core[i].sleep_time;
+    }
+
+    // Power domains of consecutive cores (the last one may be smaller)
+    stats->num_domains = (ctx->config.domain_size > 0) ? (ctx->num_cores + ctx->config.domain_size - 1) / ctx->config.domain_size : ctx->num_cores;
+    for (int d = 0; d < stats->num_domains; d++)
+        stats->domain_sleep_time[d] = ctx->domain_sleep_time[d];
+
+    // Violations found so far by the schedule verifier
+    if (ctx->trace != NULL && ctx->trace->verifier != NULL)
+        stats->schedule_violations = count_violations (ctx->trace->verifier);
+}
+
+// Trace the schedule of the allocated context to the given file (Chrome trace event format), closed when the context is destroyed
+// Returns 0 on success, -1 if the taskset is not allocated, the simulation has started, the trace is already open or the file could not be opened
+
+int eemcs_open_trace (Sim_context *ctx, const char *path) {
+
+    if (ctx->num_cores <= 0 || ctx->scheduler_initialized || (ctx->trace != NULL && ctx->trace->fd >= 0))
+        return -1;
+
+    return open_trace (ctx, path);
+}
+
+// Verify the schedule of the allocated context while it is simulated (streaming verifier: EDF order, deadlines, budgets, sleep states)
+// The violations are printed as they are found and counted in the statistics (schedule_violations)
+// Returns 0 on success, -1 if the taskset is not allocated, the simulation has started or the schedule is already verified
+
+int eemcs_verify (Sim_context *ctx) {
+
+    if (ctx->num_cores <= 0 || ctx->scheduler_initialized)
+        return -1;
+
+    return open_verifier (ctx);
+}
+
+// Execute the allocated taskset on real cores instead of simulating it (one SCHED_FIFO worker thread pinned to a CPU per allocated core)
+// Returns 0 on success, -1 if the taskset is not allocated, a task has a deadline greater than its period (the executor keeps one
+// release per task) or the executor could not be started
+
+int eemcs_execute (Sim_context *ctx, Exec_config *config, Exec_stats *stats) {
+
+    if (ctx->num_cores <= 0)
+        return -1;
+
+    for (int i = 0; i < ctx->num_tasks; i++) {
+        if (ctx->tasks_arr[i].deadline > ctx->tasks_arr[i].period) {
+            printf (" ERROR: Task %d has a deadline greater than its period, it cannot be executed\n", ctx->tasks_arr[i].task_no);
+            return -1;
+        }
+    }
+
+    return run_executor (ctx, config, stats);
+}
+
+// Destroy the simulation context, releasing all its memory
+
+void eemcs_destroy (Sim_context *ctx) {
+
+    if (ctx == NULL)
+        return;
+
+    close_trace (ctx);
+    if (ctx->scheduler_initialized)
+        free_scheduler (ctx);
+    free_taskset (&ctx->taskset);
+    free (ctx);
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "header.h"
+
+// --------------------------------------------------------
+// COUNTER-BASED RANDOM NUMBER GENERATION (NO HIDDEN STATE)
+// --------------------------------------------------------
+
+// Random numbers are a pure function of (seed, task number, job number, counter):
+// the key is hashed with the SplitMix64 finalizer, so every job draws from its own stream
+// and its execution time does not depend on the order in which jobs are generated (serial/parallel runs, anticipated arrivals)
+
+// SplitMix64 finalizer (bijective 64-bit mixing function)
+
+unsigned long long mix64 (unsigned long long x) {
+
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Get 64 random bits for the given (seed, task number, job number, counter)
+
+unsigned long long get_random_bits (unsigned long long seed, int task_no, int job_no, unsigned int counter) {
+
+    unsigned long long key;
+
+    key = mix64 (seed + 0x9e3779b97f4a7c15ULL);
+    key = mix64 (key ^ (((unsigned long long)(unsigned int) task_no << 32) | (unsigned int) job_no));
+    return mix64 (key + (unsigned long long) counter * 0x9e3779b97f4a7c15ULL);
+}
+
+// Get a uniformly distributed random number in [0, 1) for the given (seed, task number, job number, counter)
+
+double get_random_uniform (unsigned long long seed, int task_no, int job_no, unsigned int counter) {
+
+    // 53 random bits -> double precision mantissa
+    return (double)(get_random_bits (seed, task_no, job_no, counter) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Get a uniformly distributed random integer in [low, high] (unbiased up to 2^-53, unlike rand () % n)
+
+int get_random_int (unsigned long long seed, int task_no, int job_no, unsigned int counter, int low, int high) {
+
+    int value = low + (int)(get_random_uniform (seed, task_no, job_no, counter) * (high - low + 1));
+
+    if (value > high)
+        value = high;
+    return value;
+}
+
+// -----------------------------------
+// ACTUAL EXECUTION TIME DISTRIBUTIONS
+// -----------------------------------
+
+// Parse the name of an execution time distribution (uniform/normal/bimodal/lo)
+// Returns the distribution value, -1 if the name is not recognized
+
+int parse_exec_distribution (const char *name) {
+
+    if (strcmp (name, "uniform") == 0)
+        return EXEC_UNIFORM;
+    if (strcmp (name, "normal") == 0)
+        return EXEC_TRUNCATED_NORMAL;
+    if (strcmp (name, "bimodal") == 0)
+        return EXEC_BIMODAL;
+    if (strcmp (name, "lo") == 0)
+        return EXEC_LO_WCET;
+    return -1;
+}
+
+// Generate the actual execution time of a job of the given task
+// The execution time is a pure function of (seed, task number, job number) and lies in (0, wcet at the task's own criticality level]
+
+double generate_execution_time (Sim_config *config, Tasks *task, int job_no) {
+
+    int max_wcet = task->wcet[task->criticality - 1];     // Wcet at the task's own (highest defined) criticality level
+    int lo_wcet = task->wcet[0];                          // Wcet at the lowest criticality level
+    double mean = 0.0, stddev = 0.0;                      // Truncated normal distribution parameters
+    double u1 = 0.0, u2 = 0.0, value = 0.0;               // Temporary random values
+    unsigned int counter = 1;                             // Counter of the job's random number stream
+
+    switch (config->exec_distribution) {
+
+        // Truncated normal distribution over (0, max wcet] (Box-Muller transform, out-of-range samples rejected)
+        case EXEC_TRUNCATED_NORMAL:
+            mean = EXEC_NORMAL_MEAN * max_wcet;
+            stddev = EXEC_NORMAL_STDDEV * max_wcet;
+            for (int i = 0; i < EXEC_NORMAL_MAX_TRIES; i++) {
+                u1 = get_random_uniform (config->seed, task->task_no, job_no, counter++);
+                u2 = get_random_uniform (config->seed, task->task_no, job_no, counter++);
+                value = mean + stddev * sqrt (-2.0 * log (1.0 - u1)) * cos (2.0 * M_PI * u2);
+                if (value > 0 && value <= max_wcet)
+                    break;
+            }
+            if (value <= 0 || value > max_wcet)
+                value = mean;
+
+            // Execution times are whole time units (as for the other distributions), so decision points stay exact
+            value = ceil (value);
+            return (value > max_wcet) ? max_wcet : value;
+
+        // Bimodal (overrun-prone) distribution: the job overruns its lowest criticality wcet with the given probability
+        case EXEC_BIMODAL:
+            if (max_wcet > lo_wcet && get_random_uniform (config->seed, task->task_no, job_no, 0) < config->overrun_probability)
+                return get_random_int (config->seed, task->task_no, job_no, counter, lo_wcet + 1, max_wcet);
+            return get_random_int (config->seed, task->task_no, job_no, counter, 1, lo_wcet);
+
+        // Deterministic execution times: the lowest criticality wcet (no random number is drawn)
+        case EXEC_LO_WCET:
+            return lo_wcet;
+
+        // Uniform distribution of integer execution times over [1, max wcet]
+        default:
+            return get_random_int (config->seed, task->task_no, job_no, counter, 1, max_wcet);
+    }
+}
+
+// Check if the execution times of the jobs repeat every super-hyperperiod
+// (only deterministic execution times do: random ones depend on the job number)
+
+int has_periodic_execution_times (Sim_config *config) {
+    return (config->exec_distribution == EXEC_LO_WCET);
+}
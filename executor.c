@@ -0,0 +1,416 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "header.h"
+
+// ------------------------------------------------------------
+// REAL-TIME EXECUTOR (ALLOCATION + EDF-VD ON REAL LINUX CORES)
+// ------------------------------------------------------------
+
+// The executor runs the offline allocation and the EDF-VD policy for real: one worker thread per allocated core,
+// pinned to its own CPU (sched_setaffinity) and running with SCHED_FIFO, so the simulator's numbers can be validated on real hardware
+// --> Jobs are released at their nominal release times (clock_nanosleep on absolute CLOCK_MONOTONIC times while the core is idle)
+// --> A job executes a busy-work payload until its actual execution time (same counter-based RNG as the simulator) is consumed
+// --> Execution time and budgets are measured on the thread CPU-time clock, so time the worker is not running is not charged to the job
+// --> A job exhausting its budget at the current level raises the system criticality level (shared by all workers) or is aborted at its own level
+// --> Jobs below the accepted criticality level of a core are discarded (discarded jobs are not scheduled in the slack by the executor)
+// Tasks must have constrained deadlines (deadline <= period, checked by eemcs_execute), i.e. at most one job of each task is active
+
+// Get the current time of the given clock in ns
+
+long long get_clock_ns (int clock_id) {
+
+    struct timespec ts;
+
+    clock_gettime (clock_id, &ts);
+    return (long long) ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+// Sleep until the given absolute CLOCK_MONOTONIC time (ns)
+
+void sleep_until (long long time) {
+
+    struct timespec ts;
+
+    ts.tv_sec = time / NSEC_PER_SEC;
+    ts.tv_nsec = time % NSEC_PER_SEC;
+    while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+// Default busy-work payload of a job (integer arithmetic the compiler cannot optimize away)
+
+void busy_work_payload (void *arg) {
+
+    volatile unsigned int x = 1;
+
+    (void) arg;
+    for (int i = 0; i < EXEC_PAYLOAD_ITERATIONS; i++)
+        x = x * 1664525u + 1013904223u;
+}
+
+// Initialize an executor configuration with the default values
+
+void initialize_executor_config (Exec_config *config, long long time_unit_ns) {
+
+    config->time_unit_ns = time_unit_ns;
+    config->duration = 0;
+    config->first_cpu = 0;
+    config->rt_priority = EXEC_RT_PRIORITY;
+    config->payload = busy_work_payload;
+    config->payload_arg = NULL;
+}
+
+// Pin the calling worker thread to its CPU and switch it to SCHED_FIFO
+// Failures (e.g. missing privileges) are recorded in the worker's measurements, the run continues with the default policy
+
+void setup_worker_thread (Exec_worker *worker) {
+
+    Exec_config *config = worker->shared->config;
+    cpu_set_t cpu_set;                             // CPU affinity mask of the worker
+    struct sched_param param;                      // Real-time priority of the worker
+    long num_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+    int cpu = 0;
+
+    if (num_cpus < 1)
+        num_cpus = 1;
+    cpu = (config->first_cpu + worker->core_idx) % num_cpus;
+
+    CPU_ZERO (&cpu_set);
+    CPU_SET (cpu, &cpu_set);
+    worker->stats.cpu = (sched_setaffinity (0, sizeof (cpu_set), &cpu_set) == 0) ? cpu : -1;
+
+    param.sched_priority = config->rt_priority;
+    worker->stats.realtime = (sched_setscheduler (0, SCHED_FIFO, &param) == 0);
+}
+
+// Release the jobs of the worker's tasks whose nominal release time has passed
+// The release jitter is the delay between the nominal release time and the time the worker releases the job
+
+void release_worker_jobs (Exec_worker *worker, long long now) {
+
+    Sim_context *ctx = worker->shared->ctx;
+    long long unit = worker->shared->config->time_unit_ns;
+    long long end_time = __atomic_load_n (&worker->shared->end_time, __ATOMIC_ACQUIRE);
+    Exec_task *exec_task;
+    Tasks *task;
+    Jobs *job;
+    long long jitter = 0;
+
+    for (int i = 0; i < worker->num_tasks; i++) {
+
+        exec_task = &worker->task[i];
+        task = exec_task->task;
+
+        while (exec_task->next_release <= now && exec_task->next_release < end_time) {
+
+            // The previous job is still pending at the next release --> deadline miss, the job is dropped
+            if (exec_task->active) {
+                exec_task->active = 0;
+                worker->stats.deadline_misses++;
+            }
+
+            // Job parameters (as in the simulator's job structure)
+            job = &exec_task->job;
+            job->job_no = (int)((exec_task->next_release - (long long) task->phase * unit) / ((long long) task->period * unit));
+            job->task_no = task->task_no;
+            job->allocated_core = worker->core->core_no;
+            job->arrival_time = task->phase + job->job_no * task->period;
+            job->job_criticality = task->criticality;
+            job->status_flag = READY;
+            for (int j = 0; j < MAX_LEVELS; j++)
+                job->wcet_budget[j] = task->wcet[(j < task->criticality) ? j : (task->criticality - 1)];
+            job->virtual_deadline = job->arrival_time + task->virtual_deadline;
+            job->real_deadline = job->arrival_time + task->deadline;
+            job->execution_time = generate_execution_time (&ctx->config, task, job->job_no);
+
+            exec_task->release = exec_task->next_release;
+            exec_task->next_release = exec_task->next_release + (long long) task->period * unit;
+            exec_task->demand = (long long)(job->execution_time * unit);
+            exec_task->consumed = 0;
+
+            // Release jitter
+            jitter = now - exec_task->release;
+            worker->stats.jobs_released++;
+            worker->stats.total_release_jitter = worker->stats.total_release_jitter + jitter;
+            if (worker->stats.max_release_jitter < jitter)
+                worker->stats.max_release_jitter = jitter;
+
+            // Jobs below the accepted criticality level are discarded on arrival
+            if (task->criticality < accept_above_criticality_level (worker->level, worker->core->threshold_criticality))
+                worker->stats.jobs_discarded++;
+            else
+                exec_task->active = 1;
+        }
+    }
+}
+
+// Apply a criticality level change (made by any worker) to the worker's active jobs
+
+void apply_level_change (Exec_worker *worker) {
+
+    int level = __atomic_load_n (&worker->shared->current_level, __ATOMIC_ACQUIRE);
+    int accept_level = 0;
+
+    if (level == worker->level)
+        return;
+
+    // Discard all the active jobs below the accepted criticality level of the core
+    worker->level = level;
+    accept_level = accept_above_criticality_level (level, worker->core->threshold_criticality);
+    for (int i = 0; i < worker->num_tasks; i++) {
+        if (worker->task[i].active && worker->task[i].job.job_criticality < accept_level) {
+            worker->task[i].active = 0;
+            worker->stats.jobs_discarded++;
+        }
+    }
+}
+
+// Select the earliest deadline active job of the worker (EDF-VD)
+// Virtual deadlines are considered if the system criticality is below the core's EDF-VD threshold, else original deadlines
+// Returns NULL if the core is idle
+
+Exec_task *select_worker_job (Exec_worker *worker) {
+
+    Exec_task *selected = NULL;
+    int deadline_type = (worker->level <= worker->core->threshold_criticality) ? VIRTUAL_DEADLINES : REAL_DEADLINES;
+
+    for (int i = 0; i < worker->num_tasks; i++) {
+        if (worker->task[i].active) {
+            worker->task[i].job.sched_deadline = get_job_deadline (&worker->task[i].job, deadline_type);
+            if (selected == NULL || worker->task[i].job.sched_deadline < selected->job.sched_deadline)
+                selected = &worker->task[i];
+        }
+    }
+
+    return selected;
+}
+
+// Run the selected job until it completes, exhausts its budget at the current level, the next release is due or another worker changes the level
+
+void run_worker_job (Exec_worker *worker, Exec_task *exec_task, long long next_release) {
+
+    Exec_shared *shared = worker->shared;
+    Exec_config *config = shared->config;
+    Jobs *job = &exec_task->job;
+    long long unit = config->time_unit_ns;
+    long long budget = (long long) job->wcet_budget[worker->level - 1] * unit;   // Budget of the job at the current level
+    long long cpu_start = get_clock_ns (CLOCK_THREAD_CPUTIME_ID);                 // Thread CPU time when the job was (re)started
+    long long consumed = exec_task->consumed;                                     // CPU time consumed by the job
+    long long now = 0;
+    int level = worker->level;
+
+    // Execute the payload (the budget timer is the thread CPU-time clock, checked after every payload call)
+    while (1) {
+        config->payload (config->payload_arg);
+        consumed = exec_task->consumed + (get_clock_ns (CLOCK_THREAD_CPUTIME_ID) - cpu_start);
+        if (consumed >= exec_task->demand || consumed >= budget)
+            break;
+        now = get_clock_ns (CLOCK_MONOTONIC) - shared->start_time;
+        if (now >= next_release || __atomic_load_n (&shared->current_level, __ATOMIC_ACQUIRE) != level)
+            break;
+    }
+    exec_task->consumed = consumed;
+    now = get_clock_ns (CLOCK_MONOTONIC) - shared->start_time;
+
+    // JOB TERMINATION
+    if (consumed >= exec_task->demand) {
+        exec_task->active = 0;
+        worker->stats.jobs_completed++;
+        worker->stats.total_response_time = worker->stats.total_response_time + (now - exec_task->release);
+        if (worker->stats.max_response_time < now - exec_task->release)
+            worker->stats.max_response_time = now - exec_task->release;
+        if (now > (long long)(job->real_deadline * unit))
+            worker->stats.deadline_misses++;
+    }
+
+    // Budget exhausted below the job's own criticality level --> CRITICALITY LEVEL CHANGE (for all workers)
+    else if (consumed >= budget && job->job_criticality > level) {
+        if (__atomic_compare_exchange_n (&shared->current_level, &level, level + 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            __atomic_fetch_add (&shared->mode_changes, 1, __ATOMIC_RELAXED);
+    }
+
+    // Budget exhausted at the job's own criticality level --> JOB OVERRUN, the job is aborted
+    else if (consumed >= budget) {
+        exec_task->active = 0;
+        worker->stats.jobs_aborted++;
+    }
+}
+
+// Worker thread: executes the jobs of one allocated core till the end of the run
+
+void *run_executor_worker (void *arg) {
+
+    Exec_worker *worker = (Exec_worker *) arg;
+    Exec_shared *shared = worker->shared;
+    Exec_task *selected = NULL;                    // Job selected at the current decision
+    Exec_task *running = NULL;                     // Job that was executing before the current decision
+    long long now = 0;                             // Time since the start (ns)
+    long long decision_start = 0;                  // Start of the current scheduling decision
+    long long overhead = 0;                        // Time spent in the current scheduling decision
+    long long next_release = 0;                    // Earliest nominal release time among the worker's tasks
+    long long end_time = 0;                        // End of the run
+
+    setup_worker_thread (worker);
+    sleep_until (shared->start_time);
+
+    while (1) {
+
+        decision_start = get_clock_ns (CLOCK_MONOTONIC);
+        now = decision_start - shared->start_time;
+        end_time = __atomic_load_n (&shared->end_time, __ATOMIC_ACQUIRE);
+        if (now >= end_time)
+            break;
+
+        // SCHEDULING DECISION: releases, level changes, EDF-VD selection
+        release_worker_jobs (worker, now);
+        apply_level_change (worker);
+
+        next_release = end_time;
+        for (int i = 0; i < worker->num_tasks; i++) {
+            if (next_release > worker->task[i].next_release)
+                next_release = worker->task[i].next_release;
+        }
+
+        selected = select_worker_job (worker);
+        if (running != NULL && running->active && selected != running) {
+            running->job.status_flag = PREEMPTED;
+            worker->stats.preemptions++;
+        }
+
+        overhead = get_clock_ns (CLOCK_MONOTONIC) - decision_start;
+        worker->stats.decisions++;
+        worker->stats.total_decision_overhead = worker->stats.total_decision_overhead + overhead;
+        if (worker->stats.max_decision_overhead < overhead)
+            worker->stats.max_decision_overhead = overhead;
+
+        // IDLE core: sleep till the next release
+        if (selected == NULL) {
+            running = NULL;
+            sleep_until (shared->start_time + next_release);
+            continue;
+        }
+
+        run_worker_job (worker, selected, next_release);
+        running = selected;
+    }
+
+    // Jobs still pending past their deadlines at the end of the run
+    for (int i = 0; i < worker->num_tasks; i++) {
+        if (worker->task[i].active && now > (long long)(worker->task[i].job.real_deadline * shared->config->time_unit_ns))
+            worker->stats.deadline_misses++;
+    }
+
+    return NULL;
+}
+
+// Run the allocated taskset on real cores (one worker thread per allocated core)
+// Returns 0 on success, -1 if the taskset is not allocated or the worker threads could not be created
+
+int run_executor (Sim_context *ctx, Exec_config *config, Exec_stats *stats) {
+
+    Exec_shared shared;                            // State shared by all the workers
+    Exec_worker *worker;                           // Worker of each allocated core
+    pthread_t thread[MAX_CORES];                   // Worker threads
+    int num_threads = 0;                           // Number of worker threads created
+    long num_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+    Tasks *task;
+
+    if (ctx->num_cores <= 0 || config->time_unit_ns <= 0)
+        return -1;
+
+    // The workers only run the tasks allocated to their own core (no job migration between the workers)
+    if (ctx->num_splits > 0) {
+        printf(" ERROR: Split tasks (semi-partitioned allocation) are not supported by the executor\n");
+        return -1;
+    }
+
+    worker = calloc (ctx->num_cores, sizeof (Exec_worker));
+    if (worker == NULL) {
+        printf(" ERROR: Could not allocate memory for the executor\n");
+        return -1;
+    }
+
+    if (config->payload == NULL)
+        config->payload = busy_work_payload;
+
+    shared.ctx = ctx;
+    shared.config = config;
+    shared.current_level = 1;
+    shared.mode_changes = 0;
+    shared.end_time = (long long)(((config->duration > 0) ? config->duration : ctx->hyperperiod) * config->time_unit_ns);
+
+    if (ctx->num_cores > num_cpus)
+        printf(" WARNING: %d cores allocated but only %ld CPUs online, workers will share CPUs\n", ctx->num_cores, num_cpus);
+
+    // Tasks allocated to each core, first job released at the task phase
+    for (int i = 0; i < ctx->num_cores; i++) {
+        worker[i].shared = &shared;
+        worker[i].core = &ctx->core[i];
+        worker[i].core_idx = i;
+        worker[i].level = 1;
+        worker[i].stats.cpu = -1;
+        for (int j = 0; j < ctx->num_tasks && worker[i].num_tasks < MAX_TASKS; j++) {
+            task = &ctx->tasks_arr[j];
+            if (task->allocated_core == ctx->core[i].core_no) {
+                worker[i].task[worker[i].num_tasks].task = task;
+                worker[i].task[worker[i].num_tasks].next_release = (long long) task->phase * config->time_unit_ns;
+                worker[i].num_tasks++;
+            }
+        }
+    }
+
+    // All the workers start at the same time (after all of them are created)
+    shared.start_time = get_clock_ns (CLOCK_MONOTONIC) + EXEC_START_DELAY_NS;
+    for (num_threads = 0; num_threads < ctx->num_cores; num_threads++) {
+        if (pthread_create (&thread[num_threads], NULL, run_executor_worker, &worker[num_threads]) != 0) {
+            printf(" ERROR: Could not create the worker thread of core %d\n", ctx->core[num_threads].core_no);
+            __atomic_store_n (&shared.end_time, 0, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+
+    for (int i = 0; i < num_threads; i++)
+        pthread_join (thread[i], NULL);
+
+    // Collect the measurements
+    stats->num_cores = ctx->num_cores;
+    stats->mode_changes = shared.mode_changes;
+    stats->final_level = shared.current_level;
+    for (int i = 0; i < ctx->num_cores; i++)
+        stats->core[i] = worker[i].stats;
+
+    free (worker);
+    return (num_threads == ctx->num_cores) ? 0 : -1;
+}
+
+// -----------------
+// HELPER FUNCTIONS
+// -----------------
+
+// Helper function to print the executor measurements (times in microseconds)
+
+void print_executor_stats (Exec_stats *stats) {
+
+    Exec_core_stats *cs;
+
+    printf("\n Executor measurements (times in us):\n Criticality level changes: %d (final level: %d)\n", stats->mode_changes, stats->final_level);
+
+    for (int i = 0; i < stats->num_cores; i++) {
+        cs = &stats->core[i];
+
+        printf("\n Core %d: CPU %d%s, %s\n", i + 1, cs->cpu, (cs->cpu < 0) ? " (affinity not set)" : "", cs->realtime ? "SCHED_FIFO" : "default policy (SCHED_FIFO not permitted)");
+        printf(" Jobs released: %d, completed: %d, deadline misses: %d, discarded: %d, aborted: %d, preemptions: %d\n",
+               cs->jobs_released, cs->jobs_completed, cs->deadline_misses, cs->jobs_discarded, cs->jobs_aborted, cs->preemptions);
+        printf(" Release jitter: avg %.3f max %.3f\n", cs->jobs_released ? cs->total_release_jitter / 1000.0 / cs->jobs_released : 0.0, cs->max_release_jitter / 1000.0);
+        printf(" Response time: avg %.3f max %.3f\n", cs->jobs_completed ? cs->total_response_time / 1000.0 / cs->jobs_completed : 0.0, cs->max_response_time / 1000.0);
+        printf(" Decision overhead: avg %.3f max %.3f (%d decisions)\n", cs->decisions ? cs->total_decision_overhead / 1000.0 / cs->decisions : 0.0, cs->max_decision_overhead / 1000.0, cs->decisions);
+    }
+
+    printf("\n ------------------------------------------------------------------------------\n");
+}
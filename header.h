@@ -9,6 +9,11 @@
 #define MAX_CORES 20                      // Maximum number of cores available 
 #define MAX_TASKS 20                      // Maximum number of tasks that can be allocated to core
 #define MAX_LEVELS 5                      // Maximum number of criticality levels supported by the system
+#define MAX_DISCARDED_JOBS 64             // Capacity of each discarded queue (bounds the memory used in prolonged HI-criticality modes)
+#define MAX_STAGED_LISTS MAX_CORES        // Maximum number of job lists spliced into a discarded queue before they are added to its heap
+#define MAX_SPLIT_TASKS MAX_CORES         // Maximum number of tasks split across cores (semi-partitioned allocation)
+#define MAX_PORTIONS 4                    // Maximum number of portions (cores) a split task is divided into
+#define DEMAND_MAX_HORIZON 1000000       // Maximum interval length checked by the EDF processor demand criterion (longer: not schedulable)
 
 // --------------------------------
 // PRE-DETERMINED SYSTEM PARAMETERS
@@ -17,8 +22,18 @@
 #define LPD_THRESHOLD 10                  // Minimum threshold value for (2*period - 2*wcet) for a task to be categorized as Low Period (LPD)
 #define SHUTDOWN_THRESHOLD 10              // Minimum idle time required for a core to be able to SAVE energy by shutting down
                                           // (Just a dummy value --> the actual value can be pre-determined using Critical Frequency)
+                                          // (Break-even time of the default sleep state of every core type)
+#define MAX_SLEEP_STATES 8                // Maximum number of sleep states (C-states) per core type
+#define SLEEP_STATE_NAME_LENGTH 16        // Maximum length of a sleep state name (including the terminating null character)
 #define TIME_GRANULARITY 0.01             // Timecount granularity of the runtime scheduler
+#define SLACK_CACHE_SIZE 16               // Number of (level, horizon) slack values cached per core within a decision point
 #define BASE_OPERATING_FREQUENCY 1.0      // All frequency values are normalized wrt the base operating frequency value
+#define STEADY_STATE_HISTORY 64           // Maximum number of super-hyperperiod boundary states recorded for steady-state detection
+#define TRACE_BUFFER_SIZE 65536           // Size of the schedule trace output buffer (written to the file when full)
+#define TRACE_EVENT_LENGTH 512            // Maximum length of one trace event (the buffer is flushed if less space is left)
+#define TRACE_US_PER_TIME_UNIT 1000       // Trace timestamps (microseconds) per simulation time unit
+#define SORT_RADIX_BITS 8                 // Bits of the task sort key handled by each counting pass of the radix sort
+#define SORT_INSERTION_THRESHOLD 32       // Tasksets smaller than this are sorted by insertion sort (no sort buffers needed)
 
 // ----------------------------------------
 // TASK PARAMETERS - DEFAULT/SPECIAL VALUES
@@ -26,6 +41,8 @@
 
 #define NOT_ALLOCATED -73                 // The allocated core id value is set to an invalid number when the task is yet to be allocated
 #define IDLE_TASK_NO 0                    // Task number for an IDLE task is defined as IDLE_TASK_NO = 0
+#define SPLIT_TASK -74                    // The allocated core id value of a task split across cores (its portions are allocated instead)
+#define NOT_SPLIT -1                      // Portion number of the jobs of tasks that are not split
 
 // ---------------------------------------------------------------
 // DIFFERENT CORE TYPE VALUES (in the context of SHUTDOWN-ability)
@@ -33,6 +50,7 @@
 
 #define NON_SHUTDOWNABLE 0                // Core type value 0 indicates that the core consists of LPD tasks, hence canNOT be SHUTDOWN
 #define SHUTDOWNABLE 1                    // Core type value 1 indicates that the core consists of only HPD tasks, hence can be SHUTDOWN
+#define NUM_CORE_TYPES 2                  // Number of core type values (each core type has its own table of sleep states)
 
 // --------------------------------------------------------------
 // DIFFERENT CORE STATUS VALUES (in the context of energy saving)
@@ -47,6 +65,56 @@
 
 #define READY 0                           // Status flag in job structure is set to a default value of 0 upon arrival
 #define PREEMPTED 1                       // Status flag in job structure is set to 1 if the job is preempeted - useful for printing and debugging
+#define ANTICIPATED 2                     // Status flag of the jobs created for the anticipated arrivals of the slack calculations (owned by the dummy queue)
+
+// --------------------------------------------------------------
+// ACTUAL EXECUTION TIME DISTRIBUTIONS (job execution time model)
+// --------------------------------------------------------------
+
+#define EXEC_UNIFORM 0                    // Integer execution times uniformly distributed over [1, wcet at the task's criticality level]
+#define EXEC_TRUNCATED_NORMAL 1           // Normally distributed execution times truncated to (0, wcet at the task's criticality level]
+#define EXEC_BIMODAL 2                    // Overrun-prone: execution time exceeds the lowest criticality wcet with the configured probability
+#define EXEC_LO_WCET 3                    // Deterministic: every job executes exactly its lowest criticality wcet (the system stays in LO mode)
+
+#define EXEC_NORMAL_MEAN 0.5              // Mean of the truncated normal distribution (fraction of the wcet at the task's criticality level)
+#define EXEC_NORMAL_STDDEV 0.2            // Standard deviation of the truncated normal distribution (fraction of the same wcet)
+#define EXEC_NORMAL_MAX_TRIES 16          // Maximum number of samples drawn before falling back to the mean
+#define DEFAULT_OVERRUN_PROBABILITY 0.1   // Default probability of a job overrunning its lowest criticality wcet (bimodal distribution)
+
+// ------------------------------------------------------
+// READY QUEUE ORDERING VALUES (in the context of EDF-VD)
+// ------------------------------------------------------
+
+#define VIRTUAL_DEADLINES 0               // Ready queue ordered by job virtual deadlines (core criticality <= EDF-VD threshold)
+#define REAL_DEADLINES 1                  // Ready queue ordered by job original deadlines (core criticality > EDF-VD threshold)
+
+// -------------------------------------------------------
+// TASK ALLOCATION MODES (in the context of job migration)
+// -------------------------------------------------------
+
+#define ALLOCATION_PARTITIONED 0          // Every task is allocated to one core (a new core is opened if no core can accommodate a task)
+#define ALLOCATION_SEMI_PARTITIONED 1     // A task that fits no core may be split into budgeted portions across open cores (migrating jobs)
+
+// -----------------------------------------------------
+// PREEMPTION MODES (in the context of EDF-VD scheduling)
+// -----------------------------------------------------
+
+#define PREEMPTION_FULL 0                 // A ready job with an earlier deadline preempts the running job at once
+#define PREEMPTION_LIMITED 1              // Floating non-preemptive regions: the running job is preempted at most npr_length time units after a preemption request
+
+// ----------------------------------------------------
+// SHUTDOWN POLICIES (in the context of power domains)
+// ----------------------------------------------------
+
+#define SHUTDOWN_INDEPENDENT 0            // Every core decides to SHUTDOWN in its own idle gaps
+#define SHUTDOWN_COORDINATED 1            // A core with work procrastinates it to sleep with the other (SHUTDOWN) cores of its power domain
+
+// ------------------------------------------------------
+// CRITICALITY DE-ESCALATION POLICIES (return to LO mode)
+// ------------------------------------------------------
+
+#define DEESCALATION_NONE 0               // The criticality level is never lowered (HI mode till the end of the super-hyperperiod)
+#define DEESCALATION_IDLE_INSTANT 1       // The system returns to the lowest criticality level at the first system-wide idle instant
 
 // -------------------------------------                      
 // SCHEDULING DECISION POINT FLAG VALUES
@@ -57,12 +125,101 @@
 #define JOB_WCET_EXCEEDED 4               // xx1xx to indicate that the currently executing job exceeds its allocated wcet budget => CRITICALITY LEVEL CHANGE
 #define JOB_OVERRUN 8                     // x1xxx to indicate that the currently executing job overruns its allocated wcet budget (at highest defined criticality level) 
 #define WAKEUP_CORE 16                    // 1xxxx to indicate wakeup time for a core that is currently powered down
+#define PREEMPTION_POINT 32               // 1xxxxx to indicate the end of the running job's non-preemptive region (deferred preemption)
 
 // Each flag value is added to core decision point event flag if the corresponding condition is satisfied
 // Ex: 01001 would indicate that the next decision point is due to a new job arriving as well as the currently executing job overrunning
 
 #define NA -1                             // Default slack value for SHUTDOWN cores
 
+// ---------------------------
+// SNAPSHOT FILE FORMAT VALUES
+// ---------------------------
+
+#define SNAPSHOT_MAGIC "EEMCSSNP"         // Magic bytes at the start of every preprocessed taskset snapshot file
+#define SNAPSHOT_VERSION 1                // Snapshot format version (incremented whenever the record layout changes)
+#define SNAPSHOT_TOLERANCE 1e-9           // Tolerance of the stored utilizations (checked against the stored wcets and periods)
+
+// -----------------------------
+// REAL-TIME EXECUTOR PARAMETERS
+// -----------------------------
+
+#define NSEC_PER_SEC 1000000000LL         // Nanoseconds per second
+#define EXEC_START_DELAY_NS 20000000LL    // Delay between creating the worker threads and their common start time (ns)
+#define EXEC_RT_PRIORITY 80               // Default SCHED_FIFO priority of the worker threads
+#define EXEC_PAYLOAD_ITERATIONS 2000      // Iterations of the default busy-work payload per call (granularity of preemption and budget checks)
+
+// -------------------------------
+// ALLOCATION OPTIMIZER PARAMETERS
+// -------------------------------
+
+#define POOL_QUEUE_CAPACITY 64            // Initial capacity of the thread pool task queue (grown on demand)
+#define OPTIMIZER_CHAINS 8                // Number of independent annealing chains (fixed, so the result does not depend on the number of threads)
+#define OPTIMIZER_CORE_WEIGHT 1000000.0   // Cost of an active (non-empty) core
+#define OPTIMIZER_SHUTDOWN_WEIGHT 1000.0  // Cost reduction for an active core that is SHUTDOWNABLE (no LPD tasks)
+#define OPTIMIZER_INITIAL_TEMPERATURE 2.0 // Annealing temperature at the first iteration (in cost units)
+#define OPTIMIZER_FINAL_TEMPERATURE 0.01  // Annealing temperature at the last iteration
+
+// -----------------------------------
+// ALLOCATION HEURISTICS AND PORTFOLIO
+// -----------------------------------
+
+#define HEURISTIC_ADAPTIVE 0              // WFD + FFD if the HI criticality tasks are at most 40% of the utilization, else FFD (default)
+#define HEURISTIC_WFD_FFD 1               // WFD for the HI criticality tasks, FFD for the LO criticality tasks
+#define HEURISTIC_FFD 2                   // First fit decreasing for all tasks
+#define HEURISTIC_WFD 3                   // Worst fit decreasing for all tasks
+#define HEURISTIC_BFD 4                   // Best fit decreasing (least remaining capacity) for all tasks
+#define HEURISTIC_CRITICALITY_FFD 5       // First fit among the cores hosting tasks of the same criticality level, then among all cores
+#define NUM_HEURISTICS 6                  // Number of allocation heuristics
+
+#define LPD_DEDICATED_CORES 0             // Low period tasks are allocated first, to the minimum number of NON_SHUTDOWNABLE cores (default)
+#define LPD_MIXED_CORES 1                 // Low period tasks are allocated with the other tasks, their cores become NON_SHUTDOWNABLE
+#define NUM_LPD_ALLOCATIONS 2             // Number of low period task allocation modes
+
+#define PORTFOLIO_FEWEST_CORES 0          // Portfolio objective: fewest cores (then most SHUTDOWNABLE cores, then lowest predicted energy)
+#define PORTFOLIO_MOST_SHUTDOWNABLE 1     // Portfolio objective: most SHUTDOWNABLE cores (then fewest cores, then lowest predicted energy)
+#define PORTFOLIO_LOWEST_ENERGY 2         // Portfolio objective: lowest predicted energy (then fewest cores)
+
+#define ENERGY_ACTIVE_POWER 1.0           // Predicted power of a core executing jobs (relative to the base operating frequency)
+#define ENERGY_IDLE_POWER 0.3             // Predicted power of an idle NON_SHUTDOWNABLE core
+#define ENERGY_SLEEP_POWER 0.05           // Predicted power of an idle SHUTDOWNABLE core (SHUTDOWN for its idle time)
+
+// -----------------------------------------------
+// ONLINE ADMISSION CONTROL (RUNTIME TASK CHANGES)
+// -----------------------------------------------
+
+#define MAX_TASK_CHANGES 32               // Maximum number of runtime task changes pending in a simulation context
+#define TASK_CHANGE_ADD 0                 // Add a task (allocated by WFD/FFD + EDF-VD to one of the open cores)
+#define TASK_CHANGE_REMOVE 1              // Remove a task (its released jobs complete, no further job is released)
+#define TASK_CHANGE_MODIFY 2              // Change the parameters of a task (kept on its core if it is still schedulable there)
+
+#define TASK_CHANGE_APPLIED 0             // The task change was applied at the current decision point
+#define TASK_CHANGE_REJECTED -1           // The task change was rejected (not schedulable on any open core, unknown task number ...)
+#define TASK_CHANGE_DEFERRED 1            // The task change waits for a later decision point (the selected core is SHUTDOWN)
+
+// ----------------------------------------
+// SCHEDULING SERVER PROTOCOL (UNIX SOCKET)
+// ----------------------------------------
+
+#define SERVER_MAGIC 0x434D4545           // Magic number of every request/response header (bytes "EEMC" in little-endian order)
+#define SERVER_MAX_CLIENTS 16             // Maximum number of simultaneously connected clients
+#define SERVER_LISTEN_BACKLOG 16          // Backlog of pending connections on the server socket
+#define SERVER_MAX_TASKS (MAX_CORES * MAX_TASKS)   // Maximum number of tasks in the served taskset (no allocation can hold more)
+
+#define SERVER_REQUEST_LOAD 1             // Replace the served taskset (Server_taskset followed by its Server_task records)
+#define SERVER_REQUEST_ADD_TASK 2         // Add a task to the served taskset (Server_task), answered with Server_update
+#define SERVER_REQUEST_REMOVE_TASK 3      // Remove a task from the served taskset (task number: int), answered with Server_update
+#define SERVER_REQUEST_ALLOCATE 4         // Allocate the served taskset (optional core limit: int), answered with Server_allocation
+#define SERVER_REQUEST_SIMULATE 5         // Simulate the allocated taskset (Server_simulation), answered with Server_summary
+#define SERVER_REQUEST_STOP 6             // Stop the server (after answering the request)
+
+#define SERVER_OK 0                       // Response status: request served
+#define SERVER_ERROR_REQUEST -1           // Response status: unknown request type or malformed payload
+#define SERVER_ERROR_TASKSET -2           // Response status: no taskset loaded, invalid task parameters or unknown task number
+#define SERVER_ERROR_UNSCHEDULABLE -3     // Response status: the taskset cannot be allocated (simulation requested)
+#define SERVER_ERROR_MEMORY -4            // Response status: out of memory
+#define SERVER_ERROR_IO -5                // Client side status: the request could not be sent or the response is malformed
+
 // ==============================
 // ABSTRACT DATA TYPE DEFINITIONS
 // ==============================
@@ -77,10 +234,15 @@ typedef struct {
     int allocated_core;                   // Stores the core number of the core it is allocated to
     int arrival_time;                     // Arrival time of the job
     double sched_deadline;                // Deadline according to which the scheduling is done (can be virtual/actual deadline of the job) 
-    double execution_time;                // Remaining (actual) execution time of the job - execution times are generated randomly using rand fn
+    double virtual_deadline;              // Absolute virtual deadline of the job (EDF-VD)
+    double real_deadline;                 // Absolute original deadline of the job
+    double execution_time;                // Remaining (actual) execution time of the job - execution times are generated randomly (counter-based RNG keyed by seed, task, job)
     int wcet_budget[MAX_LEVELS];          // To maintain the remaining execution time budget (timer) of the job at different criticality levels
     int job_criticality;                  // Criticality level of the job (same as the criticality level of the corresponding task set)  
     int status_flag;                      // Flag = 0: fresh arrival, Flag = 1: preempted - can be used to indicate other process states later on  
+    int portion;                          // Portion of the split task executed by the job on its current core (NOT_SPLIT for tasks that are not split)
+    double migrating_time;                // Actual execution time left for the later portions of a split task's job (migrates with the job)
+    double npr_end;                       // End of the job's non-preemptive region while a preemption is deferred (NA if none)
 }Jobs;
 
 // -------------------------
@@ -91,14 +253,53 @@ typedef struct {
     int task_no;                          // To identify a task structure
     int phase;                            // Task phase - release time
     int period;                           // Task period/Minimum inter-arrival time (we assume a periodic task set*)
-    int *wcet;                            // Worst-case execution time (array pointer, size - dynamically allocated according to the maximum criticality level in which the task can execute)
+    int *wcet;                            // Worst-case execution time (array pointer into the taskset's wcet arena, size - task's criticality level)
     int criticality;                      // Criticality level designated to the task set
     int deadline;                         // Relative deadline
     double virtual_deadline;              // Virtual deadline of a task (determined by EDFVD offline preprocessing phase)
     double utilization[MAX_LEVELS];       // Task utilization
     int allocated_core;                   // Stores the core number of the core it is allocated to
+    int lpd;                              // Set if the task satisfies the low period (LPD) condition (derived once by the preprocessing)
+    double own_utilization;               // Task utilization at its own criticality level (derived once by the preprocessing)
 }Tasks;
 
+// --------------------------
+// TASK SORT ENTRY DEFINITION
+// --------------------------
+
+typedef struct {
+    unsigned long long key;               // Packed sort key of the task (increasing key order = decreasing own level utilization)
+    int index;                            // Index of the task in the task structure array before sorting
+}Sort_entry;
+
+// ----------------------------
+// TASKSET STRUCTURE DEFINITION
+// ----------------------------
+
+typedef struct {
+    Tasks *tasks_arr;                     // Task structure array
+    int *wcet_arena;                      // Contiguous storage for the wcet arrays of all tasks (task wcet pointers point into this arena)
+    int num_tasks;                        // Number of tasks in the taskset
+    int max_criticality;                  // Maximum criticality level defined for the taskset
+    size_t source_start;                  // Byte range [source_start, source_end) of the taskset in the input file
+    size_t source_end;
+    void *snapshot_map;                   // Memory-mapped snapshot backing the wcet arrays (NULL if the taskset was parsed)
+    size_t snapshot_size;                 // Size of the memory-mapped snapshot
+}Taskset;
+
+// ---------------------------------
+// INPUT FILE STRUCTURE DEFINITION
+// ---------------------------------
+
+typedef struct {
+    const char *data;                     // Memory-mapped contents of the input file
+    size_t size;                          // Size of the input file (in bytes)
+    size_t offset;                        // Parser cursor (offset of the next unread byte)
+    int line_no;                          // Line number of the parser cursor (for error reporting)
+    int taskset_count;                    // Number of tasksets read from the file so far
+    int fd;                               // Input file descriptor
+}Taskset_file;
+
 // ---------------------------------
 // TASKSET INFO STRUCTURE DEFINITION
 // ---------------------------------
@@ -110,6 +311,56 @@ typedef struct {
     double lpd_lo_crit_util;              // Total utilization of all LO criticality low period tasks (at their own criticality level) in the workload
 }Taskset_info;
 
+// ---------------------------------------
+// TASKSET SNAPSHOT STRUCTURE DEFINITIONS
+// ---------------------------------------
+
+// Snapshot file header
+typedef struct {
+    char magic[8];                        // SNAPSHOT_MAGIC
+    int version;                          // SNAPSHOT_VERSION
+    int header_size;                      // Sizes of the header and records (to detect layout mismatches)
+    int task_record_size;
+    int core_record_size;
+    int max_cores;                        // System constraints the snapshot was preprocessed with
+    int max_tasks;
+    int max_levels;
+    int lpd_threshold;
+    int num_tasks;                        // Number of task records
+    int max_criticality;                  // Maximum criticality level defined for the taskset
+    int num_cores;                        // Number of core records (cores required for allocation)
+    int hyperperiod;                      // Super-hyperperiod of the taskset
+    int source_lines;                     // Number of lines spanned by the taskset in the input file
+    unsigned long long source_start;      // Byte range of the taskset in the input file
+    unsigned long long source_end;
+    unsigned long long source_checksum;   // FNV-1a checksum of the taskset bytes in the input file
+} Snapshot_header;
+
+// Snapshot task record (tasks are stored in sorted order)
+typedef struct {
+    int task_no;
+    int phase;
+    int period;
+    int deadline;
+    int criticality;
+    int allocated_core;
+    int wcet[MAX_LEVELS];                 // Task wcets (the task structure's wcet pointer points here when loaded)
+    double virtual_deadline;              // Virtual deadline determined by EDF-VD offline preprocessing
+    double utilization[MAX_LEVELS];
+} Snapshot_task;
+
+// Snapshot core record (allocation parameters)
+typedef struct {
+    int core_no;
+    int tasks_alloc_count;
+    int tasks_alloc_ids[MAX_TASKS];
+    int threshold_criticality;
+    int core_type;
+    double utilization;
+    double remaining_capacity;
+    double operating_frequency;
+} Snapshot_core;
+
 // ------------------------------
 // RUN QUEUE STRUCTURE DEFINITION
 // ------------------------------
@@ -119,6 +370,7 @@ struct _node {
     Jobs *job;                            // Job structure pointer
     struct _node *prev;                   // Pointer to the previous node
     struct _node *next;                   // Pointer to the next node
+    struct _node *twin;                   // Node of the same job in the other ordering of a ready queue bucket (NULL in other queues)
 };
 
 typedef struct _node RQ_NODE;
@@ -130,13 +382,64 @@ typedef struct {
     RQ_NODE *head_node;                   // Pointer to run queue head node      
 } RQ_HEAD;
 
+// --------------------------------
+// READY QUEUE STRUCTURE DEFINITION
+// --------------------------------
+
+// Ready queue of a core: ready jobs partitioned by job criticality, one EDF ordered run queue (bucket) per criticality level
+// The next job is the earliest deadline job among the bucket heads; all jobs below a criticality level are discarded by splicing whole buckets
+// Each bucket is kept in both virtual and real deadline order (twin nodes per job), the mode switch only changes the active ordering
+typedef struct {
+    int size;                             // Number of jobs in the ready queue (all criticality levels)
+    int deadline_type;                    // Active ordering: VIRTUAL_DEADLINES/REAL_DEADLINES
+    RQ_HEAD bucket[2][MAX_LEVELS];        // bucket[t][i]: ready jobs of criticality level (i + 1) in increasing order of deadline type t
+} Ready_queue;
+
+// ------------------------------------
+// DISCARDED QUEUE STRUCTURE DEFINITION
+// ------------------------------------
+
+// Discarded queue entry
+typedef struct {
+    double latest_start_time;             // Latest time at which the job can start executing and still meet its deadline (heap key)
+    Jobs *job;                            // Job structure pointer
+} Discarded_entry;
+
+// Discarded queue: binary min-heap of discarded jobs keyed by their latest start times (bounded capacity)
+typedef struct {
+    int size;                             // Number of jobs in the discarded queue
+    Discarded_entry entry[MAX_DISCARDED_JOBS];  // Heap array (entry[0] has the earliest latest start time)
+    int num_staged;                       // Number of spliced job lists not yet added to the heap
+    RQ_NODE *staged[MAX_STAGED_LISTS];    // Job lists spliced from ready queue buckets on mode change (added to the heap lazily)
+} Discarded_queue;
+
+// --------------------------------
+// SLACK CACHE STRUCTURE DEFINITION
+// --------------------------------
+
+// Slack values calculated for a discarded job candidate
+typedef struct {
+    int level;                            // Criticality level at which the slack is calculated
+    double horizon;                       // Discarded job deadline up to which the slack is calculated
+    double slack_available;               // Slack available for discarded job execution
+    double optimal_slack;                 // Optimal slack (calculated by anticipating all job arrivals till hyperperiod)
+    double expected_completion_time;      // Expected completion time of the discarded job if scheduled
+} Slack_cache_entry;
+
+// Per-core slack cache (valid within one decision point, while the core's run queue is unchanged)
+typedef struct {
+    int size;                             // Number of valid entries
+    int next;                             // Entry to be replaced next (round robin)
+    Slack_cache_entry entry[SLACK_CACHE_SIZE];
+} Slack_cache;
+
 // -----------------------------------
 // DECISION POINT STRUCTURE DEFINITION
 // -----------------------------------
 
 typedef struct {                                      
     double decision_time;                 // Time at which the next scheduling decision point occurs
-    unsigned int event:5;                 // Event causing the decision point: job arrival/job termination/criticality level change (wcet exceeded)/job overrun/core wakeup                           
+    unsigned int event:6;                 // Event causing the decision point: job arrival/job termination/criticality level change (wcet exceeded)/job overrun/core wakeup/preemption point                           
 } Decision_point;
 
 // -------------------------
@@ -151,6 +454,7 @@ typedef struct {
     double remaining_capacity;            // To determine how many more tasks can be allocated to this core (bin packing capacity)
     int tasks_alloc_count;                // Number of tasks allocated to the core       
     int tasks_alloc_ids[MAX_TASKS];       // An array that holds the task_no of tasks allocated to the given core
+    int split_portions;                   // Number of split task portions allocated to the core (no other task is allocated to it afterwards)
     int threshold_criticality;            // Threshold criticality of the core; beyond this level all low-criticality tasks discarded
     int core_criticality;                 // Criticality level of this core
 
@@ -159,6 +463,8 @@ typedef struct {
     int core_type;                        // To indicate whether a core is SHUTDOWNABLE or NON-SHUTDOWNABLE 
     int status;                           // To indicate whether a core is currently ACTIVE or SHUTDOWN (power-saving mode)
     double wakeup_time;                   // Wakeup time for cores which have been SHUTDOWN, set to -1 for active cores
+    int sleep_state;                      // Sleep state of a SHUTDOWN core (index in the sleep state table of its core type)
+    double sleep_start;                   // Time at which the core started entering its sleep state
 
     // DVFS parameters
     // double x;                          // Deadline shortening factor (x), determined by the EDF-VD offline preprocessing phase
@@ -168,12 +474,545 @@ typedef struct {
 
     // Runtime Scheduler parameters
     Decision_point *decision_point;       // Decision point structure consisting of event causing the decision point and exact time at which it occurs
-    RQ_HEAD *qhead;                       // Pointer to local run queue head
-    Jobs *curr_exe_job;                   // Stores the structure of job currently executing on this core
-    Jobs *preempted_job;                  // Stores the structure of job preempted from this core
+    Ready_queue *ready_queue;             // Pointer to local ready queue (run queues partitioned by job criticality)
+    Ready_queue *pending_queue;           // Pointer to local pending request queue (job arrivals while the core is SHUTDOWN)
+    Jobs *curr_exe_job;                   // Stores the structure of job currently executing on this core (kept out of the run queue while executing)
+    Jobs idle_job;                        // IDLE job structure (curr_exe_job points here when the core is IDLE)
+    int preemptions;                      // Number of preemptions on this core
+    int deferred_preemptions;             // Number of preemption requests deferred by a non-preemptive region on this core
+    double overhead_time;                 // Preemption/migration overhead charged to the jobs executed on this core
+    Slack_cache slack_cache;              // Slack values calculated for discarded job candidates at the current decision point
     double idle_time;                     // To record the system idle time in one hyperperiod
+    double sleep_time;                    // Time spent SHUTDOWN in one hyperperiod
 } Cores;
 
+// -------------------------------
+// SPLIT TASK STRUCTURE DEFINITION
+// -------------------------------
+
+// Task split into portions executed one after the other on different cores (semi-partitioned allocation, C=D scheme)
+// Portion p of a job is released on core core_no[p] at (job arrival + offset[p]) with relative deadline window[p], the windows are consecutive
+// All portions but the last have the same budget at every level (a fixed split point) and a window equal to it (zero laxity, apart from the reserved overheads)
+// The last portion has the rest of the deadline and of the task's wcets
+// A job migrates to the next portion's core at the start of the next window if its execution is not complete
+typedef struct {
+    int task_idx;                         // Task structure array index of the split task
+    int num_portions;                     // Number of portions (cores)
+    int core_no[MAX_PORTIONS];            // Core executing each portion
+    int offset[MAX_PORTIONS];             // Release offset of each portion wrt the job arrival
+    int window[MAX_PORTIONS];             // Relative deadline of each portion
+    double virtual_window[MAX_PORTIONS];  // Relative virtual deadline of each portion (EDF-VD on the portion's core)
+    int budget[MAX_PORTIONS][MAX_LEVELS]; // Wcet budget of each portion at each criticality level (up to the task's criticality)
+    Jobs *migrating_job;                  // Job waiting for the release of its next portion (NULL if none)
+} Split_task;
+
+// EDF demand parameters of a task/split task portion (processor demand criterion)
+typedef struct {
+    int wcet;                             // Worst-case execution time (at the task's own criticality level)
+    int deadline;                         // Relative deadline
+    int period;                           // Period
+} Demand_task;
+
+// Utilization sums of the tasks allocated to a core (updated incrementally by the optimizer's moves and the runtime task changes)
+typedef struct {
+    int count;                            // Number of tasks allocated to the core
+    int lpd_count;                        // Number of low period (LPD) tasks allocated to the core (the core is SHUTDOWNABLE if 0)
+    double utilization;                   // Total utilization of the tasks at their own criticality levels
+    double own_util[MAX_LEVELS];          // own_util[c - 1]: utilization of the tasks of criticality c at their own level
+    double level_util[MAX_LEVELS][MAX_LEVELS]; // level_util[c - 1][k - 1]: utilization of the tasks of criticality c at level k
+} Core_load;
+
+// Result of the EDF-VD schedulability test of a candidate core for a task (side-effect free probe)
+typedef struct {
+    int threshold_criticality;            // Threshold criticality of the core with the task (-1 if the task cannot be accommodated)
+    double x;                             // Deadline shortening factor of the HI criticality tasks (1.0 if EDF schedulable)
+} Core_probe;
+
+// ---------------------------------------
+// SIMULATION CONTEXT STRUCTURE DEFINITIONS
+// ---------------------------------------
+
+// Sleep state (C-state) of a core type, the states of a table are listed from the shallowest to the deepest
+// A core SHUTDOWN till its wakeup time starts leaving the state exit_latency earlier, so that it executes again from the wakeup time
+typedef struct {
+    char name[SLEEP_STATE_NAME_LENGTH];   // Name of the sleep state (e.g. C1, C6)
+    double entry_latency;                 // Time taken to enter the sleep state
+    double exit_latency;                  // Time taken to leave the sleep state
+    double break_even;                    // Minimum idle interval for which entering the state saves energy (>= entry + exit latency)
+} Sleep_state;
+
+// Simulation configuration
+typedef struct {
+    unsigned long long seed;              // Seed for the counter-based random number generator (actual execution times)
+    int exec_distribution;                // Actual execution time distribution: EXEC_UNIFORM/EXEC_TRUNCATED_NORMAL/EXEC_BIMODAL/EXEC_LO_WCET
+    double overrun_probability;           // Probability of a job overrunning its lowest criticality wcet (EXEC_BIMODAL)
+    int deescalation;                     // Criticality de-escalation policy: DEESCALATION_NONE/DEESCALATION_IDLE_INSTANT
+    int allocation;                       // Task allocation mode: ALLOCATION_PARTITIONED/ALLOCATION_SEMI_PARTITIONED
+    int preemption_mode;                  // Preemption mode: PREEMPTION_FULL/PREEMPTION_LIMITED
+    int npr_length;                       // Length of the floating non-preemptive regions (PREEMPTION_LIMITED)
+    int preemption_overhead;              // Time charged to a preempted job when it resumes (context switch, cache refill)
+    int migration_overhead;               // Time charged to a job resuming on another core (split task portion/discarded job)
+    int shutdown_policy;                  // Shutdown policy: SHUTDOWN_INDEPENDENT/SHUTDOWN_COORDINATED
+    int domain_size;                      // Number of consecutive cores per power domain (cluster)
+    Sleep_state sleep_states[NUM_CORE_TYPES][MAX_SLEEP_STATES];   // Sleep state table of each core type (NON_SHUTDOWNABLE/SHUTDOWNABLE)
+    int num_sleep_states[NUM_CORE_TYPES]; // Number of sleep states of each core type (0: the default state, break-even SHUTDOWN_THRESHOLD)
+    int num_hyperperiods;                 // Number of super-hyperperiods simulated
+    int fast_forward;                     // Set to fast-forward across repeated super-hyperperiods once a steady state is detected
+    int optimizer_iterations;             // Iterations of each allocation optimizer chain (0: greedy allocation only)
+    double optimizer_time_budget;         // Time budget of the allocation optimizer in ms (0: no limit, the result then depends only on the seed)
+    int optimizer_threads;                // Number of allocation optimizer/portfolio threads (0: one per online CPU)
+    int allocation_heuristic;             // Task allocation heuristic: HEURISTIC_* (HEURISTIC_ADAPTIVE by default)
+    int lpd_allocation;                   // Low period task allocation: LPD_DEDICATED_CORES/LPD_MIXED_CORES
+    int allocation_portfolio;             // Set to run every heuristic concurrently and keep the best allocation (by the portfolio objective)
+    int portfolio_objective;              // Portfolio objective: PORTFOLIO_FEWEST_CORES/PORTFOLIO_MOST_SHUTDOWNABLE/PORTFOLIO_LOWEST_ENERGY
+    int verbose;                          // Set to print the schedule, allocation and scheduler debug output to the terminal
+} Sim_config;
+
+// Simulation statistics
+typedef struct {
+    double timecount;                     // Current simulation time
+    int current_level;                    // Current criticality level of the system
+    int decision_points;                  // Number of scheduling decision points processed
+    int mode_changes;                     // Number of criticality level changes
+    int deescalations;                    // Number of returns to the lowest criticality level (at system-wide idle instants)
+    int shutdowns;                        // Number of times a core was SHUTDOWN
+    int coordinated_shutdowns;            // Number of times a core with work was SHUTDOWN to sleep with its power domain
+    int sleep_state_entries[NUM_CORE_TYPES][MAX_SLEEP_STATES];    // Number of times each sleep state of each core type was entered
+    double sleep_state_time[NUM_CORE_TYPES][MAX_SLEEP_STATES];    // Time spent in each sleep state of each core type (including its transitions)
+    int preemptions;                      // Number of preemptions (all cores)
+    int deferred_preemptions;             // Number of preemption requests deferred by non-preemptive regions (all cores)
+    double overhead_time;                 // Preemption/migration overhead charged to the jobs (all cores)
+    int discarded_jobs_scheduled;         // Number of discarded jobs scheduled in the available slack
+    int discarded_jobs_expired;           // Number of discarded jobs removed from the discarded queues after their latest start time
+    int discarded_jobs_dropped;           // Number of discarded jobs dropped because their discarded queue was full
+    int slack_cache_hits;                 // Number of slack calculations reused for discarded job candidates
+    int migrations;                       // Number of split task jobs migrated to the core of their next portion
+    int fast_forwarded_hyperperiods;      // Number of super-hyperperiods skipped by fast-forwarding a steady state
+    int schedule_violations;              // Number of schedule violations found by the schedule verifier (0 if the schedule is not verified)
+    int tasks_added;                      // Number of tasks added at runtime (online admission control)
+    int tasks_removed;                    // Number of tasks removed at runtime
+    int tasks_modified;                   // Number of tasks whose parameters were changed at runtime
+    int task_changes_rejected;            // Number of runtime task changes rejected by the admission control
+    int task_changes_pending;             // Number of runtime task changes still pending (waiting for the lowest criticality level/an ACTIVE core)
+    int num_cores;                        // Number of cores required for allocation
+    double idle_time[MAX_CORES];          // Idle time of each core
+    double sleep_time[MAX_CORES];         // Sleep (SHUTDOWN) time of each core
+    int num_domains;                      // Number of power domains
+    double domain_sleep_time[MAX_CORES];  // Sleep time of each power domain (all its cores SHUTDOWN)
+} Sim_stats;
+
+// Scheduling state recorded at a super-hyperperiod boundary (steady-state detection)
+typedef struct {
+    unsigned long long hash;              // Hash of the scheduling state (all times relative to the boundary)
+    int hyperperiods;                     // Number of super-hyperperiods simulated at the boundary
+    Sim_stats stats;                      // Simulation statistics at the boundary
+    int preemptions[MAX_CORES];           // Preemptions of each core at the boundary
+    int deferred_preemptions[MAX_CORES];  // Deferred preemptions of each core at the boundary
+    double overhead_time[MAX_CORES];      // Overhead time of each core at the boundary
+    double idle_time[MAX_CORES];          // Idle time of each core at the boundary
+    double sleep_time[MAX_CORES];         // Sleep time of each core at the boundary
+    double domain_sleep_time[MAX_CORES];  // Sleep time of each power domain at the boundary
+} Steady_state_record;
+
+// ----------------------------------------
+// SCHEDULE TRACE WRITER (CHROME TRACE JSON)
+// ----------------------------------------
+
+// Kind of the slice currently open on a core track
+#define TRACE_SLICE_NONE 0                // No slice open
+#define TRACE_SLICE_IDLE 1                // ACTIVE core executing the IDLE task
+#define TRACE_SLICE_JOB 2                 // ACTIVE core executing a job
+#define TRACE_SLICE_SLEEP 3               // SHUTDOWN core (in its sleep state)
+
+// Schedule event types (the event stream written to the trace file and checked by the verifier, in non-decreasing time order)
+#define TRACE_EVENT_CONFIG 0              // Simulation parameters checked by the verifier (non-preemptive region length)
+#define TRACE_EVENT_CORE 1                // Core parameters checked by the verifier (EDF-VD threshold criticality)
+#define TRACE_EVENT_BEGIN 2               // A slice starts on a core track (job executing, IDLE or sleeping)
+#define TRACE_EVENT_END 3                 // The slice open on a core track ends
+#define TRACE_EVENT_RELEASE 4             // A job is admitted to a core (ready/pending request queue), with its deadlines and remaining budgets
+#define TRACE_EVENT_COMPLETE 5            // A job completes
+#define TRACE_EVENT_ABORT 6               // A job overrunning its budget at its own criticality level is aborted
+#define TRACE_EVENT_DISCARD 7             // A job is discarded (below the accepted criticality level)
+#define TRACE_EVENT_MIGRATE 8             // A split task's job completes its portion and leaves the core
+#define TRACE_EVENT_OVERHEAD 9            // A preemption/migration overhead is charged to a job (its budgets are extended)
+#define TRACE_EVENT_MODE_CHANGE 10        // The system criticality level is raised
+#define TRACE_EVENT_DEESCALATION 11       // The system criticality level returns to the lowest level
+#define TRACE_EVENT_SHUTDOWN 12           // A core enters a sleep state
+#define TRACE_EVENT_WAKEUP 13             // A SHUTDOWN core is ACTIVE again
+#define TRACE_EVENT_FAST_FORWARD 14       // The simulation is fast-forwarded across repeated super-hyperperiods (all times shift)
+
+// Schedule event (the fields used depend on the event type)
+typedef struct {
+    int type;                             // TRACE_EVENT_*
+    double time;                          // Time of the event
+    int core_no;                          // Core of the event (0: system-wide event)
+    int kind;                             // Kind of the slice starting (TRACE_EVENT_BEGIN)
+    int task_no;                          // Task of the job (job events, TRACE_EVENT_BEGIN of a job slice)
+    int job_no;                           // Job number of the job (job events, TRACE_EVENT_BEGIN of a job slice)
+    int job_criticality;                  // Criticality level of the job
+    int period;                           // Period of the job's task (job numbers after a fast-forward)
+    double real_deadline;                 // Absolute deadline of the job
+    double virtual_deadline;              // Absolute virtual deadline of the job
+    int wcet_budget[MAX_LEVELS];          // Remaining wcet budgets of the job at each criticality level (TRACE_EVENT_RELEASE)
+    int value;                            // Level (mode change/de-escalation), overhead, sleep state, threshold criticality, npr length, super-hyperperiods
+    double wakeup_time;                   // Wakeup time of the core (TRACE_EVENT_SHUTDOWN)
+    double min_sleep;                     // Entry + exit latency of the sleep state (TRACE_EVENT_SHUTDOWN)
+    double break_even;                    // Break-even time of the sleep state (TRACE_EVENT_SHUTDOWN)
+    double shift;                         // Time shift of a fast-forward (TRACE_EVENT_FAST_FORWARD)
+    const char *name;                     // Sleep state name (TRACE_EVENT_BEGIN of a sleep slice, not read back from trace files)
+} Trace_event;
+
+// Slice open on a core track: consecutive decision point intervals with the same core state are merged into one slice
+typedef struct {
+    int kind;                             // TRACE_SLICE_NONE/IDLE/JOB/SLEEP
+    int task_no;                          // Task of the executing job (TRACE_SLICE_JOB)
+    int job_no;                           // Job number of the executing job (TRACE_SLICE_JOB)
+    int sleep_state;                      // Sleep state of the core (TRACE_SLICE_SLEEP)
+} Trace_slice;
+
+// ---------------------------------------
+// SCHEDULE VERIFIER STRUCTURE DEFINITIONS
+// ---------------------------------------
+
+// Checks of the schedule verifier
+#define VERIFY_EDF 0                      // The executing job has the earliest scheduling deadline on its core (beyond a non-preemptive region), no ACTIVE core idles with ready jobs
+#define VERIFY_DEADLINE 1                 // No job at/above the current criticality level misses its deadline
+#define VERIFY_BUDGET 2                   // No job executes beyond its wcet budget at the current criticality level
+#define VERIFY_SLEEP 3                    // Sleep states are entered for at least their break-even time and left after their entry and exit latencies, SHUTDOWN cores execute nothing
+#define VERIFY_STREAM 4                   // The event stream is consistent (time order, executed jobs released on their core)
+#define VERIFY_NUM_CHECKS 5               // Number of checks
+
+#define VERIFY_TOLERANCE 1e-6             // Tolerance of the time comparisons (rounding residues of the execution times)
+#define VERIFY_MAX_REPORTS 10             // Number of violations printed in detail (all of them are counted)
+#define VERIFY_LINE_LENGTH 4096           // Maximum length of a trace file line
+
+// Live job tracked by the verifier (released on a core and not yet completed/aborted/discarded/migrated)
+typedef struct _verify_job {
+    int task_no;                          // Task of the job
+    int job_no;                           // Job number
+    int job_criticality;                  // Criticality level of the job
+    int period;                           // Period of the job's task
+    double real_deadline;                 // Absolute deadline
+    double virtual_deadline;              // Absolute virtual deadline
+    double budget[MAX_LEVELS];            // Remaining wcet budget at each criticality level (decreased by the verified execution)
+    int reported;                         // Checks already reported as violated by the job (bit per check: one report per job)
+    struct _verify_job *next;             // Next live job of the core
+} Verify_job;
+
+// Core state tracked by the verifier
+typedef struct {
+    int threshold_criticality;            // EDF-VD threshold criticality (virtual deadlines up to this level)
+    int kind;                             // Kind of the slice open on the core track (TRACE_SLICE_*)
+    Verify_job *running;                  // Job executing on the core (NULL if none)
+    Verify_job *jobs;                     // Live jobs of the core (memory proportional to the live jobs)
+    double account_time;                  // Time up to which the execution of the running job is accounted
+    double inversion_start;               // Start of the current priority inversion (NA if none)
+    int inversion_reported;               // Set once the current priority inversion is reported
+    int asleep;                           // Set while the core is SHUTDOWN
+    double sleep_start;                   // Time at which the core entered its sleep state
+    double min_sleep;                     // Entry + exit latency of its sleep state
+    int dirty;                            // Set if the core state changed at the current time (checked once time advances)
+} Verify_core;
+
+// One-pass schedule verifier: consumes the schedule event stream (live or from a trace file) with memory proportional to the live jobs
+typedef struct {
+    Verify_core core[MAX_CORES];          // Core states (index: core number - 1)
+    int num_cores;                        // Number of cores
+    int npr_length;                       // Length of the non-preemptive regions (priority inversions allowed up to it)
+    int current_level;                    // Current criticality level of the system
+    double time;                          // Time of the last event
+    long long events;                     // Number of events checked
+    long long jobs;                       // Number of jobs released
+    int live_jobs;                        // Number of live jobs
+    int max_live_jobs;                    // Maximum number of live jobs
+    int violations[VERIFY_NUM_CHECKS];    // Number of violations of each check
+} Verifier;
+
+// Streaming writer of the schedule in the Chrome trace event format (JSON, also opened by Perfetto): one track per core
+// Events are formatted into a buffer that is written to the file only when full, so tracing costs little simulation time
+// The same event stream is checked by the schedule verifier (if enabled); the writer then exists without a trace file
+typedef struct {
+    int fd;                               // Trace file descriptor (-1 if the events are not written)
+    int length;                           // Number of buffered bytes
+    int num_events;                       // Number of events written (separators)
+    int failed;                           // Set once a write to the trace file fails (no further output)
+    int finished;                         // Set once the event stream is complete (end of the simulation)
+    Trace_slice slice[MAX_CORES];         // Slice open on each core track
+    Verifier *verifier;                   // Schedule verifier checking the events (NULL if the schedule is not verified)
+    char buffer[TRACE_BUFFER_SIZE];       // Output buffer
+} Trace_writer;
+
+// Runtime task change (online admission control)
+typedef struct {
+    int type;                             // TASK_CHANGE_ADD/TASK_CHANGE_REMOVE/TASK_CHANGE_MODIFY
+    Tasks task;                           // New task parameters (TASK_CHANGE_REMOVE: task number only), phase: release offset after the change
+    int wcet[MAX_LEVELS];                 // Wcets of the new task parameters (the task's wcet pointer is set when the change is applied)
+} Task_change;
+
+// Simulation context: all the state of one simulation (taskset, allocation, runtime scheduler)
+// Simulation contexts share no state, so any number of them can be run in one process/on different threads
+typedef struct {
+
+    // Configuration
+    Sim_config config;                    // Simulation configuration
+
+    // Taskset
+    Taskset taskset;                      // Taskset owned by the context
+    Tasks *tasks_arr;                     // Task structure array (= taskset.tasks_arr)
+    int num_tasks;                        // Number of tasks in the taskset
+    int max_criticality;                  // Maximum criticality level defined for the taskset
+
+    // Allocation
+    Cores core[MAX_CORES];                // Core structure array
+    int num_cores;                        // Number of cores required for allocation (0 if not allocated)
+    int hyperperiod;                      // Super-hyperperiod of the taskset
+    Split_task split[MAX_SPLIT_TASKS];    // Tasks split across cores (semi-partitioned allocation)
+    int num_splits;                       // Number of split tasks
+
+    // Runtime scheduler
+    int scheduler_initialized;            // Set once the runtime scheduler data structures are created
+    int current_level;                    // Current criticality level of the system
+    double timecount;                     // Current decision point
+    Discarded_queue dhead[MAX_LEVELS];    // GLOBAL discarded queues (per criticality level)
+    double domain_sleep_time[MAX_CORES];  // Sleep time of each power domain (all its cores SHUTDOWN)
+    double end_time;                      // End of the simulation (num_hyperperiods super-hyperperiods)
+
+    // Steady-state detection
+    Steady_state_record steady_state[STEADY_STATE_HISTORY];    // States recorded at the super-hyperperiod boundaries
+    int num_steady_states;                // Number of recorded states
+    int steady_state_found;               // Set once the simulation has been fast-forwarded (no further detection)
+
+    // Online admission control
+    Task_change task_change[MAX_TASK_CHANGES];    // Runtime task changes pending (applied in order at the decision points)
+    int num_task_changes;                 // Number of pending task changes
+    Core_load core_load[MAX_CORES];       // Utilization sums of the cores (built at the first task change, then updated incrementally)
+    int core_loads_valid;                 // Set once the core loads are built
+
+    // Schedule trace
+    Trace_writer *trace;                  // Schedule event stream writer (NULL if the schedule is neither traced nor verified)
+
+    // Statistics
+    Sim_stats stats;                      // Simulation statistics
+} Sim_context;
+
+// ----------------------------------------
+// REAL-TIME EXECUTOR STRUCTURE DEFINITIONS
+// ----------------------------------------
+
+// Executor configuration
+typedef struct {
+    long long time_unit_ns;               // Length of one time unit of the taskset on the real clock (ns)
+    double duration;                      // Length of the run in time units (<= 0: one super-hyperperiod)
+    int first_cpu;                        // Worker of the i-th allocated core is pinned to CPU (first_cpu + i) mod number of online CPUs
+    int rt_priority;                      // SCHED_FIFO priority of the worker threads
+    void (*payload) (void *arg);          // Busy-work payload, called repeatedly until the job's execution time is consumed (NULL: default spin loop)
+    void *payload_arg;                    // Argument passed to the payload
+} Exec_config;
+
+// Measurements of one core (worker thread) of the executor, all times in ns
+typedef struct {
+    int cpu;                              // CPU the worker is pinned to (-1 if the affinity could not be set)
+    int realtime;                         // Set if the worker runs with SCHED_FIFO
+    int jobs_released;                    // Number of jobs released
+    int jobs_completed;                   // Number of jobs completed
+    int deadline_misses;                  // Number of jobs completed after/still pending at their original deadline
+    int jobs_discarded;                   // Number of jobs discarded (criticality below the accepted level of the core)
+    int jobs_aborted;                     // Number of jobs aborted on exhausting their budget at their own criticality level
+    int preemptions;                      // Number of preemptions
+    int decisions;                        // Number of scheduling decisions
+    long long max_release_jitter;         // Maximum delay between the nominal release of a job and its release by the worker
+    long long total_release_jitter;       // Sum of the release delays (for the average)
+    long long max_response_time;          // Maximum response time (completion - nominal release)
+    long long total_response_time;        // Sum of the response times of the completed jobs (for the average)
+    long long max_decision_overhead;      // Maximum time spent in one scheduling decision
+    long long total_decision_overhead;    // Sum of the scheduling decision times (for the average)
+} Exec_core_stats;
+
+// Executor measurements
+typedef struct {
+    int num_cores;                        // Number of cores (worker threads)
+    int mode_changes;                     // Number of criticality level changes
+    int final_level;                      // Criticality level of the system at the end of the run
+    Exec_core_stats core[MAX_CORES];      // Per-core measurements
+} Exec_stats;
+
+// Task state of an executor worker
+typedef struct {
+    Tasks *task;                          // Task allocated to the worker's core
+    Jobs job;                             // Current job of the task (valid while active)
+    int active;                           // Set while the current job is released and neither complete, aborted nor discarded
+    long long release;                    // Nominal release time of the current job (ns since the start)
+    long long next_release;               // Nominal release time of the next job (ns since the start)
+    long long demand;                     // Actual execution time of the current job (ns of CPU time)
+    long long consumed;                   // CPU time consumed by the current job (ns)
+} Exec_task;
+
+// State shared by all the worker threads of one run
+typedef struct {
+    Sim_context *ctx;                     // Simulation context (taskset + allocation)
+    Exec_config *config;                  // Executor configuration
+    long long start_time;                 // Common start time of all the workers (CLOCK_MONOTONIC, ns)
+    long long end_time;                   // End of the run (ns since the start)
+    int current_level;                    // Criticality level of the system (updated atomically by the workers)
+    int mode_changes;                     // Number of criticality level changes (updated atomically)
+} Exec_shared;
+
+// Executor worker: runs the jobs of one allocated core with EDF-VD
+typedef struct {
+    Exec_shared *shared;                  // State shared with the other workers
+    Cores *core;                          // Allocated core
+    int core_idx;                         // Index of the core in the core structure array
+    int level;                            // Criticality level last seen by this worker
+    Exec_task task[MAX_TASKS];            // Tasks allocated to the core
+    int num_tasks;                        // Number of tasks allocated to the core
+    Exec_core_stats stats;                // Measurements of this core
+} Exec_worker;
+
+// ------------------------------------------
+// ALLOCATION OPTIMIZER STRUCTURE DEFINITIONS
+// ------------------------------------------
+
+// Thread pool task
+typedef struct {
+    void (*function) (void *arg);         // Function executed by a pool worker
+    void *arg;                            // Argument of the function
+} Pool_task;
+
+// Thread pool (defined in threadpool.c)
+typedef struct _thread_pool Thread_pool;
+
+// Allocation optimizer chain (simulated annealing from the greedy allocation)
+typedef struct {
+    Tasks *tasks_arr;                     // Task structure array (read only)
+    int num_tasks;                        // Number of tasks
+    int max_criticality;                  // Maximum criticality level defined for the taskset
+    int num_cores;                        // Number of cores the tasks can be moved between (cores of the greedy allocation)
+    int chain_no;                         // Chain number (selects the chain's random number stream)
+    unsigned long long seed;              // Seed of the random number streams
+    int iterations;                       // Number of iterations
+    long long end_time;                   // CLOCK_MONOTONIC time (ns) at which the chain stops (0: no limit)
+    int *initial_core;                    // Core index of each task in the greedy allocation (shared, read only)
+    int *core_of;                         // Core index of each task in the current allocation of the chain
+    int *best_core;                       // Core index of each task in the best allocation found by the chain
+    double best_cost;                     // Cost of the best allocation found by the chain
+    int accepted;                         // Number of accepted moves
+} Optimizer_chain;
+
+// Allocation portfolio entry: one heuristic run on private copies of the task and core state
+typedef struct {
+    Sim_config config;                    // Configuration of the run (heuristic, low period task allocation; no output)
+    Tasks *tasks_arr;                     // Private copy of the task structure array (the wcet arrays are shared, read only)
+    int num_tasks;                        // Number of tasks
+    int min_cores;                        // Minimum number of cores required as per the MCS feasibility condition
+    int max_criticality;                  // Maximum criticality level defined for the taskset
+    int semi_partitioned;                 // Set to allow split tasks
+    Cores core[MAX_CORES];                // Private core structures
+    Split_task split[MAX_SPLIT_TASKS];    // Private split tasks
+    int num_splits;                       // Number of split tasks
+    int num_cores;                        // Number of cores required (<= 0 if the allocation failed)
+    int shutdownable_cores;               // Number of SHUTDOWNABLE cores
+    double energy;                        // Predicted power of the allocation (sum over the cores)
+} Portfolio_entry;
+
+// ---------------------------------------
+// SCHEDULING SERVER STRUCTURE DEFINITIONS
+// ---------------------------------------
+
+// The protocol is a compact binary one between processes on the same host: every field is in the host's native byte order and layout
+// Each request/response is a header followed by length bytes of payload (the request type is echoed in the response header)
+typedef struct {
+    int magic;                            // SERVER_MAGIC
+    int type;                             // Request type (SERVER_REQUEST_*)
+    int status;                           // Response status (SERVER_OK or SERVER_ERROR_*, 0 in requests)
+    int length;                           // Number of payload bytes following the header
+} Server_header;
+
+// Taskset header of a load request (followed by num_tasks task records, numbered 1 to num_tasks in the order sent)
+typedef struct {
+    int num_tasks;                        // Number of tasks in the taskset
+    int max_criticality;                  // Maximum criticality level defined for the taskset
+} Server_taskset;
+
+// Task record of the served taskset (same parameters as a task in the input file)
+typedef struct {
+    int phase;                            // Task phase - release time
+    int period;                           // Task period
+    int deadline;                         // Relative deadline
+    int criticality;                      // Criticality level of the task
+    int wcet[MAX_LEVELS];                 // Wcet at each criticality level up to the task's criticality level
+} Server_task;
+
+// Response to a task added to/removed from the served taskset
+typedef struct {
+    int task_no;                          // Task number of the added/removed task
+    int num_tasks;                        // Number of tasks in the served taskset
+} Server_update;
+
+// Response to an allocation request
+typedef struct {
+    int num_cores;                        // Number of cores required for allocation (0 if the taskset cannot be scheduled)
+    int fits;                             // Set if the taskset can be allocated within the core limit of the request
+    int num_splits;                       // Number of tasks split across cores (semi-partitioned allocation)
+    int hyperperiod;                      // Super-hyperperiod of the taskset
+    int threshold_criticality[MAX_CORES]; // EDF-VD threshold criticality of each core
+    int core_type[MAX_CORES];             // SHUTDOWNABLE/NON_SHUTDOWNABLE type of each core
+    double utilization[MAX_CORES];        // Total utilization of each core
+} Server_allocation;
+
+// Simulation request (the other simulation parameters are those the server was started with)
+typedef struct {
+    unsigned long long seed;              // Seed of the actual execution times
+    int num_hyperperiods;                 // Number of super-hyperperiods simulated (0: the server's setting)
+    int reserved;                         // Unused (0)
+} Server_simulation;
+
+// Response to a simulation request (summary of the simulation statistics; the sleep time is the energy saving measure)
+typedef struct {
+    int num_cores;                        // Number of cores required for allocation
+    int hyperperiod;                      // Super-hyperperiod of the taskset
+    int decision_points;                  // Number of scheduling decision points processed
+    int mode_changes;                     // Number of criticality level changes
+    int deescalations;                    // Number of returns to the lowest criticality level
+    int shutdowns;                        // Number of times a core was SHUTDOWN
+    int preemptions;                      // Number of preemptions (all cores)
+    int migrations;                       // Number of split task jobs migrated to the core of their next portion
+    double timecount;                     // Simulated time
+    double total_idle_time;               // Idle time of all cores
+    double total_sleep_time;              // Sleep (SHUTDOWN) time of all cores
+    double sleep_time[MAX_CORES];         // Sleep (SHUTDOWN) time of each core
+} Server_summary;
+
+// Connected client of the scheduling server (its requests are received without blocking, into the client's own buffer)
+typedef struct {
+    int fd;                               // Connection (-1: free slot)
+    int received;                         // Number of bytes of the current request received so far (header, then payload)
+    Server_header header;                 // Header of the current request
+    unsigned long long payload[(sizeof (Server_taskset) + SERVER_MAX_TASKS * sizeof (Server_task) + 7) / 8];   // Payload of the current request (8-byte aligned)
+} Server_client;
+
+// Scheduling server state: the served taskset is kept as a task table, its allocation and the last simulation summary are kept warm
+// until the taskset changes
+typedef struct {
+    Sim_config config;                    // Configuration of the served contexts (command line options, no terminal output)
+    Server_task task[SERVER_MAX_TASKS];   // Task table of the served taskset (in the order the tasks were loaded/added)
+    int task_no[SERVER_MAX_TASKS];        // Task number of each task in the table
+    int num_tasks;                        // Number of tasks in the table (0: no taskset loaded)
+    int max_criticality;                  // Maximum criticality level defined for the served taskset
+    int next_task_no;                     // Task number of the next added task
+    Sim_context *allocated;               // Allocated context of the served taskset (never simulated, cloned by the simulations)
+    int allocation_valid;                 // Set once the served taskset is allocated (cleared when the taskset changes)
+    Server_summary summary;               // Summary of the last simulation of the served taskset
+    Server_simulation summary_request;    // Request the summary was simulated for
+    int summary_valid;                    // Set if the summary is that of the served taskset
+    int listen_fd;                        // Server socket
+    Server_client client[SERVER_MAX_CLIENTS];    // Connected clients
+    int running;                          // Cleared by a stop request
+    void *payload;                        // Payload of the request being served (in the buffer of its client)
+} Server_state;
+
+// Print scheduler output only if enabled in the simulation configuration
+#define SCHED_PRINT(ctx, ...) do { if ((ctx)->config.verbose) printf (__VA_ARGS__); } while (0)
+
 // =====================
 // FUNCTION DECLARATIONS
 // =====================
@@ -182,21 +1021,70 @@ typedef struct {
 // READ INPUT
 // -----------
 
-// Fetch input task parameters from the given file, store parameters in the task structure array
-void fetch_task_parameters (FILE* fptr, Tasks *tasks_arr, int num_tasks, int max_criticality);            
+// Open the given input file and map its contents into memory (read-only) for zero-copy parsing
+int open_taskset_file (Taskset_file *file, const char *path);
+
+// Unmap and close the input file
+void close_taskset_file (Taskset_file *file);
+
+// Skip whitespace and comment lines (starting with '#') up to the next token
+int skip_to_next_token (Taskset_file *file);
+
+// Scan the next (signed) integer from the mapped file
+int scan_int (Taskset_file *file, int *value);
+
+// Parse the next taskset from the file, storing task parameters in the task structure array (wcets in one contiguous arena)
+int parse_next_taskset (Taskset_file *file, Taskset *taskset);
+
+// Free the task structure array and wcet arena of a parsed taskset
+void free_taskset (Taskset *taskset);
+
+// Copy a taskset (task structure array and wcet arena), returns -1 if out of memory
+int copy_taskset (Taskset *dest, Taskset *src);
+
+// -----------------------------------------
+// PREPROCESSED TASKSET SNAPSHOT (READ/WRITE)
+// -----------------------------------------
+
+// Compute FNV-1a checksum of the given byte range of the input file, and count the number of lines in it
+unsigned long long get_source_checksum (Taskset_file *file, size_t start, size_t end, int *line_count);
+
+// Fill a snapshot header with the format constants and compile-time system constraints
+void initialize_snapshot_header (Snapshot_header *header);
+
+// Write the preprocessed taskset (after sorting and allocation) to a snapshot file
+int write_snapshot (const char *path, Taskset_file *file, Taskset *taskset, Cores *core, int num_cores, int hyperperiod);
+
+// Check the task and core records of a snapshot (parser value checks, EDF-VD parameters, task lists of the cores), returns 1 if all records are valid
+int check_snapshot_records (Snapshot_header *header, Snapshot_task *task_record, Snapshot_core *core_record);
+
+// Load the preprocessed taskset for the taskset starting at the current input file cursor from a snapshot file (by mmap)
+int load_snapshot (const char *path, Taskset_file *file, Taskset *taskset, Cores *core, int *num_cores, int *hyperperiod);
+
+// ------------------------------------------------------------------------------------------------------------------------------
+// TASK PREPROCESSING: DERIVED TASK FIELDS AND STABLE SORT IN DECREASING ORDER OF CRITICALITY LEVELS AND OWN LEVEL UTILIZATIONS
+// ------------------------------------------------------------------------------------------------------------------------------
+
+// Compute the derived task fields (LPD condition, utilization at the task's own criticality level) from the task parameters
+void derive_task_fields (Tasks *tasks_arr, int num_tasks);
 
-// -------------------------------------------------------------------------------------------------------------------------
-// QUICK SORT TASKS IN DECREASING ORDER OF THEIR CRITICALITY LEVELS AND UTILIZATIONS (at highest level defined for the task)
-// -------------------------------------------------------------------------------------------------------------------------
+// Packed radix sort key of a task (increasing key order = decreasing own level utilization)
+unsigned long long get_task_sort_key (Tasks *task);
 
-// Helper function to swap to elements
-void swap (Tasks* A, Tasks* B);        
+// Check if task A is placed before task B in the sorted order (greater criticality, or same criticality and greater utilization)
+int task_precedes (Tasks *A, Tasks *B);
 
-// Partitioning function for sorting task array in decreasing order of their criticalities and utilizations                                
-int partition_array (Tasks *task_ptr, int low, int high);    
+// Stable insertion sort of the task array (small tasksets)
+void insertion_sort_tasks (Tasks *tasks_arr, int num_tasks);
 
-// Quick sort driver function: sorts array in decreasing order of task criticality and utilization
-void quick_sort (Tasks *task_ptr, int low, int high);                             
+// Stable LSD radix sort of the task array on the packed utilization key and the criticality level (returns -1 if no buffer could be allocated)
+int radix_sort_tasks (Tasks *tasks_arr, int num_tasks);
+
+// Stable sort of the task array in decreasing order of task criticality and utilization
+void sort_tasks (Tasks *tasks_arr, int num_tasks);
+
+// Preprocess the task array before the allocation: derive the task fields and sort the tasks
+void preprocess_tasks (Tasks *tasks_arr, int num_tasks);
 
 // --------------------------------------------------------------------------------------------------------------------
 // GET TASK UTILIZATIONS INFO FOR GIVEN TASK SET, DETERMINE HI, LO UTILIZATIONS FOR (I) LOW PERIOD TASKS (II) ALL TASKS
@@ -211,7 +1099,17 @@ void get_taskset_info (Tasks *tasks_arr, int num_tasks, Taskset_info* tasks_info
 
 // Determine the minimum number of cores required for allocation as per MC Feasibility condition 
 // (i.e. Total utilization of all tasks at any given level < 1)
-int get_min_cores_reqd (Tasks *tasks_arr, int num_tasks, int max_criticality);
+int get_min_cores_reqd (Tasks *tasks_arr, int num_tasks, int max_criticality, int verbose);
+
+// ----------------------------------------------------------
+// SCHEDULING OVERHEADS (PREEMPTIONS, NON-PREEMPTIVE REGIONS)
+// ----------------------------------------------------------
+
+// Worst-case overhead accounted to every job by the schedulability analysis (preemption overhead + non-preemptive region length)
+int get_job_overhead (Sim_config *config);
+
+// Account the worst-case overhead of every job in the task utilizations (schedulability tests, allocation)
+void add_scheduling_overheads (Tasks *tasks_arr, int num_tasks, int max_criticality, int overhead);
 
 // --------------------------------------
 // EDF-VD OFFLINE PREPROCESSING FUNCTIONS
@@ -223,9 +1121,21 @@ double calculate_utilization_ulk (Tasks *tasks_arr, int num_tasks, int lower_lim
 // Compute total utilization of tasks when executed at their own criticality levels
 double calculate_utilization_ull (Tasks *tasks_arr, int num_tasks, int lower_limit, int upper_limit, int core_no, int new_task_no);
 
-// Check if the EDF-VD Schedulability condition holds for given core, assuming we add the new task to it 
+// EDF-VD schedulability test for the given core, assuming we add the new task to it (side-effect free), returns the threshold criticality and x
+int edfvd_schedulability_probe (Tasks* tasks_arr, int num_tasks, int max_criticality, int core_no, int new_task_no, double *x);
+
+// Set the virtual deadlines of the tasks of the given core and the new task for the given threshold criticality and deadline shortening factor
+void set_virtual_deadlines (Tasks *tasks_arr, int num_tasks, int core_no, int new_task_no, int threshold_criticality, double x);
+
+// Check if the EDF-VD Schedulability condition holds for given core, assuming we add the new task to it (virtual deadlines updated if it holds)
 int edfvd_schedulability_check (Tasks* tasks_arr, int num_tasks, int max_criticality, int core_no, int new_task_no);
 
+// Evaluate all open cores as candidates for the given task in one batch (side-effect free)
+void probe_candidate_cores (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality, Core_probe *probe);
+
+// Commit the probe result of the core selected for the given task (threshold criticality, virtual deadlines)
+void commit_core_probe (Cores *core, Tasks *tasks_arr, int num_tasks, int core_idx, int task_idx, Core_probe *probe, int max_criticality);
+
 // ---------------------------------
 // OFFLINE TASK ALLOCATION FUNCTIONS
 // ---------------------------------
@@ -242,12 +1152,124 @@ int get_worst_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int nu
 // Find the first-fitting core (i.e. first core with remaining capacity > task utilization) that can accommodate the given task
 int get_first_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality);
 
+// Find the best-fitting core (i.e. with minimum remaining capacity after accommodating the task) that can accommodate the given task
+int get_best_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality);
+
+// Find the first core that can accommodate the given task, preferring the cores that already host tasks of the same criticality level
+int get_criticality_first_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality);
+
+// Find the core for the given task with the allocation heuristic (HEURISTIC_*)
+int get_fit_core_idx (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality, int heuristic, int wfd_threshold_crit);
+
 // Allocate the given task to the core with index obtained from the allocation algorithm 
 // Update task and core structure parameters accordingly
 void allocate_task_to_core (Cores *core, Tasks *tasks_arr, int core_idx, int task_idx);
 
-// Offline task allocation driver code
-int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int min_cores, int max_criticality);
+// Deallocate the given task from its core (inverse of allocate_task_to_core)
+void deallocate_task_from_core (Cores *core, Tasks *tasks_arr, int core_idx, int task_idx);
+
+// Offline task allocation driver code (split tasks are only created if split_arr is not NULL)
+int offline_task_allocator (Cores *core, Tasks *tasks_arr, int num_tasks, int min_cores, int max_criticality, Split_task *split_arr, int *num_splits, Sim_config *config);
+
+// --------------------------------------------
+// SEMI-PARTITIONED ALLOCATION (TASK SPLITTING)
+// --------------------------------------------
+
+// Get the EDF demand parameters of the tasks and split task portions allocated to a core (worst-case reservations)
+int get_core_demand_tasks (Demand_task *demand, Cores *core, Tasks *tasks_arr, int num_tasks, Split_task *split_arr, int num_splits, int job_overhead, int migration_overhead);
+
+// EDF processor demand criterion (dbf(t) <= t at every absolute deadline in the checking interval), returns 1 if schedulable
+int check_processor_demand (Demand_task *demand, int count);
+
+// Find the largest budget of a zero laxity (window = budget + reserved overhead) portion that keeps the core EDF schedulable
+int get_max_portion_budget (Demand_task *demand, int count, int period, int max_budget, int reserve);
+
+// Split a task that fits no open core into portions across the open cores, returns 0 if the task was split, -1 otherwise
+int split_task_across_cores (Cores *core, int num_cores, Tasks *tasks_arr, int num_tasks, int task_idx, int max_criticality, Split_task *split_arr, int *num_splits, Sim_config *config);
+
+// Helper function to print the portions of the split tasks
+void print_split_tasks (Tasks *tasks_arr, Split_task *split_arr, int num_splits);
+
+// -----------------------------------------
+// THREAD POOL (PARALLEL OFFLINE PROCESSING)
+// -----------------------------------------
+
+// Get the number of online CPUs (at least 1)
+int get_num_online_cpus ();
+
+// Thread pool worker: executes queued tasks until the pool shuts down
+void *run_pool_worker (void *arg);
+
+// Create a thread pool with the given number of worker threads (<= 0: one per online CPU)
+Thread_pool *create_thread_pool (int num_threads);
+
+// Get the number of worker threads of the pool
+int get_pool_size (Thread_pool *pool);
+
+// Submit a task to the pool
+int submit_pool_task (Thread_pool *pool, void (*function) (void *arg), void *arg);
+
+// Wait until all the submitted tasks are complete
+void wait_thread_pool (Thread_pool *pool);
+
+// Destroy the thread pool (the queued tasks are completed first)
+void destroy_thread_pool (Thread_pool *pool);
+
+// -------------------------------------------------------
+// LOCAL SEARCH ALLOCATION OPTIMIZER (SIMULATED ANNEALING)
+// -------------------------------------------------------
+
+// Check if a task is a low period (LPD) task
+int is_lpd_task (Tasks *task);
+
+// Add (sign = 1) or remove (sign = -1) a task's utilizations to/from a core load
+void add_task_load (Core_load *load, Tasks *task, int sign);
+
+// EDF-VD schedulability test on a core load (side-effect free), returns the threshold criticality or -1
+int get_load_threshold (Core_load *load, int max_criticality, double *x);
+
+// Cost of a core in the allocation objective
+double get_load_cost (Core_load *load);
+
+// Calculate the core loads of an allocation from scratch, returns the total cost (-1 if any core is not schedulable)
+double calculate_core_loads (Core_load *loads, int num_cores, Tasks *tasks_arr, int num_tasks, int max_criticality, int *core_of);
+
+// Run one annealing chain (thread pool task)
+void run_optimizer_chain (void *arg);
+
+// Apply an allocation to the core and task structures, returns the number of cores used
+int apply_allocation (Cores *core, Tasks *tasks_arr, int num_tasks, int max_criticality, int *core_of, int num_cores);
+
+// Improve the greedy allocation with parallel simulated annealing chains, returns the number of cores required
+int optimize_allocation (Cores *core, Tasks *tasks_arr, int num_tasks, int num_cores, int max_criticality, Sim_config *config);
+
+// --------------------------------------------
+// ALLOCATION HEURISTIC PORTFOLIO (SPECULATIVE)
+// --------------------------------------------
+
+// Get the name of an allocation heuristic
+const char *get_heuristic_name (int heuristic);
+
+// Get the allocation heuristic with the given name (as given in the command line), returns -1 if the name is unknown
+int parse_allocation_heuristic (const char *name);
+
+// Get the portfolio objective with the given name (as given in the command line), returns -1 if the name is unknown
+int parse_portfolio_objective (const char *name);
+
+// Check if the configuration selects the default allocation (partitioned, adaptive heuristic, dedicated LPD cores, no portfolio, no optimizer)
+int is_default_allocation (Sim_config *config);
+
+// Predicted power of an allocation (executing, idle NON_SHUTDOWNABLE and SHUTDOWN SHUTDOWNABLE core time)
+double get_predicted_power (Cores *core, int num_cores);
+
+// Run the allocation heuristic of one portfolio entry (thread pool task)
+void run_portfolio_entry (void *arg);
+
+// Check if portfolio entry A is better than entry B by the given objective
+int is_better_portfolio_entry (Portfolio_entry *a, Portfolio_entry *b, int objective);
+
+// Allocate the tasks with every heuristic of the portfolio in parallel and keep the best allocation, returns the number of cores required
+int run_allocation_portfolio (Cores *core, Tasks *tasks_arr, int num_tasks, int min_cores, int max_criticality, Split_task *split_arr, int *num_splits, Sim_config *config);
 
 // -----------------------------
 // SUPER-HYPERPERIOD CALCULATION
@@ -272,6 +1294,77 @@ RQ_NODE *merge (RQ_NODE *first, RQ_NODE *second);
 // Rearrange queue wrt updated job deadlines - (Merge sort driver function)
 RQ_NODE *merge_sort (RQ_NODE *primary_head);
 
+// -------------------------------------------------------
+// DISCARDED QUEUES (BINARY MIN-HEAP ON LATEST START TIME)
+// -------------------------------------------------------
+
+// Restore the heap order by moving the entry at the given index up
+void sift_up_discarded_queue (Discarded_queue *dq, int idx);
+
+// Restore the heap order by moving the entry at the given index down
+void sift_down_discarded_queue (Discarded_queue *dq, int idx);
+
+// Insert a job into the discarded queue; returns the job dropped to make room if the queue is full (else NULL)
+Jobs* insert_discarded_job (Discarded_queue *dq, Jobs *job);
+
+// Remove and return the job with the earliest latest start time from the discarded queue (NULL if empty)
+Jobs* remove_discarded_job (Discarded_queue *dq);
+
+// Remove (and free) all jobs whose latest start time has passed from the top of the discarded queue; returns the number of jobs removed
+int expire_discarded_jobs (Discarded_queue *dq, double current_time);
+
+// Add a job to the discarded queue corresponding to its criticality level
+void discard_job (Sim_context *ctx, Jobs *job);
+
+// Splice all jobs of a ready queue bucket into the discarded queue of the same criticality level in O(1)
+void splice_discarded_jobs (Sim_context *ctx, int level_idx, RQ_HEAD *bucket);
+
+// Add the jobs spliced into the discarded queue to its heap
+void absorb_staged_jobs (Sim_context *ctx, int level_idx);
+
+// Free all jobs in the discarded queue
+void free_discarded_queue (Discarded_queue *dq);
+
+// ---------------------------------------------
+// READY QUEUES (PARTITIONED BY JOB CRITICALITY)
+// ---------------------------------------------
+
+// Create an EMPTY ready queue ordered by the given deadline type
+Ready_queue *create_ready_queue (int deadline_type);
+
+// Get the deadline of a job wrt the given ordering (virtual/real)
+double get_job_deadline (Jobs *job, int deadline_type);
+
+// Insert a node into a ready queue bucket in increasing order of the given deadline type
+void insert_ready_node (RQ_HEAD *bucket, RQ_NODE *node, int deadline_type);
+
+// Unlink a node from a ready queue bucket
+void unlink_ready_node (RQ_HEAD *bucket, RQ_NODE *node);
+
+// Merge two lists of ready queue nodes in increasing order of the given deadline type
+RQ_NODE *merge_ready_nodes (RQ_NODE *first, RQ_NODE *second, int deadline_type);
+
+// Add a job to the ready queue bucket of its criticality level (in both virtual and real deadline order)
+void add_ready_job (Ready_queue *rq, Jobs *job);
+
+// Get the bucket whose head job has the earliest scheduling deadline (NULL if the ready queue is empty)
+RQ_HEAD *get_earliest_bucket (Ready_queue *rq);
+
+// Get the earliest deadline job in the ready queue without removing it (NULL if empty)
+Jobs* peek_ready_job (Ready_queue *rq);
+
+// Remove and return the earliest deadline job from the ready queue (NULL if empty)
+Jobs* remove_ready_job (Ready_queue *rq);
+
+// Switch the ready queue to real deadline order (on mode change)
+void switch_to_real_deadlines (Ready_queue *rq);
+
+// Switch the ready queue back to virtual deadline order (on criticality de-escalation)
+void switch_to_virtual_deadlines (Ready_queue *rq);
+
+// Free a ready queue (all its nodes and the job structures in them)
+void free_ready_queue (Ready_queue *rq);
+
 // -----------------------------------------------------------------------
 // RUN-TIME SCHEDULING FUNCTIONS (SCHEDULING ALGORITHM: partitioned-EDFVD)
 // -----------------------------------------------------------------------
@@ -287,25 +1380,68 @@ double get_next_job_arrival (Tasks *task_ptr, int task_array_idx, double timecou
 
 // Determine the next scheduling decision point = min {next decision points in all cores}
 // Decision points: 1. Arrival 2. Current job termination 3. Criticality level change due to wcet budget overrun at current level 4. Overrun 5. Core Wakeup
-double get_next_decision_point (Cores *core, int num_cores, Tasks *task_ptr, int num_tasks, double timecount, int hyperperiod);
+double get_next_decision_point (Sim_context *ctx, double timecount);
 
 // Run queue is updated by inserting all the ready jobs in the queue while maintaining the EDF order
 void update_run_queue (RQ_HEAD *head, Jobs *j);
 
 // Create job structure and set the parmeter values 
-Jobs *create_job_structure (Tasks *task_arr, int task_array_idx, int threshold_criticality, int core_no, double timecount);
+Jobs *create_job_structure (Sim_context *ctx, int task_array_idx, int threshold_criticality, int core_no, double timecount);
+
+// Add a new job to the core's ready queue (ACTIVE)/pending request queue (SHUTDOWN) or to the discarded queue of its criticality level
+void admit_job (Sim_context *ctx, Cores *core, Jobs *job);
 
 // Add the jobs to run queue if core is ACTIVE; add the job to pending request queue if core is SHUTDOWN
-void add_ready_jobs (Cores *core, RQ_HEAD **dhead, RQ_HEAD *prhead, Tasks *task_arr, int num_tasks, double timecount);
+void add_ready_jobs (Sim_context *ctx, Cores *core, double timecount);
+
+// Determine the next release time of a split task portion (released offset time units after each job arrival)
+double get_next_portion_arrival (Tasks *task_arr, int task_array_idx, int offset, double timecount);
+
+// Get the earliest release of a zero-laxity split task portion (whose window equals its budget) on the core after the current time
+double get_next_zero_laxity_release (Sim_context *ctx, Cores *core, double timecount);
+
+// Get the earliest absolute deadline among the next jobs (split task portions) to arrive on the core, accepted at the current level
+double get_next_arrival_deadline (Sim_context *ctx, Cores *core, double timecount);
+
+// Set up a split task's job for the execution of the given portion on its core (budget, deadlines, execution time in the portion)
+void start_job_portion (Sim_context *ctx, Split_task *split, Jobs *job, int portion, int threshold_criticality);
+
+// Create the job structure of a split task portion released at the given time (anticipated portion jobs of the slack calculation)
+Jobs *create_portion_job (Sim_context *ctx, Split_task *split, int portion, int threshold_criticality, int core_no, double release_time);
+
+// Release the split task portions of the given core arriving at the current time (new jobs/jobs migrating from their previous portion)
+void release_split_portions (Sim_context *ctx, Cores *core, double timecount);
+
+// Hand over the completed portion of a split task's job executing on the core to its next portion (the core becomes IDLE)
+void migrate_current_job (Sim_context *ctx, Cores *core);
 
 // Schedule next job by removing a job node from head of the run queue, returning the job struct to the runtime scheduler
 Jobs* schedule_next_job (RQ_HEAD *head);
 
+// Release the job currently executing on the core (completed/aborted), the core becomes IDLE
+void release_current_job (Cores *core);
+
+// Charge a scheduling overhead (preemption/migration) to a job executed on the core (its wcet budgets are extended by the same amount)
+void charge_job_overhead (Sim_context *ctx, Cores *core, Jobs *job, int overhead);
+
+// Dispatch the next job on an ACTIVE core (preempting the running job only if a ready job has an earlier scheduling deadline,
+// at the end of its non-preemptive region in limited-preemptive mode)
+void dispatch_next_job (Sim_context *ctx, Cores *core);
+
+// Merge the pending request queue of a core into its run queue on wakeup (single pass merge of the EDF ordered queues)
+void merge_pending_requests (Cores *core);
+
 // Delete a particular job structure from the run queue
 void delete_job_from_queue (RQ_HEAD *head, Jobs *job);
 
-// Scan the run queue and discards jobs below acceptable criticality level --> when criticality level/mode is upgraded
-void discard_below_criticality_level (RQ_HEAD *head, RQ_HEAD **dhead, int level);
+// Discard all jobs below acceptable criticality level from the ready queue (by splicing whole buckets) --> when criticality level/mode is upgraded
+void discard_below_criticality_level (Sim_context *ctx, Ready_queue *rq, int level);
+
+// Check if any discarded queue holds jobs (in its heap or staged)
+int has_discarded_jobs (Sim_context *ctx);
+
+// Return to the lowest criticality level at a system-wide idle instant (criticality de-escalation), returns 1 if the level was lowered
+int deescalate_at_idle_instant (Sim_context *ctx);
 
 // Get task array index corresponding to the task number specified
 int get_task_array_index (Tasks *task_arr, int num_tasks, int task_no);
@@ -313,36 +1449,479 @@ int get_task_array_index (Tasks *task_arr, int num_tasks, int task_no);
 // Update job deadlines (wrt which we are ordering the run queue) - reset to original deadlines on mode change
 void update_sched_deadlines (RQ_HEAD *head, Tasks *task_arr, int num_tasks);
 
+// Parse a sleep state table "name:entry_latency:exit_latency:break_even,..." (shallowest state first), returns the number of states or -1
+int parse_sleep_states (const char *spec, Sleep_state *states);
+
+// Install the default sleep state (break-even SHUTDOWN_THRESHOLD, no latencies) for the core types without a sleep state table
+void initialize_sleep_states (Sim_config *config);
+
+// Get the procrastination interval of a core (minimum slack over the criticality levels >= current level, up to the next zero-laxity portion release)
+double get_procrastination_interval (Sim_context *ctx, int core_idx, double horizon, double timecount);
+
+// Select the deepest sleep state of the core type whose break-even time fits in the idle interval, returns -1 if none fits
+int select_sleep_state (Sim_config *config, int core_type, double interval);
+
+// SHUTDOWN the core in the given sleep state, the core executes again from the wakeup time
+void shutdown_core (Sim_context *ctx, Cores *core, int state, double wakeup_time);
+
+// Wake up a SHUTDOWN core as early as possible (once its sleep state is entered and left), returns 1 if the core is ACTIVE at once
+int wake_up_core_early (Sim_context *ctx, Cores *core, double timecount);
+
+// Get the power domain of a core (consecutive cores share a power domain)
+int get_power_domain (Sim_context *ctx, int core_idx);
+
+// Check if all the other cores of the core's power domain are SHUTDOWN
+int is_power_domain_asleep (Sim_context *ctx, int core_idx);
+
+// SHUTDOWN a core with work along with the rest of its power domain by procrastinating its jobs, returns 1 if the core was SHUTDOWN
+int procrastinate_to_power_domain (Sim_context *ctx, int core_idx, double timecount);
+
+// Add the interval to the sleep time of the power domains whose cores are all SHUTDOWN
+void update_power_domain_sleep (Sim_context *ctx, double interval);
+
+
+// Initialize runtime scheduler data structures and the first decision point
+void initialize_scheduler (Sim_context *ctx);
+
+// Execute the scheduler at the current decision point and advance timecount to the next decision point
+int scheduler_step (Sim_context *ctx);
+
 // Runtime scheduler driver code
-void run_scheduler_loop (Cores *core, int num_cores, Tasks *task_arr, int num_tasks, int hyperperiod, int max_criticality);
+void run_scheduler_loop (Sim_context *ctx);
+
+// Release all runtime scheduler data structures
+void free_scheduler (Sim_context *ctx);
 
 // ---------------------------
 // SLACK CALCULATION FUNCTIONS
 // ---------------------------
 
-// Copies all non-DISCARDED jobs present in the run queue to a dummy queue
-void copy_jobs_to_dummy_queue (RQ_HEAD *head, RQ_HEAD *dummy_head, int threshold_criticality, int level);
+// Copies all non-DISCARDED jobs present in the run queue (and the currently executing job) to a dummy queue (all of them at the current level)
+void copy_jobs_to_dummy_queue (Ready_queue *rq, Jobs *curr_exe_job, RQ_HEAD *dummy_head, int threshold_criticality, int level, int current_level);
 
 // Anticipates jobs arriving before the specified max_arrival_time and adds them to the dummy queue in EDF order
-void add_anticipated_arrivals (RQ_HEAD *dummy_head, double max_arrival_time, Tasks *task_ptr, int num_tasks, int threshold_criticality, int level, int core_no, int timecount);
+void add_anticipated_arrivals (Sim_context *ctx, RQ_HEAD *dummy_head, double max_arrival_time, int threshold_criticality, int level, int core_no, double timecount);
+
+// Delete the tail node of the dummy queue
+void delete_tail_node (RQ_HEAD *dummy_head, RQ_NODE *tail);
+
+// Free a dummy queue (its nodes and anticipated jobs, not the jobs copied from the ready queue)
+void free_dummy_queue (RQ_HEAD *dummy_head);
 
 // Slack calculation (using Dynamic Procrastination): 
 // Slack = (latest time by which run queue jobs must start executing in order to guarantee completion by deadline) - (window time consumed by the anticipated jobs)
-double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, double max_deadline, int timecount, int level);
+double calculate_slack_available (RQ_HEAD *dummy_head, double latest_arrival, double max_deadline, double timecount, int level, int job_overhead);
 
 // --------------------------------
 // DYNAMIC PROCRASTINATION FUNCTION
 // --------------------------------
 
 // Calculates the maximum available slack for given core to find its maximum SHUTDOWN interval
-void get_dynamic_procrastination_slack (Cores *core, int core_idx, Tasks *task_arr, int num_tasks, double next_job_deadline, int max_criticality, int current_level, int hyperperiod, double current_time);
+void get_dynamic_procrastination_slack (Sim_context *ctx, int core_idx, double next_job_deadline, double current_time);
+
+// Get the latest time up to which the slack calculations anticipate job arrivals (one super-hyperperiod ahead, at most the end of the simulation)
+double get_anticipation_horizon (Sim_context *ctx, double current_time);
 
 // -----------------------
 // DISCARDED JOB SCHEDULER 
 // -----------------------
 
+// Invalidate all cached slack values of a core
+void invalidate_slack_cache (Slack_cache *cache);
+
+// Look up the cached slack values for the given level and horizon (returns NULL on a cache miss)
+Slack_cache_entry* lookup_slack_cache (Slack_cache *cache, int level, double horizon);
+
+// Cache the slack values calculated for the given level and horizon
+void insert_slack_cache (Slack_cache *cache, int level, double horizon, double slack_available, double optimal_slack, double expected_completion_time);
+
 // Schedules discarded job if enough slack is available for it to execute
-void schedule_discarded_job (RQ_HEAD *head, RQ_HEAD **dhead, Tasks *task_ptr, int num_tasks, int threshold_criticality, int max_criticality, int current_level, int core_no, int hyperperiod, double timecount);
+void schedule_discarded_job (Sim_context *ctx, int core_idx, double timecount);
+
+// --------------------------------------------------------
+// COUNTER-BASED RANDOM NUMBER GENERATION (NO HIDDEN STATE)
+// --------------------------------------------------------
+
+// SplitMix64 finalizer (bijective 64-bit mixing function)
+unsigned long long mix64 (unsigned long long x);
+
+// Get 64 random bits for the given (seed, task number, job number, counter)
+unsigned long long get_random_bits (unsigned long long seed, int task_no, int job_no, unsigned int counter);
+
+// Get a uniformly distributed random number in [0, 1) for the given (seed, task number, job number, counter)
+double get_random_uniform (unsigned long long seed, int task_no, int job_no, unsigned int counter);
+
+// Get a uniformly distributed random integer in [low, high]
+int get_random_int (unsigned long long seed, int task_no, int job_no, unsigned int counter, int low, int high);
+
+// -----------------------------------
+// ACTUAL EXECUTION TIME DISTRIBUTIONS
+// -----------------------------------
+
+// Parse the name of an execution time distribution (uniform/normal/bimodal/lo), returns -1 if not recognized
+int parse_exec_distribution (const char *name);
+
+// Generate the actual execution time of a job of the given task (pure function of seed, task number, job number)
+double generate_execution_time (Sim_config *config, Tasks *task, int job_no);
+
+// Check if the execution times of the jobs repeat every super-hyperperiod (deterministic distribution)
+int has_periodic_execution_times (Sim_config *config);
+
+// ---------------------------------------------------------
+// STEADY-STATE DETECTION (FAST-FORWARD ACROSS HYPERPERIODS)
+// ---------------------------------------------------------
+
+// Check if steady-state detection applies to the simulation (enabled, several super-hyperperiods, periodic execution times)
+int is_steady_state_detection_enabled (Sim_context *ctx);
+
+// Mix a value into a scheduling state hash
+unsigned long long hash_value (unsigned long long hash, double value);
+
+// Mix a time (relative to the given base, NA kept apart) into a scheduling state hash
+unsigned long long hash_time (unsigned long long hash, double time, double base);
+
+// Mix a job (times relative to the given base) into a scheduling state hash
+unsigned long long hash_job (unsigned long long hash, Jobs *job, double base);
+
+// Mix the jobs of a run queue (in queue order) into a scheduling state hash
+unsigned long long hash_run_queue (unsigned long long hash, RQ_NODE *node, double base);
+
+// Hash the scheduling state of the context (criticality level, cores, queues, migrating jobs), times relative to the current time
+unsigned long long hash_scheduling_state (Sim_context *ctx);
+
+// Shift the times of a job by the given number of super-hyperperiods
+void shift_job (Sim_context *ctx, Jobs *job, int hyperperiods);
+
+// Shift the times of the jobs of a run queue by the given number of super-hyperperiods
+void shift_run_queue (Sim_context *ctx, RQ_NODE *node, int hyperperiods);
+
+// Shift the scheduling state of the context (all jobs, cores and the current time) by the given number of super-hyperperiods
+void shift_scheduling_state (Sim_context *ctx, int hyperperiods);
+
+// Record the scheduling state hash and the statistics of the context at a super-hyperperiod boundary
+void record_steady_state (Sim_context *ctx, Steady_state_record *record, unsigned long long hash);
+
+// Add the statistics of the given number of repetitions of the cycle starting at the recorded boundary
+void extrapolate_statistics (Sim_context *ctx, Steady_state_record *record, int cycles);
+
+// Detect a steady state at a super-hyperperiod boundary and fast-forward the simulation across its repetitions ending by the given time
+// Returns 1 if the simulation was fast-forwarded
+int fast_forward_steady_state (Sim_context *ctx, double time);
+
+// -----------------------------------------
+// REAL-TIME EXECUTOR (LINUX WORKER THREADS)
+// -----------------------------------------
+
+// Get the current time of the given clock in ns
+long long get_clock_ns (int clock_id);
+
+// Sleep until the given absolute CLOCK_MONOTONIC time (ns)
+void sleep_until (long long time);
+
+// Default busy-work payload of a job
+void busy_work_payload (void *arg);
+
+// Initialize an executor configuration with the default values
+void initialize_executor_config (Exec_config *config, long long time_unit_ns);
+
+// Pin the calling worker thread to its CPU and switch it to SCHED_FIFO
+void setup_worker_thread (Exec_worker *worker);
+
+// Release the jobs of the worker's tasks whose nominal release time has passed
+void release_worker_jobs (Exec_worker *worker, long long now);
+
+// Apply a criticality level change (made by any worker) to the worker's active jobs
+void apply_level_change (Exec_worker *worker);
+
+// Select the earliest (virtual/original) deadline active job of the worker (EDF-VD)
+Exec_task *select_worker_job (Exec_worker *worker);
+
+// Run the selected job until it completes, exhausts its budget or the next release is due
+void run_worker_job (Exec_worker *worker, Exec_task *exec_task, long long next_release);
+
+// Worker thread: executes the jobs of one allocated core till the end of the run
+void *run_executor_worker (void *arg);
+
+// Run the allocated taskset on real cores (one worker thread per allocated core)
+int run_executor (Sim_context *ctx, Exec_config *config, Exec_stats *stats);
+
+// Print the executor measurements
+void print_executor_stats (Exec_stats *stats);
+
+// ----------------------------------------
+// SCHEDULE TRACE WRITER (CHROME TRACE JSON)
+// ----------------------------------------
+
+// Create the schedule event stream writer of an allocated context (no trace file, no verifier), returns NULL if out of memory
+Trace_writer *create_trace_writer (Sim_context *ctx);
+
+// Open the schedule trace file of an allocated context and write the trace header (process and core track names, verifier parameters)
+int open_trace (Sim_context *ctx, const char *path);
+
+// Append formatted text to the trace buffer (writing the buffer to the file when full)
+void trace_printf (Trace_writer *trace, const char *format, ...);
+
+// Start a new trace event (separator, room for TRACE_EVENT_LENGTH bytes in the buffer)
+void trace_begin_event (Trace_writer *trace);
+
+// Write the buffered trace output to the trace file
+void flush_trace (Trace_writer *trace);
+
+// Get the name of a schedule event type (NULL for the slice and metadata events)
+const char *get_trace_event_name (int type);
+
+// Write a schedule event to the trace file in the Chrome trace event format
+void write_trace_event (Trace_writer *trace, Trace_event *event);
+
+// Emit a schedule event: written to the trace file (if open) and checked by the schedule verifier (if enabled)
+void emit_trace_event (Sim_context *ctx, Trace_event *event);
+
+// End the slice open on a core track at the given time
+void trace_close_slice (Sim_context *ctx, int core_idx, double time);
+
+// End the slices open on all core tracks at the given time
+void trace_close_slices (Sim_context *ctx, double time);
+
+// Trace the state of every core from the current decision point to the next one (a slice starts on each core track whose state changed)
+void trace_schedule (Sim_context *ctx, double start, double end);
+
+// Emit a job event (release, completion, abort, discard, migration, overhead) on a core track
+void trace_job_event (Sim_context *ctx, int type, int core_no, Jobs *job, double time, int value);
+
+// Emit a core event (shutdown, wakeup) on the core track
+void trace_core_event (Sim_context *ctx, int type, Cores *core, double time);
+
+// Emit a criticality level event (mode change, de-escalation) with the new current level
+void trace_level_event (Sim_context *ctx, int type, double time);
+
+// Emit a steady-state fast-forward event (all later times are shifted)
+void trace_fast_forward (Sim_context *ctx, int hyperperiods, double shift);
+
+// Emit the new EDF-VD threshold criticality of a core (runtime task change)
+void trace_threshold_event (Sim_context *ctx, Cores *core);
+
+// Trace an informational instant event on a core track (core_no 0: global event), with the job it concerns (NULL if none) and an integer value (value_name NULL if none)
+void trace_instant (Sim_context *ctx, int core_no, const char *name, const char *category, double time, Jobs *job, const char *value_name, int value);
+
+// Trace the slack values at the criticality levels >= current level (slack[i]: slack at level current level + i) as a counter of the core
+void trace_slack (Sim_context *ctx, int core_no, const char *name, double *slack, double time);
+
+// Complete the event stream at the end of the simulation: end the open slices, finish the verification and close the trace file
+void finish_trace (Sim_context *ctx);
+
+// Complete the event stream (if not yet complete) and release the writer and its verifier
+void close_trace (Sim_context *ctx);
+
+// --------------------------------------
+// SCHEDULE VERIFIER (ONE-PASS, STREAMING)
+// --------------------------------------
+
+// Create a schedule verifier (no core, lowest criticality level), returns NULL if out of memory
+Verifier *create_verifier (void);
+
+// Attach a schedule verifier to the event stream of an allocated context (created if needed) and pass it the simulation parameters
+int open_verifier (Sim_context *ctx);
+
+// Record a violation of a check (printed in detail for the first VERIFY_MAX_REPORTS violations)
+void report_violation (Verifier *verifier, int check, double time, const char *format, ...);
+
+// Find a live job of a core (NULL if not live)
+Verify_job *find_verify_job (Verify_core *core, int task_no, int job_no);
+
+// Remove a live job of a core and release it
+void remove_verify_job (Verifier *verifier, Verify_core *core, Verify_job *job);
+
+// Get the scheduling deadline of a live job on its core (virtual deadline up to the core's EDF-VD threshold)
+double get_verify_deadline (Verifier *verifier, Verify_core *core, Verify_job *job);
+
+// Check that a job leaving its core at the given time did not miss its deadline (if at/above the current criticality level)
+void check_verify_deadline (Verifier *verifier, Verify_job *job, double time);
+
+// Charge the execution of the running job of a core up to the given time to its budgets and check its budget at the current criticality level
+void account_verify_execution (Verifier *verifier, int core_idx, double time);
+
+// Check the schedule of a core at the current time (EDF order, priority inversions within the non-preemptive regions, no idling with ready jobs)
+void check_core_schedule (Verifier *verifier, int core_idx);
+
+// Advance the verifier time: check the core schedules at the current time and charge the execution up to the new time
+void advance_verifier (Verifier *verifier, double time);
+
+// Check a schedule event
+void verify_event (Verifier *verifier, Trace_event *event);
+
+// Complete the verification at the end of the simulation (jobs still live after their deadline missed it)
+void finish_verifier (Verifier *verifier);
+
+// Get the total number of violations found by a verifier
+int count_violations (Verifier *verifier);
+
+// Print the verification report
+void print_verifier_report (Verifier *verifier);
+
+// Release a verifier and its live jobs
+void free_verifier (Verifier *verifier);
+
+// Read a numeric field ("key":value) of a trace file line (default_value if absent)
+double read_trace_field (const char *line, const char *key, double default_value);
+
+// Parse a trace file line into a schedule event, returns 1 if the line holds a schedule event
+int parse_trace_line (const char *line, Trace_event *event);
+
+// Verify a schedule trace file written by the simulator in one pass, prints the report
+int verify_trace_file (const char *path);
+
+// --------------------------------------
+// SCHEDULING SERVER (UNIX DOMAIN SOCKET)
+// --------------------------------------
+
+// Receive exactly length bytes from the socket, returns -1 on error or if the peer closed the connection
+int receive_full (int fd, void *buffer, size_t length);
+
+// Wait until a (non-blocking) socket can take more bytes, returns -1 on error
+int wait_writable (int fd);
+
+// Send exactly length bytes to the socket, returns -1 on error
+int send_full (int fd, const void *buffer, size_t length);
+
+// Send a message (header and payload) to the socket
+int send_message (int fd, Server_header *header, const void *payload);
+
+// Check the parameters of a task record, returns -1 if invalid
+int check_server_task (Server_task *task, int max_criticality);
+
+// Discard the allocation and simulation summary kept for the served taskset (when it changes)
+void invalidate_server_state (Server_state *server);
+
+// Build a taskset from the task table of the server, returns -1 if out of memory
+int build_server_taskset (Server_state *server, Taskset *taskset);
+
+// Allocate the served taskset (if not yet allocated since it last changed), returns the response status
+int allocate_served_taskset (Server_state *server);
+
+// Serve a load request: replace the served taskset
+int serve_load (Server_state *server, int length);
+
+// Serve an add task request
+int serve_add_task (Server_state *server, int length, Server_update *update);
+
+// Serve a remove task request
+int serve_remove_task (Server_state *server, int length, Server_update *update);
+
+// Serve an allocation request (allocation of the served taskset, and whether it fits within the requested number of cores)
+int serve_allocate (Server_state *server, int length, Server_allocation *allocation);
+
+// Serve a simulation request (simulation of a clone of the allocated context)
+int serve_simulate (Server_state *server, int length, Server_summary *summary);
+
+// Serve the request received from a client, returns -1 if the connection must be closed
+int serve_request (Server_state *server, Server_client *client);
+
+// Receive the available bytes of a client's requests without blocking and serve the completed requests, returns -1 if the connection must be closed
+int receive_requests (Server_state *server, Server_client *client);
+
+// Run the scheduling server on the Unix domain socket at the given path until a stop request is served
+int run_server (const char *path, Sim_config *config);
+
+// Connect to the scheduling server at the given socket path, returns the connection's descriptor (-1 on error)
+int connect_server (const char *path);
+
+// Send a request to the scheduling server and receive its response, returns the response status (SERVER_ERROR_IO on a connection error)
+int server_request (int fd, int type, const void *payload, int length, void *response, int response_size);
+
+// -----------------------------------------------
+// ONLINE ADMISSION CONTROL (RUNTIME TASK CHANGES)
+// -----------------------------------------------
+
+// Check the parameters of a runtime task change and derive its task fields, returns -1 if invalid
+int prepare_task_change (Sim_context *ctx, Task_change *change);
+
+// Build the utilization sums of the cores from the allocation (once, at the first task change)
+void build_core_loads (Sim_context *ctx);
+
+// Check if a core can take a task (EDF-VD test on the core load with the task added, side-effect free)
+int check_core_admission (Sim_context *ctx, int core_idx, Tasks *task);
+
+// Select the core for a task among the open cores (WFD above the WFD threshold criticality, FFD otherwise), returns -1 if no core can take it
+int select_admission_core (Sim_context *ctx, Tasks *task, int exclude_idx);
+
+// Recalculate the EDF-VD threshold criticality of a core and the virtual deadlines of its tasks from its load
+void update_core_deadlines (Sim_context *ctx, int core_idx);
+
+// Get the super-hyperperiod of the taskset with a task of the given period added, returns -1 if it exceeds INT_MAX
+int get_admission_hyperperiod (Sim_context *ctx, int period);
+
+// Get the time at which a task's first job is released after the current decision point, returns -1 if it exceeds INT_MAX
+int get_admission_release (Sim_context *ctx, Tasks *task);
+
+// Store a task's new parameters in the task structure array (task_idx = num_tasks appends the task), returns -1 if out of memory
+int store_task (Sim_context *ctx, int task_idx, Tasks *task);
+
+// Apply an add task change, returns TASK_CHANGE_APPLIED/TASK_CHANGE_REJECTED/TASK_CHANGE_DEFERRED
+int apply_add_task (Sim_context *ctx, Tasks *task);
+
+// Apply a remove task change, returns TASK_CHANGE_APPLIED/TASK_CHANGE_REJECTED
+int apply_remove_task (Sim_context *ctx, int task_no);
+
+// Apply a modify task change, returns TASK_CHANGE_APPLIED/TASK_CHANGE_REJECTED/TASK_CHANGE_DEFERRED
+int apply_modify_task (Sim_context *ctx, Tasks *task);
+
+// Apply the pending runtime task changes in order at the current decision point (before the scheduler executes at it)
+void apply_task_changes (Sim_context *ctx);
+
+// Queue a runtime task change, returns -1 if the taskset is not allocated, the simulation is complete, the change is invalid or too many changes are pending
+int queue_task_change (Sim_context *ctx, int type, Tasks *task);
+
+// ---------------------------------------------
+// LIBRARY API (libeemcs) -- SIMULATION CONTEXTS
+// ---------------------------------------------
+
+// Create a simulation context with the given configuration
+Sim_context *eemcs_create (Sim_config *config);
+
+// Load a parsed taskset into the context (the context takes ownership of the taskset)
+int eemcs_load (Sim_context *ctx, Taskset *taskset);
+
+// Load a preprocessed (sorted + allocated) taskset from its snapshot into the context
+int eemcs_load_snapshot (Sim_context *ctx, const char *path, Taskset_file *file);
+
+// Sort, allocate the loaded taskset to cores and calculate the super-hyperperiod
+int eemcs_allocate (Sim_context *ctx);
+
+// Create a context with the given configuration holding a copy of the taskset and allocation of an allocated (not yet simulated) context
+Sim_context *eemcs_clone (Sim_context *ctx, Sim_config *config);
+
+// Run the simulation up to (but excluding) the decision points at/after the given time
+int eemcs_step_until (Sim_context *ctx, double time);
+
+// Run the simulation till its end (num_hyperperiods super-hyperperiods)
+void eemcs_run (Sim_context *ctx);
+
+// Query the simulation statistics
+void eemcs_get_stats (Sim_context *ctx, Sim_stats *stats);
+
+// Trace the schedule of the allocated context to the given file (Chrome trace event format), closed when the context is destroyed
+int eemcs_open_trace (Sim_context *ctx, const char *path);
+
+// Verify the schedule of the allocated context while it is simulated (streaming verifier, the violations are counted in the statistics)
+int eemcs_verify (Sim_context *ctx);
+
+// Execute the allocated taskset on real cores instead of simulating it
+int eemcs_execute (Sim_context *ctx, Exec_config *config, Exec_stats *stats);
+
+// Add a task to the running simulation (online admission control), applied at the next safe decision point
+int eemcs_add_task (Sim_context *ctx, Tasks *task);
+
+// Remove a task from the running simulation, applied at the next safe decision point
+int eemcs_remove_task (Sim_context *ctx, int task_no);
+
+// Change the parameters of a task of the running simulation, applied at the next safe decision point
+int eemcs_modify_task (Sim_context *ctx, Tasks *task);
+
+// Get the core number a task is allocated to (NOT_ALLOCATED if the task is not in the taskset or was removed, SPLIT_TASK if split)
+int eemcs_get_task_core (Sim_context *ctx, int task_no);
+
+// Destroy the simulation context, releasing all its memory
+void eemcs_destroy (Sim_context *ctx);
 
 // -----------------
 // HELPER FUNCTIONS
@@ -354,9 +1933,6 @@ void print_sorted_array (Tasks *task_ptr, int num_tasks);
 // Helper funtion to print the taskset information for the given workload
 void print_taskset_info (Taskset_info* tasks_info);
 
-// Helper funtion to free all the wcet mallocs
-void free_wcet_mallocs (Tasks *task_ptr, int num_tasks);
-
 // Helper function to print task allocations
 void print_task_allocations (Cores *core, int num_cores);
 
@@ -366,6 +1942,12 @@ double find_modulo (double a, double b);
 // Helper function to print run queue
 void print_run_queue (RQ_HEAD *head);
 
+// Helper function to print the sleep time of each core, power domain and sleep state
+void print_sleep_times (Sim_context *ctx, Sim_stats *stats);
+
+// Helper function to free a run queue (all its nodes and the job structures in them)
+void free_run_queue (RQ_HEAD *head);
+
 // Helper function to copy job structure from source pointer to destination pointer
 void copy_job_structure (Jobs *dest, Jobs *src);
 
@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "header.h"
+
+// -------------------------------------------------------
+// LOCAL SEARCH ALLOCATION OPTIMIZER (SIMULATED ANNEALING)
+// -------------------------------------------------------
+
+// The greedy allocation (offline_task_allocator) never revisits its decisions. The optimizer starts from the greedy result and runs
+// OPTIMIZER_CHAINS independent simulated annealing chains in parallel (thread pool). Each chain moves single tasks between cores and
+// swaps pairs of tasks, every affected core being checked with the EDF-VD test on incrementally maintained utilization sums.
+// Objective (minimized): OPTIMIZER_CORE_WEIGHT per active core - OPTIMIZER_SHUTDOWN_WEIGHT per SHUTDOWNABLE active core - sum of squared
+// core utilizations (the last term favours packing tasks tightly, which lets the search empty cores)
+// The random numbers of each chain are a pure function of (seed, chain, iteration), and the best chain is selected by (cost, chain number),
+// so the result depends only on the seed (unless the time budget stops the chains early)
+
+// Check if a task is a low period (LPD) task (cores with LPD tasks cannot be SHUTDOWN)
+
+int is_lpd_task (Tasks *task) {
+    return task->lpd;
+}
+
+// Add (sign = 1) or remove (sign = -1) a task's utilizations to/from a core load
+
+void add_task_load (Core_load *load, Tasks *task, int sign) {
+
+    int c = task->criticality - 1;     // Index of the task's criticality level
+
+    load->count = load->count + sign;
+    load->lpd_count = load->lpd_count + sign * is_lpd_task (task);
+    load->utilization = load->utilization + sign * task->own_utilization;
+    load->own_util[c] = load->own_util[c] + sign * task->own_utilization;
+    for (int k = 0; k < MAX_LEVELS; k++)
+        load->level_util[c][k] = load->level_util[c][k] + sign * task->utilization[k];
+}
+
+// EDF-VD schedulability test on a core load (same conditions as edfvd_schedulability_check, without modifying any task or core)
+// Returns the threshold criticality (max criticality if EDF schedulable) and the deadline shortening factor x, -1 if not schedulable
+
+int get_load_threshold (Core_load *load, int max_criticality, double *x) {
+
+    double ull_lo = 0.0;               // Utilization of the LO criticality tasks (criticality <= threshold) at their own levels
+    double ull_hi = 0.0;               // Utilization of the HI criticality tasks (criticality > threshold) at their own levels
+    double ulk_hi = 0.0;               // Utilization of the HI criticality tasks at the threshold level
+    double x_lb = 0.0, x_ub = 0.0;     // Bounds on the deadline shortening factor
+
+    *x = 1.0;
+
+    if (load->count > MAX_TASKS)
+        return -1;
+
+    // Sum of all task utilizations (at their own criticality level) <= 1 --> EDF schedulable
+    if (load->utilization <= 1.0)
+        return max_criticality;
+
+    // EDF-VD conditions for all possible threshold criticalities
+    for (int threshold = max_criticality - 1; threshold > 0; threshold--) {
+
+        ull_lo = 0.0;
+        ull_hi = 0.0;
+        ulk_hi = 0.0;
+        for (int c = 1; c <= max_criticality; c++) {
+            if (c <= threshold)
+                ull_lo = ull_lo + load->own_util[c - 1];
+            else {
+                ull_hi = ull_hi + load->own_util[c - 1];
+                ulk_hi = ulk_hi + load->level_util[c - 1][threshold - 1];
+            }
+        }
+
+        if (ull_lo < 1.0) {
+            x_lb = ulk_hi / (1.0 - ull_lo);
+            x_ub = (1.0 - ull_hi) / ull_lo;
+            if (x_lb <= x_ub) {
+                *x = (x_lb + x_ub) / 2;
+                return threshold;
+            }
+        }
+    }
+
+    return -1;
+}
+
+// Cost of a core in the allocation objective (0 for an empty core)
+
+double get_load_cost (Core_load *load) {
+
+    if (load->count == 0)
+        return 0.0;
+
+    return OPTIMIZER_CORE_WEIGHT - ((load->lpd_count == 0) ? OPTIMIZER_SHUTDOWN_WEIGHT : 0.0) - load->utilization * load->utilization;
+}
+
+// Calculate the core loads of an allocation from scratch
+// Returns the total cost of the allocation, -1 if any core is not schedulable
+
+double calculate_core_loads (Core_load *loads, int num_cores, Tasks *tasks_arr, int num_tasks, int max_criticality, int *core_of) {
+
+    double cost = 0.0;
+    double x = 0.0;
+
+    memset (loads, 0, num_cores * sizeof (Core_load));
+    for (int i = 0; i < num_tasks; i++)
+        add_task_load (&loads[core_of[i]], &tasks_arr[i], 1);
+
+    for (int j = 0; j < num_cores; j++) {
+        if (loads[j].count > 0 && get_load_threshold (&loads[j], max_criticality, &x) < 0)
+            return -1.0;
+        cost = cost + get_load_cost (&loads[j]);
+    }
+
+    return cost;
+}
+
+// Run one annealing chain (thread pool task)
+// Move: a random task is moved to a random other core; swap: two random tasks on different cores are exchanged
+// A move/swap is only made if all the affected cores stay EDF-VD schedulable (removing a task never breaks schedulability)
+
+void run_optimizer_chain (void *arg) {
+
+    Optimizer_chain *chain = (Optimizer_chain *) arg;
+    Tasks *tasks_arr = chain->tasks_arr;
+    int num_tasks = chain->num_tasks;
+    Core_load loads[MAX_CORES];                      // Core loads of the current allocation
+    double cost = 0.0;                               // Cost of the current allocation
+    double delta = 0.0;                              // Cost difference of the move/swap
+    double temperature = 0.0;                        // Annealing temperature
+    double x = 0.0;
+    int a = 0, b = 0;                                // Tasks moved/swapped
+    int from = 0, to = 0;                            // Cores of the move/swap
+    int feasible = 0;
+
+    memcpy (chain->core_of, chain->initial_core, num_tasks * sizeof (int));
+    memcpy (chain->best_core, chain->initial_core, num_tasks * sizeof (int));
+    cost = calculate_core_loads (loads, chain->num_cores, tasks_arr, num_tasks, chain->max_criticality, chain->core_of);
+    chain->best_cost = cost;
+    chain->accepted = 0;
+
+    if (cost < 0 || chain->num_cores < 2)
+        return;
+
+    for (int iter = 0; iter < chain->iterations; iter++) {
+
+        // Time budget (checked every 256 iterations)
+        if (chain->end_time > 0 && (iter & 255) == 0 && get_clock_ns (CLOCK_MONOTONIC) >= chain->end_time)
+            break;
+
+        temperature = OPTIMIZER_INITIAL_TEMPERATURE * pow (OPTIMIZER_FINAL_TEMPERATURE / OPTIMIZER_INITIAL_TEMPERATURE, (double) iter / chain->iterations);
+
+        // Random numbers of this iteration (counter-based: chain number and iteration select the stream)
+        a = get_random_int (chain->seed, chain->chain_no, iter, 0, 0, num_tasks - 1);
+        from = chain->core_of[a];
+        b = -1;
+
+        // MOVE task a to another core
+        if (get_random_uniform (chain->seed, chain->chain_no, iter, 1) < 0.5) {
+            to = get_random_int (chain->seed, chain->chain_no, iter, 2, 0, chain->num_cores - 2);
+            if (to >= from)
+                to++;
+            delta = -get_load_cost (&loads[from]) - get_load_cost (&loads[to]);
+            add_task_load (&loads[from], &tasks_arr[a], -1);
+            add_task_load (&loads[to], &tasks_arr[a], 1);
+            feasible = (get_load_threshold (&loads[to], chain->max_criticality, &x) >= 0);
+        }
+
+        // SWAP tasks a and b (on different cores)
+        else {
+            b = get_random_int (chain->seed, chain->chain_no, iter, 2, 0, num_tasks - 1);
+            to = chain->core_of[b];
+            if (to == from)
+                continue;
+            delta = -get_load_cost (&loads[from]) - get_load_cost (&loads[to]);
+            add_task_load (&loads[from], &tasks_arr[a], -1);
+            add_task_load (&loads[to], &tasks_arr[a], 1);
+            add_task_load (&loads[to], &tasks_arr[b], -1);
+            add_task_load (&loads[from], &tasks_arr[b], 1);
+            feasible = (get_load_threshold (&loads[to], chain->max_criticality, &x) >= 0 && get_load_threshold (&loads[from], chain->max_criticality, &x) >= 0);
+        }
+
+        delta = delta + get_load_cost (&loads[from]) + get_load_cost (&loads[to]);
+
+        // Accept improving moves, and worsening moves with probability exp (-delta / temperature)
+        if (feasible && (delta <= 0 || get_random_uniform (chain->seed, chain->chain_no, iter, 3) < exp (-delta / temperature))) {
+            chain->core_of[a] = to;
+            if (b >= 0)
+                chain->core_of[b] = from;
+            cost = cost + delta;
+            chain->accepted++;
+
+            if (cost < chain->best_cost) {
+                chain->best_cost = cost;
+                memcpy (chain->best_core, chain->core_of, num_tasks * sizeof (int));
+            }
+        }
+
+        // Reject: undo the move/swap
+        else {
+            add_task_load (&loads[to], &tasks_arr[a], -1);
+            add_task_load (&loads[from], &tasks_arr[a], 1);
+            if (b >= 0) {
+                add_task_load (&loads[from], &tasks_arr[b], -1);
+                add_task_load (&loads[to], &tasks_arr[b], 1);
+            }
+        }
+    }
+}
+
+// Apply an allocation to the core and task structures (empty cores are removed, cores are renumbered in order)
+// Threshold criticalities and virtual deadlines are set as by the EDF-VD schedulability check
+// Returns the number of cores used
+
+int apply_allocation (Cores *core, Tasks *tasks_arr, int num_tasks, int max_criticality, int *core_of, int num_cores) {
+
+    Core_load loads[MAX_CORES];        // Core loads of the allocation
+    int core_idx[MAX_CORES];           // New index of each (non-empty) core
+    double x[MAX_CORES];               // Deadline shortening factor of each core
+    int used_cores = 0;                // Number of non-empty cores
+
+    calculate_core_loads (loads, num_cores, tasks_arr, num_tasks, max_criticality, core_of);
+
+    initialize_cores_offline (core, max_criticality);
+    for (int j = 0; j < num_cores; j++) {
+        core_idx[j] = -1;
+        if (loads[j].count > 0) {
+            core_idx[j] = used_cores++;
+            core[core_idx[j]].threshold_criticality = get_load_threshold (&loads[j], max_criticality, &x[j]);
+            core[core_idx[j]].core_type = (loads[j].lpd_count > 0) ? NON_SHUTDOWNABLE : SHUTDOWNABLE;
+        }
+    }
+
+    // Allocate the tasks in task structure array order
+    for (int i = 0; i < num_tasks; i++) {
+        tasks_arr[i].allocated_core = NOT_ALLOCATED;
+        allocate_task_to_core (core, tasks_arr, core_idx[core_of[i]], i);
+
+        // For HI criticality tasks (criticality > threshold) virtual deadlines are set to x * original deadlines
+        if (tasks_arr[i].criticality > core[core_idx[core_of[i]]].threshold_criticality)
+            tasks_arr[i].virtual_deadline = x[core_of[i]] * tasks_arr[i].deadline;
+        else
+            tasks_arr[i].virtual_deadline = tasks_arr[i].deadline;
+    }
+
+    return used_cores;
+}
+
+// Improve the greedy allocation with parallel simulated annealing chains
+// The tasks can be moved between the cores opened by the greedy allocation; the allocation is only replaced if a chain found a lower cost
+// Returns the number of cores required for allocation
+
+int optimize_allocation (Cores *core, Tasks *tasks_arr, int num_tasks, int num_cores, int max_criticality, Sim_config *config) {
+
+    Optimizer_chain chain[OPTIMIZER_CHAINS];         // Annealing chains
+    Core_load loads[MAX_CORES];                      // Core loads (for validating the best allocation)
+    Thread_pool *pool;                               // Thread pool running the chains
+    int *initial_core;                               // Core index of each task in the greedy allocation
+    int *buffers;                                    // Allocation arrays of all chains
+    int best = 0;                                    // Best chain
+    int used_cores = num_cores;                      // Number of cores of the optimized allocation
+    long long end_time = 0;                          // End of the time budget (CLOCK_MONOTONIC ns)
+    double initial_cost = 0.0;                       // Cost of the greedy allocation
+
+    initial_core = malloc (num_tasks * sizeof (int));
+    buffers = malloc (2 * OPTIMIZER_CHAINS * (size_t) num_tasks * sizeof (int));
+    pool = create_thread_pool ((config->optimizer_threads > 0) ? config->optimizer_threads : get_num_online_cpus ());
+    if (initial_core == NULL || buffers == NULL || pool == NULL) {
+        printf(" ERROR: Could not start the allocation optimizer, keeping the greedy allocation\n");
+        free (initial_core);
+        free (buffers);
+        destroy_thread_pool (pool);
+        return num_cores;
+    }
+
+    // Greedy allocation (core numbers 1..num_cores -> core indices)
+    for (int i = 0; i < num_tasks; i++)
+        initial_core[i] = tasks_arr[i].allocated_core - 1;
+    initial_cost = calculate_core_loads (loads, num_cores, tasks_arr, num_tasks, max_criticality, initial_core);
+
+    if (config->optimizer_time_budget > 0)
+        end_time = get_clock_ns (CLOCK_MONOTONIC) + (long long)(config->optimizer_time_budget * 1000000.0);
+
+    // Run the chains
+    for (int c = 0; c < OPTIMIZER_CHAINS; c++) {
+        chain[c].tasks_arr = tasks_arr;
+        chain[c].num_tasks = num_tasks;
+        chain[c].max_criticality = max_criticality;
+        chain[c].num_cores = num_cores;
+        chain[c].chain_no = c;
+        chain[c].seed = config->seed;
+        chain[c].iterations = config->optimizer_iterations;
+        chain[c].end_time = end_time;
+        chain[c].initial_core = initial_core;
+        chain[c].core_of = buffers + (2 * c) * (size_t) num_tasks;
+        chain[c].best_core = buffers + (2 * c + 1) * (size_t) num_tasks;
+        chain[c].best_cost = initial_cost;
+        if (submit_pool_task (pool, run_optimizer_chain, &chain[c]) < 0)
+            chain[c].iterations = -1;
+    }
+    wait_thread_pool (pool);
+    destroy_thread_pool (pool);
+
+    // Best chain (lowest cost, ties broken by chain number)
+    for (int c = 1; c < OPTIMIZER_CHAINS; c++) {
+        if (chain[c].iterations >= 0 && (chain[best].iterations < 0 || chain[c].best_cost < chain[best].best_cost))
+            best = c;
+    }
+
+    if (config->verbose)
+        printf(" Allocation optimizer: greedy cost %.4f, best cost %.4f (chain %d, %d moves accepted)\n",
+               initial_cost, chain[best].best_cost, best, chain[best].accepted);
+
+    // Replace the greedy allocation if it was improved (the best allocation is validated with loads calculated from scratch)
+    if (chain[best].iterations >= 0 && initial_cost >= 0 && chain[best].best_cost < initial_cost &&
+        calculate_core_loads (loads, num_cores, tasks_arr, num_tasks, max_criticality, chain[best].best_core) >= 0) {
+        used_cores = apply_allocation (core, tasks_arr, num_tasks, max_criticality, chain[best].best_core, num_cores);
+        if (config->verbose)
+            printf(" Allocation optimizer: %d cores required (greedy: %d)\n\n", used_cores, num_cores);
+    }
+
+    free (initial_core);
+    free (buffers);
+    return used_cores;
+}
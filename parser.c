@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "header.h"
+
+// ------------------------------------------------------
+// MEMORY-MAPPED TASKSET FILE HANDLING (OPEN/CLOSE INPUT)
+// ------------------------------------------------------
+
+// Open the given input file and map its contents into memory (read-only) for zero-copy parsing
+
+int open_taskset_file (Taskset_file *file, const char *path) {
+
+    struct stat file_stat;        // Input file stats (required for the file size)
+
+    // Initialize the file cursor
+    file->data = NULL;
+    file->size = 0;
+    file->offset = 0;
+    file->line_no = 1;
+    file->taskset_count = 0;
+
+    // Open the input file
+    file->fd = open (path, O_RDONLY);
+    if (file->fd < 0) {
+        printf(" ERROR: Could not open the input file (%s) containing taskset parameters\n", path);
+        return -1;
+    }
+
+    if (fstat (file->fd, &file_stat) < 0) {
+        printf(" ERROR: Could not determine the size of the input file (%s)\n", path);
+        close (file->fd);
+        return -1;
+    }
+    file->size = (size_t) file_stat.st_size;
+
+    // An empty file contains no tasksets --> nothing to map
+    if (file->size == 0)
+        return 0;
+
+    // Map the entire file; the parser reads the integers directly from the mapped pages
+    file->data = mmap (NULL, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+    if (file->data == MAP_FAILED) {
+        printf(" ERROR: Could not map the input file (%s) into memory\n", path);
+        file->data = NULL;
+        close (file->fd);
+        return -1;
+    }
+
+    // The file is scanned strictly sequentially
+    madvise ((void *) file->data, file->size, MADV_SEQUENTIAL);
+
+    return 0;
+}
+
+// Unmap and close the input file
+
+void close_taskset_file (Taskset_file *file) {
+
+    if (file->data != NULL)
+        munmap ((void *) file->data, file->size);
+    if (file->fd >= 0)
+        close (file->fd);
+
+    file->data = NULL;
+    file->fd = -1;
+}
+
+// ------------------------
+// HAND-ROLLED INT SCANNER
+// ------------------------
+
+// Skip whitespace and comment lines (starting with '#') up to the next token
+// Returns 1 if a token follows, 0 at end of file
+
+int skip_to_next_token (Taskset_file *file) {
+
+    const char *data = file->data;
+    size_t offset = file->offset;
+
+    while (offset < file->size) {
+
+        // Count lines for error reporting
+        if (data[offset] == '\n') {
+            file->line_no++;
+            offset++;
+        }
+
+        // Skip blanks (spaces, tabs, carriage returns)
+        else if (data[offset] == ' ' || data[offset] == '\t' || data[offset] == '\r')
+            offset++;
+
+        // Skip comment till end of line
+        else if (data[offset] == '#') {
+            while (offset < file->size && data[offset] != '\n')
+                offset++;
+        }
+
+        else
+            break;
+    }
+
+    file->offset = offset;
+    return (offset < file->size);
+}
+
+// Scan the next (signed) integer from the mapped file
+// Returns 0 on success, -1 if the next token is missing/not an integer/out of range
+
+int scan_int (Taskset_file *file, int *value) {
+
+    const char *data = file->data;
+    size_t offset = 0;
+    long result = 0;          // Accumulated value (long to detect int overflow)
+    int negative = 0;         // Sign of the integer
+
+    if (!skip_to_next_token (file))
+        return -1;
+
+    offset = file->offset;
+
+    // Optional sign
+    if (data[offset] == '-' || data[offset] == '+') {
+        negative = (data[offset] == '-');
+        offset++;
+    }
+
+    // At least one digit must follow
+    if (offset >= file->size || data[offset] < '0' || data[offset] > '9')
+        return -1;
+
+    // Accumulate digits
+    while (offset < file->size && data[offset] >= '0' && data[offset] <= '9') {
+        result = result * 10 + (data[offset] - '0');
+        if (result > INT_MAX)
+            return -1;
+        offset++;
+    }
+
+    // The integer must be terminated by whitespace/comment/end of file
+    if (offset < file->size && data[offset] != ' ' && data[offset] != '\t' && data[offset] != '\r' && data[offset] != '\n' && data[offset] != '#')
+        return -1;
+
+    file->offset = offset;
+    *value = (int)(negative ? -result : result);
+    return 0;
+}
+
+// ------------------------------------------------------------------------------------------
+// FETCH INPUT TASK SET PARAMETERS FROM THE MAPPED FILE, STORE PARAMETERS IN TASKSET STRUCTURE
+// ------------------------------------------------------------------------------------------
+
+// Parse the next taskset from the file (each taskset starts with a header: <number of tasks> <max criticality level>)
+// Task wcets of the entire taskset are stored in one contiguous arena
+// Returns 1 if a taskset was parsed, 0 at end of file, -1 on a malformed taskset
+
+int parse_next_taskset (Taskset_file *file, Taskset *taskset) {
+
+    Tasks *task;                  // Task being parsed
+    int *wcet_ptr;                // Next free slot in the wcet arena
+    int wcets_used = 0;           // Number of wcet arena slots filled
+
+    taskset->tasks_arr = NULL;
+    taskset->wcet_arena = NULL;
+    taskset->num_tasks = 0;
+    taskset->max_criticality = 0;
+    taskset->source_start = file->offset;
+    taskset->source_end = file->offset;
+    taskset->snapshot_map = NULL;
+    taskset->snapshot_size = 0;
+
+    // No more tasksets in the file
+    if (file->data == NULL || !skip_to_next_token (file))
+        return 0;
+
+    file->taskset_count++;
+
+    // Read taskset header: number of tasks and maximum criticality level
+    if (scan_int (file, &taskset->num_tasks) < 0 || scan_int (file, &taskset->max_criticality) < 0) {
+        printf(" ERROR: Taskset %d (line %d): malformed taskset header\n", file->taskset_count, file->line_no);
+        return -1;
+    }
+    if (taskset->num_tasks <= 0) {
+        printf(" ERROR: Taskset %d (line %d): number of tasks must be positive\n", file->taskset_count, file->line_no);
+        return -1;
+    }
+    if (taskset->max_criticality < 1 || taskset->max_criticality > MAX_LEVELS) {
+        printf(" ERROR: Taskset %d (line %d): maximum criticality level must lie in [1, %d]\n", file->taskset_count, file->line_no, MAX_LEVELS);
+        return -1;
+    }
+
+    // Allocate memory for task structure array and the wcet arena (upper bound: max criticality wcets per task)
+    taskset->tasks_arr = malloc (taskset->num_tasks * sizeof (Tasks));
+    taskset->wcet_arena = malloc ((size_t) taskset->num_tasks * taskset->max_criticality * sizeof (int));
+    if (taskset->tasks_arr == NULL || taskset->wcet_arena == NULL) {
+        printf(" ERROR: Taskset %d: could not allocate memory for %d tasks\n", file->taskset_count, taskset->num_tasks);
+        free_taskset (taskset);
+        return -1;
+    }
+    wcet_ptr = taskset->wcet_arena;
+
+    // For all tasks
+    for (int i = 0 ; i < taskset->num_tasks ; i++) {
+
+        task = &taskset->tasks_arr[i];
+
+        // Record the task's phase, period, relative deadline and criticality level from the file
+        if (scan_int (file, &task->phase) < 0 || scan_int (file, &task->period) < 0 || scan_int (file, &task->deadline) < 0 || scan_int (file, &task->criticality) < 0) {
+            printf(" ERROR: Taskset %d (line %d): malformed parameters for task %d\n", file->taskset_count, file->line_no, i + 1);
+            free_taskset (taskset);
+            return -1;
+        }
+
+        // Validate task parameters
+        if (task->phase < 0 || task->period <= 0 || task->deadline <= 0) {
+            printf(" ERROR: Taskset %d (line %d): task %d must have phase >= 0, period > 0 and deadline > 0\n", file->taskset_count, file->line_no, i + 1);
+            free_taskset (taskset);
+            return -1;
+        }
+        if (task->criticality < 1 || task->criticality > taskset->max_criticality) {
+            printf(" ERROR: Taskset %d (line %d): task %d criticality must lie in [1, %d]\n", file->taskset_count, file->line_no, i + 1, taskset->max_criticality);
+            free_taskset (taskset);
+            return -1;
+        }
+
+        // Assign a task number to each task structure
+        task->task_no = i + 1;
+
+        // Initialize task's allocated core number to NOT_ALLOCATED
+        task->allocated_core = NOT_ALLOCATED;
+
+        // Initialize the task's virtual deadline as its relative deadline
+        task->virtual_deadline = task->deadline;
+
+        // WCET array is a slice of the arena; no. of elements = task's criticality level
+        task->wcet = wcet_ptr;
+        wcet_ptr = wcet_ptr + task->criticality;
+        wcets_used = wcets_used + task->criticality;
+
+        // For each criticality level (defined for the given task)
+        for (int j = 0 ; j < task->criticality ; j++) {
+
+            // Record task's WCET value for the current criticality level
+            if (scan_int (file, &task->wcet[j]) < 0) {
+                printf(" ERROR: Taskset %d (line %d): malformed wcet at level %d for task %d\n", file->taskset_count, file->line_no, j + 1, i + 1);
+                free_taskset (taskset);
+                return -1;
+            }
+
+            // WCETs must be positive and non-decreasing with criticality level
+            if (task->wcet[j] <= 0 || (j > 0 && task->wcet[j] < task->wcet[j - 1])) {
+                printf(" ERROR: Taskset %d (line %d): wcets of task %d must be positive and non-decreasing with criticality\n", file->taskset_count, file->line_no, i + 1);
+                free_taskset (taskset);
+                return -1;
+            }
+
+            // Calculate the task's utilization for the current criticality level
+            task->utilization[j] = (double)(task->wcet[j]) / (task->period);
+        }
+
+        // For criticality levels beyond the task's (maximum defined) criticality level,
+        // the utilization is set to task utilization at it's own criticality level
+        // (reqd for EDF-VD offline preprocessing)
+        for (int j = task->criticality ; j < taskset->max_criticality ; j++)
+            task->utilization[j] = task->utilization[task->criticality - 1];
+    }
+
+    // Release the unused tail of the arena (only when tasks have criticality < max criticality)
+    if (wcets_used < taskset->num_tasks * taskset->max_criticality) {
+        int *arena = realloc (taskset->wcet_arena, wcets_used * sizeof (int));
+        if (arena != NULL && arena != taskset->wcet_arena) {
+            for (int i = 0, k = 0; i < taskset->num_tasks; k = k + taskset->tasks_arr[i].criticality, i++)
+                taskset->tasks_arr[i].wcet = arena + k;
+            taskset->wcet_arena = arena;
+        }
+    }
+
+    taskset->source_end = file->offset;
+    return 1;
+}
+
+// Free the task structure array and wcet arena of a parsed taskset
+
+void free_taskset (Taskset *taskset) {
+
+    free (taskset->tasks_arr);
+    free (taskset->wcet_arena);
+    if (taskset->snapshot_map != NULL)
+        munmap (taskset->snapshot_map, taskset->snapshot_size);
+    taskset->tasks_arr = NULL;
+    taskset->wcet_arena = NULL;
+    taskset->snapshot_map = NULL;
+    taskset->num_tasks = 0;
+}
+
+// Copy a taskset (task structure array and wcet arena; the wcets of a taskset loaded from a snapshot are copied out of the mapping)
+// Returns -1 if out of memory
+
+int copy_taskset (Taskset *dest, Taskset *src) {
+
+    int *wcet_ptr;                // Next free slot in the wcet arena
+    int num_wcets = 0;            // Number of wcets of all tasks
+
+    *dest = *src;
+    dest->snapshot_map = NULL;
+    dest->snapshot_size = 0;
+
+    for (int i = 0; i < src->num_tasks; i++)
+        num_wcets = num_wcets + src->tasks_arr[i].criticality;
+
+    dest->tasks_arr = malloc (src->num_tasks * sizeof (Tasks));
+    dest->wcet_arena = malloc (num_wcets * sizeof (int));
+    if (dest->tasks_arr == NULL || dest->wcet_arena == NULL) {
+        free_taskset (dest);
+        return -1;
+    }
+
+    memcpy (dest->tasks_arr, src->tasks_arr, src->num_tasks * sizeof (Tasks));
+    wcet_ptr = dest->wcet_arena;
+    for (int i = 0; i < src->num_tasks; i++) {
+        memcpy (wcet_ptr, src->tasks_arr[i].wcet, src->tasks_arr[i].criticality * sizeof (int));
+        dest->tasks_arr[i].wcet = wcet_ptr;
+        wcet_ptr = wcet_ptr + src->tasks_arr[i].criticality;
+    }
+
+    return 0;
+}
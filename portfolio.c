@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "header.h"
+
+// --------------------------------------------
+// ALLOCATION HEURISTIC PORTFOLIO (SPECULATIVE)
+// --------------------------------------------
+
+// The greedy allocation (offline_task_allocator) picks its bin-packing scheme with a fixed rule (WFD + FFD if the HI criticality tasks are at
+// most 40% of the utilization, else FFD). The portfolio runs every heuristic (HEURISTIC_*) with both low period task allocations
+// (LPD_*) concurrently on the thread pool, each entry on private copies of the task and core state, and keeps the allocation that is
+// best by the configured objective (fewest cores, most SHUTDOWNABLE cores or lowest predicted energy)
+// Every entry is deterministic and the winner is selected by (objective, entry number), so the result does not depend on the number of threads
+
+// Get the name of an allocation heuristic
+
+const char *get_heuristic_name (int heuristic) {
+
+    switch (heuristic) {
+        case HEURISTIC_ADAPTIVE: return "adaptive";
+        case HEURISTIC_WFD_FFD: return "WFD + FFD";
+        case HEURISTIC_FFD: return "FFD";
+        case HEURISTIC_WFD: return "WFD";
+        case HEURISTIC_BFD: return "BFD";
+        case HEURISTIC_CRITICALITY_FFD: return "criticality-aware FFD";
+        default: return "unknown";
+    }
+}
+
+// Get the allocation heuristic with the given name (as given in the command line), returns -1 if the name is unknown
+
+int parse_allocation_heuristic (const char *name) {
+
+    if (strcmp (name, "adaptive") == 0)
+        return HEURISTIC_ADAPTIVE;
+    if (strcmp (name, "wfd-ffd") == 0)
+        return HEURISTIC_WFD_FFD;
+    if (strcmp (name, "ffd") == 0)
+        return HEURISTIC_FFD;
+    if (strcmp (name, "wfd") == 0)
+        return HEURISTIC_WFD;
+    if (strcmp (name, "bfd") == 0)
+        return HEURISTIC_BFD;
+    if (strcmp (name, "cffd") == 0)
+        return HEURISTIC_CRITICALITY_FFD;
+    return -1;
+}
+
+// Get the portfolio objective with the given name (as given in the command line), returns -1 if the name is unknown
+
+int parse_portfolio_objective (const char *name) {
+
+    if (strcmp (name, "cores") == 0)
+        return PORTFOLIO_FEWEST_CORES;
+    if (strcmp (name, "shutdown") == 0)
+        return PORTFOLIO_MOST_SHUTDOWNABLE;
+    if (strcmp (name, "energy") == 0)
+        return PORTFOLIO_LOWEST_ENERGY;
+    return -1;
+}
+
+// Check if the configuration selects the default allocation (partitioned, adaptive heuristic, dedicated LPD cores, no portfolio, no optimizer)
+// (Only allocations made by the default heuristic are saved to/loaded from snapshots)
+
+int is_default_allocation (Sim_config *config) {
+    return config->allocation == ALLOCATION_PARTITIONED && config->allocation_heuristic == HEURISTIC_ADAPTIVE && config->lpd_allocation == LPD_DEDICATED_CORES &&
+           !config->allocation_portfolio && config->optimizer_iterations == 0;
+}
+
+// Predicted power of an allocation: each core executes for its utilization and is idle (NON_SHUTDOWNABLE) or SHUTDOWN (SHUTDOWNABLE) otherwise
+
+double get_predicted_power (Cores *core, int num_cores) {
+
+    double power = 0.0;                // Sum of the predicted power of the cores
+    double busy = 0.0;                 // Fraction of time a core executes jobs
+
+    for (int j = 0; j < num_cores; j++) {
+        busy = (core[j].utilization < 1.0) ? core[j].utilization : 1.0;
+        power = power + busy * ENERGY_ACTIVE_POWER + (1.0 - busy) * ((core[j].core_type == SHUTDOWNABLE) ? ENERGY_SLEEP_POWER : ENERGY_IDLE_POWER);
+    }
+    return power;
+}
+
+// Run the allocation heuristic of one portfolio entry (thread pool task)
+
+void run_portfolio_entry (void *arg) {
+
+    Portfolio_entry *entry = arg;
+
+    entry->num_cores = offline_task_allocator (entry->core, entry->tasks_arr, entry->num_tasks, entry->min_cores, entry->max_criticality,
+                                               entry->semi_partitioned ? entry->split : NULL, &entry->num_splits, &entry->config);
+    if (entry->num_cores <= 0 || entry->num_cores > MAX_CORES)
+        return;
+
+    entry->shutdownable_cores = 0;
+    for (int j = 0; j < entry->num_cores; j++)
+        entry->shutdownable_cores = entry->shutdownable_cores + (entry->core[j].core_type == SHUTDOWNABLE);
+    entry->energy = get_predicted_power (entry->core, entry->num_cores);
+}
+
+// Check if portfolio entry A is better than entry B by the given objective (failed allocations are never better)
+
+int is_better_portfolio_entry (Portfolio_entry *a, Portfolio_entry *b, int objective) {
+
+    if (a->num_cores <= 0 || a->num_cores > MAX_CORES)
+        return 0;
+    if (b->num_cores <= 0 || b->num_cores > MAX_CORES)
+        return 1;
+
+    switch (objective) {
+        case PORTFOLIO_MOST_SHUTDOWNABLE:
+            if (a->shutdownable_cores != b->shutdownable_cores)
+                return a->shutdownable_cores > b->shutdownable_cores;
+            if (a->num_cores != b->num_cores)
+                return a->num_cores < b->num_cores;
+            return a->energy < b->energy;
+
+        case PORTFOLIO_LOWEST_ENERGY:
+            if (a->energy != b->energy)
+                return a->energy < b->energy;
+            return a->num_cores < b->num_cores;
+
+        default:
+            if (a->num_cores != b->num_cores)
+                return a->num_cores < b->num_cores;
+            if (a->shutdownable_cores != b->shutdownable_cores)
+                return a->shutdownable_cores > b->shutdownable_cores;
+            return a->energy < b->energy;
+    }
+}
+
+// Allocate the tasks with every heuristic of the portfolio in parallel and keep the best allocation (same interface as offline_task_allocator)
+// Falls back to the configured single heuristic if the portfolio cannot be started
+// Returns the number of cores required for allocation (-1 if no heuristic could allocate the taskset)
+
+int run_allocation_portfolio (Cores *core, Tasks *tasks_arr, int num_tasks, int min_cores, int max_criticality, Split_task *split_arr, int *num_splits, Sim_config *config) {
+
+    int num_entries = NUM_HEURISTICS * NUM_LPD_ALLOCATIONS;      // Number of portfolio entries
+    Portfolio_entry *entry;                                      // Portfolio entries
+    Tasks *buffers;                                              // Task structure arrays of all entries
+    Thread_pool *pool;                                           // Thread pool running the entries
+    int best = 0;                                                // Best entry
+    int num_cores = -1;                                          // Number of cores of the best allocation
+
+    entry = calloc (num_entries, sizeof (Portfolio_entry));
+    buffers = malloc (num_entries * (size_t) num_tasks * sizeof (Tasks));
+    pool = create_thread_pool ((config->optimizer_threads > 0) ? config->optimizer_threads : get_num_online_cpus ());
+    if (entry == NULL || buffers == NULL || pool == NULL) {
+        printf(" ERROR: Could not start the allocation portfolio, using the %s heuristic\n", get_heuristic_name (config->allocation_heuristic));
+        free (entry);
+        free (buffers);
+        destroy_thread_pool (pool);
+        return offline_task_allocator (core, tasks_arr, num_tasks, min_cores, max_criticality, split_arr, num_splits, config);
+    }
+
+    // Run the entries (entry e: heuristic e / NUM_LPD_ALLOCATIONS, low period task allocation e % NUM_LPD_ALLOCATIONS)
+    for (int e = 0; e < num_entries; e++) {
+        entry[e].config = *config;
+        entry[e].config.verbose = 0;
+        entry[e].config.allocation_heuristic = e / NUM_LPD_ALLOCATIONS;
+        entry[e].config.lpd_allocation = e % NUM_LPD_ALLOCATIONS;
+        entry[e].tasks_arr = buffers + e * (size_t) num_tasks;
+        memcpy (entry[e].tasks_arr, tasks_arr, num_tasks * sizeof (Tasks));
+        entry[e].num_tasks = num_tasks;
+        entry[e].min_cores = min_cores;
+        entry[e].max_criticality = max_criticality;
+        entry[e].semi_partitioned = (split_arr != NULL);
+        memcpy (entry[e].core, core, sizeof (entry[e].core));   // (the runtime fields of the cores are kept as they are)
+        entry[e].num_cores = -1;
+        if (submit_pool_task (pool, run_portfolio_entry, &entry[e]) < 0)
+            run_portfolio_entry (&entry[e]);
+    }
+    wait_thread_pool (pool);
+    destroy_thread_pool (pool);
+
+    // Best entry (ties broken by entry number)
+    for (int e = 0; e < num_entries; e++) {
+        if (config->verbose && entry[e].num_cores > 0 && entry[e].num_cores <= MAX_CORES)
+            printf(" Portfolio: %-21s %-9s LPD cores: %2d cores (%2d SHUTDOWNABLE), predicted power %.4f\n",
+                   get_heuristic_name (entry[e].config.allocation_heuristic), (entry[e].config.lpd_allocation == LPD_MIXED_CORES) ? "mixed" : "dedicated",
+                   entry[e].num_cores, entry[e].shutdownable_cores, entry[e].energy);
+        else if (config->verbose)
+            printf(" Portfolio: %-21s %-9s LPD cores: allocation failed\n",
+                   get_heuristic_name (entry[e].config.allocation_heuristic), (entry[e].config.lpd_allocation == LPD_MIXED_CORES) ? "mixed" : "dedicated");
+        if (is_better_portfolio_entry (&entry[e], &entry[best], config->portfolio_objective))
+            best = e;
+    }
+
+    // Keep the best allocation (the task structure arrays hold the same tasks in the same order)
+    if (entry[best].num_cores > 0 && entry[best].num_cores <= MAX_CORES) {
+        num_cores = entry[best].num_cores;
+        memcpy (tasks_arr, entry[best].tasks_arr, num_tasks * sizeof (Tasks));
+        memcpy (core, entry[best].core, sizeof (entry[best].core));
+        if (split_arr != NULL) {
+            memcpy (split_arr, entry[best].split, sizeof (entry[best].split));
+            *num_splits = entry[best].num_splits;
+        }
+        if (config->verbose)
+            printf(" Portfolio: selected %s heuristic with %s LPD cores\n\n", get_heuristic_name (entry[best].config.allocation_heuristic),
+                   (entry[best].config.lpd_allocation == LPD_MIXED_CORES) ? "mixed" : "dedicated");
+    }
+
+    free (entry);
+    free (buffers);
+    return num_cores;
+}
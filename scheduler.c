@@ -2,11 +2,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <limits.h>
 #include "header.h"
 
-int current_level = 1;
-
 // -----------------------------
 // SUPER-HYPERPERIOD CALCULATION
 // -----------------------------
@@ -114,6 +114,409 @@ RQ_NODE *merge_sort (RQ_NODE *primary_head) {
     return merge (primary_head, secondary_head); 
 } 
 
+// -------------------------------------------------------
+// DISCARDED QUEUES (BINARY MIN-HEAP ON LATEST START TIME)
+// -------------------------------------------------------
+
+// A discarded job can only be scheduled if it starts executing before its latest start time = (deadline - wcet budget at its own criticality level)
+// Keying the discarded queues by latest start time keeps all the jobs that can no longer be scheduled at the top of the heap,
+// so they are removed lazily (only when the queue is scanned for scheduling) in O(log n) each
+
+// Restore the heap order by moving the entry at the given index up
+
+void sift_up_discarded_queue (Discarded_queue *dq, int idx) {
+
+    Discarded_entry entry = dq->entry[idx];     // Entry being moved up
+    int parent = 0;                             // Index of the parent entry
+
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (dq->entry[parent].latest_start_time <= entry.latest_start_time)
+            break;
+        dq->entry[idx] = dq->entry[parent];
+        idx = parent;
+    }
+    dq->entry[idx] = entry;
+}
+
+// Restore the heap order by moving the entry at the given index down
+
+void sift_down_discarded_queue (Discarded_queue *dq, int idx) {
+
+    Discarded_entry entry = dq->entry[idx];     // Entry being moved down
+    int child = 0;                              // Index of the child entry with the earlier latest start time
+
+    while ((child = 2 * idx + 1) < dq->size) {
+        if (child + 1 < dq->size && dq->entry[child + 1].latest_start_time < dq->entry[child].latest_start_time)
+            child++;
+        if (entry.latest_start_time <= dq->entry[child].latest_start_time)
+            break;
+        dq->entry[idx] = dq->entry[child];
+        idx = child;
+    }
+    dq->entry[idx] = entry;
+}
+
+// Insert a job into the discarded queue
+// If the queue is full, the job with the earliest latest start time (the first to expire) is dropped to make room;
+// returns the dropped job (NULL if no job was dropped)
+
+Jobs* insert_discarded_job (Discarded_queue *dq, Jobs *job) {
+
+    Jobs *dropped_job = NULL;                                                      // Job dropped due to the bounded queue capacity
+    double latest_start_time = job->sched_deadline - job->wcet_budget[job->job_criticality - 1];
+
+    // Queue is not full: add the job at the end and sift it up
+    if (dq->size < MAX_DISCARDED_JOBS) {
+        dq->entry[dq->size].latest_start_time = latest_start_time;
+        dq->entry[dq->size].job = job;
+        dq->size++;
+        sift_up_discarded_queue (dq, dq->size - 1);
+        return NULL;
+    }
+
+    // Queue is full and the new job expires first: drop the new job
+    if (latest_start_time <= dq->entry[0].latest_start_time)
+        return job;
+
+    // Else replace the job at the top of the heap with the new job
+    dropped_job = dq->entry[0].job;
+    dq->entry[0].latest_start_time = latest_start_time;
+    dq->entry[0].job = job;
+    sift_down_discarded_queue (dq, 0);
+
+    return dropped_job;
+}
+
+// Remove and return the job with the earliest latest start time from the discarded queue (NULL if empty)
+
+Jobs* remove_discarded_job (Discarded_queue *dq) {
+
+    Jobs *job;
+
+    if (dq->size == 0)
+        return NULL;
+
+    job = dq->entry[0].job;
+    dq->size--;
+    if (dq->size > 0) {
+        dq->entry[0] = dq->entry[dq->size];
+        sift_down_discarded_queue (dq, 0);
+    }
+
+    return job;
+}
+
+// Remove (and free) all jobs whose latest start time has passed from the top of the discarded queue
+// Returns the number of jobs removed
+
+int expire_discarded_jobs (Discarded_queue *dq, double current_time) {
+
+    int expired = 0;     // Number of jobs removed
+
+    while (dq->size > 0 && dq->entry[0].latest_start_time < current_time) {
+        free (remove_discarded_job (dq));
+        expired++;
+    }
+
+    return expired;
+}
+
+// Add a job to the discarded queue corresponding to its criticality level (the job dropped if the queue is full is freed)
+
+void discard_job (Sim_context *ctx, Jobs *job) {
+
+    Jobs *dropped_job;     // Job dropped due to the bounded queue capacity
+
+    dropped_job = insert_discarded_job (&ctx->dhead[job->job_criticality - 1], job);
+    if (dropped_job != NULL) {
+        trace_instant (ctx, 0, "Drop", "discard", ctx->timecount, dropped_job, NULL, 0);
+        free (dropped_job);
+        ctx->stats.discarded_jobs_dropped++;
+    }
+}
+
+// Splice all jobs of a ready queue bucket into the discarded queue of the same criticality level in O(1)
+// The spliced job list is staged, and its jobs are added to the heap only when the discarded queue is considered for scheduling
+
+void splice_discarded_jobs (Sim_context *ctx, int level_idx, RQ_HEAD *bucket) {
+
+    Discarded_queue *dq = &ctx->dhead[level_idx];     // Discarded queue of the bucket's criticality level
+    RQ_NODE *temp;                                    // Temporary node to traverse through the bucket
+
+    if (bucket->head_node == NULL)
+        return;
+
+    // Trace the discarded jobs (only when the schedule is traced)
+    for (temp = bucket->head_node; ctx->trace != NULL && temp != NULL; temp = temp->next)
+        trace_job_event (ctx, TRACE_EVENT_DISCARD, temp->job->allocated_core, temp->job, ctx->timecount, 0);
+
+    // No room to stage another list: add the staged jobs to the heap first
+    if (dq->num_staged == MAX_STAGED_LISTS)
+        absorb_staged_jobs (ctx, level_idx);
+
+    // Move the entire bucket to the discarded queue
+    dq->staged[dq->num_staged] = bucket->head_node;
+    dq->num_staged++;
+    bucket->head_node = NULL;
+    bucket->size = 0;
+}
+
+// Add the jobs spliced into the discarded queue to its heap (the job nodes are released)
+
+void absorb_staged_jobs (Sim_context *ctx, int level_idx) {
+
+    Discarded_queue *dq = &ctx->dhead[level_idx];     // Discarded queue
+    RQ_NODE *temp, *next;                             // Temporary node variables
+
+    for (int i = 0; i < dq->num_staged; i++) {
+        temp = dq->staged[i];
+        while (temp != NULL) {
+            next = temp->next;
+            discard_job (ctx, temp->job);
+            free (temp->twin);
+            free (temp);
+            temp = next;
+        }
+    }
+    dq->num_staged = 0;
+}
+
+// Free all jobs in the discarded queue (including the staged job lists)
+
+void free_discarded_queue (Discarded_queue *dq) {
+
+    RQ_NODE *temp, *next;     // Temporary node variables
+
+    for (int i = 0; i < dq->size; i++)
+        free (dq->entry[i].job);
+    dq->size = 0;
+
+    for (int i = 0; i < dq->num_staged; i++) {
+        temp = dq->staged[i];
+        while (temp != NULL) {
+            next = temp->next;
+            free (temp->job);
+            free (temp->twin);
+            free (temp);
+            temp = next;
+        }
+    }
+    dq->num_staged = 0;
+}
+
+// ---------------------------------------------
+// READY QUEUES (PARTITIONED BY JOB CRITICALITY)
+// ---------------------------------------------
+
+// Each core's ready jobs are partitioned by job criticality: one EDF ordered run queue (bucket) per criticality level
+// The next job to be scheduled is selected among the bucket heads in O(levels)
+
+// Each bucket is maintained in two orders over twin nodes of the same jobs: virtual deadline order and real deadline order
+// When the core switches to HI mode, the ready queue just switches to the real deadline order (no deadline lookup/resort)
+// The scheduling deadline of a ready job is refreshed from the active order when the job is examined/leaves the ready queue
+
+// Create an EMPTY ready queue ordered by the given deadline type
+
+Ready_queue *create_ready_queue (int deadline_type) {
+
+    // Allocate memory for the ready queue
+    Ready_queue *rq;
+    rq = (Ready_queue *) malloc (sizeof (Ready_queue));
+
+    // Initialize all buckets (both orders) as EMPTY run queues
+    rq->size = 0;
+    rq->deadline_type = deadline_type;
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < MAX_LEVELS; i++) {
+            rq->bucket[t][i].size = 0;
+            rq->bucket[t][i].parameter = -1;
+            rq->bucket[t][i].head_node = NULL;
+        }
+    }
+
+    return rq;
+}
+
+// Get the deadline of a job wrt the given ordering (virtual/real)
+
+double get_job_deadline (Jobs *job, int deadline_type) {
+
+    if (deadline_type == REAL_DEADLINES)
+        return job->real_deadline;
+    return job->virtual_deadline;
+}
+
+// Insert a node into a ready queue bucket in increasing order of the given deadline type
+// (A new job is placed before jobs with equal deadlines, as in update_run_queue)
+
+void insert_ready_node (RQ_HEAD *bucket, RQ_NODE *node, int deadline_type) {
+
+    double deadline = get_job_deadline (node->job, deadline_type);     // Deadline of the job being inserted
+    RQ_NODE *temp = bucket->head_node;                                   // Temporary node variable
+    RQ_NODE *prev = NULL;                                                // Node after which the new node is inserted
+
+    while (temp != NULL && get_job_deadline (temp->job, deadline_type) < deadline) {
+        prev = temp;
+        temp = temp->next;
+    }
+
+    node->prev = prev;
+    node->next = temp;
+    if (temp != NULL)
+        temp->prev = node;
+    if (prev != NULL)
+        prev->next = node;
+    else
+        bucket->head_node = node;
+
+    bucket->size = bucket->size + 1;
+}
+
+// Unlink a node from a ready queue bucket (O(1), the node is not freed)
+
+void unlink_ready_node (RQ_HEAD *bucket, RQ_NODE *node) {
+
+    if (node->prev != NULL)
+        node->prev->next = node->next;
+    else
+        bucket->head_node = node->next;
+    if (node->next != NULL)
+        node->next->prev = node->prev;
+
+    bucket->size = bucket->size - 1;
+}
+
+// Merge two lists of ready queue nodes in increasing order of the given deadline type (single pass)
+// Nodes of the second list are placed first on equal deadlines
+
+RQ_NODE *merge_ready_nodes (RQ_NODE *first, RQ_NODE *second, int deadline_type) {
+
+    RQ_NODE *head = NULL, *tail = NULL;     // Merged list
+    RQ_NODE *next;                          // Next node to be appended to the merged list
+
+    while (first != NULL || second != NULL) {
+        if (second == NULL || (first != NULL && get_job_deadline (first->job, deadline_type) < get_job_deadline (second->job, deadline_type))) {
+            next = first;
+            first = first->next;
+        }
+        else {
+            next = second;
+            second = second->next;
+        }
+
+        next->prev = tail;
+        next->next = NULL;
+        if (tail != NULL)
+            tail->next = next;
+        else
+            head = next;
+        tail = next;
+    }
+
+    return head;
+}
+
+// Add a job to the ready queue bucket of its criticality level (in both virtual and real deadline order)
+
+void add_ready_job (Ready_queue *rq, Jobs *job) {
+
+    RQ_NODE *virtual_node = (RQ_NODE *) malloc (sizeof (RQ_NODE));     // Node in virtual deadline order
+    RQ_NODE *real_node = (RQ_NODE *) malloc (sizeof (RQ_NODE));        // Node in real deadline order
+
+    virtual_node->job = job;
+    real_node->job = job;
+    virtual_node->twin = real_node;
+    real_node->twin = virtual_node;
+
+    insert_ready_node (&rq->bucket[VIRTUAL_DEADLINES][job->job_criticality - 1], virtual_node, VIRTUAL_DEADLINES);
+    insert_ready_node (&rq->bucket[REAL_DEADLINES][job->job_criticality - 1], real_node, REAL_DEADLINES);
+    rq->size++;
+}
+
+// Get the bucket (in the active order) whose head job has the earliest deadline (NULL if the ready queue is empty)
+// On equal deadlines, the higher criticality job is preferred
+
+RQ_HEAD *get_earliest_bucket (Ready_queue *rq) {
+
+    RQ_HEAD *bucket = rq->bucket[rq->deadline_type];     // Buckets in the active order
+    RQ_HEAD *earliest = NULL;                            // Bucket with the earliest deadline head job
+
+    for (int i = MAX_LEVELS - 1; i >= 0; i--) {
+        if (bucket[i].head_node != NULL && (earliest == NULL || get_job_deadline (bucket[i].head_node->job, rq->deadline_type) < get_job_deadline (earliest->head_node->job, rq->deadline_type)))
+            earliest = &bucket[i];
+    }
+
+    return earliest;
+}
+
+// Get the earliest deadline job in the ready queue without removing it (NULL if empty)
+// The job's scheduling deadline is refreshed from the active order
+
+Jobs* peek_ready_job (Ready_queue *rq) {
+
+    RQ_HEAD *bucket = get_earliest_bucket (rq);
+    Jobs *job;
+
+    if (bucket == NULL)
+        return NULL;
+
+    job = bucket->head_node->job;
+    job->sched_deadline = get_job_deadline (job, rq->deadline_type);
+    return job;
+}
+
+// Remove and return the earliest deadline job from the ready queue (NULL if empty)
+
+Jobs* remove_ready_job (Ready_queue *rq) {
+
+    RQ_HEAD *bucket = get_earliest_bucket (rq);     // Bucket of the earliest deadline job (active order)
+    RQ_NODE *node;                                  // Node of the job in the active order
+    Jobs *job;                                      // Earliest deadline job
+
+    if (bucket == NULL)
+        return NULL;
+
+    // Unlink the job from both orders
+    node = bucket->head_node;
+    job = node->job;
+    unlink_ready_node (bucket, node);
+    unlink_ready_node (&rq->bucket[1 - rq->deadline_type][job->job_criticality - 1], node->twin);
+    free (node->twin);
+    free (node);
+    rq->size--;
+
+    job->sched_deadline = get_job_deadline (job, rq->deadline_type);
+    return job;
+}
+
+// Switch the ready queue to real deadline order (on mode change) -- O(1)
+
+void switch_to_real_deadlines (Ready_queue *rq) {
+    rq->deadline_type = REAL_DEADLINES;
+}
+
+// Switch the ready queue back to virtual deadline order (on criticality de-escalation) -- O(1)
+// Both orders are always maintained, so the virtual deadline order of the queued jobs is still valid
+
+void switch_to_virtual_deadlines (Ready_queue *rq) {
+    rq->deadline_type = VIRTUAL_DEADLINES;
+}
+
+// Free a ready queue (all its nodes and the job structures in them)
+
+void free_ready_queue (Ready_queue *rq) {
+
+    Jobs *job;
+
+    if (rq == NULL)
+        return;
+
+    while ((job = remove_ready_job (rq)) != NULL)
+        free (job);
+    free (rq);
+}
+
 // -----------------------------
 // RUN-TIME SCHEDULING FUNCTIONS
 // -----------------------------
@@ -182,27 +585,32 @@ double get_next_job_arrival (Tasks *task_arr, int task_array_idx, double timecou
 
 // Determine the next scheduling decision point = min {next decision points in all cores}
 // Decision points: 1. Arrival 2. Current job termination 3. Criticality level change due to wcet budget overrun at current level 4. Overrun 5. Core Wakeup
+// 6. End of a non-preemptive region (limited-preemptive mode)
 // Set preferences within decision point events
 
-double get_next_decision_point (Cores *core, int num_cores, Tasks *task_arr, int num_tasks, double timecount, int hyperperiod) {
+double get_next_decision_point (Sim_context *ctx, double timecount) {
+
+    Cores *core = ctx->core;                        // Core structure array
+    Tasks *task_arr = ctx->tasks_arr;               // Task structure array
+    int current_level = ctx->current_level;         // Current criticality level of the system
 
     double next_arrival = 0.0;                      // Next job arrival time for given task
     double min_arrival = 0.0;                       // Minimum of next job arrival times among all tasks
     double job_termination = 0.0;                   // Currently executing job's termination time
     double criticality_level_change = 0.0;          // Time at which criticality level change is triggered 
                                                     // (in case currently executing job exceeds its wcet budget) 
-    double next_decision_point = hyperperiod;       // = min {next decision points in all cores}
+    double next_decision_point = ctx->end_time;     // = min {next decision points in all cores}
     int i = 0;                                      // Index to traverse through the task structure array
     int j = 0;                                      // Index to traverse through the core structure array
     
     // For all cores
-    for (j = 0; j < num_cores; j++) {
+    for (j = 0; j < ctx->num_cores; j++) {
     
         // Case 1: Job arrival 
-        min_arrival = hyperperiod; 
+        min_arrival = ctx->end_time; 
 
         // For all tasks that belong to the given core 
-        for (i = 0 ; i < num_tasks ; i++) {
+        for (i = 0 ; i < ctx->num_tasks ; i++) {
             if (task_arr[i].allocated_core == core[j].core_no) {
         
                 // Determine next job arrival time
@@ -214,6 +622,17 @@ double get_next_decision_point (Cores *core, int num_cores, Tasks *task_arr, int
             }
         }
     
+        // For all split task portions that belong to the given core (released at a fixed offset after each job arrival)
+        for (int s = 0; s < ctx->num_splits; s++) {
+            for (int p = 0; p < ctx->split[s].num_portions; p++) {
+                if (ctx->split[s].core_no[p] == core[j].core_no) {
+                    next_arrival = get_next_portion_arrival (task_arr, ctx->split[s].task_idx, ctx->split[s].offset[p], timecount);
+                    if (min_arrival > next_arrival)
+                        min_arrival = next_arrival;
+                }
+            }
+        }
+
         // Set next decision point as minimum of next job arrival times for all tasks
         core[j].decision_point->decision_time = min_arrival;
         core[j].decision_point->event = JOB_ARRIVAL;
@@ -271,6 +690,16 @@ double get_next_decision_point (Cores *core, int num_cores, Tasks *task_arr, int
                             core[j].decision_point->event = core[j].decision_point->event + JOB_OVERRUN;
                     }
                 }
+
+                // Case 6: End of the non-preemptive region of the running job (deferred preemption, limited-preemptive mode)
+                if (core[j].curr_exe_job->npr_end != NA) {
+                    if (core[j].decision_point->decision_time > core[j].curr_exe_job->npr_end) {
+                        core[j].decision_point->decision_time = core[j].curr_exe_job->npr_end;
+                        core[j].decision_point->event = PREEMPTION_POINT;
+                    }
+                    else if (core[j].decision_point->decision_time == core[j].curr_exe_job->npr_end)
+                        core[j].decision_point->event = core[j].decision_point->event + PREEMPTION_POINT;
+                }
             }
         }
         
@@ -298,7 +727,9 @@ double get_next_decision_point (Cores *core, int num_cores, Tasks *task_arr, int
 
 // Create job structure and set the parmeter values 
 
-Jobs *create_job_structure (Tasks *task_arr, int task_array_idx, int threshold_criticality, int core_no, double timecount) {
+Jobs *create_job_structure (Sim_context *ctx, int task_array_idx, int threshold_criticality, int core_no, double timecount) {
+
+    Tasks *task_arr = ctx->tasks_arr;     // Task structure array
 
     // Allocating memory for job structure
     Jobs *job;
@@ -325,6 +756,13 @@ Jobs *create_job_structure (Tasks *task_arr, int task_array_idx, int threshold_c
     // Job status flag is initialized to READY
     job->status_flag = READY;
 
+    // The job executes the whole task on its core (the portions of split tasks are set up by start_job_portion)
+    job->portion = NOT_SPLIT;
+    job->migrating_time = 0.0;
+
+    // No preemption is deferred (limited-preemptive mode)
+    job->npr_end = NA;
+
     // Wcet budgets of the job at each criticality are determined by task wcet
     for (int i = 0; i < MAX_LEVELS; i++) {
         if (i < job->job_criticality)
@@ -336,18 +774,22 @@ Jobs *create_job_structure (Tasks *task_arr, int task_array_idx, int threshold_c
             job->wcet_budget[i]= task_arr[task_array_idx].wcet[job->job_criticality - 1];
     }
 
+    // Absolute virtual and original deadlines of the job (the ready queues are maintained in both orders)
+    job->virtual_deadline = job->arrival_time + task_arr[task_array_idx].virtual_deadline;
+    job->real_deadline = job->arrival_time + task_arr[task_array_idx].deadline;
+
     // Sched_deadline: deadline (virtual/actual) that decides scheduling order
     // Virtual deadlines are considered if the system criticality is below EDF-VD threshold 
-    if (current_level <= threshold_criticality)                        
-        job->sched_deadline = job->arrival_time + task_arr[task_array_idx].virtual_deadline;
+    if (ctx->current_level <= threshold_criticality)                        
+        job->sched_deadline = job->virtual_deadline;
     
     // Else, original deadlines are considered 
     else  
-        job->sched_deadline = job->arrival_time + task_arr[task_array_idx].deadline; 
+        job->sched_deadline = job->real_deadline; 
 
     // Random values generated for actual execution times     
-    // TODO: Modify to include a probabilistic random number generation i.e. exection time exceeds wcet with prob p 
-    job->execution_time = (rand() % (task_arr[task_array_idx].wcet[(task_arr[task_array_idx].criticality) - 1])) + 1;  
+    // (Counter-based: the execution time is a pure function of (seed, task, job), drawn from the configured distribution)
+    job->execution_time = generate_execution_time (&ctx->config, &task_arr[task_array_idx], job->job_no);
     
     // Return job structure pointer
     return job;
@@ -361,6 +803,7 @@ void update_run_queue (RQ_HEAD *head, Jobs *j) {
     RQ_NODE *temp, *add_node;
     add_node = (RQ_NODE *) malloc (sizeof (RQ_NODE));
     add_node->job = j;
+    add_node->twin = NULL;
 
     head->size = head->size + 1;
     temp = head->head_node;
@@ -415,18 +858,49 @@ void update_run_queue (RQ_HEAD *head, Jobs *j) {
     }
 }
 
-// Create job stuctures for all READY jobs
-// Add the jobs to run queue if core is ACTIVE; add the job to pending request queue if core is SHUTDOWN
+// Add a new job to the core's ready queue if core is ACTIVE; to its pending request queue if core is SHUTDOWN
+// or to the discarded queue corresponding to its criticality level if it is below the accepted criticality level
 
-void add_ready_jobs (Cores *core, RQ_HEAD **dhead, RQ_HEAD *prhead, Tasks *task_arr, int num_tasks, double timecount) {
+void admit_job (Sim_context *ctx, Cores *core, Jobs *job) {
 
     int accept_above_criticality_rval = 0;       // Temporary variable to store the "accept above" criticality level value  
                                                  // All jobs with criticality > accept_above_criticality_level will be added to respective core's run queue
                                                  // Else, added to discarded queue corresponding to the job's criticality level
+
+    // Add the job to run queue/discarded queue/pending request queue
+    accept_above_criticality_rval = accept_above_criticality_level (ctx->current_level, core->threshold_criticality);
+
+    // If job criticality > accept_above_criticality_level 
+    if (job->job_criticality >= accept_above_criticality_rval) {
+
+        // If the core is ACTIVE - add job to respective core's ready queue
+        if (core->status == ACTIVE) 
+            add_ready_job (core->ready_queue, job);
+
+        // If the core is SHUTDOWN - add job to the core's pending request queue
+        else 
+            add_ready_job (core->pending_queue, job);
+
+        trace_job_event (ctx, TRACE_EVENT_RELEASE, core->core_no, job, ctx->timecount, 0);
+    }
+
+    // Else, add job to the discarded job queue (corresponding to it's criticality level)
+    else {
+        trace_job_event (ctx, TRACE_EVENT_DISCARD, core->core_no, job, ctx->timecount, 0);
+        discard_job (ctx, job);
+    }
+}
+
+// Create job stuctures for all READY jobs
+// Add the jobs to run queue if core is ACTIVE; add the job to pending request queue if core is SHUTDOWN
+
+void add_ready_jobs (Sim_context *ctx, Cores *core, double timecount) {
+
+    Tasks *task_arr = ctx->tasks_arr;            // Task structure array
     double modulo_result = 0;                    // To store return value of find modulo function
      
     // For all tasks
-    for (int i = 0 ; i < num_tasks ; i++) {
+    for (int i = 0 ; i < ctx->num_tasks ; i++) {
   
         // Add ready jobs only for the core in consideration   
         if (task_arr[i].allocated_core == core->core_no) {
@@ -436,54 +910,34 @@ void add_ready_jobs (Cores *core, RQ_HEAD **dhead, RQ_HEAD *prhead, Tasks *task_
             // If the job arrival condition is satisfied 
             if (timecount - task_arr[i].phase >= 0 && !(modulo_result)) {   
 
-                // Allocate memory for a new job structure
-                Jobs *job;
-                job = malloc (sizeof (Jobs));
-
                 // Create a new job structure and set the job parameter values
-                job = create_job_structure (task_arr, i, core->threshold_criticality, core->core_no, timecount);
+                Jobs *job;
+                job = create_job_structure (ctx, i, core->threshold_criticality, core->core_no, timecount);
 
                 // Add the job to run queue/discarded queue/pending request queue
-                accept_above_criticality_rval = accept_above_criticality_level (current_level, core->threshold_criticality);
-
-                // If job criticality > accept_above_criticality_level 
-                if (job->job_criticality >= accept_above_criticality_rval) {
-
-                    // If the core is ACTIVE - add job to respective core's run queue
-                    if (core->status == ACTIVE) 
-                        update_run_queue (core->qhead, job);
-
-                    // If the core is SHUTDOWN - add job to the pending request queue
-                    else 
-                        update_run_queue (prhead, job);
-                }
-
-                // Else, add job to the discarded job queue (corresponding to it's criticality level)
-                else 
-                    update_run_queue (dhead [(job->job_criticality) - 1], job);                               
+                admit_job (ctx, core, job);
             }
         }
     }
+
+    // Release the portions of split tasks allocated to the core (semi-partitioned allocation)
+    if (ctx->num_splits > 0)
+        release_split_portions (ctx, core, timecount);
 }
 
 // Schedule next job by removing a job node from head of the run queue, returning the job struct to the runtime scheduler
+// The queued job structure itself is handed over (no copy); returns NULL if the run queue is empty
 
 Jobs* schedule_next_job (RQ_HEAD *head) {
 
     RQ_NODE *temp;       // Temporary node variable 
-
-    // Allocate memory for the job to be scheduled next
-    Jobs *next_job;
-    next_job = malloc (sizeof (Jobs));
+    Jobs *next_job;      // Job to be scheduled next
 
     // If the run queue is empty 
-    // Return a job structure with IDLE_TASK_NO
-    if(head->head_node == NULL) {                    
-        next_job->task_no = IDLE_TASK_NO;
-        return next_job;
-    }
+    if(head->head_node == NULL)
+        return NULL;
 
-    // Else, dequeue and return the job structure at the head of the queue 
+    // Else, dequeue the job structure at the head of the queue 
     temp = head->head_node;
     head->head_node = head->head_node->next;
     if(head->head_node != NULL)
@@ -492,16 +946,126 @@ Jobs* schedule_next_job (RQ_HEAD *head) {
     // Update queue size
     head->size = head->size - 1;
     
-    // Copy temp job structure info to the node structure to be returned
-    copy_job_structure (next_job, temp->job);
-    
     // Free memory allocated to temp (delete node)
-    free (temp);    
+    next_job = temp->job;
+    free (temp);
     
     // Return pointer to structure containing next job info     
     return next_job; 
 }
 
+// Release the job currently executing on the core (completed/aborted), the core becomes IDLE
+
+void release_current_job (Cores *core) {
+
+    if (core->curr_exe_job != &core->idle_job)
+        free (core->curr_exe_job);
+    core->curr_exe_job = &core->idle_job;
+}
+
+// Charge a scheduling overhead (preemption/migration) to a job executed on the core
+// The overhead is executed by the job, and its wcet budgets are extended by the same amount
+// (the overheads are accounted in the schedulability analysis, so they never trigger a criticality level change)
+
+void charge_job_overhead (Sim_context *ctx, Cores *core, Jobs *job, int overhead) {
+
+    if (overhead <= 0)
+        return;
+
+    job->execution_time = job->execution_time + overhead;
+    for (int i = 0; i < MAX_LEVELS; i++)
+        job->wcet_budget[i] = job->wcet_budget[i] + overhead;
+
+    core->overhead_time = core->overhead_time + overhead;
+    ctx->stats.overhead_time = ctx->stats.overhead_time + overhead;
+    trace_job_event (ctx, TRACE_EVENT_OVERHEAD, core->core_no, job, ctx->timecount, overhead);
+}
+
+// Dispatch the next job on an ACTIVE core (lazy preemption)
+// The running job is kept out of the ready queue: it is preempted only if the earliest deadline ready job has an earlier scheduling deadline
+// so a decision point without preemption costs O(levels)
+// Limited-preemptive mode: a preemption request starts a floating non-preemptive region, the running job is only preempted at its end
+// (if the earlier deadline job is still waiting) or completes within it
+
+void dispatch_next_job (Sim_context *ctx, Cores *core) {
+
+    Jobs *running_job = core->curr_exe_job;     // Job currently executing on the core
+    Jobs *next_job;                             // Earliest deadline job in the ready queue
+
+    // No ready job, keep executing the current job (or stay IDLE)
+    next_job = peek_ready_job (core->ready_queue);
+    if (next_job == NULL) {
+        running_job->npr_end = NA;
+        return;
+    }
+
+    // IDLE core: schedule the earliest deadline ready job
+    if (running_job->task_no == IDLE_TASK_NO) {
+        core->curr_exe_job = remove_ready_job (core->ready_queue);
+        core->curr_exe_job->npr_end = NA;
+        return;
+    }
+
+    // Preempt the running job only if a ready job has an earlier scheduling deadline
+    if (next_job->sched_deadline < running_job->sched_deadline) {
+
+        // Limited-preemptive mode: defer the preemption till the end of the non-preemptive region started by the first request
+        if (ctx->config.preemption_mode == PREEMPTION_LIMITED && ctx->config.npr_length > 0) {
+            if (running_job->npr_end == NA) {
+                running_job->npr_end = ctx->timecount + ctx->config.npr_length;
+                core->deferred_preemptions++;
+                ctx->stats.deferred_preemptions++;
+            }
+            if (ctx->timecount < running_job->npr_end)
+                return;
+        }
+
+        running_job->status_flag = PREEMPTED;
+        running_job->npr_end = NA;
+        core->curr_exe_job = remove_ready_job (core->ready_queue);
+        core->curr_exe_job->npr_end = NA;
+        add_ready_job (core->ready_queue, running_job);
+        core->preemptions++;
+        ctx->stats.preemptions++;
+
+        // The preempted job refills its context (cache, pipeline) when it resumes
+        charge_job_overhead (ctx, core, running_job, ctx->config.preemption_overhead);
+    }
+
+    // No preemption request is pending (e.g. the earlier deadline job was discarded on a mode change)
+    else
+        running_job->npr_end = NA;
+}
+
+// Merge the pending request queue of a core (job arrivals while the core was SHUTDOWN) into its ready queue on wakeup
+// The buckets of both queues are in EDF order (both orders), so each pair is merged in a single pass (linear in the number of jobs of this core)
+
+void merge_pending_requests (Cores *core) {
+
+    Ready_queue *rq = core->ready_queue;          // Core's ready queue
+    Ready_queue *pending = core->pending_queue;   // Core's pending request queue
+
+    // Nothing to merge
+    if (pending->size == 0)
+        return;
+
+    // Merge the two EDF ordered buckets of each criticality level, in both orders (pending jobs are placed first on equal deadlines)
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < MAX_LEVELS; i++) {
+            if (pending->bucket[t][i].head_node == NULL)
+                continue;
+            rq->bucket[t][i].head_node = merge_ready_nodes (rq->bucket[t][i].head_node, pending->bucket[t][i].head_node, t);
+            rq->bucket[t][i].size = rq->bucket[t][i].size + pending->bucket[t][i].size;
+            pending->bucket[t][i].head_node = NULL;
+            pending->bucket[t][i].size = 0;
+        }
+    }
+
+    // Pending request queue is now empty
+    rq->size = rq->size + pending->size;
+    pending->size = 0;
+}
+
 // Delete a particular job structure from the run queue
 
 void delete_job_from_queue (RQ_HEAD *head, Jobs *job) {
@@ -552,44 +1116,84 @@ void delete_job_from_queue (RQ_HEAD *head, Jobs *job) {
     }
 }
 
-// Scan the run queue and discards jobs below acceptable criticality level --> when criticality level/mode is upgraded
+// Discard all jobs below acceptable criticality level from the ready queue --> when criticality level/mode is upgraded
+// The bucket of each criticality level below the given level is spliced into the discarded queue of that level as a whole (O(levels))
+// (The twin nodes in the other order are released when the spliced jobs are added to the discarded heap)
 
-void discard_below_criticality_level (RQ_HEAD *head, RQ_HEAD **dhead, int level) {
+void discard_below_criticality_level (Sim_context *ctx, Ready_queue *rq, int level) {
 
-    RQ_NODE *temp;     // Temporary node variable
+    // For all criticality levels below the given level
+    for (int i = 0; i < level - 1; i++) {
+        rq->size = rq->size - rq->bucket[rq->deadline_type][i].size;
+        splice_discarded_jobs (ctx, i, &rq->bucket[rq->deadline_type][i]);
+        rq->bucket[1 - rq->deadline_type][i].head_node = NULL;
+        rq->bucket[1 - rq->deadline_type][i].size = 0;
+    }
+}
 
-    // Initialize temp to run queue head node    
-    temp = head->head_node;
+// Check if any discarded queue holds jobs (in its heap or staged)
 
-    // Traverse through the core's run queue
-    while (temp != NULL) {
-    
-        // If the job criticality is less than the given level
-        if (temp->job->job_criticality < level) {
-        
-            // Add this job to the discarded queue corresponding to its criticality level
-            update_run_queue (dhead[(temp->job->job_criticality) - 1], temp->job);
-            
-            // Delete job from run queue
-            delete_job_from_queue (head, temp->job); 
-        }
+int has_discarded_jobs (Sim_context *ctx) {
 
-        // Update temp
-        temp = temp->next;
+    for (int i = 0; i < ctx->max_criticality - 1; i++) {
+        if (ctx->dhead[i].size > 0 || ctx->dhead[i].num_staged > 0)
+            return 1;
     }
+    return 0;
 }
 
-// Get task array index corresponding to the task number specified
+// Return to the lowest criticality level at a system-wide idle instant (criticality de-escalation)
+// At an idle instant no job is executing or waiting in any core, so re-enabling the virtual deadlines and the low-criticality tasks
+// cannot affect a job already in the system (the EDF-VD LO mode guarantees hold again from this instant)
+// Jobs still in the discarded queues stay there and remain eligible for slack scheduling
+// Returns 1 if the criticality level was lowered
 
-int get_task_array_index (Tasks *task_arr, int num_tasks, int task_no) {
+int deescalate_at_idle_instant (Sim_context *ctx) {
 
-    int i = 0;     // Task array index
+    Cores *core = ctx->core;     // Core structure array
 
-    // For all tasks
-    for (i = 0; i < num_tasks; i++) {
+    if (ctx->config.deescalation == DEESCALATION_NONE || ctx->current_level == 1)
+        return 0;
 
-        // If task_no of task in array matches the given task_no
-        if (task_arr[i].task_no == task_no)
+    // Every core (ACTIVE or SHUTDOWN) must be IDLE with empty ready and pending request queues
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        if (core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO || core[core_idx].ready_queue->size > 0 || core[core_idx].pending_queue->size > 0)
+            return 0;
+    }
+
+    ctx->current_level = 1;
+    ctx->stats.deescalations++;
+    SCHED_PRINT (ctx, "\n System-wide idle instant: current level reset to 1\n (Low-criticality tasks and virtual deadlines re-enabled)\n\n");
+    trace_level_event (ctx, TRACE_EVENT_DEESCALATION, ctx->timecount);
+
+    // Cores below their EDF-VD threshold schedule wrt virtual deadlines again
+    // SHUTDOWN cores are woken up: their wakeup time ignored the arrivals of the low-criticality tasks
+    // (they are idle with empty queues, the shutdown decision is taken again at this decision point if they are ACTIVE at once,
+    // else they wake up as soon as they have left their sleep state)
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        if (core[core_idx].status == SHUTDOWN)
+            wake_up_core_early (ctx, &core[core_idx], ctx->timecount);
+        core[core_idx].core_criticality = ctx->current_level;
+        if (ctx->current_level <= core[core_idx].threshold_criticality) {
+            switch_to_virtual_deadlines (core[core_idx].ready_queue);
+            switch_to_virtual_deadlines (core[core_idx].pending_queue);
+        }
+    }
+
+    return 1;
+}
+
+// Get task array index corresponding to the task number specified
+
+int get_task_array_index (Tasks *task_arr, int num_tasks, int task_no) {
+
+    int i = 0;     // Task array index
+
+    // For all tasks
+    for (i = 0; i < num_tasks; i++) {
+
+        // If task_no of task in array matches the given task_no
+        if (task_arr[i].task_no == task_no)
             break;
     }
 
@@ -615,272 +1219,360 @@ void update_sched_deadlines (RQ_HEAD *head, Tasks *task_arr, int num_tasks) {
     }
 }
 
-// RUN-TIME SCHEDULER LOOP
+// RUN-TIME SCHEDULER INITIALIZATION
 
-void run_scheduler_loop (Cores *core, int num_cores, Tasks *task_arr, int num_tasks, int hyperperiod, int max_criticality) {
+void initialize_scheduler (Sim_context *ctx) {
 
-    double timecount = -1.0 * TIME_GRANULARITY;    // Timer value 
-    double next_decision_point = 0.0;              // Next scheduler decision point at any given time = min {next decision points in all cores}
-    double min_arrival = hyperperiod;              // Time-instant at which the next job arrives
-    double next_arrival = 0.0;                     // Time-instant at which the next job of given task arrives
+    Cores *core = ctx->core;                       // Core structure array
     int core_idx = 0;                              // Index to traverse through core structure array
-    RQ_NODE *temp;                                 // Temporary node variable
-    int min_idx = 0; 
-    int i = 0;
-    
+    int deadline_type = VIRTUAL_DEADLINES;         // Initial ready queue order of a core (virtual deadlines below the EDF-VD threshold)
+
+    // Every simulation starts at the lowest criticality level
+    ctx->current_level = 1;
+
+    // The simulation spans num_hyperperiods super-hyperperiods (as many as fit the integer job arrival times)
+    ctx->end_time = (double) ctx->hyperperiod * ((ctx->config.num_hyperperiods > 1) ? ctx->config.num_hyperperiods : 1);
+    if (ctx->end_time > INT_MAX)
+        ctx->end_time = (double) ctx->hyperperiod * (INT_MAX / ctx->hyperperiod);
+
+    // No scheduling state is recorded for steady-state detection yet
+    ctx->num_steady_states = 0;
+    ctx->steady_state_found = 0;
+
     // INITITIALIZE RUNTIME SCHEDULER DATA STRUCTURES
 
-    // Create GLOBAL discarded queues (per criticality level) to store all low-criticality discarded jobs
-    RQ_HEAD *dhead [max_criticality - 1];
-    for (int i = 0; i < max_criticality - 1; i++)
-        dhead[i] = create_run_queue();
+    // Empty GLOBAL discarded queues (per criticality level) to store all low-criticality discarded jobs
+    for (int i = 0; i < ctx->max_criticality - 1; i++) {
+        ctx->dhead[i].size = 0;
+        ctx->dhead[i].num_staged = 0;
+    }
         
-    // Create a GLOBAL pending request queue to add the job arrivals of all SHUTDOWN cores
-    RQ_HEAD *prhead;
-    prhead = create_run_queue();
-
     // Initialize cores for scheduling
-    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-        core[core_idx].qhead = create_run_queue();                        // Create a LOCAL run queues for each core
-        core[core_idx].curr_exe_job = malloc (sizeof (Jobs));             // Allocate memory for currently executing job structure in each core
-        core[core_idx].curr_exe_job->task_no = IDLE_TASK_NO;              // Currently executing job initialized to IDLE for each core
+    for (core_idx = 0 ; core_idx < ctx->num_cores ; core_idx++) {
+        deadline_type = (ctx->current_level <= core[core_idx].threshold_criticality) ? VIRTUAL_DEADLINES : REAL_DEADLINES;
+        core[core_idx].ready_queue = create_ready_queue (deadline_type);  // Create a LOCAL ready queue for each core
+        core[core_idx].pending_queue = create_ready_queue (deadline_type); // Create a LOCAL pending request queue for each core (job arrivals while SHUTDOWN)
+        core[core_idx].idle_job.task_no = IDLE_TASK_NO;                   // IDLE job structure of each core
+        core[core_idx].curr_exe_job = &core[core_idx].idle_job;           // Currently executing job initialized to IDLE for each core
+        core[core_idx].preemptions = 0;                                   // Preemption count initialized to 0
+        core[core_idx].deferred_preemptions = 0;                          // Deferred preemption count initialized to 0
+        core[core_idx].overhead_time = 0.0;                               // Overhead charged to the core's jobs initialized to 0
         core[core_idx].decision_point = malloc (sizeof (Decision_point)); // Allocate memory for decision point structure in each core
-        core[core_idx].core_criticality = current_level;                  // Core criticality is initialized to current criticality level of the system
+        core[core_idx].core_criticality = ctx->current_level;             // Core criticality is initialized to current criticality level of the system
         core[core_idx].status = ACTIVE;                                   // Initialize core status as ACTIVE
         core[core_idx].wakeup_time = NA;                                  // Initialize core wakeup time to NA 
-        for (int i = 0; i < max_criticality; i++)                         // Initialize slack for all criticality levels to NA
+        core[core_idx].sleep_state = 0;                                   // Sleep state of the core (valid while SHUTDOWN)
+        core[core_idx].sleep_start = NA;                                  // Time at which the core was last SHUTDOWN
+        for (int i = 0; i < ctx->max_criticality; i++)                    // Initialize slack for all criticality levels to NA
             core[core_idx].slack_available[i] = NA;
         core[core_idx].idle_time = 0.0;                                   // Core idle time initialized to 0
+        core[core_idx].sleep_time = 0.0;                                  // Core sleep time initialized to 0
+        ctx->domain_sleep_time[core_idx] = 0.0;                           // Power domain sleep time initialized to 0 (at most one domain per core)
     }
 
-    // RUNTIME SCHEDULER
+    // No split task job is waiting for the release of its next portion
+    for (int s = 0; s < ctx->num_splits; s++)
+        ctx->split[s].migrating_job = NULL;
 
     // Initialize timecount to first decision point --> min {first decision points in all cores}
-    timecount = get_next_decision_point (core, num_cores, task_arr, num_tasks, timecount, hyperperiod);
-    printf (" Timecount initialized to %lf\n", timecount);
-    
-    // Scheduler loop - executes at every decision point
-    while (timecount < hyperperiod) { 
-    
-        // printf ("\n Running scheduler loop for timecount %lf\n", timecount);
+    ctx->timecount = get_next_decision_point (ctx, -1.0 * TIME_GRANULARITY);
+    SCHED_PRINT (ctx, " Timecount initialized to %lf\n", ctx->timecount);
+}
+
+// RUN-TIME SCHEDULER STEP -- executes the scheduler at the current decision point and advances timecount to the next decision point
+// Returns 0 once the simulation has reached its end (num_hyperperiods super-hyperperiods)
+
+int scheduler_step (Sim_context *ctx) {
+
+    Cores *core = ctx->core;                       // Core structure array
+    Tasks *task_arr = ctx->tasks_arr;              // Task structure array
+    int num_cores = ctx->num_cores;                // Number of cores (allocated)
+    int num_tasks = ctx->num_tasks;                // Number of tasks
+    double end_time = ctx->end_time;               // End of the simulation
+    double timecount = ctx->timecount;             // Timer value (current decision point)
+    double next_decision_point = 0.0;              // Next scheduler decision point at any given time = min {next decision points in all cores}
+    double min_arrival = end_time;                 // Time-instant at which the next job arrives
+    double next_arrival = 0.0;                     // Time-instant at which the next job of given task arrives
+    double min_deadline = 0.0;                     // Earliest absolute deadline among the next jobs (split task portions) to arrive
+    double min_slack = 0.0;                        // Procrastination interval of an idle core (minimum slack over the criticality levels)
+    double wakeup_time = 0.0;                      // Wakeup time of a core being SHUTDOWN
+    int sleep_state = 0;                           // Sleep state selected for an idle core (-1: no sleep state fits)
+    int slack_sleep_state = 0;                     // Sleep state fitting in the procrastination interval of an idle core
+    int core_idx = 0;                              // Index to traverse through core structure array
+    int i = 0;
+
+    // Simulation complete
+    if (timecount >= end_time)
+        return 0;
+
+    ctx->stats.decision_points++;
     
-        // PREEMPTION HANDLING
-        
-        // For all ACTIVE cores
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-            if (core[core_idx].status == ACTIVE) {
+    // printf ("\n Running scheduler loop for timecount %lf\n", timecount);
 
-                // Preempt the currently executing job if it has not yet completed executing (i.e. remaining execution time != 0), 
-                // by adding it back to the respective core's run queue
-                if (core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO  && core[core_idx].curr_exe_job->execution_time > 0) {
-                    core[core_idx].preempted_job = malloc (sizeof (Jobs));
-                    core[core_idx].curr_exe_job->status_flag = PREEMPTED;
-                    copy_job_structure (core[core_idx].preempted_job, core[core_idx].curr_exe_job);
+    // JOB TERMINATION -- release the jobs that completed executing at this decision point
+    // (a remaining execution time below the resolution of timecount is a rounding residue: the job would never advance the timer)
 
-                    // Run queue updation
-                    update_run_queue (core[core_idx].qhead, core[core_idx].preempted_job);
-                }
+    // For all ACTIVE cores
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+        if (core[core_idx].status == ACTIVE && core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO && timecount + core[core_idx].curr_exe_job->execution_time <= timecount) {
+
+            // A split task's job with execution time left waits for the release of its next portion (on another core)
+            if (core[core_idx].curr_exe_job->migrating_time > 0)
+                migrate_current_job (ctx, &core[core_idx]);
+            else {
+                trace_job_event (ctx, TRACE_EVENT_COMPLETE, core[core_idx].core_no, core[core_idx].curr_exe_job, timecount, 0);
+                release_current_job (&core[core_idx]);
             }
         }
+    }
 
-        // SCHEDULING DECISION POINTS
+    // CRITICALITY DE-ESCALATION -- at a system-wide idle instant, return to the lowest criticality level
+    // (before the jobs arriving at this instant are admitted, so that they are accepted in LO mode)
+    deescalate_at_idle_instant (ctx);
 
-        // JOB ARRIVAL -- RUN QUEUE UPDATION
+    // SCHEDULING DECISION POINTS
 
-        // For all cores        
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+    // JOB ARRIVAL -- RUN QUEUE UPDATION
 
-            // If the decision point occurred due to JOB ARRIVAL in an ACTIVE core, add ready jobs to that core's local run queue/discarded queue/pending request queue
-            if ((core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & JOB_ARRIVAL)) { 
-                add_ready_jobs ((&core[core_idx]), dhead, prhead, task_arr, num_tasks, timecount);
-            }
+    // For all cores        
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+
+        // If the decision point occurred due to JOB ARRIVAL in an ACTIVE core, add ready jobs to that core's local run queue/discarded queue/pending request queue
+        if ((core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & JOB_ARRIVAL)) { 
+            add_ready_jobs (ctx, (&core[core_idx]), timecount);
         }
+    }
 
-        // JOB TERMINATION -- DYNAMIC PROCRASTINATION + SHUTDOWN (w/o job migration)
+    // JOB TERMINATION -- DYNAMIC PROCRASTINATION + SHUTDOWN (w/o job migration)
 
-        // For all cores
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+    // For all cores
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
 
-            // If the decision point occurred due to JOB TERMINATION in an ACTIVE core, check if the core can SHUTDOWN / reduce its OPERATING FREQUENCY to save power
-            if (core[core_idx].status == ACTIVE /* FIXME: && (core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & JOB_TERMINATION) */) {     
-
-                // If the core's run queue is empty
-                if (core[core_idx].qhead->head_node == NULL) {
-
-                    // Anticipate the next job arrival
-                    for (i = 0 ; i < num_tasks ; i++) {
-                        if (task_arr[i].allocated_core == core[core_idx].core_no) {
-                            if (task_arr[i].criticality >= accept_above_criticality_level (current_level, core->threshold_criticality)) {
-                                next_arrival = get_next_job_arrival (task_arr, i, timecount);
-                                if (min_arrival > next_arrival) {
-                                    min_arrival = next_arrival;
-                                    min_idx = i; 
-                                }
-                            }
+        // If the decision point occurred due to JOB TERMINATION in an ACTIVE core, check if the core can SHUTDOWN / reduce its OPERATING FREQUENCY to save power
+        if (core[core_idx].status == ACTIVE /* FIXME: && (core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & JOB_TERMINATION) */) {     
+
+            // If the core is IDLE and its run queue is empty
+            if (core[core_idx].ready_queue->size == 0 && core[core_idx].curr_exe_job->task_no == IDLE_TASK_NO) {
+
+                // Anticipate the next job arrival and the earliest deadline among the next jobs (the procrastination horizon)
+                // (After a de-escalation, the first job to arrive need not be the one with the earliest deadline)
+                min_arrival = end_time;
+                min_deadline = end_time;
+                for (i = 0 ; i < num_tasks ; i++) {
+                    if (task_arr[i].allocated_core == core[core_idx].core_no) {
+                        if (task_arr[i].criticality >= accept_above_criticality_level (ctx->current_level, core[core_idx].threshold_criticality)) {
+                            next_arrival = get_next_job_arrival (task_arr, i, timecount);
+                            if (min_arrival > next_arrival)
+                                min_arrival = next_arrival;
+                            if (min_deadline > next_arrival + task_arr[i].deadline)
+                                min_deadline = next_arrival + task_arr[i].deadline;
                         }
                     }
+                }
 
-                    // If the next arrival is anticipated at/after (timecount + SHUTDOWN_THRESHOLD)
-                    // SHUTDOWN core till next arrival
-                    if (min_arrival >= (timecount + SHUTDOWN_THRESHOLD)) {
-                        core[core_idx].wakeup_time = min_arrival;
-                        core[core_idx].status = SHUTDOWN;
+                // Including the releases of the split task portions allocated to the core
+                for (int s = 0; s < ctx->num_splits; s++) {
+                    if (task_arr[ctx->split[s].task_idx].criticality < accept_above_criticality_level (ctx->current_level, core[core_idx].threshold_criticality))
+                        continue;
+                    for (int p = 0; p < ctx->split[s].num_portions; p++) {
+                        if (ctx->split[s].core_no[p] == core[core_idx].core_no) {
+                            next_arrival = get_next_portion_arrival (task_arr, ctx->split[s].task_idx, ctx->split[s].offset[p], timecount);
+                            if (min_arrival > next_arrival)
+                                min_arrival = next_arrival;
+                            if (min_deadline > next_arrival + ctx->split[s].window[p])
+                                min_deadline = next_arrival + ctx->split[s].window[p];
+                        }
                     }
+                }
 
-                    // If the next arrival is anticipated before (timecount + SHUTDOWN_THRESHOLD)
-                    // Calculate the amount of slack obtained by DYNAMICALLY PROCRASTINATING jobs arriving before next job's deadline
-                    else {                    
+                // Select the deepest sleep state whose break-even time fits in the idle interval till the next arrival
+                // (the core is SHUTDOWN till next arrival)
+                sleep_state = select_sleep_state (&ctx->config, core[core_idx].core_type, min_arrival - timecount);
+                wakeup_time = min_arrival;
 
-                        get_dynamic_procrastination_slack (core, core_idx, task_arr, num_tasks, min_arrival + task_arr[min_idx].deadline, max_criticality, current_level, hyperperiod, timecount);
+                // If the deepest sleep state does not fit before the next arrival
+                // Calculate the amount of slack obtained by DYNAMICALLY PROCRASTINATING jobs arriving before next job's deadline
+                if (sleep_state < ctx->config.num_sleep_states[core[core_idx].core_type] - 1) {
 
-                        // Check if the slack available in all criticality levels is equal to/exceeds the SHUTDOWN_THRESHOLD
-                        for (i = 0; i < max_criticality; i++) {
-                            if (core[core_idx].slack_available[i] < SHUTDOWN_THRESHOLD)
-                                break;
-                        }
+                    min_slack = get_procrastination_interval (ctx, core_idx, min_deadline, timecount);
 
-                        // If slack available in all criticality levels is equal to/exceeds the SHUTDOWN_THRESHOLD
-                        // SHUTDOWN core for the slack time calculated at current level (OR min?)
-                        if (i == max_criticality) {
-                            core[core_idx].wakeup_time = core[i].slack_available[current_level - 1];
-                            core[core_idx].status = SHUTDOWN;
-                        }
-                        // else {
-                            // JOB MIGRATION / DVFS / DISCARDED JOB SCHEDULING --- Set priority
-                        // }
+                    // If a deeper sleep state fits in the procrastination interval
+                    // SHUTDOWN core for the procrastination interval (both the sleep state and the wakeup time are taken from it)
+                    slack_sleep_state = select_sleep_state (&ctx->config, core[core_idx].core_type, min_slack);
+                    if (slack_sleep_state > sleep_state) {
+                        sleep_state = slack_sleep_state;
+                        wakeup_time = timecount + min_slack;
                     }
+                    // else {
+                        // JOB MIGRATION / DVFS / DISCARDED JOB SCHEDULING --- Set priority
+                    // }
                 }
 
-                // TODO: If not EMPTY?? --> DVFS?
+                if (sleep_state >= 0)
+                    shutdown_core (ctx, &core[core_idx], sleep_state, wakeup_time);
             }
+
+            // COORDINATED SHUTDOWN -- a core with work whose power domain is otherwise asleep procrastinates it (if enough slack is available)
+            // so that the idle windows of the cores of the domain line up
+            else if (ctx->config.shutdown_policy == SHUTDOWN_COORDINATED && is_power_domain_asleep (ctx, core_idx))
+                procrastinate_to_power_domain (ctx, core_idx, timecount);
+
+            // TODO: If not EMPTY?? --> DVFS?
         }
+    }
 
-        // JOB TERMINATION -- DISCARDED JOB SCHEDULING
+    // JOB TERMINATION -- DISCARDED JOB SCHEDULING
 
-        // Add discarded job to run queue for scheduling if enough slack is available for it to execute -- TODO: Load balancing for discarded job scheduling
+    // Add discarded job to run queue for scheduling if enough slack is available for it to execute -- TODO: Load balancing for discarded job scheduling
 
-        // For all cores
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+    // For all cores
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
 
-            // If the decision point occurred due to JOB TERMINATION in an ACTIVE core and the current level > 1, check if the core can accommodate a discarded job to improve runtime utilization
-            if (current_level > 1 && core[core_idx].status == ACTIVE && (core[core_idx].decision_point->decision_time == timecount) /*&& (core[core_idx].decision_point->event & JOB_TERMINATION)*/)  
-                schedule_discarded_job (core[core_idx].qhead, dhead, task_arr, num_tasks, core[core_idx].threshold_criticality, max_criticality, current_level, core[core_idx].core_no, hyperperiod, timecount);
-        }
-        
-        // CRITICALITY LEVEL, MODE CHANGE/JOB OVERRUN
+        // If the decision point occurred due to JOB TERMINATION in an ACTIVE core and there are discarded jobs, check if the core can accommodate a discarded job to improve runtime utilization
+        // (Discarded jobs remain after a de-escalation to the lowest criticality level)
+        if (has_discarded_jobs (ctx) && core[core_idx].status == ACTIVE && (core[core_idx].decision_point->decision_time == timecount) /*&& (core[core_idx].decision_point->event & JOB_TERMINATION)*/)  
+            schedule_discarded_job (ctx, core_idx, timecount);
+    }
+    
+    // CRITICALITY LEVEL, MODE CHANGE/JOB OVERRUN
+
+    // If decision event in any ACTIVE core is JOB BUDGET EXCEEDED, update system and all core criticalities
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+        if (core[core_idx].status == ACTIVE && (core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & JOB_WCET_EXCEEDED))
+            break;
+    } 
+    
+    if (core_idx < num_cores) {
+        ctx->current_level++;
+        ctx->stats.mode_changes++;
+        SCHED_PRINT (ctx, "\n Current level updated to %d\n\n", ctx->current_level);
+        trace_level_event (ctx, TRACE_EVENT_MODE_CHANGE, timecount);
 
-        // If decision event in any ACTIVE core is JOB BUDGET EXCEEDED, update system and all core criticalities
         for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-            if (core[core_idx].status == ACTIVE && (core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & JOB_WCET_EXCEEDED))
-                break;
-        } 
-        
-        if (core_idx < num_cores) {
-            current_level++;
-            printf("\n Current level updated to %d\n\n", current_level);
-
-            for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-                core[core_idx].core_criticality++;
-
-                // For cores in which criticality level change is triggered because of a job exceeding its wcet budget and NOT job overrun
-                // The currently executing job is handled as a preemption added back to the core's run queue
-                if (core[core_idx].status == ACTIVE && core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO && core[core_idx].curr_exe_job->execution_time == 0 && (core[core_idx].decision_point->event & JOB_WCET_EXCEEDED) && (core[core_idx].decision_point->decision_time == timecount)) {
-                    core[core_idx].curr_exe_job->status_flag = PREEMPTED;  
-                    core[core_idx].preempted_job = malloc (sizeof (Jobs));
-                    copy_job_structure (core[core_idx].preempted_job, core[core_idx].curr_exe_job);
-                    update_run_queue (core[core_idx].qhead, core[core_idx].preempted_job);
-                    core[core_idx].curr_exe_job->task_no = IDLE_TASK_NO;
-                }
-                
+            core[core_idx].core_criticality++;
+
+            // The currently executing job stays on the core (it is not added back to the run queue)
+            if (core[core_idx].status == ACTIVE && core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO) {
+
                 // For cores in which criticality level change is triggered because of a job overrunning its budget at its highest criticality level
-                // The currently executing job is simply discarded from the core's run queue
-                else if (core[core_idx].status == ACTIVE && (core[core_idx].decision_point->event & JOB_OVERRUN) && (core[core_idx].decision_point->decision_time == timecount)) 
-                    core[core_idx].curr_exe_job->task_no = IDLE_TASK_NO;
-                    
-                // Case 1: Criticality mode: LO 
-                //--> discard jobs with criticality < current criticality level of the system (after updation) from the run queue 
-                if (current_level <= core[core_idx].threshold_criticality) 
-                    discard_below_criticality_level (core[core_idx].qhead, dhead, current_level);
-
-                // Case 2: Criticality mode: HI 
-                // --> discard jobs with criticality <= threshold criticality from the run queue, 
-                //     update absolute deadlines for all jobs and reorder run queue as per updated deadlines
-                if (current_level > core[core_idx].threshold_criticality) {
-                    printf(" Criticality MODE updated to HI\n (All jobs will now be scheduled wrt their original deadlines)\n\n");
-                    discard_below_criticality_level (core[core_idx].qhead, dhead, (core[core_idx].threshold_criticality + 1));
-                    update_sched_deadlines (core[core_idx].qhead, task_arr, num_tasks);
-                    core[core_idx].qhead->head_node = merge_sort (core[core_idx].qhead->head_node);    // sort run queue
+                // The currently executing job is aborted
+                if ((core[core_idx].decision_point->event & JOB_OVERRUN) && (core[core_idx].decision_point->decision_time == timecount)) {
+                    trace_job_event (ctx, TRACE_EVENT_ABORT, core[core_idx].core_no, core[core_idx].curr_exe_job, timecount, 0);
+                    release_current_job (&core[core_idx]);
                 }
-            }
-        }
-        
-       // Handling job overruns (When the criticality level change event is triggered ONLY due to job overruns - no criticality level updation reqd)
-        else {
-            for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-                if (core[core_idx].status == ACTIVE && (core[core_idx].decision_point->event & JOB_OVERRUN) && (core[core_idx].decision_point->decision_time == timecount)) 
-                    core[core_idx].curr_exe_job->task_no = IDLE_TASK_NO;
-            }   
-        }
-        
-        // CORE WAKEUP
 
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-            if (core[core_idx].status == SHUTDOWN && (core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & WAKEUP_CORE)) {
-                core[core_idx].status = ACTIVE;
+                // If the currently executing job is below the acceptable criticality level, it is DISCARDED (added to the discarded queue of its criticality level)
+                else if (core[core_idx].curr_exe_job->job_criticality < accept_above_criticality_level (ctx->current_level, core[core_idx].threshold_criticality)) {
+                    core[core_idx].curr_exe_job->status_flag = PREEMPTED;
+                    trace_job_event (ctx, TRACE_EVENT_DISCARD, core[core_idx].core_no, core[core_idx].curr_exe_job, timecount, 0);
+                    discard_job (ctx, core[core_idx].curr_exe_job);
+                    core[core_idx].curr_exe_job = &core[core_idx].idle_job;
+                }
+
+                // In HI mode, the currently executing job is scheduled wrt its original deadline
+                else if (ctx->current_level > core[core_idx].threshold_criticality) 
+                    core[core_idx].curr_exe_job->sched_deadline = core[core_idx].curr_exe_job->real_deadline;
+            }
                 
-                // Copy pending request queue jobs to core run queue
-                temp = prhead->head_node;
-                while (temp != NULL) {
-                    if (temp->job->allocated_core == core[core_idx].core_no) {
-                        update_run_queue (core[core_idx].qhead, temp->job);
-                        delete_job_from_queue (prhead, temp->job);
-                    }
-                    temp = temp->next;
-                } 
+            // Case 1: Criticality mode: LO 
+            //--> discard jobs with criticality < current criticality level of the system (after updation) from the run queue 
+            if (ctx->current_level <= core[core_idx].threshold_criticality) {
+                discard_below_criticality_level (ctx, core[core_idx].ready_queue, ctx->current_level);
+                discard_below_criticality_level (ctx, core[core_idx].pending_queue, ctx->current_level);
             }
-        }
 
-        // SCHEDULE NEXT JOB
-        
-        // Schedule next job 
+            // Case 2: Criticality mode: HI 
+            // --> discard jobs with criticality <= threshold criticality from the run queue, 
+            //     switch the ready queue to the real (original) deadline order
+            if (ctx->current_level > core[core_idx].threshold_criticality) {
+                SCHED_PRINT (ctx, " Criticality MODE updated to HI\n (All jobs will now be scheduled wrt their original deadlines)\n\n");
+                discard_below_criticality_level (ctx, core[core_idx].ready_queue, (core[core_idx].threshold_criticality + 1));
+                switch_to_real_deadlines (core[core_idx].ready_queue);
+
+                // Same for the jobs waiting in the pending request queue of a SHUTDOWN core
+                discard_below_criticality_level (ctx, core[core_idx].pending_queue, (core[core_idx].threshold_criticality + 1));
+                switch_to_real_deadlines (core[core_idx].pending_queue);
+            }
+        }
+    }
+    
+   // Handling job overruns (When the criticality level change event is triggered ONLY due to job overruns - no criticality level updation reqd)
+    else {
         for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+            if (core[core_idx].status == ACTIVE && (core[core_idx].decision_point->event & JOB_OVERRUN) && (core[core_idx].decision_point->decision_time == timecount)) {
+                trace_job_event (ctx, TRACE_EVENT_ABORT, core[core_idx].core_no, core[core_idx].curr_exe_job, timecount, 0);
+                release_current_job (&core[core_idx]);
+            }
+        }   
+    }
+    
+    // CORE WAKEUP
 
-            // Schedule next job from run queue head 
-            core[core_idx].curr_exe_job = schedule_next_job (core[core_idx].qhead); 
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+        if (core[core_idx].status == SHUTDOWN && (core[core_idx].decision_point->decision_time == timecount) && (core[core_idx].decision_point->event & WAKEUP_CORE)) {
+            core[core_idx].status = ACTIVE;
+            trace_core_event (ctx, TRACE_EVENT_WAKEUP, &core[core_idx], timecount);
+            
+            // Merge the core's pending request queue jobs into its run queue
+            merge_pending_requests (&core[core_idx]);
         }
+    }
+
+    // SCHEDULE NEXT JOB
+    
+    // Schedule next job (preempting the currently executing job only if a job with an earlier deadline is ready)
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+        if (core[core_idx].status == ACTIVE)
+            dispatch_next_job (ctx, &core[core_idx]);
+    }
 /*
-        // Print allocated wcet budgets and randomly generated actual execution times  
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-            if (core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO) {
-                if (core[core_idx].curr_exe_job->status_flag == READY) 
-                    printf(" For task %d, job %d wcet: %d actual exe:%lf\n", core[core_idx].curr_exe_job->task_no, core[core_idx].curr_exe_job->job_no, core[core_idx].curr_exe_job->wcet_budget[current_level - 1], core[core_idx].curr_exe_job->execution_time);
-                else if (core[core_idx].curr_exe_job->status_flag == PREEMPTED)
-                    printf(" Preempted task %d, job %d continued with remaining wcet: %d and exe time: %lf\n", core[core_idx].curr_exe_job->task_no, core[core_idx].curr_exe_job->job_no, core[core_idx].curr_exe_job->wcet_budget[current_level - 1], core[core_idx].curr_exe_job->execution_time);
-            }
-        }     
+    // Print allocated wcet budgets and randomly generated actual execution times  
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+        if (core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO) {
+            if (core[core_idx].curr_exe_job->status_flag == READY) 
+                printf(" For task %d, job %d wcet: %d actual exe:%lf\n", core[core_idx].curr_exe_job->task_no, core[core_idx].curr_exe_job->job_no, core[core_idx].curr_exe_job->wcet_budget[ctx->current_level - 1], core[core_idx].curr_exe_job->execution_time);
+            else if (core[core_idx].curr_exe_job->status_flag == PREEMPTED)
+                printf(" Preempted task %d, job %d continued with remaining wcet: %d and exe time: %lf\n", core[core_idx].curr_exe_job->task_no, core[core_idx].curr_exe_job->job_no, core[core_idx].curr_exe_job->wcet_budget[ctx->current_level - 1], core[core_idx].curr_exe_job->execution_time);
+        }
+    }     
 */
-        // Calculate next decision point
-        next_decision_point = get_next_decision_point (core, num_cores, task_arr, num_tasks, timecount, hyperperiod);
-        
-        // Not required for schedule --- just to stop printing at timecount = hyperperiod
-        if (next_decision_point > hyperperiod)    
-            next_decision_point = hyperperiod;
+    // Calculate next decision point
+    next_decision_point = get_next_decision_point (ctx, timecount);
+    
+    // Not required for schedule --- just to stop printing at timecount = end of the simulation
+    if (next_decision_point > end_time)    
+        next_decision_point = end_time;
 
-        
-        // Update the wcet and actual execution times for the job
-        for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
-            if(core[core_idx].status == ACTIVE) {
-                if (core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO) {
-                    core[core_idx].curr_exe_job->execution_time = core[core_idx].curr_exe_job->execution_time - (next_decision_point - timecount);    
-                    for (int i = 0 ; i < MAX_LEVELS ; i++)   
-                        core[core_idx].curr_exe_job->wcet_budget[i] = core[core_idx].curr_exe_job->wcet_budget[i] - (next_decision_point - timecount); 
-                } 
-                else
-                    core[core_idx].idle_time = core[core_idx].idle_time + (next_decision_point - timecount);            
-            }
+    // Every super-hyperperiod boundary is a decision point (steady-state detection compares the scheduling states at the boundaries)
+    if (next_decision_point > (floor (timecount / ctx->hyperperiod) + 1) * ctx->hyperperiod)
+        next_decision_point = (floor (timecount / ctx->hyperperiod) + 1) * ctx->hyperperiod;
+
+    
+    // Update the wcet and actual execution times for the job
+    for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
+        if(core[core_idx].status == ACTIVE) {
+            if (core[core_idx].curr_exe_job->task_no != IDLE_TASK_NO) {
+                core[core_idx].curr_exe_job->execution_time = core[core_idx].curr_exe_job->execution_time - (next_decision_point - timecount);    
+                for (int i = 0 ; i < MAX_LEVELS ; i++)   
+                    core[core_idx].curr_exe_job->wcet_budget[i] = core[core_idx].curr_exe_job->wcet_budget[i] - (next_decision_point - timecount); 
+            } 
+            else
+                core[core_idx].idle_time = core[core_idx].idle_time + (next_decision_point - timecount);            
         }
-        
-        // Print schedule timecount to next decision point
+        else {
+            core[core_idx].sleep_time = core[core_idx].sleep_time + (next_decision_point - timecount);
+            ctx->stats.sleep_state_time[core[core_idx].core_type][core[core_idx].sleep_state] += next_decision_point - timecount;
+        }
+    }
+
+    // Sleep time of the power domains (all cores SHUTDOWN)
+    update_power_domain_sleep (ctx, next_decision_point - timecount);
+    
+    // Trace the schedule from timecount to next decision point
+    trace_schedule (ctx, timecount, next_decision_point);
+
+    // Print schedule timecount to next decision point
+    if (ctx->config.verbose) {
         printf(" Time: %lf to %lf \t", timecount, next_decision_point);
         for (core_idx = 0 ; core_idx < num_cores ; core_idx++) {
             
@@ -901,46 +1593,546 @@ void run_scheduler_loop (Cores *core, int num_cores, Tasks *task_arr, int num_ta
                 printf(" Core: %d POWERED DOWN \t\t", core[core_idx].core_no);
         }
         printf("\n");
-                
-        // Timecount = next decision point
-        timecount = next_decision_point;
     }
+            
+    // Timecount = next decision point
+    ctx->timecount = next_decision_point;
+
+    return (ctx->timecount < end_time);
+}
+
+// RUN-TIME SCHEDULER LOOP
+
+void run_scheduler_loop (Sim_context *ctx) {
+
+    // Initialize runtime scheduler data structures and the first decision point
+    initialize_scheduler (ctx);
+
+    // Scheduler loop - executes at every decision point (fast-forwarding a steady state at the super-hyperperiod boundaries)
+    // Pending runtime task changes are applied at a decision point before the scheduler executes at it (safe point)
+    while (1) {
+        apply_task_changes (ctx);
+        if (!scheduler_step (ctx))
+            break;
+        fast_forward_steady_state (ctx, ctx->end_time);
+    }
+
+    // Complete the schedule event stream (trace file, verifier)
+    finish_trace (ctx);
 }
 
+// Release all runtime scheduler data structures (run queues, discarded queues, pending request queues, core job structures)
+
+void free_scheduler (Sim_context *ctx) {
+
+    for (int i = 0; i < ctx->max_criticality - 1; i++)
+        free_discarded_queue (&ctx->dhead[i]);
+
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        free_ready_queue (ctx->core[core_idx].ready_queue);
+        free_ready_queue (ctx->core[core_idx].pending_queue);
+        release_current_job (&ctx->core[core_idx]);
+        free (ctx->core[core_idx].decision_point);
+        ctx->core[core_idx].ready_queue = NULL;
+        ctx->core[core_idx].pending_queue = NULL;
+        ctx->core[core_idx].curr_exe_job = NULL;
+        ctx->core[core_idx].decision_point = NULL;
+    }
+
+    for (int s = 0; s < ctx->num_splits; s++) {
+        free (ctx->split[s].migrating_job);
+        ctx->split[s].migrating_job = NULL;
+    }
+}
+
+// ------------------------------------
+// SPLIT TASK PORTIONS (MIGRATING JOBS)
+// ------------------------------------
+
+// Semi-partitioned allocation: the job of a split task executes its portions one after the other, each on its own core and within its own window
+// A job whose execution is not complete at the end of a portion waits (out of all queues) for the release of its next portion at the start of
+// the next window, where it is admitted on the next portion's core like a new job (ready/pending request/discarded queue)
+// Jobs completing within an earlier portion are not released again; the windows are consecutive, so a job has at most one live portion
+
+// Determine the next release time of a split task portion (released offset time units after each job arrival)
+
+double get_next_portion_arrival (Tasks *task_arr, int task_array_idx, int offset, double timecount) {
+    return get_next_job_arrival (task_arr, task_array_idx, timecount - offset) + offset;
+}
+
+// Determine the next release of a zero-laxity split task portion (all portions but the last) on the core, accepted at the current level
+// The core must be ACTIVE at this release, since the portion must start executing at once (end of the simulation if none)
+
+double get_next_zero_laxity_release (Sim_context *ctx, Cores *core, double timecount) {
+
+    Tasks *task_arr = ctx->tasks_arr;            // Task structure array
+    double min_release = ctx->end_time;          // Next zero-laxity portion release
+    double next_release = 0.0;                   // Next release of a portion
+
+    for (int s = 0; s < ctx->num_splits; s++) {
+        if (task_arr[ctx->split[s].task_idx].criticality < accept_above_criticality_level (ctx->current_level, core->threshold_criticality))
+            continue;
+
+        for (int p = 0; p < ctx->split[s].num_portions - 1; p++) {
+            if (ctx->split[s].core_no[p] == core->core_no) {
+                next_release = get_next_portion_arrival (task_arr, ctx->split[s].task_idx, ctx->split[s].offset[p], timecount);
+                if (min_release > next_release)
+                    min_release = next_release;
+            }
+        }
+    }
+
+    return min_release;
+}
+
+// Determine the earliest absolute deadline among the next jobs (split task portions) to arrive on the core, accepted at the current level
+// (end of the simulation if none)
+
+double get_next_arrival_deadline (Sim_context *ctx, Cores *core, double timecount) {
+
+    Tasks *task_arr = ctx->tasks_arr;            // Task structure array
+    double min_deadline = ctx->end_time;         // Earliest deadline among the next jobs
+    double next_arrival = 0.0;                   // Next arrival of a job (portion)
+
+    for (int i = 0; i < ctx->num_tasks; i++) {
+        if (task_arr[i].allocated_core == core->core_no && task_arr[i].criticality >= accept_above_criticality_level (ctx->current_level, core->threshold_criticality)) {
+            next_arrival = get_next_job_arrival (task_arr, i, timecount);
+            if (min_deadline > next_arrival + task_arr[i].deadline)
+                min_deadline = next_arrival + task_arr[i].deadline;
+        }
+    }
+
+    for (int s = 0; s < ctx->num_splits; s++) {
+        if (task_arr[ctx->split[s].task_idx].criticality < accept_above_criticality_level (ctx->current_level, core->threshold_criticality))
+            continue;
+
+        for (int p = 0; p < ctx->split[s].num_portions; p++) {
+            if (ctx->split[s].core_no[p] == core->core_no) {
+                next_arrival = get_next_portion_arrival (task_arr, ctx->split[s].task_idx, ctx->split[s].offset[p], timecount);
+                if (min_deadline > next_arrival + ctx->split[s].window[p])
+                    min_deadline = next_arrival + ctx->split[s].window[p];
+            }
+        }
+    }
+
+    return min_deadline;
+}
+
+// Set up a split task's job for the execution of the given portion on its core
+// All portions but the last execute at most their (fixed) budget, the last portion executes the rest of the job
+
+void start_job_portion (Sim_context *ctx, Split_task *split, Jobs *job, int portion, int threshold_criticality) {
+
+    Tasks *task = &ctx->tasks_arr[split->task_idx];                              // Split task
+    int c = task->criticality - 1;                                               // Index of the task's criticality level
+    double remaining_time = job->migrating_time;                                 // Actual execution time left for this and the later portions
+
+    // Execution time of the job not yet consumed (the whole job at its first portion)
+    if (job->execution_time > 0)
+        remaining_time = remaining_time + job->execution_time;
+
+    job->portion = portion;
+    job->status_flag = READY;
+    job->allocated_core = split->core_no[portion];
+    job->arrival_time = task->phase + job->job_no * task->period + split->offset[portion];
+
+    // Execution time within the portion (the rest migrates with the job)
+    if (portion < split->num_portions - 1 && remaining_time > split->budget[portion][0])
+        job->execution_time = split->budget[portion][0];
+    else
+        job->execution_time = remaining_time;
+    job->migrating_time = remaining_time - job->execution_time;
+
+    // Wcet budgets of the portion (at levels higher than the job criticality, the budget at the job criticality)
+    for (int k = 0; k < MAX_LEVELS; k++)
+        job->wcet_budget[k] = split->budget[portion][(k < c) ? k : c];
+
+    // Deadlines of the portion (end of its window)
+    job->real_deadline = job->arrival_time + split->window[portion];
+    job->virtual_deadline = job->arrival_time + split->virtual_window[portion];
+    if (ctx->current_level <= threshold_criticality)
+        job->sched_deadline = job->virtual_deadline;
+    else
+        job->sched_deadline = job->real_deadline;
+}
+
+// Create the job structure of a split task portion released at the given time (anticipated portion jobs of the slack calculation)
+
+Jobs *create_portion_job (Sim_context *ctx, Split_task *split, int portion, int threshold_criticality, int core_no, double release_time) {
+
+    Jobs *job;
+    job = create_job_structure (ctx, split->task_idx, threshold_criticality, core_no, release_time - split->offset[portion]);
+    start_job_portion (ctx, split, job, portion, threshold_criticality);
+
+    return job;
+}
+
+// Release the split task portions of the given core arriving at the current time
+// The first portion releases a new job; the later portions take over the job that completed its previous portion (if any)
+
+void release_split_portions (Sim_context *ctx, Cores *core, double timecount) {
+
+    Tasks *task_arr = ctx->tasks_arr;            // Task structure array
+    Split_task *split;                           // Split task
+    Jobs *job;                                   // Job released for the portion
+    double release_offset = 0.0;                 // Time elapsed since the first release of the portion
+    int task_idx = 0;                            // Task structure array index of the split task
+
+    // For all split task portions allocated to the core
+    for (int s = 0; s < ctx->num_splits; s++) {
+        split = &ctx->split[s];
+        task_idx = split->task_idx;
+
+        for (int p = 0; p < split->num_portions; p++) {
+
+            // If the portion release condition is satisfied
+            release_offset = timecount - task_arr[task_idx].phase - split->offset[p];
+            if (split->core_no[p] != core->core_no || release_offset < 0 || find_modulo (release_offset, task_arr[task_idx].period))
+                continue;
+
+            // First portion: new job arrival
+            if (p == 0)
+                job = create_job_structure (ctx, task_idx, core->threshold_criticality, core->core_no, timecount);
+
+            // Later portions: the job migrates from the core of its previous portion
+            else {
+                job = split->migrating_job;
+                split->migrating_job = NULL;
+
+                // The job completed (or was aborted/discarded) in an earlier portion
+                if (job == NULL)
+                    continue;
+
+                // The job did not complete its previous portion within the window (it missed the portion's deadline): it is dropped
+                if (job->job_no != (int)(release_offset / task_arr[task_idx].period) || job->portion != p - 1) {
+                    free (job);
+                    continue;
+                }
+
+                ctx->stats.migrations++;
+                SCHED_PRINT (ctx, " Task %d Job %d migrates to core %d (portion %d)\n", job->task_no, job->job_no, core->core_no, p + 1);
+                trace_instant (ctx, core->core_no, "Migration", "migration", ctx->timecount, job, "portion", p + 1);
+            }
+
+            start_job_portion (ctx, split, job, p, core->threshold_criticality);
+
+            // The migrated job reloads its context on the new core (reserved in the portion's window)
+            if (p > 0)
+                charge_job_overhead (ctx, core, job, ctx->config.migration_overhead);
+            admit_job (ctx, core, job);
+        }
+    }
+}
+
+// Hand over the completed portion of a split task's job executing on the core to its next portion (the core becomes IDLE)
+
+void migrate_current_job (Sim_context *ctx, Cores *core) {
+
+    Jobs *job = core->curr_exe_job;              // Job that completed its portion
+
+    trace_job_event (ctx, TRACE_EVENT_MIGRATE, core->core_no, job, ctx->timecount, 0);
+
+    // The portion completed after the end of its window (a discarded job executed in the slack)
+    // The next portion was released without it, so the job is dropped
+    if (ctx->timecount > job->real_deadline) {
+        release_current_job (core);
+        return;
+    }
+
+    for (int s = 0; s < ctx->num_splits; s++) {
+        if (ctx->tasks_arr[ctx->split[s].task_idx].task_no == job->task_no) {
+
+            // A job still waiting here missed the release of its next portion (it is dropped)
+            free (ctx->split[s].migrating_job);
+            ctx->split[s].migrating_job = job;
+            break;
+        }
+    }
+
+    core->curr_exe_job = &core->idle_job;
+}
+
+// ------------------------------
+// SLEEP STATES (BREAK-EVEN TIME)
+// ------------------------------
+
+// Each core type has a table of sleep states (C-states) ordered from the shallowest to the deepest. An idle core enters the deepest state
+// whose break-even time fits in its predicted idle interval (till the next arrival, or the procrastination interval if the slack allows a deeper state)
+// The wakeup time of a SHUTDOWN core is the time at which it executes again: the core starts leaving its state exit_latency earlier, which is
+// always possible since the break-even time covers the entry and exit latencies. So the wakeup times calculated from the slack are kept
+
+// Parse a sleep state table "name:entry_latency:exit_latency:break_even,..." (shallowest state first)
+// Returns the number of states, -1 if the table is malformed
+
+int parse_sleep_states (const char *spec, Sleep_state *states) {
+
+    const char *pos = spec;       // Current position in the table
+    char *end = NULL;             // End of the last number parsed
+    int num_states = 0;           // Number of states parsed
+    int len = 0;                  // Length of the state name
+
+    while (*pos != '\0') {
+
+        if (num_states == MAX_SLEEP_STATES) {
+            printf(" ERROR: At most %d sleep states can be defined per core type\n", MAX_SLEEP_STATES);
+            return -1;
+        }
+
+        // State name (up to the first ':')
+        for (len = 0; pos[len] != ':' && pos[len] != ',' && pos[len] != '\0'; len++);
+        if (len == 0 || len >= SLEEP_STATE_NAME_LENGTH || pos[len] != ':') {
+            printf(" ERROR: Malformed sleep state (%s): expected name:entry_latency:exit_latency:break_even\n", pos);
+            return -1;
+        }
+        memcpy (states[num_states].name, pos, len);
+        states[num_states].name[len] = '\0';
+        pos = pos + len + 1;
+
+        // Entry latency, exit latency and break-even time
+        states[num_states].entry_latency = strtod (pos, &end);
+        if (end != pos && *end == ':') {
+            pos = end + 1;
+            states[num_states].exit_latency = strtod (pos, &end);
+        }
+        if (end != pos && *end == ':') {
+            pos = end + 1;
+            states[num_states].break_even = strtod (pos, &end);
+        }
+        if (end == pos || (*end != ',' && *end != '\0')) {
+            printf(" ERROR: Malformed sleep state %s: expected name:entry_latency:exit_latency:break_even\n", states[num_states].name);
+            return -1;
+        }
+        pos = (*end == ',') ? end + 1 : end;
+
+        // The break-even time covers the transitions, deeper states break even later
+        if (states[num_states].entry_latency < 0 || states[num_states].exit_latency < 0 || states[num_states].break_even <= 0 ||
+            states[num_states].break_even < states[num_states].entry_latency + states[num_states].exit_latency) {
+            printf(" ERROR: Sleep state %s: latencies must be non-negative and the break-even time positive, >= entry + exit latency\n", states[num_states].name);
+            return -1;
+        }
+        if (num_states > 0 && states[num_states].break_even <= states[num_states - 1].break_even) {
+            printf(" ERROR: Sleep state %s: the states must be listed by increasing break-even time\n", states[num_states].name);
+            return -1;
+        }
+
+        num_states++;
+    }
+
+    if (num_states == 0) {
+        printf(" ERROR: Empty sleep state table\n");
+        return -1;
+    }
+
+    return num_states;
+}
+
+// Install the default sleep state (break-even SHUTDOWN_THRESHOLD, no latencies) for the core types without a sleep state table
+
+void initialize_sleep_states (Sim_config *config) {
+
+    for (int type = 0; type < NUM_CORE_TYPES; type++) {
+        if (config->num_sleep_states[type] > 0)
+            continue;
+        strcpy (config->sleep_states[type][0].name, "SHUTDOWN");
+        config->sleep_states[type][0].entry_latency = 0.0;
+        config->sleep_states[type][0].exit_latency = 0.0;
+        config->sleep_states[type][0].break_even = SHUTDOWN_THRESHOLD;
+        config->num_sleep_states[type] = 1;
+    }
+}
+
+// Get the procrastination interval of a core: the slack obtained by procrastinating its jobs (ready + anticipated arrivals before the horizon),
+// minimum over all criticality levels (>= current level) and up to the next zero-laxity portion release
+// The sleep state of the core and its wakeup time are both derived from this interval
+
+double get_procrastination_interval (Sim_context *ctx, int core_idx, double horizon, double timecount) {
+
+    Cores *core = &ctx->core[core_idx];        // Core structure
+    double min_slack = 0.0;                    // Minimum slack over the criticality levels
+
+    get_dynamic_procrastination_slack (ctx, core_idx, horizon, timecount);
+
+    // (slack_available[i] is the slack at level current level + i)
+    min_slack = get_next_zero_laxity_release (ctx, core, timecount) - timecount;
+    for (int i = 0; i < ctx->max_criticality - ctx->current_level + 1; i++) {
+        if (core->slack_available[i] < min_slack)
+            min_slack = core->slack_available[i];
+    }
+    trace_slack (ctx, core->core_no, "Procrastination slack", core->slack_available, timecount);
+
+    return min_slack;
+}
+
+// Select the deepest sleep state of the core type whose break-even time fits in the idle interval, returns -1 if none fits
+
+int select_sleep_state (Sim_config *config, int core_type, double interval) {
+
+    for (int state = config->num_sleep_states[core_type] - 1; state >= 0; state--) {
+        if (interval >= config->sleep_states[core_type][state].break_even)
+            return state;
+    }
+
+    return -1;
+}
+
+// SHUTDOWN the core in the given sleep state, the core executes again from the wakeup time
+
+void shutdown_core (Sim_context *ctx, Cores *core, int state, double wakeup_time) {
+
+    core->wakeup_time = wakeup_time;
+    core->status = SHUTDOWN;
+    core->sleep_state = state;
+    core->sleep_start = ctx->timecount;
+    ctx->stats.shutdowns++;
+    ctx->stats.sleep_state_entries[core->core_type][state]++;
+    trace_core_event (ctx, TRACE_EVENT_SHUTDOWN, core, ctx->timecount);
+}
+
+// Wake up a SHUTDOWN core as early as possible: once it has entered its sleep state, it needs exit_latency to execute again
+// Returns 1 if the core is ACTIVE at once
+
+int wake_up_core_early (Sim_context *ctx, Cores *core, double timecount) {
+
+    Sleep_state *state = &ctx->config.sleep_states[core->core_type][core->sleep_state];    // Sleep state of the core
+    double active_time = core->sleep_start + state->entry_latency;                           // Earliest time at which the core can start leaving its state
+
+    if (active_time < timecount)
+        active_time = timecount;
+    active_time = active_time + state->exit_latency;
+
+    if (active_time <= timecount) {
+        core->status = ACTIVE;
+        core->wakeup_time = NA;
+        trace_core_event (ctx, TRACE_EVENT_WAKEUP, core, timecount);
+        return 1;
+    }
+
+    if (active_time < core->wakeup_time)
+        core->wakeup_time = active_time;
+
+    return 0;
+}
+
+// ------------------------------------
+// COORDINATED SHUTDOWN (POWER DOMAINS)
+// ------------------------------------
+
+// The cores are grouped into power domains (clusters) of domain_size consecutive cores, a domain only sleeps when all its cores are SHUTDOWN
+// Cores decide to SHUTDOWN independently in their own idle gaps, which rarely overlap. In coordinated mode, a core that still has work while
+// all the other cores of its domain are SHUTDOWN procrastinates this work (dynamic procrastination slack of its ready jobs) and sleeps as well,
+// shifting its execution after the domain's sleep interval
+
+// Get the power domain of a core
+
+int get_power_domain (Sim_context *ctx, int core_idx) {
+    return core_idx / ((ctx->config.domain_size > 0) ? ctx->config.domain_size : 1);
+}
+
+// Check if all the other cores of the core's power domain are SHUTDOWN (0 if the core is alone in its domain)
+
+int is_power_domain_asleep (Sim_context *ctx, int core_idx) {
+
+    int domain = get_power_domain (ctx, core_idx);     // Power domain of the core
+    int others = 0;                                    // Number of other cores in the domain
+
+    for (int j = 0; j < ctx->num_cores; j++) {
+        if (j == core_idx || get_power_domain (ctx, j) != domain)
+            continue;
+        if (ctx->core[j].status != SHUTDOWN)
+            return 0;
+        others++;
+    }
+
+    return (others > 0);
+}
+
+// Procrastinate the work of a core (running job and ready jobs) and SHUTDOWN the core, if the slack of its earliest deadline job
+// at all criticality levels (>= current level) fits one of its sleep states
+// The running job is preempted (it waits in the ready queue), the core wakes up when the minimum slack elapses (or at the next zero-laxity portion release)
+// Returns 1 if the core was SHUTDOWN
+
+int procrastinate_to_power_domain (Sim_context *ctx, int core_idx, double timecount) {
+
+    Cores *core = &ctx->core[core_idx];           // Core structure
+    Jobs *running_job = core->curr_exe_job;       // Job currently executing on the core
+    Jobs *next_job = NULL;                        // Earliest deadline ready job
+    double horizon = 0.0;                         // Deadline of the earliest deadline job of the core (ready or anticipated)
+    double min_slack = 0.0;                       // Procrastination interval (minimum slack over the criticality levels)
+    double wakeup_time = 0.0;                     // Wakeup time of the core
+    int sleep_state = 0;                          // Sleep state of the core
+
+    // The running job is not preempted inside its non-preemptive region (limited-preemptive mode)
+    if (running_job->task_no != IDLE_TASK_NO && running_job->npr_end != NA && timecount < running_job->npr_end)
+        return 0;
+
+    // Earliest deadline among the running job, the ready jobs and the next jobs to arrive
+    // (a job arriving while the core sleeps may have an earlier deadline than the jobs it holds)
+    horizon = get_next_arrival_deadline (ctx, core, timecount);
+    next_job = peek_ready_job (core->ready_queue);
+    if (next_job != NULL && next_job->sched_deadline < horizon)
+        horizon = next_job->sched_deadline;
+    if (running_job->task_no != IDLE_TASK_NO && running_job->sched_deadline < horizon)
+        horizon = running_job->sched_deadline;
+
+    // Slack obtained by procrastinating all the jobs of the core (ready + anticipated arrivals)
+    min_slack = get_procrastination_interval (ctx, core_idx, horizon, timecount);
+
+    // Deepest sleep state whose break-even time fits in the procrastination interval, the core wakes up when the interval elapses
+    sleep_state = select_sleep_state (&ctx->config, core->core_type, min_slack);
+    if (sleep_state < 0)
+        return 0;
+    wakeup_time = timecount + min_slack;
+
+    // The running job waits in the ready queue till the core wakes up
+    if (running_job->task_no != IDLE_TASK_NO) {
+        running_job->status_flag = PREEMPTED;
+        running_job->npr_end = NA;
+        add_ready_job (core->ready_queue, running_job);
+        core->curr_exe_job = &core->idle_job;
+        core->preemptions++;
+        ctx->stats.preemptions++;
+        charge_job_overhead (ctx, core, running_job, ctx->config.preemption_overhead);
+    }
+
+    SCHED_PRINT (ctx, " Core %d procrastinates its jobs till %lf (power domain %d asleep)\n", core->core_no, wakeup_time, get_power_domain (ctx, core_idx) + 1);
+    shutdown_core (ctx, core, sleep_state, wakeup_time);
+    ctx->stats.coordinated_shutdowns++;
+
+    return 1;
+}
+
+// Add the interval to the sleep time of the power domains whose cores are all SHUTDOWN
+
+void update_power_domain_sleep (Sim_context *ctx, double interval) {
+
+    int domain_size = (ctx->config.domain_size > 0) ? ctx->config.domain_size : 1;     // Number of cores per power domain
+    int asleep = 0;                                                                     // Set if all the cores of the domain are SHUTDOWN
+
+    for (int first = 0; first < ctx->num_cores; first = first + domain_size) {
+        asleep = 1;
+        for (int j = first; j < first + domain_size && j < ctx->num_cores; j++) {
+            if (ctx->core[j].status != SHUTDOWN)
+                asleep = 0;
+        }
+        if (asleep)
+            ctx->domain_sleep_time[first / domain_size] = ctx->domain_sleep_time[first / domain_size] + interval;
+    }
+}
 
 // -----------------
 // HELPER FUNCTIONS
 // -----------------
 
 // Helper function to find the modulo of two floating point numbers
+// (exact remainder in constant time: the simulated time grows with the number of super-hyperperiods)
 
 double find_modulo (double a, double b) {
 
-    double a_modulo_b = 0.0;     // (a % b) result
-    
-    // Initialize (a % b) to magnitude of a
-    if (a < 0.0)
-        a_modulo_b = -a;
-    else
-        a_modulo_b =  a;
-
-    // If b is negative, negate again to get magnitude
-    if (b < 0.0)
-        b = -b;
-
     if (b == 0.0)
         return 0.0;
 
-    // Find a_modulo_b by subtracting b repeatedly till the remainder is < b
-    while (a_modulo_b >= b && b != 0.0)
-        a_modulo_b = a_modulo_b - b;
- 
-    // Sign of modulo is same as sign of a (convention)
-    if (a < 0)
-        return -a_modulo_b;
-
-    // Return (a % b)
-    return a_modulo_b;
+    // Sign of modulo is same as sign of a (convention, as fmod)
+    return fmod (a, b);
 }
 
 // Helper function to print run queue
@@ -960,6 +2152,50 @@ void print_run_queue (RQ_HEAD *head) {
     }
 } 
 
+// Helper function to print the sleep time of each core, power domain and sleep state
+
+void print_sleep_times (Sim_context *ctx, Sim_stats *stats) {
+
+    Sim_config *config = &ctx->config;     // Simulation configuration (sleep states)
+
+    printf("\n Sleep time (SHUTDOWN) per core:\n");
+    for (int i = 0; i < stats->num_cores; i++)
+        printf(" Core %d: %.2lf\n", ctx->core[i].core_no, stats->sleep_time[i]);
+
+    printf(" Sleep time per power domain (all cores SHUTDOWN):\n");
+    for (int d = 0; d < stats->num_domains; d++)
+        printf(" Domain %d: %.2lf\n", d + 1, stats->domain_sleep_time[d]);
+
+    printf(" Coordinated shutdowns: %d\n", stats->coordinated_shutdowns);
+
+    printf(" Sleep states (entries, time):\n");
+    for (int type = 0; type < NUM_CORE_TYPES; type++) {
+        for (int state = 0; state < config->num_sleep_states[type]; state++)
+            printf(" %s cores, %s: %d, %.2lf\n", (type == SHUTDOWNABLE) ? "SHUTDOWNABLE" : "NON-SHUTDOWNABLE", config->sleep_states[type][state].name,
+                   stats->sleep_state_entries[type][state], stats->sleep_state_time[type][state]);
+    }
+    printf("\n");
+}
+
+// Helper function to free a run queue (all its nodes and the job structures in them)
+
+void free_run_queue (RQ_HEAD *head) {
+
+    RQ_NODE *temp, *next;
+
+    if (head == NULL)
+        return;
+
+    temp = head->head_node;
+    while (temp != NULL) {
+        next = temp->next;
+        free (temp->job);
+        free (temp);
+        temp = next;
+    }
+    free (head);
+}
+
 // Helper function to copy job structure from source pointer to destination pointer
 
 void copy_job_structure (Jobs *dest, Jobs *src) {
@@ -969,6 +2205,8 @@ void copy_job_structure (Jobs *dest, Jobs *src) {
     dest->allocated_core = src->allocated_core;
     dest->arrival_time = src->arrival_time;
     dest->sched_deadline = src->sched_deadline;
+    dest->virtual_deadline = src->virtual_deadline;
+    dest->real_deadline = src->real_deadline;
     dest->execution_time = src->execution_time;
     for (int i = 0 ; i < MAX_LEVELS ; i++)
         dest->wcet_budget[i] = src->wcet_budget[i];
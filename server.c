@@ -0,0 +1,643 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "header.h"
+
+// ----------------------------------------------------------------------------------------------
+// SCHEDULING SERVER (long-running service answering allocation/simulation queries over a socket)
+// ----------------------------------------------------------------------------------------------
+
+// Protocol (Unix domain stream socket, native byte order and layout -- clients run on the same host):
+// request  = [Server_header: SERVER_MAGIC, request type, 0, payload length] [payload]
+// response = [Server_header: SERVER_MAGIC, request type, status, payload length] [payload, only if the status is SERVER_OK]
+// Any number of requests can be sent on a connection; a connection with a malformed header is closed
+// The connections are non-blocking: the bytes of each client's requests are collected in its own buffer as they arrive, and a request is
+// served once it is complete, so a client sending a partial request never holds up the others
+// The served taskset is kept as a task table updated by load/add/remove requests. Its allocation is computed at the first query after
+// a change and kept until the next change, and every simulation runs on a clone of the allocated context, so a query costs no
+// parsing, sorting or allocation (the last simulation summary is also kept, for repeated queries with the same parameters)
+
+// Receive exactly length bytes from the socket, returns -1 on error or if the peer closed the connection
+
+int receive_full (int fd, void *buffer, size_t length) {
+
+    char *pos = buffer;        // Next byte to receive
+    ssize_t received = 0;      // Number of bytes received by one call
+
+    while (length > 0) {
+        received = recv (fd, pos, length, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            return -1;
+        pos = pos + received;
+        length = length - received;
+    }
+    return 0;
+}
+
+// Wait until a (non-blocking) socket can take more bytes, returns -1 on error
+
+int wait_writable (int fd) {
+
+    struct pollfd pfd;         // Socket waited for
+
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    while (poll (&pfd, 1, -1) < 0) {
+        if (errno != EINTR)
+            return -1;
+    }
+    return (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) ? -1 : 0;
+}
+
+// Send exactly length bytes to the socket, returns -1 on error (a closed peer does not raise SIGPIPE)
+// (A full non-blocking socket is waited for, the responses are small)
+
+int send_full (int fd, const void *buffer, size_t length) {
+
+    const char *pos = buffer;  // Next byte to send
+    ssize_t sent = 0;          // Number of bytes sent by one call
+
+    while (length > 0) {
+        sent = send (fd, pos, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable (fd) == 0)
+            continue;
+        if (sent < 0)
+            return -1;
+        pos = pos + sent;
+        length = length - sent;
+    }
+    return 0;
+}
+
+// Send a message (header and payload) to the socket, in a single system call unless the socket buffer is full
+
+int send_message (int fd, Server_header *header, const void *payload) {
+
+    struct iovec iov[2];       // Header and payload
+    struct msghdr msg;         // Message of the sendmsg call
+    ssize_t sent = 0;          // Number of bytes sent by the sendmsg call
+    size_t header_size = sizeof (Server_header);
+
+    memset (&msg, 0, sizeof (msg));
+    iov[0].iov_base = header;
+    iov[0].iov_len = header_size;
+    iov[1].iov_base = (void *) payload;
+    iov[1].iov_len = header->length;
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (header->length > 0) ? 2 : 1;
+
+    do {
+        sent = sendmsg (fd, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && (errno == EINTR || ((errno == EAGAIN || errno == EWOULDBLOCK) && wait_writable (fd) == 0)));
+    if (sent < 0)
+        return -1;
+
+    // Complete a partial send
+    if ((size_t) sent < header_size) {
+        if (send_full (fd, (char *) header + sent, header_size - sent) < 0)
+            return -1;
+        sent = header_size;
+    }
+    if ((size_t) sent < header_size + header->length)
+        return send_full (fd, (const char *) payload + (sent - header_size), header_size + header->length - sent);
+
+    return 0;
+}
+
+// Check the parameters of a task record (same conditions as for the tasks of the input file), returns -1 if invalid
+
+int check_server_task (Server_task *task, int max_criticality) {
+
+    if (task->phase < 0 || task->period <= 0 || task->deadline <= 0)
+        return -1;
+    if (task->criticality < 1 || task->criticality > max_criticality)
+        return -1;
+
+    // Wcets must be positive and non-decreasing with criticality level
+    for (int j = 0; j < task->criticality; j++) {
+        if (task->wcet[j] <= 0 || (j > 0 && task->wcet[j] < task->wcet[j - 1]))
+            return -1;
+    }
+    return 0;
+}
+
+// Discard the allocation and simulation summary kept for the served taskset (when it changes)
+
+void invalidate_server_state (Server_state *server) {
+
+    eemcs_destroy (server->allocated);
+    server->allocated = NULL;
+    server->allocation_valid = 0;
+    server->summary_valid = 0;
+}
+
+// Build a taskset (task structure array and wcet arena, as parsed from an input file) from the task table of the server
+// Returns -1 if out of memory
+
+int build_server_taskset (Server_state *server, Taskset *taskset) {
+
+    Tasks *task;                  // Task being built
+    int *wcet_ptr;                // Next free slot in the wcet arena
+    int num_wcets = 0;            // Number of wcets of all tasks
+
+    memset (taskset, 0, sizeof (Taskset));
+    for (int i = 0; i < server->num_tasks; i++)
+        num_wcets = num_wcets + server->task[i].criticality;
+
+    taskset->tasks_arr = malloc (server->num_tasks * sizeof (Tasks));
+    taskset->wcet_arena = malloc (num_wcets * sizeof (int));
+    if (taskset->tasks_arr == NULL || taskset->wcet_arena == NULL) {
+        free_taskset (taskset);
+        return -1;
+    }
+    taskset->num_tasks = server->num_tasks;
+    taskset->max_criticality = server->max_criticality;
+    wcet_ptr = taskset->wcet_arena;
+
+    for (int i = 0; i < server->num_tasks; i++) {
+
+        task = &taskset->tasks_arr[i];
+        task->task_no = server->task_no[i];
+        task->phase = server->task[i].phase;
+        task->period = server->task[i].period;
+        task->deadline = server->task[i].deadline;
+        task->criticality = server->task[i].criticality;
+        task->allocated_core = NOT_ALLOCATED;
+        task->virtual_deadline = task->deadline;
+
+        task->wcet = wcet_ptr;
+        wcet_ptr = wcet_ptr + task->criticality;
+        for (int j = 0; j < task->criticality; j++) {
+            task->wcet[j] = server->task[i].wcet[j];
+            task->utilization[j] = (double)(task->wcet[j]) / (task->period);
+        }
+
+        // (Levels beyond the task's criticality level keep the utilization at its own level)
+        for (int j = task->criticality; j < taskset->max_criticality; j++)
+            task->utilization[j] = task->utilization[task->criticality - 1];
+    }
+
+    return 0;
+}
+
+// Allocate the served taskset (if not yet allocated since it last changed)
+// Returns SERVER_OK (also if the taskset cannot be scheduled: no cores allocated), or the error status
+
+int allocate_served_taskset (Server_state *server) {
+
+    Taskset taskset;              // Taskset built from the task table
+
+    if (server->allocation_valid)
+        return SERVER_OK;
+    if (server->num_tasks == 0)
+        return SERVER_ERROR_TASKSET;
+
+    if (build_server_taskset (server, &taskset) < 0)
+        return SERVER_ERROR_MEMORY;
+
+    server->allocated = eemcs_create (&server->config);
+    if (server->allocated == NULL) {
+        free_taskset (&taskset);
+        return SERVER_ERROR_MEMORY;
+    }
+    eemcs_load (server->allocated, &taskset);
+    eemcs_allocate (server->allocated);
+    server->allocation_valid = 1;
+
+    return SERVER_OK;
+}
+
+// Serve a load request: replace the served taskset (the request is rejected as a whole if any task is invalid)
+
+int serve_load (Server_state *server, int length) {
+
+    Server_taskset *taskset = (Server_taskset *) server->payload;                              // Taskset header
+    Server_task *task = (Server_task *) ((char *) server->payload + sizeof (Server_taskset));  // Task records
+
+    if (length < (int) sizeof (Server_taskset) || taskset->num_tasks <= 0 || taskset->num_tasks > SERVER_MAX_TASKS ||
+        length != (int) (sizeof (Server_taskset) + taskset->num_tasks * sizeof (Server_task)))
+        return SERVER_ERROR_REQUEST;
+    if (taskset->max_criticality < 1 || taskset->max_criticality > MAX_LEVELS)
+        return SERVER_ERROR_TASKSET;
+    for (int i = 0; i < taskset->num_tasks; i++) {
+        if (check_server_task (&task[i], taskset->max_criticality) < 0)
+            return SERVER_ERROR_TASKSET;
+    }
+
+    invalidate_server_state (server);
+    memcpy (server->task, task, taskset->num_tasks * sizeof (Server_task));
+    for (int i = 0; i < taskset->num_tasks; i++)
+        server->task_no[i] = i + 1;
+    server->num_tasks = taskset->num_tasks;
+    server->max_criticality = taskset->max_criticality;
+    server->next_task_no = taskset->num_tasks + 1;
+
+    return SERVER_OK;
+}
+
+// Serve an add task request: the task is appended to the served taskset with the next task number
+
+int serve_add_task (Server_state *server, int length, Server_update *update) {
+
+    Server_task *task = (Server_task *) server->payload;      // Added task
+
+    if (length != (int) sizeof (Server_task))
+        return SERVER_ERROR_REQUEST;
+    if (server->max_criticality == 0 || server->num_tasks >= SERVER_MAX_TASKS || check_server_task (task, server->max_criticality) < 0)
+        return SERVER_ERROR_TASKSET;
+
+    invalidate_server_state (server);
+    server->task[server->num_tasks] = *task;
+    server->task_no[server->num_tasks] = server->next_task_no++;
+    server->num_tasks++;
+
+    update->task_no = server->task_no[server->num_tasks - 1];
+    update->num_tasks = server->num_tasks;
+    return SERVER_OK;
+}
+
+// Serve a remove task request (the other tasks keep their task numbers and order)
+
+int serve_remove_task (Server_state *server, int length, Server_update *update) {
+
+    int task_no = 0;              // Task number of the removed task
+    int i = 0;
+
+    if (length != (int) sizeof (int))
+        return SERVER_ERROR_REQUEST;
+    memcpy (&task_no, server->payload, sizeof (int));
+
+    for (i = 0; i < server->num_tasks && server->task_no[i] != task_no; i++);
+    if (i == server->num_tasks)
+        return SERVER_ERROR_TASKSET;
+
+    invalidate_server_state (server);
+    memmove (&server->task[i], &server->task[i + 1], (server->num_tasks - i - 1) * sizeof (Server_task));
+    memmove (&server->task_no[i], &server->task_no[i + 1], (server->num_tasks - i - 1) * sizeof (int));
+    server->num_tasks--;
+
+    update->task_no = task_no;
+    update->num_tasks = server->num_tasks;
+    return SERVER_OK;
+}
+
+// Serve an allocation request ("can the taskset run on N cores?"): the optional core limit defaults to MAX_CORES
+
+int serve_allocate (Server_state *server, int length, Server_allocation *allocation) {
+
+    Sim_context *ctx;             // Allocated context of the served taskset
+    int core_limit = MAX_CORES;   // Core limit of the request
+    int status = 0;
+
+    if (length != 0 && length != (int) sizeof (int))
+        return SERVER_ERROR_REQUEST;
+    if (length != 0)
+        memcpy (&core_limit, server->payload, sizeof (int));
+    if (core_limit <= 0 || core_limit > MAX_CORES)
+        core_limit = MAX_CORES;
+
+    if ((status = allocate_served_taskset (server)) != SERVER_OK)
+        return status;
+
+    ctx = server->allocated;
+    memset (allocation, 0, sizeof (Server_allocation));
+    allocation->num_cores = ctx->num_cores;
+    allocation->fits = (ctx->num_cores > 0 && ctx->num_cores <= core_limit);
+    allocation->num_splits = ctx->num_splits;
+    allocation->hyperperiod = ctx->hyperperiod;
+    for (int i = 0; i < ctx->num_cores; i++) {
+        allocation->threshold_criticality[i] = ctx->core[i].threshold_criticality;
+        allocation->core_type[i] = ctx->core[i].core_type;
+        allocation->utilization[i] = ctx->core[i].utilization;
+    }
+
+    return SERVER_OK;
+}
+
+// Serve a simulation request: simulate a clone of the allocated context with the requested seed and number of super-hyperperiods
+
+int serve_simulate (Server_state *server, int length, Server_summary *summary) {
+
+    Server_simulation request;    // Simulation parameters
+    Sim_config config;            // Configuration of the simulation
+    Sim_context *ctx;             // Simulated context
+    Sim_stats stats;              // Simulation statistics
+    int status = 0;
+
+    if (length != (int) sizeof (Server_simulation))
+        return SERVER_ERROR_REQUEST;
+    memcpy (&request, server->payload, sizeof (Server_simulation));
+    if (request.num_hyperperiods < 0)
+        return SERVER_ERROR_REQUEST;
+
+    if ((status = allocate_served_taskset (server)) != SERVER_OK)
+        return status;
+    if (server->allocated->num_cores <= 0)
+        return SERVER_ERROR_UNSCHEDULABLE;
+
+    // Same simulation as the last one (the schedule is a pure function of the taskset, the configuration and the seed)
+    if (server->summary_valid && server->summary_request.seed == request.seed && server->summary_request.num_hyperperiods == request.num_hyperperiods) {
+        *summary = server->summary;
+        return SERVER_OK;
+    }
+
+    config = server->config;
+    config.seed = request.seed;
+    if (request.num_hyperperiods > 0)
+        config.num_hyperperiods = request.num_hyperperiods;
+
+    ctx = eemcs_clone (server->allocated, &config);
+    if (ctx == NULL)
+        return SERVER_ERROR_MEMORY;
+    eemcs_run (ctx);
+    eemcs_get_stats (ctx, &stats);
+
+    memset (summary, 0, sizeof (Server_summary));
+    summary->num_cores = stats.num_cores;
+    summary->hyperperiod = ctx->hyperperiod;
+    summary->decision_points = stats.decision_points;
+    summary->mode_changes = stats.mode_changes;
+    summary->deescalations = stats.deescalations;
+    summary->shutdowns = stats.shutdowns;
+    summary->preemptions = stats.preemptions;
+    summary->migrations = stats.migrations;
+    summary->timecount = stats.timecount;
+    for (int i = 0; i < stats.num_cores; i++) {
+        summary->total_idle_time = summary->total_idle_time + stats.idle_time[i];
+        summary->total_sleep_time = summary->total_sleep_time + stats.sleep_time[i];
+        summary->sleep_time[i] = stats.sleep_time[i];
+    }
+    eemcs_destroy (ctx);
+
+    server->summary = *summary;
+    server->summary_request = request;
+    server->summary_valid = 1;
+
+    return SERVER_OK;
+}
+
+// Serve the request received from a client (header and payload in the client's buffer)
+// Returns -1 if the connection must be closed (send error)
+
+int serve_request (Server_state *server, Server_client *client) {
+
+    Server_header header = client->header;    // Request header
+    Server_header reply;          // Response header
+    Server_update update;         // Response payloads
+    Server_allocation allocation;
+    Server_summary summary;
+    void *response = NULL;        // Response payload of the request
+    int response_length = 0;      // Size of the response payload
+
+    server->payload = client->payload;
+
+    reply.magic = SERVER_MAGIC;
+    reply.type = header.type;
+
+    switch (header.type) {
+        case SERVER_REQUEST_LOAD:
+            reply.status = serve_load (server, header.length);
+            break;
+        case SERVER_REQUEST_ADD_TASK:
+            reply.status = serve_add_task (server, header.length, &update);
+            response = &update;
+            response_length = sizeof (Server_update);
+            break;
+        case SERVER_REQUEST_REMOVE_TASK:
+            reply.status = serve_remove_task (server, header.length, &update);
+            response = &update;
+            response_length = sizeof (Server_update);
+            break;
+        case SERVER_REQUEST_ALLOCATE:
+            reply.status = serve_allocate (server, header.length, &allocation);
+            response = &allocation;
+            response_length = sizeof (Server_allocation);
+            break;
+        case SERVER_REQUEST_SIMULATE:
+            reply.status = serve_simulate (server, header.length, &summary);
+            response = &summary;
+            response_length = sizeof (Server_summary);
+            break;
+        case SERVER_REQUEST_STOP:
+            reply.status = SERVER_OK;
+            server->running = 0;
+            break;
+        default:
+            reply.status = SERVER_ERROR_REQUEST;
+            break;
+    }
+
+    // The payload is only sent with a successful response
+    reply.length = (reply.status == SERVER_OK) ? response_length : 0;
+
+    return send_message (client->fd, &reply, response);
+}
+
+// Receive the available bytes of a client's requests without blocking, and serve every request they complete
+// Returns -1 if the connection must be closed (closed by the client, malformed header or send error)
+
+int receive_requests (Server_state *server, Server_client *client) {
+
+    char *buffer;                 // Next byte of the request to receive
+    size_t missing = 0;           // Number of bytes missing in the header/payload being received
+    ssize_t received = 0;         // Number of bytes received by one call
+
+    while (server->running) {
+
+        // Header complete: check it, and serve the request once its payload is complete
+        if (client->received >= (int) sizeof (Server_header)) {
+            if (client->header.magic != SERVER_MAGIC || client->header.length < 0 || client->header.length > (int) sizeof (client->payload))
+                return -1;
+            if (client->received == (int) sizeof (Server_header) + client->header.length) {
+                client->received = 0;
+                if (serve_request (server, client) < 0)
+                    return -1;
+                continue;
+            }
+            buffer = (char *) client->payload + (client->received - sizeof (Server_header));
+            missing = sizeof (Server_header) + client->header.length - client->received;
+        }
+        else {
+            buffer = (char *) &client->header + client->received;
+            missing = sizeof (Server_header) - client->received;
+        }
+
+        received = recv (client->fd, buffer, missing, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+        if (received <= 0)
+            return -1;
+        client->received = client->received + received;
+    }
+
+    return 0;
+}
+
+// Run the scheduling server on the Unix domain socket at the given path until a stop request is served
+// Requests are served one at a time (in the order they are completed), so the served taskset is shared by all clients
+// Returns 0 after a stop request, -1 if the server could not be started
+
+int run_server (const char *path, Sim_config *config) {
+
+    Server_state *server;                             // Server state (task table, warm allocation)
+    struct sockaddr_un address;                       // Socket address
+    struct pollfd fds[SERVER_MAX_CLIENTS + 1];        // Server socket and connected clients
+    int fd = -1;                                      // Accepted connection
+    int slot = 0;                                     // Client slot of the accepted connection
+
+    if (strlen (path) >= sizeof (address.sun_path)) {
+        printf(" ERROR: Server socket path is too long (%s)\n", path);
+        return -1;
+    }
+
+    server = calloc (1, sizeof (Server_state));
+    if (server == NULL) {
+        printf(" ERROR: Could not allocate memory for the scheduling server\n");
+        return -1;
+    }
+
+    // The served contexts print nothing
+    server->config = *config;
+    server->config.verbose = 0;
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++)
+        server->client[i].fd = -1;
+
+    // Create the server socket (replacing a stale socket file left by an earlier server)
+    memset (&address, 0, sizeof (address));
+    address.sun_family = AF_UNIX;
+    strcpy (address.sun_path, path);
+    server->listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    if (server->listen_fd < 0) {
+        printf(" ERROR: Could not create the server socket\n");
+        free (server);
+        return -1;
+    }
+    unlink (path);
+    if (bind (server->listen_fd, (struct sockaddr *) &address, sizeof (address)) < 0 || listen (server->listen_fd, SERVER_LISTEN_BACKLOG) < 0) {
+        printf(" ERROR: Could not listen on the server socket (%s)\n", path);
+        close (server->listen_fd);
+        free (server);
+        return -1;
+    }
+
+    printf(" Scheduling server listening on %s\n", path);
+    fflush (stdout);
+
+    server->running = 1;
+    while (server->running) {
+
+        fds[0].fd = server->listen_fd;
+        fds[0].events = POLLIN;
+        for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+            fds[i + 1].fd = server->client[i].fd;     // (Negative descriptors are ignored by poll)
+            fds[i + 1].events = POLLIN;
+            fds[i + 1].revents = 0;
+        }
+
+        if (poll (fds, SERVER_MAX_CLIENTS + 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            printf(" ERROR: Could not wait for the server socket\n");
+            break;
+        }
+
+        // Accept a new client (closed at once if all client slots are in use or it cannot be made non-blocking)
+        if (fds[0].revents & POLLIN) {
+            fd = accept (server->listen_fd, NULL, NULL);
+            if (fd >= 0) {
+                for (slot = 0; slot < SERVER_MAX_CLIENTS && server->client[slot].fd >= 0; slot++);
+                if (slot < SERVER_MAX_CLIENTS && fcntl (fd, F_SETFL, fcntl (fd, F_GETFL) | O_NONBLOCK) == 0) {
+                    server->client[slot].fd = fd;
+                    server->client[slot].received = 0;
+                }
+                else
+                    close (fd);
+            }
+        }
+
+        // Receive the available bytes of every readable client, and serve the requests they complete
+        for (int i = 0; i < SERVER_MAX_CLIENTS && server->running; i++) {
+            if (fds[i + 1].fd >= 0 && (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) && receive_requests (server, &server->client[i]) < 0) {
+                close (server->client[i].fd);
+                server->client[i].fd = -1;
+            }
+        }
+    }
+
+    // Close all connections and remove the socket file
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (server->client[i].fd >= 0)
+            close (server->client[i].fd);
+    }
+    close (server->listen_fd);
+    unlink (path);
+
+    invalidate_server_state (server);
+    free (server);
+    return 0;
+}
+
+// -------------------------------------
+// SCHEDULING SERVER CLIENT (SAME HOST)
+// -------------------------------------
+
+// Connect to the scheduling server at the given socket path, returns the connection's descriptor (-1 on error)
+
+int connect_server (const char *path) {
+
+    struct sockaddr_un address;   // Socket address
+    int fd = -1;
+
+    if (strlen (path) >= sizeof (address.sun_path))
+        return -1;
+
+    memset (&address, 0, sizeof (address));
+    address.sun_family = AF_UNIX;
+    strcpy (address.sun_path, path);
+
+    fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    if (connect (fd, (struct sockaddr *) &address, sizeof (address)) < 0) {
+        close (fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send a request to the scheduling server and receive its response (payload of at most response_size bytes, into response)
+// Returns the response status, or SERVER_ERROR_IO if the request could not be sent or the response is malformed
+
+int server_request (int fd, int type, const void *payload, int length, void *response, int response_size) {
+
+    Server_header header;         // Request header
+    Server_header reply;          // Response header
+
+    header.magic = SERVER_MAGIC;
+    header.type = type;
+    header.status = 0;
+    header.length = length;
+
+    if (send_message (fd, &header, payload) < 0 || receive_full (fd, &reply, sizeof (Server_header)) < 0)
+        return SERVER_ERROR_IO;
+    if (reply.magic != SERVER_MAGIC || reply.type != type || reply.length < 0 || reply.length > response_size)
+        return SERVER_ERROR_IO;
+    if (reply.length > 0 && receive_full (fd, response, reply.length) < 0)
+        return SERVER_ERROR_IO;
+
+    return reply.status;
+}
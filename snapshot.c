@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "header.h"
+
+// ---------------------------------------------------------------------------------
+// PREPROCESSED TASKSET SNAPSHOT (sorted task table + allocation + EDF-VD parameters)
+// ---------------------------------------------------------------------------------
+
+// Snapshot file layout (native byte order):
+// [Snapshot_header] [num_tasks x Snapshot_task] [num_cores x Snapshot_core]
+// The snapshot is bound to the exact bytes of the taskset in the input file (FNV-1a checksum over its byte range)
+// and to the compile-time system constraints, so a stale snapshot is never used
+
+// Compute FNV-1a checksum of the given byte range of the input file, and count the number of lines in it
+
+unsigned long long get_source_checksum (Taskset_file *file, size_t start, size_t end, int *line_count) {
+
+    unsigned long long checksum = 14695981039346656037ULL;    // FNV-1a 64-bit offset basis
+    int lines = 0;
+
+    for (size_t i = start; i < end; i++) {
+        checksum = (checksum ^ (unsigned char) file->data[i]) * 1099511628211ULL;
+        if (file->data[i] == '\n')
+            lines++;
+    }
+
+    *line_count = lines;
+    return checksum;
+}
+
+// Fill a snapshot header with the format constants and compile-time system constraints
+
+void initialize_snapshot_header (Snapshot_header *header) {
+
+    memset (header, 0, sizeof (Snapshot_header));
+    memcpy (header->magic, SNAPSHOT_MAGIC, sizeof (header->magic));
+    header->version = SNAPSHOT_VERSION;
+    header->header_size = sizeof (Snapshot_header);
+    header->task_record_size = sizeof (Snapshot_task);
+    header->core_record_size = sizeof (Snapshot_core);
+    header->max_cores = MAX_CORES;
+    header->max_tasks = MAX_TASKS;
+    header->max_levels = MAX_LEVELS;
+    header->lpd_threshold = LPD_THRESHOLD;
+}
+
+// Write the preprocessed taskset (after sorting and allocation) to a snapshot file
+// The snapshot is written to a temporary file and renamed, so readers never see a partially written snapshot
+
+int write_snapshot (const char *path, Taskset_file *file, Taskset *taskset, Cores *core, int num_cores, int hyperperiod) {
+
+    Snapshot_header header;        // Snapshot file header
+    Snapshot_task task_record;     // Task record
+    Snapshot_core core_record;     // Core record
+    char temp_path[4096];          // Temporary file path
+    FILE *fptr;                    // Snapshot file pointer
+    Tasks *task;
+    int written = 1;               // Set to 0 if any of the writes fails
+
+    // Snapshot header
+    initialize_snapshot_header (&header);
+    header.num_tasks = taskset->num_tasks;
+    header.max_criticality = taskset->max_criticality;
+    header.num_cores = num_cores;
+    header.hyperperiod = hyperperiod;
+    header.source_start = taskset->source_start;
+    header.source_end = taskset->source_end;
+    header.source_checksum = get_source_checksum (file, taskset->source_start, taskset->source_end, &header.source_lines);
+
+    snprintf (temp_path, sizeof (temp_path), "%s.tmp", path);
+    fptr = fopen (temp_path, "wb");
+    if (fptr == NULL) {
+        printf(" ERROR: Could not create the snapshot file (%s)\n", path);
+        return -1;
+    }
+
+    written = written && (fwrite (&header, sizeof (header), 1, fptr) == 1);
+
+    // Task records (in sorted order)
+    for (int i = 0; i < taskset->num_tasks && written; i++) {
+        task = &taskset->tasks_arr[i];
+        memset (&task_record, 0, sizeof (task_record));
+        task_record.task_no = task->task_no;
+        task_record.phase = task->phase;
+        task_record.period = task->period;
+        task_record.deadline = task->deadline;
+        task_record.criticality = task->criticality;
+        task_record.allocated_core = task->allocated_core;
+        task_record.virtual_deadline = task->virtual_deadline;
+        for (int j = 0; j < task->criticality; j++)
+            task_record.wcet[j] = task->wcet[j];
+        for (int j = 0; j < MAX_LEVELS; j++)
+            task_record.utilization[j] = task->utilization[j];
+        written = (fwrite (&task_record, sizeof (task_record), 1, fptr) == 1);
+    }
+
+    // Core records (allocation, threshold criticalities)
+    for (int i = 0; i < num_cores && written; i++) {
+        memset (&core_record, 0, sizeof (core_record));
+        core_record.core_no = core[i].core_no;
+        core_record.tasks_alloc_count = core[i].tasks_alloc_count;
+        core_record.threshold_criticality = core[i].threshold_criticality;
+        core_record.core_type = core[i].core_type;
+        core_record.utilization = core[i].utilization;
+        core_record.remaining_capacity = core[i].remaining_capacity;
+        core_record.operating_frequency = core[i].operating_frequency;
+        for (int j = 0; j < core[i].tasks_alloc_count; j++)
+            core_record.tasks_alloc_ids[j] = core[i].tasks_alloc_ids[j];
+        written = (fwrite (&core_record, sizeof (core_record), 1, fptr) == 1);
+    }
+
+    if (fclose (fptr) != 0)
+        written = 0;
+
+    if (!written || rename (temp_path, path) != 0) {
+        printf(" ERROR: Could not write the snapshot file (%s)\n", path);
+        unlink (temp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+// Check the task and core records of a snapshot with the value checks of the parser (criticality levels, phase, period, deadline,
+// wcets) and the consistency of the stored EDF-VD parameters (utilizations, virtual deadlines), and check that every task is listed
+// exactly once, by the core it is allocated to, so that a corrupt snapshot cannot index outside the task and core structures
+// Returns 1 if all records are valid
+
+int check_snapshot_records (Snapshot_header *header, Snapshot_task *task_record, Snapshot_core *core_record) {
+
+    Snapshot_task *task;       // Task record being checked
+    int *listed;               // Core listing each task number (0: not listed yet)
+    int listed_count = 0;      // Number of task numbers listed by the cores
+    int valid = 1;             // Cleared at the first invalid record
+    double utilization = 0;    // Utilization expected from the task's wcet
+    int task_no = 0;           // Task number listed by a core
+
+    if (header->max_criticality < 1 || header->max_criticality > MAX_LEVELS || header->hyperperiod <= 0)
+        return 0;
+
+    for (int i = 0; i < header->num_tasks; i++) {
+        task = &task_record[i];
+        if (task->task_no < 1 || task->task_no > header->num_tasks || task->phase < 0 || task->period <= 0 || task->deadline <= 0 ||
+            task->criticality < 1 || task->criticality > header->max_criticality ||
+            task->allocated_core < 1 || task->allocated_core > header->num_cores ||
+            !(task->virtual_deadline > 0 && task->virtual_deadline <= task->deadline))
+            return 0;
+        for (int j = 0; j < header->max_criticality; j++) {
+            if (j < task->criticality && (task->wcet[j] <= 0 || (j > 0 && task->wcet[j] < task->wcet[j - 1])))
+                return 0;
+            utilization = (double)(task->wcet[(j < task->criticality) ? j : task->criticality - 1]) / task->period;
+            if (!(task->utilization[j] > utilization - SNAPSHOT_TOLERANCE && task->utilization[j] < utilization + SNAPSHOT_TOLERANCE))
+                return 0;
+        }
+    }
+
+    listed = calloc (header->num_tasks, sizeof (int));
+    if (listed == NULL)
+        return 0;
+
+    for (int i = 0; i < header->num_cores && valid; i++) {
+        if (core_record[i].core_no != i + 1 || core_record[i].tasks_alloc_count < 0 || core_record[i].tasks_alloc_count > MAX_TASKS ||
+            core_record[i].threshold_criticality < 1 || core_record[i].threshold_criticality > header->max_criticality) {
+            valid = 0;
+            break;
+        }
+
+        // Every task number listed by the core must be that of a task allocated to the core, and listed only once
+        for (int j = 0; j < core_record[i].tasks_alloc_count; j++) {
+            task_no = core_record[i].tasks_alloc_ids[j];
+            if (task_no < 1 || task_no > header->num_tasks || listed[task_no - 1] != 0) {
+                valid = 0;
+                break;
+            }
+            listed[task_no - 1] = i + 1;
+            listed_count++;
+        }
+    }
+
+    // Every task is listed by its allocated core (the task numbers of the task records are then unique as well)
+    for (int i = 0; i < header->num_tasks && valid; i++)
+        valid = (listed[task_record[i].task_no - 1] == task_record[i].allocated_core);
+    valid = valid && (listed_count == header->num_tasks);
+
+    free (listed);
+    return valid;
+}
+
+// Load the preprocessed taskset for the taskset starting at the current input file cursor from a snapshot file (by mmap)
+// Returns 1 if the snapshot was loaded (input file cursor moves past the taskset), 0 if there is no valid snapshot for this taskset
+
+int load_snapshot (const char *path, Taskset_file *file, Taskset *taskset, Cores *core, int *num_cores, int *hyperperiod) {
+
+    struct stat file_stat;           // Snapshot file stats
+    Snapshot_header *header;         // Snapshot header (mapped)
+    Snapshot_task *task_record;      // Task records (mapped)
+    Snapshot_core *core_record;      // Core records (mapped)
+    Snapshot_header expected;        // Expected header constants
+    void *map;                       // Mapped snapshot file
+    size_t map_size = 0;             // Snapshot file size
+    int fd = -1;                     // Snapshot file descriptor
+    int source_lines = 0;            // Number of lines spanned by the taskset in the input file
+
+    fd = open (path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    if (fstat (fd, &file_stat) < 0 || (size_t) file_stat.st_size < sizeof (Snapshot_header)) {
+        close (fd);
+        return 0;
+    }
+    map_size = (size_t) file_stat.st_size;
+
+    map = mmap (NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (map == MAP_FAILED)
+        return 0;
+
+    header = (Snapshot_header *) map;
+    initialize_snapshot_header (&expected);
+
+    // Validate snapshot format and system constraints
+    if (memcmp (header->magic, expected.magic, sizeof (header->magic)) != 0 || header->version != expected.version ||
+        header->header_size != expected.header_size || header->task_record_size != expected.task_record_size ||
+        header->core_record_size != expected.core_record_size || header->max_cores != expected.max_cores ||
+        header->max_tasks != expected.max_tasks || header->max_levels != expected.max_levels ||
+        header->lpd_threshold != expected.lpd_threshold) {
+        printf(" Snapshot %s was written with a different format/configuration, ignoring it\n", path);
+        munmap (map, map_size);
+        return 0;
+    }
+
+    // Validate record counts against the file size
+    if (header->num_tasks <= 0 || header->num_cores <= 0 || header->num_cores > MAX_CORES ||
+        map_size != sizeof (Snapshot_header) + (size_t) header->num_tasks * sizeof (Snapshot_task) + (size_t) header->num_cores * sizeof (Snapshot_core)) {
+        printf(" Snapshot %s is truncated/corrupt, ignoring it\n", path);
+        munmap (map, map_size);
+        return 0;
+    }
+
+    // The snapshot must have been taken for the exact same taskset bytes at the current cursor of the input file
+    if (header->source_start != file->offset || header->source_end > file->size || header->source_end < header->source_start ||
+        get_source_checksum (file, header->source_start, header->source_end, &source_lines) != header->source_checksum ||
+        source_lines != header->source_lines) {
+        printf(" Snapshot %s does not match the input taskset, ignoring it\n", path);
+        munmap (map, map_size);
+        return 0;
+    }
+
+    task_record = (Snapshot_task *)((char *) map + sizeof (Snapshot_header));
+    core_record = (Snapshot_core *)(task_record + header->num_tasks);
+
+    // Validate the records (a fresh allocation is made for the taskset if they are out of range)
+    if (!check_snapshot_records (header, task_record, core_record)) {
+        printf(" Snapshot %s is truncated/corrupt, ignoring it\n", path);
+        munmap (map, map_size);
+        return 0;
+    }
+
+    // Rebuild the task structure array; wcet arrays point directly into the mapped snapshot
+    taskset->num_tasks = header->num_tasks;
+    taskset->max_criticality = header->max_criticality;
+    taskset->source_start = header->source_start;
+    taskset->source_end = header->source_end;
+    taskset->wcet_arena = NULL;
+    taskset->snapshot_map = map;
+    taskset->snapshot_size = map_size;
+    taskset->tasks_arr = malloc (header->num_tasks * sizeof (Tasks));
+    if (taskset->tasks_arr == NULL) {
+        munmap (map, map_size);
+        taskset->snapshot_map = NULL;
+        return 0;
+    }
+
+    for (int i = 0; i < header->num_tasks; i++) {
+        taskset->tasks_arr[i].task_no = task_record[i].task_no;
+        taskset->tasks_arr[i].phase = task_record[i].phase;
+        taskset->tasks_arr[i].period = task_record[i].period;
+        taskset->tasks_arr[i].deadline = task_record[i].deadline;
+        taskset->tasks_arr[i].criticality = task_record[i].criticality;
+        taskset->tasks_arr[i].allocated_core = task_record[i].allocated_core;
+        taskset->tasks_arr[i].virtual_deadline = task_record[i].virtual_deadline;
+        taskset->tasks_arr[i].wcet = task_record[i].wcet;
+        for (int j = 0; j < MAX_LEVELS; j++)
+            taskset->tasks_arr[i].utilization[j] = task_record[i].utilization[j];
+    }
+
+    // The derived task fields are not stored (the stored task array is already sorted)
+    derive_task_fields (taskset->tasks_arr, header->num_tasks);
+
+    // Rebuild the core structures
+    initialize_cores_offline (core, header->max_criticality);
+    for (int i = 0; i < header->num_cores; i++) {
+        core[i].core_no = core_record[i].core_no;
+        core[i].tasks_alloc_count = core_record[i].tasks_alloc_count;
+        core[i].threshold_criticality = core_record[i].threshold_criticality;
+        core[i].core_type = core_record[i].core_type;
+        core[i].utilization = core_record[i].utilization;
+        core[i].remaining_capacity = core_record[i].remaining_capacity;
+        core[i].operating_frequency = core_record[i].operating_frequency;
+        for (int j = 0; j < MAX_TASKS; j++)
+            core[i].tasks_alloc_ids[j] = core_record[i].tasks_alloc_ids[j];
+    }
+    *num_cores = header->num_cores;
+    *hyperperiod = header->hyperperiod;
+
+    // Move the input file cursor past the taskset
+    file->offset = header->source_end;
+    file->line_no = file->line_no + source_lines;
+    file->taskset_count++;
+
+    return 1;
+}
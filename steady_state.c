@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "header.h"
+
+// ---------------------------------------------------------
+// STEADY-STATE DETECTION (FAST-FORWARD ACROSS HYPERPERIODS)
+// ---------------------------------------------------------
+
+// Job arrivals repeat every super-hyperperiod; if the execution times repeat as well (deterministic distribution), the schedule of a
+// super-hyperperiod only depends on the scheduling state at its start. The state is hashed at every super-hyperperiod boundary, with all
+// times relative to the boundary. Once the state at a boundary matches the state recorded at an earlier one, the super-hyperperiods in
+// between repeat forever: the statistics of the remaining full cycles are added analytically and the state is shifted to the last
+// boundary of the cycles, so that only the rest of the horizon is simulated
+
+// Check if steady-state detection applies to the simulation (enabled, several super-hyperperiods, periodic execution times)
+
+int is_steady_state_detection_enabled (Sim_context *ctx) {
+    return (ctx->config.fast_forward && ctx->config.num_hyperperiods > 1 && has_periodic_execution_times (&ctx->config));
+}
+
+// Mix a value into a scheduling state hash
+
+unsigned long long hash_value (unsigned long long hash, double value) {
+
+    unsigned long long bits = 0;     // Bit pattern of the value
+
+    value = value + 0.0;             // -0.0 and 0.0 hash alike
+    memcpy (&bits, &value, sizeof (bits));
+    return mix64 ((hash ^ bits) + 0x9e3779b97f4a7c15ULL);
+}
+
+// Mix a time (relative to the given base, NA kept apart) into a scheduling state hash
+
+unsigned long long hash_time (unsigned long long hash, double time, double base) {
+
+    if (time == NA)
+        return hash_value (hash, 0);
+    return hash_value (hash_value (hash, 1), time - base);
+}
+
+// Mix a job (times relative to the given base) into a scheduling state hash
+// (the job number is left out: it only identifies the job, its execution time does not depend on it)
+
+unsigned long long hash_job (unsigned long long hash, Jobs *job, double base) {
+
+    hash = hash_value (hash, job->task_no);
+    hash = hash_value (hash, job->allocated_core);
+    hash = hash_time (hash, job->arrival_time, base);
+    hash = hash_time (hash, job->sched_deadline, base);
+    hash = hash_time (hash, job->virtual_deadline, base);
+    hash = hash_time (hash, job->real_deadline, base);
+    hash = hash_time (hash, job->npr_end, base);
+    hash = hash_value (hash, job->execution_time);
+    hash = hash_value (hash, job->migrating_time);
+    for (int i = 0; i < MAX_LEVELS; i++)
+        hash = hash_value (hash, job->wcet_budget[i]);
+    hash = hash_value (hash, job->job_criticality);
+    hash = hash_value (hash, job->status_flag);
+    return hash_value (hash, job->portion);
+}
+
+// Mix the jobs of a run queue (in queue order) into a scheduling state hash
+
+unsigned long long hash_run_queue (unsigned long long hash, RQ_NODE *node, double base) {
+
+    int size = 0;     // Number of jobs in the run queue
+
+    for (; node != NULL; node = node->next, size++)
+        hash = hash_job (hash, node->job, base);
+    return hash_value (hash, size);
+}
+
+// Hash the scheduling state of the context (criticality level, cores, queues, migrating jobs), times relative to the current time
+// Equal states may hash differently if their discarded queue heaps were built in a different order (a cycle is then detected later, never wrongly)
+
+unsigned long long hash_scheduling_state (Sim_context *ctx) {
+
+    double base = ctx->timecount;                       // All times are hashed relative to the current time
+    unsigned long long hash = mix64 (ctx->current_level);
+    Ready_queue *rq = NULL;                             // Ready queue/pending request queue of a core
+    Cores *core = NULL;                                 // Core structure
+
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        core = &ctx->core[core_idx];
+        hash = hash_value (hash, core->status);
+        hash = hash_value (hash, core->core_criticality);
+        hash = hash_time (hash, core->wakeup_time, base);
+        if (core->status == SHUTDOWN) {
+            hash = hash_value (hash, core->sleep_state);
+            hash = hash_time (hash, core->sleep_start, base);
+        }
+        hash = hash_time (hash, core->decision_point->decision_time, base);
+        hash = hash_value (hash, core->decision_point->event);
+
+        // Currently executing job
+        if (core->curr_exe_job->task_no == IDLE_TASK_NO)
+            hash = hash_value (hash, IDLE_TASK_NO);
+        else
+            hash = hash_job (hash, core->curr_exe_job, base);
+
+        // Ready and pending request queues (each job once, in the active ordering)
+        for (int q = 0; q < 2; q++) {
+            rq = (q == 0) ? core->ready_queue : core->pending_queue;
+            hash = hash_value (hash, rq->deadline_type);
+            for (int i = 0; i < MAX_LEVELS; i++)
+                hash = hash_run_queue (hash, rq->bucket[rq->deadline_type][i].head_node, base);
+        }
+    }
+
+    // Discarded queues (heap entries and staged job lists)
+    for (int i = 0; i < ctx->max_criticality - 1; i++) {
+        hash = hash_value (hash, ctx->dhead[i].size);
+        for (int k = 0; k < ctx->dhead[i].size; k++) {
+            hash = hash_time (hash, ctx->dhead[i].entry[k].latest_start_time, base);
+            hash = hash_job (hash, ctx->dhead[i].entry[k].job, base);
+        }
+        hash = hash_value (hash, ctx->dhead[i].num_staged);
+        for (int k = 0; k < ctx->dhead[i].num_staged; k++)
+            hash = hash_run_queue (hash, ctx->dhead[i].staged[k], base);
+    }
+
+    // Split task jobs waiting for the release of their next portion
+    for (int s = 0; s < ctx->num_splits; s++) {
+        if (ctx->split[s].migrating_job == NULL)
+            hash = hash_value (hash, IDLE_TASK_NO);
+        else
+            hash = hash_job (hash, ctx->split[s].migrating_job, base);
+    }
+
+    return hash;
+}
+
+// Shift the times of a job by the given number of super-hyperperiods (the job number follows its arrival time)
+
+void shift_job (Sim_context *ctx, Jobs *job, int hyperperiods) {
+
+    double shift = (double) hyperperiods * ctx->hyperperiod;                                     // Shift in time units
+    int task_array_idx = get_task_array_index (ctx->tasks_arr, ctx->num_tasks, job->task_no);    // Task of the job
+
+    job->job_no = job->job_no + hyperperiods * (ctx->hyperperiod / ctx->tasks_arr[task_array_idx].period);
+    job->arrival_time = job->arrival_time + hyperperiods * ctx->hyperperiod;
+    job->sched_deadline = job->sched_deadline + shift;
+    job->virtual_deadline = job->virtual_deadline + shift;
+    job->real_deadline = job->real_deadline + shift;
+    if (job->npr_end != NA)
+        job->npr_end = job->npr_end + shift;
+}
+
+// Shift the times of the jobs of a run queue by the given number of super-hyperperiods
+
+void shift_run_queue (Sim_context *ctx, RQ_NODE *node, int hyperperiods) {
+
+    for (; node != NULL; node = node->next)
+        shift_job (ctx, node->job, hyperperiods);
+}
+
+// Shift the scheduling state of the context (all jobs, cores and the current time) by the given number of super-hyperperiods
+
+void shift_scheduling_state (Sim_context *ctx, int hyperperiods) {
+
+    double shift = (double) hyperperiods * ctx->hyperperiod;     // Shift in time units
+    Ready_queue *rq = NULL;                                      // Ready queue/pending request queue of a core
+    Cores *core = NULL;                                          // Core structure
+
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        core = &ctx->core[core_idx];
+        if (core->wakeup_time != NA)
+            core->wakeup_time = core->wakeup_time + shift;
+        if (core->sleep_start != NA)
+            core->sleep_start = core->sleep_start + shift;
+        core->decision_point->decision_time = core->decision_point->decision_time + shift;
+        invalidate_slack_cache (&core->slack_cache);
+
+        if (core->curr_exe_job->task_no != IDLE_TASK_NO)
+            shift_job (ctx, core->curr_exe_job, hyperperiods);
+
+        // Both orderings of a ready queue bucket hold the same jobs: each job is shifted once
+        for (int q = 0; q < 2; q++) {
+            rq = (q == 0) ? core->ready_queue : core->pending_queue;
+            for (int i = 0; i < MAX_LEVELS; i++)
+                shift_run_queue (ctx, rq->bucket[rq->deadline_type][i].head_node, hyperperiods);
+        }
+    }
+
+    for (int i = 0; i < ctx->max_criticality - 1; i++) {
+        for (int k = 0; k < ctx->dhead[i].size; k++) {
+            ctx->dhead[i].entry[k].latest_start_time = ctx->dhead[i].entry[k].latest_start_time + shift;
+            shift_job (ctx, ctx->dhead[i].entry[k].job, hyperperiods);
+        }
+        for (int k = 0; k < ctx->dhead[i].num_staged; k++)
+            shift_run_queue (ctx, ctx->dhead[i].staged[k], hyperperiods);
+    }
+
+    for (int s = 0; s < ctx->num_splits; s++) {
+        if (ctx->split[s].migrating_job != NULL)
+            shift_job (ctx, ctx->split[s].migrating_job, hyperperiods);
+    }
+
+    ctx->timecount = ctx->timecount + shift;
+}
+
+// Record the scheduling state hash and the statistics of the context at a super-hyperperiod boundary
+
+void record_steady_state (Sim_context *ctx, Steady_state_record *record, unsigned long long hash) {
+
+    record->hash = hash;
+    record->hyperperiods = (int)(ctx->timecount / ctx->hyperperiod);
+    record->stats = ctx->stats;
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        record->preemptions[core_idx] = ctx->core[core_idx].preemptions;
+        record->deferred_preemptions[core_idx] = ctx->core[core_idx].deferred_preemptions;
+        record->overhead_time[core_idx] = ctx->core[core_idx].overhead_time;
+        record->idle_time[core_idx] = ctx->core[core_idx].idle_time;
+        record->sleep_time[core_idx] = ctx->core[core_idx].sleep_time;
+        record->domain_sleep_time[core_idx] = ctx->domain_sleep_time[core_idx];
+    }
+}
+
+// Add the statistics of the given number of repetitions of the cycle starting at the recorded boundary
+// (every counter grows by (current value - recorded value) per cycle)
+
+void extrapolate_statistics (Sim_context *ctx, Steady_state_record *record, int cycles) {
+
+    Sim_stats *stats = &ctx->stats;           // Statistics of the context (current boundary)
+    Sim_stats *start = &record->stats;        // Statistics at the start of the cycle
+
+    stats->decision_points += cycles * (stats->decision_points - start->decision_points);
+    stats->mode_changes += cycles * (stats->mode_changes - start->mode_changes);
+    stats->deescalations += cycles * (stats->deescalations - start->deescalations);
+    stats->shutdowns += cycles * (stats->shutdowns - start->shutdowns);
+    stats->coordinated_shutdowns += cycles * (stats->coordinated_shutdowns - start->coordinated_shutdowns);
+    stats->preemptions += cycles * (stats->preemptions - start->preemptions);
+    stats->deferred_preemptions += cycles * (stats->deferred_preemptions - start->deferred_preemptions);
+    stats->overhead_time += cycles * (stats->overhead_time - start->overhead_time);
+    stats->discarded_jobs_scheduled += cycles * (stats->discarded_jobs_scheduled - start->discarded_jobs_scheduled);
+    stats->discarded_jobs_expired += cycles * (stats->discarded_jobs_expired - start->discarded_jobs_expired);
+    stats->discarded_jobs_dropped += cycles * (stats->discarded_jobs_dropped - start->discarded_jobs_dropped);
+    stats->slack_cache_hits += cycles * (stats->slack_cache_hits - start->slack_cache_hits);
+    stats->migrations += cycles * (stats->migrations - start->migrations);
+    for (int type = 0; type < NUM_CORE_TYPES; type++) {
+        for (int state = 0; state < MAX_SLEEP_STATES; state++) {
+            stats->sleep_state_entries[type][state] += cycles * (stats->sleep_state_entries[type][state] - start->sleep_state_entries[type][state]);
+            stats->sleep_state_time[type][state] += cycles * (stats->sleep_state_time[type][state] - start->sleep_state_time[type][state]);
+        }
+    }
+
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        ctx->core[core_idx].preemptions += cycles * (ctx->core[core_idx].preemptions - record->preemptions[core_idx]);
+        ctx->core[core_idx].deferred_preemptions += cycles * (ctx->core[core_idx].deferred_preemptions - record->deferred_preemptions[core_idx]);
+        ctx->core[core_idx].overhead_time += cycles * (ctx->core[core_idx].overhead_time - record->overhead_time[core_idx]);
+        ctx->core[core_idx].idle_time += cycles * (ctx->core[core_idx].idle_time - record->idle_time[core_idx]);
+        ctx->core[core_idx].sleep_time += cycles * (ctx->core[core_idx].sleep_time - record->sleep_time[core_idx]);
+        ctx->domain_sleep_time[core_idx] += cycles * (ctx->domain_sleep_time[core_idx] - record->domain_sleep_time[core_idx]);
+    }
+}
+
+// Detect a steady state at a super-hyperperiod boundary and fast-forward the simulation across its repetitions ending by the given time
+// The states of the first STEADY_STATE_HISTORY boundaries are recorded, the cycle must start at one of them
+// Returns 1 if the simulation was fast-forwarded
+
+int fast_forward_steady_state (Sim_context *ctx, double time) {
+
+    Steady_state_record *record = NULL;     // Recorded boundary with the same scheduling state
+    unsigned long long hash = 0;            // Hash of the scheduling state at the current boundary
+    int boundary = 0;                       // Number of super-hyperperiods simulated
+    int cycle_length = 0;                   // Number of super-hyperperiods per cycle
+    int cycles = 0;                         // Number of cycles skipped
+
+    if (ctx->steady_state_found || !is_steady_state_detection_enabled (ctx) || ctx->timecount >= ctx->end_time || fmod (ctx->timecount, ctx->hyperperiod) != 0.0)
+        return 0;
+
+    // Pending runtime task changes are applied at their decision points (never skipped)
+    if (ctx->num_task_changes > 0)
+        return 0;
+
+    boundary = (int)(ctx->timecount / ctx->hyperperiod);
+    hash = hash_scheduling_state (ctx);
+    for (int i = 0; i < ctx->num_steady_states && record == NULL; i++) {
+        if (ctx->steady_state[i].hash == hash)
+            record = &ctx->steady_state[i];
+    }
+
+    // New state: record it (as long as the history is not full)
+    if (record == NULL) {
+        if (ctx->num_steady_states < STEADY_STATE_HISTORY)
+            record_steady_state (ctx, &ctx->steady_state[ctx->num_steady_states++], hash);
+        return 0;
+    }
+
+    // The super-hyperperiods since the recorded boundary repeat: skip the whole cycles ending by the given time
+    // (the last super-hyperperiod is always simulated, its slack calculations anticipate job arrivals only till the end of the simulation)
+    if (time > ctx->end_time - ctx->hyperperiod)
+        time = ctx->end_time - ctx->hyperperiod;
+    cycle_length = boundary - record->hyperperiods;
+    cycles = (int) floor ((time - ctx->timecount) / ((double) cycle_length * ctx->hyperperiod));
+    if (cycles <= 0)
+        return 0;
+
+    extrapolate_statistics (ctx, record, cycles);
+    trace_fast_forward (ctx, cycles * cycle_length, (double) cycles * cycle_length * ctx->hyperperiod);
+    shift_scheduling_state (ctx, cycles * cycle_length);
+    ctx->stats.fast_forwarded_hyperperiods += cycles * cycle_length;
+    ctx->steady_state_found = 1;
+
+    SCHED_PRINT (ctx, "\n Steady state: super-hyperperiods %d to %d repeat, fast-forwarded %d cycles to %lf\n\n", record->hyperperiods + 1, boundary, cycles, ctx->timecount);
+
+    return 1;
+}
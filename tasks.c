@@ -1,112 +1,175 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 #include "header.h"
 
-// ---------------------------------------------------------------------------------------------
-// FETCH INPUT TASK SET PARAMETERS FROM THE GIVEN FILE, STORE PARAMETERS IN TASK STRUCTURE ARRAY
-// ---------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------------------------------------
+// TASK PREPROCESSING: DERIVED TASK FIELDS AND STABLE SORT IN DECREASING ORDER OF CRITICALITY LEVELS AND OWN LEVEL UTILIZATIONS
+// ------------------------------------------------------------------------------------------------------------------------------
 
-void fetch_task_parameters (FILE* fptr, Tasks *tasks_arr, int num_tasks, int max_criticality) {
+// Compute the derived task fields once, so that the allocation, the optimizer and the taskset stats do not re-evaluate them per use
+// (Must be called again whenever the task utilizations change, e.g. after the scheduling overheads are accounted)
 
-    // For all tasks
-    for (int i = 0 ; i < num_tasks ; i++) {
+void derive_task_fields (Tasks *tasks_arr, int num_tasks) {
 
-        // Record the task's phase, period, relative deadline and criticality level from the file
-        fscanf(fptr,"%d\t%d\t%d\t%d", &tasks_arr[i].phase, &tasks_arr[i].period, &tasks_arr[i].deadline, &tasks_arr[i].criticality);
+    for (int i = 0; i < num_tasks; i++) {
+        tasks_arr[i].lpd = (2 * (tasks_arr[i].period - tasks_arr[i].wcet[0]) < LPD_THRESHOLD);    // --> LPD condition
+        tasks_arr[i].own_utilization = tasks_arr[i].utilization[tasks_arr[i].criticality - 1];
+    }
+}
 
-        // Assign a task number to each task structure
-        tasks_arr[i].task_no = i + 1;
+// Packed radix sort key of a task
+// The IEEE-754 bit pattern of a non-negative double increases with its value, so the inverted bit pattern of the own level
+// utilization increases as the utilization decreases
 
-        // Initialize task's allocated core number to NOT_ALLOCATED
-        tasks_arr[i].allocated_core = NOT_ALLOCATED;
+unsigned long long get_task_sort_key (Tasks *task) {
 
-        // Initialize the task's virtual deadline as its relative deadline
-        tasks_arr[i].virtual_deadline = tasks_arr[i].deadline;
+    unsigned long long bits = 0;       // Bit pattern of the task's own level utilization
 
-        // Allocate memory for WCET array; no. of elements = task's criticality level
-        tasks_arr[i].wcet = malloc (tasks_arr[i].criticality * sizeof (int));
+    memcpy (&bits, &task->own_utilization, sizeof (bits));
+    return ~bits;
+}
 
-        // For each criticality level (defined for the given task)
-        for (int j = 0 ; j < tasks_arr[i].criticality ; j++) {
+// Check if task A is placed before task B in the sorted order
 
-            // Record task's WCET value for the current criticality level
-            fscanf(fptr,"%d", &tasks_arr[i].wcet[j]);
+int task_precedes (Tasks *A, Tasks *B) {
 
-            // Calculate the task's utilization for the current criticality level
-            tasks_arr[i].utilization[j] = (double)(tasks_arr[i].wcet[j]) / (tasks_arr[i].period); 
-        }
+    if (A->criticality != B->criticality)
+        return (A->criticality > B->criticality);
+    return (A->own_utilization > B->own_utilization);
+}
 
-        // For criticality levels beyond the task's (maximum defined) criticality level,
-        // the utilization is set to task utilization at it's own criticality level
-        // (reqd for EDF-VD offline preprocessing)
-        for (int j = tasks_arr[i].criticality ; j < max_criticality ; j++)
-            tasks_arr[i].utilization[j] = (double)(tasks_arr[i].wcet[(tasks_arr[i].criticality - 1)]) / (tasks_arr[i].period);
+// Stable insertion sort of the task array (used for small tasksets, where the radix passes cost more than the comparisons)
+
+void insertion_sort_tasks (Tasks *tasks_arr, int num_tasks) {
+
+    Tasks temp;             // Task being inserted
+    int j = 0;
+
+    for (int i = 1; i < num_tasks; i++) {
+        temp = tasks_arr[i];
+        for (j = i - 1; j >= 0 && task_precedes (&temp, &tasks_arr[j]); j--)
+            tasks_arr[j + 1] = tasks_arr[j];
+        tasks_arr[j + 1] = temp;
     }
 }
 
-// -------------------------------------------------------------------------------------------------------------------------
-// QUICK SORT TASKS IN DECREASING ORDER OF THEIR CRITICALITY LEVELS AND UTILIZATIONS (at highest level defined for the task)
-// -------------------------------------------------------------------------------------------------------------------------
+// Stable LSD radix sort of the task array
+// The (key, index) entries are sorted by counting passes over the SORT_RADIX_BITS digits of the utilization key, followed by one
+// pass over the criticality level (the most significant sort order). The digit histograms of all key passes are built in a single
+// scan, and passes whose digit is the same for every task are skipped. The task structures are moved only once at the end, by
+// following the cycles of the resulting permutation
+// Returns -1 if the sort buffers cannot be allocated (the task array is left unchanged)
+
+int radix_sort_tasks (Tasks *tasks_arr, int num_tasks) {
+
+    int num_passes = (int)(8 * sizeof (unsigned long long)) / SORT_RADIX_BITS;               // Number of counting passes over the key
+    unsigned long long mask = (1ULL << SORT_RADIX_BITS) - 1;                                  // Mask of a key digit
+    int histogram[(8 * sizeof (unsigned long long)) / SORT_RADIX_BITS][1 << SORT_RADIX_BITS]; // Digit histograms of all key passes
+    int level_count[MAX_LEVELS + 1];                                                          // Histogram of the criticality digits
+    Sort_entry *buffer = NULL;                                                                // Sort buffers (entries and scatter target)
+    Sort_entry *entry = NULL, *target = NULL, *temp_ptr = NULL;
+    int digit = 0, offset = 0, count = 0, j = 0, k = 0;
+    Tasks temp;
+
+    buffer = malloc (2 * num_tasks * sizeof (Sort_entry));
+    if (buffer == NULL)
+        return -1;
+    entry = buffer;
+    target = buffer + num_tasks;
+
+    // Build the entries and the digit histograms of all passes in one scan
+    memset (histogram, 0, sizeof (histogram));
+    memset (level_count, 0, sizeof (level_count));
+    for (int i = 0; i < num_tasks; i++) {
+        entry[i].key = get_task_sort_key (&tasks_arr[i]);
+        entry[i].index = i;
+        for (int p = 0; p < num_passes; p++)
+            histogram[p][(entry[i].key >> (p * SORT_RADIX_BITS)) & mask]++;
+        level_count[MAX_LEVELS - tasks_arr[i].criticality]++;
+    }
 
-// Utility function to swap array elements
+    // Counting passes over the key digits (least significant first)
+    for (int p = 0; p < num_passes; p++) {
 
-void swap (Tasks* A, Tasks* B) {
+        // Every task has the same digit --> the pass does not change the order
+        if (histogram[p][(entry[0].key >> (p * SORT_RADIX_BITS)) & mask] == num_tasks)
+            continue;
 
-    Tasks temp = *A;
-    *A = *B;
-    *B = temp;
-}
- 
-// Partitioning function for sorting task array in decreasing order of their criticalities and utilizations
-// The pivot is placed at its correct position in sorted array by placing the "greater" elements to left and
-// the "smaller" elements to right of pivot
+        // Convert the digit counts to the starting offsets of the digit buckets
+        offset = 0;
+        for (digit = 0; digit <= (int)mask; digit++) {
+            count = histogram[p][digit];
+            histogram[p][digit] = offset;
+            offset = offset + count;
+        }
 
-int partition_array (Tasks *tasks_arr, int low, int high) {
+        for (int i = 0; i < num_tasks; i++)
+            target[histogram[p][(entry[i].key >> (p * SORT_RADIX_BITS)) & mask]++] = entry[i];
 
-    double pivot_utilization = tasks_arr[high].utilization[(tasks_arr[high].criticality - 1)];  // Last element's utilization is considered as pivot utilization
-    int pivot_criticality = tasks_arr[high].criticality;                                        // Last element's criticality is considered as pivot criticality
-    int i = (low - 1);                                                                          // Initialize pivot position to low
+        temp_ptr = entry;
+        entry = target;
+        target = temp_ptr;
+    }
 
-    // Determine pivot position in sorted array 
-    // Sorting order: Decreasing criticality, and within same criticality decreasing utilization
-    for (int j = low ; j <= high - 1 ; j++) {
+    // Final counting pass over the criticality level (in decreasing order of the criticality levels)
+    if (level_count[MAX_LEVELS - tasks_arr[entry[0].index].criticality] != num_tasks) {
 
-        // If the criticality level of jth task is greater than that of pivot - increment position
-        if (tasks_arr[j].criticality > pivot_criticality) {
-            i++;
-            swap (&tasks_arr[i], &tasks_arr[j]);
+        offset = 0;
+        for (digit = 0; digit <= MAX_LEVELS; digit++) {
+            count = level_count[digit];
+            level_count[digit] = offset;
+            offset = offset + count;
         }
 
-        // If the criticality level of jth task is equal to that of pivot, but its utilization is greater than that of pivot - increment position
-        else if ((tasks_arr[j].criticality == pivot_criticality) && (tasks_arr[j].utilization [(tasks_arr[j].criticality - 1)] > pivot_utilization)) { 
-            i++;
-            swap (&tasks_arr[i], &tasks_arr[j]); 
+        for (int i = 0; i < num_tasks; i++)
+            target[level_count[MAX_LEVELS - tasks_arr[entry[i].index].criticality]++] = entry[i];
+
+        entry = target;
+    }
+
+    // Permute the task array in place: position i receives the task at index entry[i].index
+    // (Each cycle of the permutation is followed once, the visited entries are marked by setting their index to their own position)
+    for (int i = 0; i < num_tasks; i++) {
+
+        if (entry[i].index == i)
+            continue;
+
+        temp = tasks_arr[i];
+        j = i;
+        while (1) {
+            k = entry[j].index;
+            entry[j].index = j;
+            if (k == i) {
+                tasks_arr[j] = temp;
+                break;
+            }
+            tasks_arr[j] = tasks_arr[k];
+            j = k;
         }
     }
-    
-    // Swap to reposition pivot in the array 
-    swap (&tasks_arr[i + 1], &tasks_arr[high]);
-    
-    // Return pivot's updated position 
-    return (i + 1); 
+
+    free (buffer);
+    return 0;
 }
 
-// Quick sort driver function: sorts array in decreasing order of task criticality and utilization
+// Stable sort of the task array in decreasing order of task criticality and utilization (at the task's own criticality level)
+// (Tasks with the same criticality level and utilization keep their input order)
 
-void quick_sort (Tasks *tasks_arr, int low, int high) {
-    int pi = 0;                     // Pivot index                           
-    
-    // Sort in decreasing order of criticality and then utilization
-    if (low < high) {
-    
-        // Initialize pivot  
-        pi = partition_array (tasks_arr, low, high); 
-        
-        // Recursive call to sort partitioned sub-arrays
-        quick_sort (tasks_arr, low, pi - 1); 
-        quick_sort (tasks_arr, pi + 1, high); 
-    }
+void sort_tasks (Tasks *tasks_arr, int num_tasks) {
+
+    // Small tasksets, or no memory for the radix sort buffers --> insertion sort (same order)
+    if (num_tasks < SORT_INSERTION_THRESHOLD || radix_sort_tasks (tasks_arr, num_tasks) == -1)
+        insertion_sort_tasks (tasks_arr, num_tasks);
+}
+
+// Preprocess the task array before the allocation: derive the task fields (from the final task utilizations) and sort the tasks
+
+void preprocess_tasks (Tasks *tasks_arr, int num_tasks) {
+
+    derive_task_fields (tasks_arr, num_tasks);
+    sort_tasks (tasks_arr, num_tasks);
 }
 
 // --------------------------------------------------------------------------------------------------------------------
@@ -115,8 +178,6 @@ void quick_sort (Tasks *tasks_arr, int low, int high) {
 
 void get_taskset_info (Tasks *tasks_arr, int num_tasks, Taskset_info* tasks_info, int hi_level_threshold) {
 
-    int idx = 0;    // Index for getting utilization of a task at its own criticality level
-
     // Initializing all utilization stats
     tasks_info->hi_crit_util = 0.0;
     tasks_info->lo_crit_util = 0.0;
@@ -126,24 +187,22 @@ void get_taskset_info (Tasks *tasks_arr, int num_tasks, Taskset_info* tasks_info
     // For all tasks
     for (int i = 0; i < num_tasks; i++) {
 
-        idx = tasks_arr[i].criticality - 1;    // Set utilization array index to (task's criticality level - 1)
-
         // Update HI criticality utilization if task criticality is greater than hi_level_threshold
         if (tasks_arr[i].criticality > hi_level_threshold) {
-            tasks_info->hi_crit_util = tasks_info->hi_crit_util + tasks_arr[i].utilization[idx];
+            tasks_info->hi_crit_util = tasks_info->hi_crit_util + tasks_arr[i].own_utilization;
 
             // Also update low period HI criticality utilization if task satifies the LPD condition
-            if (2 * (tasks_arr[i].period - tasks_arr[i].wcet[0]) < LPD_THRESHOLD) // --> LPD condition
-                tasks_info->lpd_hi_crit_util = tasks_info->lpd_hi_crit_util + tasks_arr[i].utilization[idx];
+            if (tasks_arr[i].lpd)
+                tasks_info->lpd_hi_crit_util = tasks_info->lpd_hi_crit_util + tasks_arr[i].own_utilization;
         }
 
         // Update LO criticality utilization if task is less than or equal to hi_level_threshold
         else {
-            tasks_info->lo_crit_util = tasks_info->lo_crit_util + tasks_arr[i].utilization[idx];
+            tasks_info->lo_crit_util = tasks_info->lo_crit_util + tasks_arr[i].own_utilization;
 
             // Also update low period LO criticality utilization if task satifies the LPD condition
-            if (2 * (tasks_arr[i].period - tasks_arr[i].wcet[0]) < LPD_THRESHOLD) // --> LPD condition
-                tasks_info->lpd_lo_crit_util = tasks_info->lpd_lo_crit_util + tasks_arr[i].utilization[idx];
+            if (tasks_arr[i].lpd)
+                tasks_info->lpd_lo_crit_util = tasks_info->lpd_lo_crit_util + tasks_arr[i].own_utilization;
         }
     }
 }
@@ -153,7 +212,7 @@ void get_taskset_info (Tasks *tasks_arr, int num_tasks, Taskset_info* tasks_info
 // MC Feasibility condition: Total utilization of all tasks at any given level < 1
 // ---------------------------------------------------------------------------------------------------
 
-int get_min_cores_reqd (Tasks *tasks_arr, int num_tasks, int max_criticality) {
+int get_min_cores_reqd (Tasks *tasks_arr, int num_tasks, int max_criticality, int verbose) {
 
     int min_cores_reqd = 0;               // Minimum number of cores required for allocation
     double utilization_sum = 0.0;         // Sum of utilizations of all tasks at a given criticality level
@@ -179,7 +238,8 @@ int get_min_cores_reqd (Tasks *tasks_arr, int num_tasks, int max_criticality) {
             max_utilization_sum = utilization_sum;
     }
 
-    printf (" Maximum utilization among all criticalities: %lf\n\n", max_utilization_sum);
+    if (verbose)
+        printf (" Maximum utilization among all criticalities: %lf\n\n", max_utilization_sum);
 
     // Minimum number of cores required will be the ceiling of maximum utilization sum among all criticalities
     min_cores_reqd = ceil(max_utilization_sum); 
@@ -188,6 +248,39 @@ int get_min_cores_reqd (Tasks *tasks_arr, int num_tasks, int max_criticality) {
     return min_cores_reqd;
 }
 
+// ----------------------------------------------------------
+// SCHEDULING OVERHEADS (PREEMPTIONS, NON-PREEMPTIVE REGIONS)
+// ----------------------------------------------------------
+
+// Worst-case overhead accounted to every job by the schedulability analysis
+// Under EDF a job arrival causes at most one preemption (the preempted job pays the preemption overhead when it resumes),
+// and a job can be blocked by at most one non-preemptive region of a later deadline job (at its arrival)
+// so inflating every job's wcet by (preemption overhead + non-preemptive region length) is a sufficient adjustment
+
+int get_job_overhead (Sim_config *config) {
+
+    int overhead = config->preemption_overhead;     // Overhead accounted to every job
+
+    if (config->preemption_mode == PREEMPTION_LIMITED)
+        overhead = overhead + config->npr_length;
+
+    return overhead;
+}
+
+// Account the worst-case overhead of every job in the task utilizations used by the schedulability tests and the allocation
+
+void add_scheduling_overheads (Tasks *tasks_arr, int num_tasks, int max_criticality, int overhead) {
+
+    for (int i = 0; i < num_tasks; i++) {
+        for (int j = 0; j < tasks_arr[i].criticality; j++)
+            tasks_arr[i].utilization[j] = (double)(tasks_arr[i].wcet[j] + overhead) / tasks_arr[i].period;
+
+        // (Levels beyond the task's criticality level keep the utilization at its own level)
+        for (int j = tasks_arr[i].criticality; j < max_criticality; j++)
+            tasks_arr[i].utilization[j] = tasks_arr[i].utilization[tasks_arr[i].criticality - 1];
+    }
+}
+
 // ----------------
 // HELPER FUNCTIONS
 // ----------------
@@ -198,7 +291,7 @@ void print_sorted_array (Tasks *tasks_arr, int num_tasks) {
 
     printf(" Sorted task structure array\n\n"); 
     for (int i = 0 ; i < num_tasks ; i++)
-        printf(" Task %d \tCriticality: %d \tUtilization:%lf\n", tasks_arr[i].task_no, tasks_arr[i].criticality, tasks_arr[i].utilization[(tasks_arr[i].criticality - 1)]); 
+        printf(" Task %d \tCriticality: %d \tUtilization:%lf\n", tasks_arr[i].task_no, tasks_arr[i].criticality, tasks_arr[i].own_utilization); 
     printf("\n"); 
 }
 
@@ -224,12 +317,3 @@ void print_taskset_info (Taskset_info* tasks_info) {
     else
         printf(" Proportion of LPD HI criticality tasks in all LPD tasks in the given workload: NA\n\n");
 }
-
-// Helper funtion to free all the wcet mallocs
-
-void free_wcet_mallocs (Tasks *task_ptr, int num_tasks) {
-
-    // For all tasks
-    for (int i = 0 ; i < num_tasks ; i++) 
-        free(task_ptr[i].wcet); 
-}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "header.h"
+
+// -----------------------------------------
+// THREAD POOL (PARALLEL OFFLINE PROCESSING)
+// -----------------------------------------
+
+// Fixed set of worker threads executing submitted tasks from a FIFO queue (grown on demand)
+// Used by the offline stages (allocation optimizer) to run independent computations in parallel
+// Results must not depend on the order in which the tasks complete
+
+struct _thread_pool {
+    pthread_mutex_t lock;                 // Protects all the fields below
+    pthread_cond_t task_available;        // Signalled when a task is queued or the pool shuts down
+    pthread_cond_t all_done;              // Signalled when no task is queued or running
+    Pool_task *queue;                     // Circular task queue
+    int capacity;                         // Capacity of the task queue
+    int head;                             // Index of the next task to be executed
+    int count;                            // Number of queued tasks
+    int pending;                          // Number of queued + running tasks
+    int shutdown;                         // Set when the pool is being destroyed
+    int num_threads;                      // Number of worker threads
+    pthread_t *threads;                   // Worker threads
+};
+
+// Get the number of online CPUs (at least 1)
+
+int get_num_online_cpus () {
+
+    long num_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+    return (num_cpus < 1) ? 1 : (int) num_cpus;
+}
+
+// Thread pool worker: executes queued tasks until the pool shuts down
+
+void *run_pool_worker (void *arg) {
+
+    Thread_pool *pool = (Thread_pool *) arg;
+    Pool_task task;
+
+    while (1) {
+
+        pthread_mutex_lock (&pool->lock);
+        while (pool->count == 0 && !pool->shutdown)
+            pthread_cond_wait (&pool->task_available, &pool->lock);
+
+        if (pool->count == 0 && pool->shutdown) {
+            pthread_mutex_unlock (&pool->lock);
+            return NULL;
+        }
+
+        task = pool->queue[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+        pthread_mutex_unlock (&pool->lock);
+
+        task.function (task.arg);
+
+        pthread_mutex_lock (&pool->lock);
+        pool->pending--;
+        if (pool->pending == 0)
+            pthread_cond_broadcast (&pool->all_done);
+        pthread_mutex_unlock (&pool->lock);
+    }
+}
+
+// Create a thread pool with the given number of worker threads (<= 0: one per online CPU)
+// Returns NULL if the pool could not be created
+
+Thread_pool *create_thread_pool (int num_threads) {
+
+    Thread_pool *pool;
+
+    if (num_threads <= 0)
+        num_threads = get_num_online_cpus ();
+
+    pool = calloc (1, sizeof (Thread_pool));
+    if (pool == NULL)
+        return NULL;
+
+    pool->capacity = POOL_QUEUE_CAPACITY;
+    pool->queue = malloc (pool->capacity * sizeof (Pool_task));
+    pool->threads = malloc (num_threads * sizeof (pthread_t));
+    if (pool->queue == NULL || pool->threads == NULL) {
+        free (pool->queue);
+        free (pool->threads);
+        free (pool);
+        return NULL;
+    }
+
+    pthread_mutex_init (&pool->lock, NULL);
+    pthread_cond_init (&pool->task_available, NULL);
+    pthread_cond_init (&pool->all_done, NULL);
+
+    // Start the worker threads (the pool works with as many as could be created)
+    for (pool->num_threads = 0; pool->num_threads < num_threads; pool->num_threads++) {
+        if (pthread_create (&pool->threads[pool->num_threads], NULL, run_pool_worker, pool) != 0)
+            break;
+    }
+
+    if (pool->num_threads == 0) {
+        destroy_thread_pool (pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+// Get the number of worker threads of the pool
+
+int get_pool_size (Thread_pool *pool) {
+    return pool->num_threads;
+}
+
+// Submit a task to the pool, returns 0 on success, -1 if the task queue could not be grown
+
+int submit_pool_task (Thread_pool *pool, void (*function) (void *arg), void *arg) {
+
+    Pool_task *queue;
+
+    pthread_mutex_lock (&pool->lock);
+
+    // Grow the circular queue (tasks are copied in FIFO order)
+    if (pool->count == pool->capacity) {
+        queue = malloc (2 * pool->capacity * sizeof (Pool_task));
+        if (queue == NULL) {
+            pthread_mutex_unlock (&pool->lock);
+            return -1;
+        }
+        for (int i = 0; i < pool->count; i++)
+            queue[i] = pool->queue[(pool->head + i) % pool->capacity];
+        free (pool->queue);
+        pool->queue = queue;
+        pool->head = 0;
+        pool->capacity = 2 * pool->capacity;
+    }
+
+    pool->queue[(pool->head + pool->count) % pool->capacity].function = function;
+    pool->queue[(pool->head + pool->count) % pool->capacity].arg = arg;
+    pool->count++;
+    pool->pending++;
+    pthread_cond_signal (&pool->task_available);
+    pthread_mutex_unlock (&pool->lock);
+
+    return 0;
+}
+
+// Wait until all the submitted tasks are complete
+
+void wait_thread_pool (Thread_pool *pool) {
+
+    pthread_mutex_lock (&pool->lock);
+    while (pool->pending > 0)
+        pthread_cond_wait (&pool->all_done, &pool->lock);
+    pthread_mutex_unlock (&pool->lock);
+}
+
+// Destroy the thread pool (the queued tasks are completed first)
+
+void destroy_thread_pool (Thread_pool *pool) {
+
+    if (pool == NULL)
+        return;
+
+    pthread_mutex_lock (&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast (&pool->task_available);
+    pthread_mutex_unlock (&pool->lock);
+
+    for (int i = 0; i < pool->num_threads; i++)
+        pthread_join (pool->threads[i], NULL);
+
+    pthread_mutex_destroy (&pool->lock);
+    pthread_cond_destroy (&pool->task_available);
+    pthread_cond_destroy (&pool->all_done);
+    free (pool->queue);
+    free (pool->threads);
+    free (pool);
+}
@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "header.h"
+
+// ----------------------------------------
+// SCHEDULE TRACE WRITER (CHROME TRACE JSON)
+// ----------------------------------------
+
+// The simulator emits its schedule as a stream of events in non-decreasing time order. The stream is written as a Chrome trace event JSON file
+// (chrome://tracing, ui.perfetto.dev: one process with one track (thread) per core) and/or checked on the fly by the schedule verifier
+// --> Slices ("B"/"E" events): the job executing on a core, IDLE intervals of ACTIVE cores and sleep intervals of SHUTDOWN cores
+// --> Instant events ("i" events): job releases/completions/aborts/discards/migrations/overheads, mode changes, de-escalations, shutdowns/wakeups,
+//     steady-state fast-forwards (with the fields the verifier needs), and informational events (discarded job scheduling, drops, expiries)
+// --> Counters ("C" events): slack values calculated for procrastination and discarded job scheduling
+// --> Metadata ("M" events): track names, and the simulation parameters checked by the verifier
+// Timestamps are in microseconds, TRACE_US_PER_TIME_UNIT per simulation time unit. Every event is written on its own line (read back by the verifier)
+
+// Create the schedule event stream writer of an allocated context (no trace file, no verifier), returns NULL if out of memory
+
+Trace_writer *create_trace_writer (Sim_context *ctx) {
+
+    Trace_writer *trace;     // Schedule event stream writer
+
+    if (ctx->trace != NULL)
+        return ctx->trace;
+
+    trace = malloc (sizeof (Trace_writer));
+    if (trace == NULL)
+        return NULL;
+
+    trace->fd = -1;
+    trace->length = 0;
+    trace->num_events = 0;
+    trace->failed = 0;
+    trace->finished = 0;
+    trace->verifier = NULL;
+    for (int core_idx = 0; core_idx < MAX_CORES; core_idx++)
+        trace->slice[core_idx].kind = TRACE_SLICE_NONE;
+
+    ctx->trace = trace;
+    return trace;
+}
+
+// Open the schedule trace file of an allocated context and write the trace header (process and core track names, verifier parameters)
+// Returns 0 on success, -1 if the file could not be opened (the writer is kept only if the schedule is verified)
+
+int open_trace (Sim_context *ctx, const char *path) {
+
+    Trace_writer *trace;     // Schedule event stream writer
+    Trace_event event;       // Simulation/core parameters
+
+    trace = create_trace_writer (ctx);
+    if (trace == NULL)
+        return -1;
+
+    trace->fd = open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (trace->fd < 0) {
+        printf(" ERROR: Could not open the trace file (%s)\n", path);
+        if (trace->verifier == NULL) {
+            free (trace);
+            ctx->trace = NULL;
+        }
+        return -1;
+    }
+
+    // Trace header, process and core track names (tracks sorted by core number)
+    trace_printf (trace, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    trace_begin_event (trace);
+    trace_printf (trace, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"EEMCS schedule (super-hyperperiod %d)\"}}", ctx->hyperperiod);
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        trace_begin_event (trace);
+        trace_printf (trace, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Core %d (%s)\"}}",
+                      ctx->core[core_idx].core_no, ctx->core[core_idx].core_no, (ctx->core[core_idx].core_type == SHUTDOWNABLE) ? "SHUTDOWNABLE" : "NON-SHUTDOWNABLE");
+        trace_begin_event (trace);
+        trace_printf (trace, "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", ctx->core[core_idx].core_no, ctx->core[core_idx].core_no);
+    }
+
+    // Simulation and core parameters (read back by the verifier)
+    event.type = TRACE_EVENT_CONFIG;
+    event.time = 0;
+    event.core_no = 0;
+    event.value = (ctx->config.preemption_mode == PREEMPTION_LIMITED) ? ctx->config.npr_length : 0;
+    write_trace_event (trace, &event);
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        event.type = TRACE_EVENT_CORE;
+        event.core_no = ctx->core[core_idx].core_no;
+        event.value = ctx->core[core_idx].threshold_criticality;
+        write_trace_event (trace, &event);
+    }
+
+    return 0;
+}
+
+// Append formatted text to the trace buffer (writing the buffer to the file when full)
+// A single call appends at most TRACE_EVENT_LENGTH bytes (longer text is truncated)
+
+void trace_printf (Trace_writer *trace, const char *format, ...) {
+
+    va_list args;       // Format arguments
+    int length = 0;     // Length of the formatted text
+
+    if (TRACE_BUFFER_SIZE - trace->length < TRACE_EVENT_LENGTH)
+        flush_trace (trace);
+
+    va_start (args, format);
+    length = vsnprintf (trace->buffer + trace->length, TRACE_EVENT_LENGTH, format, args);
+    va_end (args);
+
+    if (length >= TRACE_EVENT_LENGTH)
+        length = TRACE_EVENT_LENGTH - 1;
+    if (length > 0)
+        trace->length = trace->length + length;
+}
+
+// Start a new trace event (separator from the previous event)
+
+void trace_begin_event (Trace_writer *trace) {
+
+    if (trace->num_events > 0)
+        trace_printf (trace, ",\n");
+    trace->num_events++;
+}
+
+// Write the buffered trace output to the trace file
+
+void flush_trace (Trace_writer *trace) {
+
+    int written = 0;     // Number of bytes written so far
+    int rval = 0;        // Return value of write
+
+    while (!trace->failed && written < trace->length) {
+        rval = write (trace->fd, trace->buffer + written, trace->length - written);
+        if (rval <= 0) {
+            printf(" ERROR: Could not write the trace file (the trace is incomplete)\n");
+            trace->failed = 1;
+        }
+        else
+            written = written + rval;
+    }
+
+    trace->length = 0;
+}
+
+// Get the name of a schedule event type (NULL for the slice and metadata events)
+
+const char *get_trace_event_name (int type) {
+
+    switch (type) {
+        case TRACE_EVENT_RELEASE:       return "Release";
+        case TRACE_EVENT_COMPLETE:      return "Complete";
+        case TRACE_EVENT_ABORT:         return "Abort";
+        case TRACE_EVENT_DISCARD:       return "Discard";
+        case TRACE_EVENT_MIGRATE:       return "Migrate";
+        case TRACE_EVENT_OVERHEAD:      return "Overhead";
+        case TRACE_EVENT_MODE_CHANGE:   return "Mode change";
+        case TRACE_EVENT_DEESCALATION:  return "De-escalation";
+        case TRACE_EVENT_SHUTDOWN:      return "Shutdown";
+        case TRACE_EVENT_WAKEUP:        return "Wakeup";
+        case TRACE_EVENT_FAST_FORWARD:  return "Fast-forward";
+        default:                        return NULL;
+    }
+}
+
+// Write a schedule event to the trace file in the Chrome trace event format
+// Deadlines and shifts are written with nanosecond resolution (the verifier compares times with VERIFY_TOLERANCE)
+
+void write_trace_event (Trace_writer *trace, Trace_event *event) {
+
+    double ts = event->time * TRACE_US_PER_TIME_UNIT;         // Timestamp (us)
+    const char *name = get_trace_event_name (event->type);    // Name of the instant event
+
+    if (trace->fd < 0 || trace->failed)
+        return;
+
+    trace_begin_event (trace);
+    switch (event->type) {
+
+        case TRACE_EVENT_CONFIG:
+            trace_printf (trace, "{\"name\":\"eemcs_config\",\"ph\":\"M\",\"pid\":1,\"args\":{\"npr_length\":%d}}", event->value);
+            break;
+
+        case TRACE_EVENT_CORE:
+            trace_printf (trace, "{\"name\":\"eemcs_core\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"threshold\":%d}}", event->core_no, event->value);
+            break;
+
+        case TRACE_EVENT_BEGIN:
+            if (event->kind == TRACE_SLICE_JOB)
+                trace_printf (trace, "{\"name\":\"Task %d\",\"cat\":\"job\",\"ph\":\"B\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{\"task\":%d,\"job\":%d,\"criticality\":%d,\"deadline\":%.9lf}}",
+                              event->task_no, ts, event->core_no, event->task_no, event->job_no, event->job_criticality, event->real_deadline);
+            else if (event->kind == TRACE_SLICE_IDLE)
+                trace_printf (trace, "{\"name\":\"IDLE\",\"cat\":\"idle\",\"ph\":\"B\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d}", ts, event->core_no);
+            else
+                trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"sleep\",\"ph\":\"B\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{\"state\":%d}}", event->name, ts, event->core_no, event->value);
+            break;
+
+        case TRACE_EVENT_END:
+            trace_printf (trace, "{\"ph\":\"E\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d}", ts, event->core_no);
+            break;
+
+        case TRACE_EVENT_RELEASE:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"job\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{\"task\":%d,\"job\":%d,\"criticality\":%d,\"period\":%d,\"deadline\":%.9lf,\"virtual_deadline\":%.9lf,\"budget\":[",
+                          name, ts, event->core_no, event->task_no, event->job_no, event->job_criticality, event->period, event->real_deadline, event->virtual_deadline);
+            for (int i = 0; i < MAX_LEVELS; i++)
+                trace_printf (trace, "%s%d", (i > 0) ? "," : "", event->wcet_budget[i]);
+            trace_printf (trace, "]}}");
+            break;
+
+        case TRACE_EVENT_COMPLETE:
+        case TRACE_EVENT_ABORT:
+        case TRACE_EVENT_DISCARD:
+        case TRACE_EVENT_MIGRATE:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"job\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{\"task\":%d,\"job\":%d}}",
+                          name, ts, event->core_no, event->task_no, event->job_no);
+            break;
+
+        case TRACE_EVENT_OVERHEAD:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"job\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{\"task\":%d,\"job\":%d,\"overhead\":%d}}",
+                          name, ts, event->core_no, event->task_no, event->job_no, event->value);
+            break;
+
+        case TRACE_EVENT_MODE_CHANGE:
+        case TRACE_EVENT_DEESCALATION:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"criticality\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.6lf,\"pid\":1,\"tid\":0,\"args\":{\"level\":%d}}", name, ts, event->value);
+            break;
+
+        case TRACE_EVENT_SHUTDOWN:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"power\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{\"state\":%d,\"wakeup\":%.9lf,\"min_sleep\":%.9lf,\"break_even\":%.9lf}}",
+                          name, ts, event->core_no, event->value, event->wakeup_time, event->min_sleep, event->break_even);
+            break;
+
+        case TRACE_EVENT_WAKEUP:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"power\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d}", name, ts, event->core_no);
+            break;
+
+        case TRACE_EVENT_FAST_FORWARD:
+            trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"steady state\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.6lf,\"pid\":1,\"tid\":0,\"args\":{\"hyperperiods\":%d,\"shift\":%.9lf}}", name, ts, event->value, event->shift);
+            break;
+    }
+}
+
+// Emit a schedule event: written to the trace file (if open) and checked by the schedule verifier (if enabled)
+
+void emit_trace_event (Sim_context *ctx, Trace_event *event) {
+
+    Trace_writer *trace = ctx->trace;     // Schedule event stream writer
+
+    if (trace == NULL || trace->finished)
+        return;
+
+    write_trace_event (trace, event);
+    if (trace->verifier != NULL)
+        verify_event (trace->verifier, event);
+}
+
+// End the slice open on a core track at the given time
+
+void trace_close_slice (Sim_context *ctx, int core_idx, double time) {
+
+    Trace_slice *slice = &ctx->trace->slice[core_idx];     // Slice open on the core track
+    Trace_event event;                                     // Slice end event
+
+    if (slice->kind != TRACE_SLICE_NONE) {
+        event.type = TRACE_EVENT_END;
+        event.time = time;
+        event.core_no = ctx->core[core_idx].core_no;
+        emit_trace_event (ctx, &event);
+    }
+
+    slice->kind = TRACE_SLICE_NONE;
+}
+
+// End the slices open on all core tracks at the given time
+
+void trace_close_slices (Sim_context *ctx, double time) {
+
+    if (ctx->trace == NULL)
+        return;
+
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++)
+        trace_close_slice (ctx, core_idx, time);
+}
+
+// Trace the state of every core from the current decision point to the next one (a slice starts on each core track whose state changed)
+
+void trace_schedule (Sim_context *ctx, double start, double end) {
+
+    Trace_slice *slice = NULL;     // Slice open on a core track
+    Trace_event event;             // Slice start event
+    Cores *core = NULL;            // Core structure
+    Jobs *job = NULL;              // Job executing on the core
+    int kind = 0;                  // Kind of the core state in the interval
+
+    if (ctx->trace == NULL || ctx->trace->finished || end <= start)
+        return;
+
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        core = &ctx->core[core_idx];
+        slice = &ctx->trace->slice[core_idx];
+        job = core->curr_exe_job;
+
+        if (core->status != ACTIVE)
+            kind = TRACE_SLICE_SLEEP;
+        else if (job->task_no == IDLE_TASK_NO)
+            kind = TRACE_SLICE_IDLE;
+        else
+            kind = TRACE_SLICE_JOB;
+
+        // Same state as the open slice: the slice continues
+        if (kind == slice->kind && (kind == TRACE_SLICE_IDLE || (kind == TRACE_SLICE_JOB && job->task_no == slice->task_no && job->job_no == slice->job_no)
+            || (kind == TRACE_SLICE_SLEEP && core->sleep_state == slice->sleep_state)))
+            continue;
+
+        trace_close_slice (ctx, core_idx, start);
+        slice->kind = kind;
+        event.type = TRACE_EVENT_BEGIN;
+        event.time = start;
+        event.core_no = core->core_no;
+        event.kind = kind;
+        if (kind == TRACE_SLICE_JOB) {
+            slice->task_no = job->task_no;
+            slice->job_no = job->job_no;
+            event.task_no = job->task_no;
+            event.job_no = job->job_no;
+            event.job_criticality = job->job_criticality;
+            event.real_deadline = job->real_deadline;
+        }
+        else if (kind == TRACE_SLICE_SLEEP) {
+            slice->sleep_state = core->sleep_state;
+            event.value = core->sleep_state;
+            event.name = ctx->config.sleep_states[core->core_type][core->sleep_state].name;
+        }
+        emit_trace_event (ctx, &event);
+    }
+}
+
+// Emit a job event (release, completion, abort, discard, migration, overhead) on a core track, value: overhead charged
+
+void trace_job_event (Sim_context *ctx, int type, int core_no, Jobs *job, double time, int value) {
+
+    Trace_event event;     // Job event
+
+    if (ctx->trace == NULL || ctx->trace->finished)
+        return;
+
+    event.type = type;
+    event.time = time;
+    event.core_no = core_no;
+    event.task_no = job->task_no;
+    event.job_no = job->job_no;
+    event.job_criticality = job->job_criticality;
+    event.period = ctx->tasks_arr[get_task_array_index (ctx->tasks_arr, ctx->num_tasks, job->task_no)].period;
+    event.real_deadline = job->real_deadline;
+    event.virtual_deadline = job->virtual_deadline;
+    for (int i = 0; i < MAX_LEVELS; i++)
+        event.wcet_budget[i] = job->wcet_budget[i];
+    event.value = value;
+    emit_trace_event (ctx, &event);
+}
+
+// Emit a core event (shutdown, wakeup) on the core track
+// A shutdown carries the wakeup time of the core and the minimum sleep interval (entry + exit latency) and break-even time of its sleep state
+
+void trace_core_event (Sim_context *ctx, int type, Cores *core, double time) {
+
+    Sleep_state *state = &ctx->config.sleep_states[core->core_type][core->sleep_state];    // Sleep state of the core
+    Trace_event event;                                                                       // Core event
+
+    if (ctx->trace == NULL || ctx->trace->finished)
+        return;
+
+    event.type = type;
+    event.time = time;
+    event.core_no = core->core_no;
+    event.value = core->sleep_state;
+    event.wakeup_time = core->wakeup_time;
+    event.min_sleep = state->entry_latency + state->exit_latency;
+    event.break_even = state->break_even;
+    emit_trace_event (ctx, &event);
+}
+
+// Emit a criticality level event (mode change, de-escalation) with the new current level
+
+void trace_level_event (Sim_context *ctx, int type, double time) {
+
+    Trace_event event;     // Criticality level event
+
+    if (ctx->trace == NULL || ctx->trace->finished)
+        return;
+
+    event.type = type;
+    event.time = time;
+    event.core_no = 0;
+    event.value = ctx->current_level;
+    emit_trace_event (ctx, &event);
+}
+
+// Emit a steady-state fast-forward event (all later times are shifted)
+// The slices open at the current time end first, so that no slice spans the skipped super-hyperperiods
+
+void trace_fast_forward (Sim_context *ctx, int hyperperiods, double shift) {
+
+    Trace_event event;     // Fast-forward event
+
+    if (ctx->trace == NULL || ctx->trace->finished)
+        return;
+
+    trace_close_slices (ctx, ctx->timecount);
+    event.type = TRACE_EVENT_FAST_FORWARD;
+    event.time = ctx->timecount;
+    event.core_no = 0;
+    event.value = hyperperiods;
+    event.shift = shift;
+    emit_trace_event (ctx, &event);
+}
+
+// Emit the new EDF-VD threshold criticality of a core (runtime task change), read by the verifier like the core parameters at the start
+
+void trace_threshold_event (Sim_context *ctx, Cores *core) {
+
+    Trace_event event;     // Core parameter event
+
+    if (ctx->trace == NULL || ctx->trace->finished)
+        return;
+
+    event.type = TRACE_EVENT_CORE;
+    event.time = ctx->timecount;
+    event.core_no = core->core_no;
+    event.value = core->threshold_criticality;
+    emit_trace_event (ctx, &event);
+}
+
+// Trace an informational instant event on a core track (core_no 0: global event), with the job it concerns (NULL if none) and an integer value (value_name NULL if none)
+// Informational events are only written to the trace file (they are not checked by the verifier)
+
+void trace_instant (Sim_context *ctx, int core_no, const char *name, const char *category, double time, Jobs *job, const char *value_name, int value) {
+
+    Trace_writer *trace = ctx->trace;     // Schedule event stream writer
+
+    if (trace == NULL || trace->fd < 0 || trace->failed || trace->finished)
+        return;
+
+    trace_begin_event (trace);
+    if (core_no > 0)
+        trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.6lf,\"pid\":1,\"tid\":%d,\"args\":{", name, category, time * TRACE_US_PER_TIME_UNIT, core_no);
+    else
+        trace_printf (trace, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.6lf,\"pid\":1,\"tid\":0,\"args\":{", name, category, time * TRACE_US_PER_TIME_UNIT);
+    if (job != NULL)
+        trace_printf (trace, "\"task\":%d,\"job\":%d%s", job->task_no, job->job_no, (value_name != NULL) ? "," : "");
+    if (value_name != NULL)
+        trace_printf (trace, "\"%s\":%d", value_name, value);
+    trace_printf (trace, "}}");
+}
+
+// Trace the slack values at the criticality levels >= current level (slack[i]: slack at level current level + i) as a counter of the core
+
+void trace_slack (Sim_context *ctx, int core_no, const char *name, double *slack, double time) {
+
+    Trace_writer *trace = ctx->trace;     // Schedule event stream writer
+
+    if (trace == NULL || trace->fd < 0 || trace->failed || trace->finished)
+        return;
+
+    trace_begin_event (trace);
+    trace_printf (trace, "{\"name\":\"%s (core %d)\",\"ph\":\"C\",\"ts\":%.6lf,\"pid\":1,\"args\":{", name, core_no, time * TRACE_US_PER_TIME_UNIT);
+    for (int i = 0; i < ctx->max_criticality - ctx->current_level + 1; i++)
+        trace_printf (trace, "%s\"level %d\":%.3lf", (i > 0) ? "," : "", ctx->current_level + i, slack[i]);
+    trace_printf (trace, "}}");
+}
+
+// Complete the event stream at the end of the simulation: end the open slices, finish the verification and close the trace file
+
+void finish_trace (Sim_context *ctx) {
+
+    Trace_writer *trace = ctx->trace;     // Schedule event stream writer
+
+    if (trace == NULL || trace->finished)
+        return;
+
+    trace_close_slices (ctx, ctx->timecount);
+    if (trace->verifier != NULL)
+        finish_verifier (trace->verifier);
+
+    if (trace->fd >= 0) {
+        trace_printf (trace, "\n]}\n");
+        flush_trace (trace);
+        close (trace->fd);
+        trace->fd = -1;
+    }
+
+    trace->finished = 1;
+}
+
+// Complete the event stream (if not yet complete) and release the writer and its verifier
+
+void close_trace (Sim_context *ctx) {
+
+    if (ctx->trace == NULL)
+        return;
+
+    finish_trace (ctx);
+    free_verifier (ctx->trace->verifier);
+    free (ctx->trace);
+    ctx->trace = NULL;
+}
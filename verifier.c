@@ -0,0 +1,647 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "header.h"
+
+// --------------------------------------
+// SCHEDULE VERIFIER (ONE-PASS, STREAMING)
+// --------------------------------------
+
+// The verifier checks the schedule event stream in a single pass, either live (attached to the event stream of a simulation) or read back
+// from a trace file. It only keeps the jobs live on each core (released and not yet completed/aborted/discarded/migrated), so its memory does
+// not grow with the simulated time. The state of a core is checked when the time advances past the events of a decision point
+// --> EDF order: the executing job has the earliest scheduling deadline of the live jobs of its core (virtual deadlines up to the core's EDF-VD
+//     threshold), except within a non-preemptive region (limited-preemptive mode); an ACTIVE core never idles with live jobs
+// --> Deadlines: a job at/above the current criticality level completes by its deadline (jobs still live at the end of the simulation included)
+// --> Budgets: a job never executes beyond its wcet budget at the current criticality level (including the overheads charged to it)
+// --> Sleep states: a core enters a sleep state for at least its break-even time, leaves it after its entry and exit latencies, and
+//     executes nothing while SHUTDOWN
+// Jobs not live on a core (e.g. discarded jobs) are ignored by the job events; they are tracked again when released on a core
+
+// Create a schedule verifier (no core, lowest criticality level), returns NULL if out of memory
+
+Verifier *create_verifier (void) {
+
+    Verifier *verifier;     // Schedule verifier
+
+    verifier = malloc (sizeof (Verifier));
+    if (verifier == NULL)
+        return NULL;
+
+    verifier->num_cores = 0;
+    verifier->npr_length = 0;
+    verifier->current_level = 1;
+    verifier->time = 0;
+    verifier->events = 0;
+    verifier->jobs = 0;
+    verifier->live_jobs = 0;
+    verifier->max_live_jobs = 0;
+    for (int i = 0; i < VERIFY_NUM_CHECKS; i++)
+        verifier->violations[i] = 0;
+
+    for (int core_idx = 0; core_idx < MAX_CORES; core_idx++) {
+        verifier->core[core_idx].threshold_criticality = 0;
+        verifier->core[core_idx].kind = TRACE_SLICE_NONE;
+        verifier->core[core_idx].running = NULL;
+        verifier->core[core_idx].jobs = NULL;
+        verifier->core[core_idx].account_time = 0;
+        verifier->core[core_idx].inversion_start = NA;
+        verifier->core[core_idx].inversion_reported = 0;
+        verifier->core[core_idx].asleep = 0;
+        verifier->core[core_idx].sleep_start = 0;
+        verifier->core[core_idx].min_sleep = 0;
+        verifier->core[core_idx].dirty = 0;
+    }
+
+    return verifier;
+}
+
+// Attach a schedule verifier to the event stream of an allocated context (created if needed) and pass it the simulation parameters
+// Returns 0 on success, -1 if out of memory or a verifier is already attached
+
+int open_verifier (Sim_context *ctx) {
+
+    Trace_writer *trace;     // Schedule event stream writer
+    Trace_event event;       // Simulation/core parameters
+
+    trace = create_trace_writer (ctx);
+    if (trace == NULL || trace->verifier != NULL)
+        return -1;
+
+    trace->verifier = create_verifier ();
+    if (trace->verifier == NULL)
+        return -1;
+
+    event.type = TRACE_EVENT_CONFIG;
+    event.time = 0;
+    event.core_no = 0;
+    event.value = (ctx->config.preemption_mode == PREEMPTION_LIMITED) ? ctx->config.npr_length : 0;
+    verify_event (trace->verifier, &event);
+    for (int core_idx = 0; core_idx < ctx->num_cores; core_idx++) {
+        event.type = TRACE_EVENT_CORE;
+        event.core_no = ctx->core[core_idx].core_no;
+        event.value = ctx->core[core_idx].threshold_criticality;
+        verify_event (trace->verifier, &event);
+    }
+
+    return 0;
+}
+
+// Record a violation of a check (printed in detail for the first VERIFY_MAX_REPORTS violations)
+
+void report_violation (Verifier *verifier, int check, double time, const char *format, ...) {
+
+    const char *check_name[VERIFY_NUM_CHECKS] = {"EDF", "DEADLINE", "BUDGET", "SLEEP", "STREAM"};     // Names of the checks
+    va_list args;                                                                                    // Format arguments
+
+    verifier->violations[check]++;
+    if (count_violations (verifier) > VERIFY_MAX_REPORTS)
+        return;
+
+    printf(" VIOLATION (%s) at time %lf: ", check_name[check], time);
+    va_start (args, format);
+    vprintf (format, args);
+    va_end (args);
+    printf("\n");
+}
+
+// Find a live job of a core (NULL if not live)
+
+Verify_job *find_verify_job (Verify_core *core, int task_no, int job_no) {
+
+    Verify_job *job;     // Live job of the core
+
+    for (job = core->jobs; job != NULL; job = job->next) {
+        if (job->task_no == task_no && job->job_no == job_no)
+            return job;
+    }
+
+    return NULL;
+}
+
+// Remove a live job of a core and release it
+
+void remove_verify_job (Verifier *verifier, Verify_core *core, Verify_job *job) {
+
+    Verify_job **link = &core->jobs;     // Link to the job in the core's live job list
+
+    while (*link != job)
+        link = &(*link)->next;
+    *link = job->next;
+
+    if (core->running == job)
+        core->running = NULL;
+    verifier->live_jobs--;
+    free (job);
+}
+
+// Get the scheduling deadline of a live job on its core (virtual deadline up to the core's EDF-VD threshold)
+
+double get_verify_deadline (Verifier *verifier, Verify_core *core, Verify_job *job) {
+
+    if (verifier->current_level <= core->threshold_criticality)
+        return job->virtual_deadline;
+
+    return job->real_deadline;
+}
+
+// Check that a job leaving its core at the given time did not miss its deadline (if at/above the current criticality level)
+
+void check_verify_deadline (Verifier *verifier, Verify_job *job, double time) {
+
+    if (job->job_criticality < verifier->current_level || time <= job->real_deadline + VERIFY_TOLERANCE || (job->reported & (1 << VERIFY_DEADLINE)))
+        return;
+
+    job->reported = job->reported | (1 << VERIFY_DEADLINE);
+    report_violation (verifier, VERIFY_DEADLINE, time, "Task %d Job %d (criticality %d) missed its deadline %lf at level %d",
+                      job->task_no, job->job_no, job->job_criticality, job->real_deadline, verifier->current_level);
+}
+
+// Charge the execution of the running job of a core up to the given time to its budgets and check its budget at the current criticality level
+
+void account_verify_execution (Verifier *verifier, int core_idx, double time) {
+
+    Verify_core *core = &verifier->core[core_idx];     // Verified core
+    Verify_job *job = core->running;                   // Job executing on the core
+    double elapsed = time - core->account_time;        // Execution time not yet charged
+
+    core->account_time = time;
+    if (job == NULL || elapsed <= 0)
+        return;
+
+    for (int i = 0; i < MAX_LEVELS; i++)
+        job->budget[i] = job->budget[i] - elapsed;
+
+    if (job->budget[verifier->current_level - 1] < -VERIFY_TOLERANCE && !(job->reported & (1 << VERIFY_BUDGET))) {
+        job->reported = job->reported | (1 << VERIFY_BUDGET);
+        report_violation (verifier, VERIFY_BUDGET, time, "Task %d Job %d executed %lf beyond its budget at level %d on core %d",
+                          job->task_no, job->job_no, -job->budget[verifier->current_level - 1], verifier->current_level, core_idx + 1);
+    }
+}
+
+// Check the schedule of a core at the current time (EDF order, priority inversions within the non-preemptive regions, no idling with ready jobs)
+// A priority inversion is allowed while it lasts at most npr_length (limited-preemptive mode), its length is checked when it ends
+
+void check_core_schedule (Verifier *verifier, int core_idx) {
+
+    Verify_core *core = &verifier->core[core_idx];     // Verified core
+    Verify_job *earliest = NULL;                       // Live job with the earliest scheduling deadline
+    Verify_job *job = NULL;                            // Live job of the core
+    int inverted = 0;                                  // Set if a job with an earlier deadline waits while the running job executes
+
+    if (core->asleep || core->kind == TRACE_SLICE_NONE || core->kind == TRACE_SLICE_SLEEP)
+        return;
+
+    // An ACTIVE core never idles while jobs are ready
+    if (core->kind == TRACE_SLICE_IDLE && core->jobs != NULL)
+        report_violation (verifier, VERIFY_EDF, verifier->time, "Core %d is IDLE with Task %d Job %d ready", core_idx + 1, core->jobs->task_no, core->jobs->job_no);
+
+    if (core->kind == TRACE_SLICE_JOB) {
+        if (core->running == NULL) {
+            report_violation (verifier, VERIFY_STREAM, verifier->time, "Core %d executes a job that is no longer live", core_idx + 1);
+            return;
+        }
+
+        for (job = core->jobs; job != NULL; job = job->next) {
+            if (earliest == NULL || get_verify_deadline (verifier, core, job) < get_verify_deadline (verifier, core, earliest))
+                earliest = job;
+        }
+        inverted = (get_verify_deadline (verifier, core, earliest) < get_verify_deadline (verifier, core, core->running) - VERIFY_TOLERANCE);
+    }
+
+    // Priority inversion: allowed within a non-preemptive region
+    if (inverted) {
+        if (core->inversion_start == NA) {
+            core->inversion_start = verifier->time;
+            core->inversion_reported = 0;
+        }
+        if (verifier->npr_length == 0 && !core->inversion_reported) {
+            core->inversion_reported = 1;
+            report_violation (verifier, VERIFY_EDF, verifier->time, "Core %d executes Task %d Job %d (deadline %lf) while Task %d Job %d (deadline %lf) is ready",
+                              core_idx + 1, core->running->task_no, core->running->job_no, get_verify_deadline (verifier, core, core->running),
+                              earliest->task_no, earliest->job_no, get_verify_deadline (verifier, core, earliest));
+        }
+    }
+
+    // End of a priority inversion: it must not outlast the non-preemptive region
+    else if (core->inversion_start != NA) {
+        if (verifier->time - core->inversion_start > verifier->npr_length + VERIFY_TOLERANCE && !core->inversion_reported)
+            report_violation (verifier, VERIFY_EDF, verifier->time, "Core %d delayed an earlier deadline job for %lf (non-preemptive region length %d)",
+                              core_idx + 1, verifier->time - core->inversion_start, verifier->npr_length);
+        core->inversion_start = NA;
+    }
+}
+
+// Advance the verifier time: check the core schedules at the current time and charge the execution up to the new time
+// (all the events of a decision point have the same time, so the state of a core is complete once the time advances)
+
+void advance_verifier (Verifier *verifier, double time) {
+
+    for (int core_idx = 0; core_idx < verifier->num_cores; core_idx++) {
+        if (verifier->core[core_idx].dirty)
+            check_core_schedule (verifier, core_idx);
+        verifier->core[core_idx].dirty = 0;
+        account_verify_execution (verifier, core_idx, time);
+    }
+
+    verifier->time = time;
+}
+
+// Check a schedule event
+
+void verify_event (Verifier *verifier, Trace_event *event) {
+
+    Verify_core *core = NULL;     // Core of the event
+    Verify_job *job = NULL;       // Live job of the event
+    double time = event->time;    // Time of the event
+
+    verifier->events++;
+
+    if (event->core_no < 0 || event->core_no > MAX_CORES) {
+        report_violation (verifier, VERIFY_STREAM, time, "Event on unknown core %d", event->core_no);
+        return;
+    }
+    if (event->core_no > 0)
+        core = &verifier->core[event->core_no - 1];
+
+    // Simulation and core parameters
+    if (event->type == TRACE_EVENT_CONFIG) {
+        verifier->npr_length = event->value;
+        return;
+    }
+    if (event->type == TRACE_EVENT_CORE) {
+        if (core != NULL) {
+            core->threshold_criticality = event->value;
+            if (verifier->num_cores < event->core_no)
+                verifier->num_cores = event->core_no;
+        }
+        return;
+    }
+
+    // Events must come in non-decreasing time order
+    if (time < verifier->time - VERIFY_TOLERANCE)
+        report_violation (verifier, VERIFY_STREAM, time, "Event out of time order (after time %lf)", verifier->time);
+    else if (time > verifier->time)
+        advance_verifier (verifier, time);
+
+    // Job and core events need a core
+    if (core == NULL && event->type != TRACE_EVENT_MODE_CHANGE && event->type != TRACE_EVENT_DEESCALATION && event->type != TRACE_EVENT_FAST_FORWARD) {
+        report_violation (verifier, VERIFY_STREAM, time, "Core event without a core");
+        return;
+    }
+    if (core != NULL) {
+        core->dirty = 1;
+        if (event->core_no > verifier->num_cores)
+            verifier->num_cores = event->core_no;
+    }
+
+    switch (event->type) {
+
+        // A slice starts: the executed job must be live on the core, a SHUTDOWN core executes nothing
+        case TRACE_EVENT_BEGIN:
+            core->kind = event->kind;
+            core->account_time = time;
+            if (event->kind != TRACE_SLICE_SLEEP && core->asleep)
+                report_violation (verifier, VERIFY_SLEEP, time, "Core %d executes while SHUTDOWN", event->core_no);
+            if (event->kind == TRACE_SLICE_SLEEP && !core->asleep)
+                report_violation (verifier, VERIFY_STREAM, time, "Core %d sleeps without a shutdown", event->core_no);
+            if (event->kind == TRACE_SLICE_JOB) {
+                core->running = find_verify_job (core, event->task_no, event->job_no);
+                if (core->running == NULL)
+                    report_violation (verifier, VERIFY_STREAM, time, "Core %d executes Task %d Job %d, which is not released on it", event->core_no, event->task_no, event->job_no);
+            }
+            break;
+
+        // The slice ends (its execution is already charged)
+        case TRACE_EVENT_END:
+            core->kind = TRACE_SLICE_NONE;
+            core->running = NULL;
+            break;
+
+        // A job becomes live on the core
+        case TRACE_EVENT_RELEASE:
+            job = find_verify_job (core, event->task_no, event->job_no);
+            if (job != NULL) {
+                report_violation (verifier, VERIFY_STREAM, time, "Task %d Job %d released twice on core %d", event->task_no, event->job_no, event->core_no);
+                break;
+            }
+            job = malloc (sizeof (Verify_job));
+            if (job == NULL)
+                break;
+            job->task_no = event->task_no;
+            job->job_no = event->job_no;
+            job->job_criticality = event->job_criticality;
+            job->period = event->period;
+            job->real_deadline = event->real_deadline;
+            job->virtual_deadline = event->virtual_deadline;
+            for (int i = 0; i < MAX_LEVELS; i++)
+                job->budget[i] = event->wcet_budget[i];
+            job->reported = 0;
+            job->next = core->jobs;
+            core->jobs = job;
+            verifier->jobs++;
+            verifier->live_jobs++;
+            if (verifier->max_live_jobs < verifier->live_jobs)
+                verifier->max_live_jobs = verifier->live_jobs;
+            break;
+
+        // A job completes (or completes its portion on the core): it must meet its deadline
+        case TRACE_EVENT_COMPLETE:
+        case TRACE_EVENT_MIGRATE:
+            job = find_verify_job (core, event->task_no, event->job_no);
+            if (job != NULL) {
+                check_verify_deadline (verifier, job, time);
+                remove_verify_job (verifier, core, job);
+            }
+            break;
+
+        // A job leaves the core without completing
+        case TRACE_EVENT_ABORT:
+        case TRACE_EVENT_DISCARD:
+            job = find_verify_job (core, event->task_no, event->job_no);
+            if (job != NULL)
+                remove_verify_job (verifier, core, job);
+            break;
+
+        // An overhead extends the budgets of the job
+        case TRACE_EVENT_OVERHEAD:
+            job = find_verify_job (core, event->task_no, event->job_no);
+            if (job != NULL) {
+                for (int i = 0; i < MAX_LEVELS; i++)
+                    job->budget[i] = job->budget[i] + event->value;
+            }
+            break;
+
+        // The criticality level changes (the execution up to this time is charged at the previous level)
+        case TRACE_EVENT_MODE_CHANGE:
+        case TRACE_EVENT_DEESCALATION:
+            if (event->type == TRACE_EVENT_DEESCALATION && verifier->live_jobs > 0)
+                report_violation (verifier, VERIFY_STREAM, time, "De-escalation with %d live jobs (not an idle instant)", verifier->live_jobs);
+            verifier->current_level = event->value;
+            if (verifier->current_level < 1 || verifier->current_level > MAX_LEVELS) {
+                report_violation (verifier, VERIFY_STREAM, time, "Unknown criticality level %d", event->value);
+                verifier->current_level = 1;
+            }
+            for (int core_idx = 0; core_idx < verifier->num_cores; core_idx++)
+                verifier->core[core_idx].dirty = 1;
+            break;
+
+        // A core enters a sleep state: the sleep interval must cover the break-even time of the state
+        case TRACE_EVENT_SHUTDOWN:
+            if (core->asleep)
+                report_violation (verifier, VERIFY_SLEEP, time, "Core %d SHUTDOWN twice", event->core_no);
+            if (event->wakeup_time - time < event->break_even - VERIFY_TOLERANCE)
+                report_violation (verifier, VERIFY_SLEEP, time, "Core %d sleeps %lf, less than the break-even time %lf of its sleep state", event->core_no, event->wakeup_time - time, event->break_even);
+            core->asleep = 1;
+            core->sleep_start = time;
+            core->min_sleep = event->min_sleep;
+            break;
+
+        // A core leaves its sleep state: only once it has entered and left it
+        case TRACE_EVENT_WAKEUP:
+            if (!core->asleep)
+                report_violation (verifier, VERIFY_STREAM, time, "Core %d woken up while ACTIVE", event->core_no);
+            else if (time - core->sleep_start < core->min_sleep - VERIFY_TOLERANCE)
+                report_violation (verifier, VERIFY_SLEEP, time, "Core %d woken up after %lf, before the entry and exit latencies %lf of its sleep state", event->core_no, time - core->sleep_start, core->min_sleep);
+            core->asleep = 0;
+            break;
+
+        // The simulation skips repeated super-hyperperiods: the live jobs and the times shift (the job numbers by the periods skipped)
+        case TRACE_EVENT_FAST_FORWARD:
+            for (int core_idx = 0; core_idx < verifier->num_cores; core_idx++) {
+                core = &verifier->core[core_idx];
+                for (job = core->jobs; job != NULL; job = job->next) {
+                    job->real_deadline = job->real_deadline + event->shift;
+                    job->virtual_deadline = job->virtual_deadline + event->shift;
+                    if (job->period > 0)
+                        job->job_no = job->job_no + (int)(event->shift / job->period + 0.5);
+                }
+                core->account_time = core->account_time + event->shift;
+                core->sleep_start = core->sleep_start + event->shift;
+                if (core->inversion_start != NA)
+                    core->inversion_start = core->inversion_start + event->shift;
+            }
+            verifier->time = verifier->time + event->shift;
+            break;
+    }
+}
+
+// Complete the verification at the end of the simulation (jobs still live after their deadline missed it)
+
+void finish_verifier (Verifier *verifier) {
+
+    Verify_job *job;     // Live job
+
+    advance_verifier (verifier, verifier->time);
+
+    for (int core_idx = 0; core_idx < verifier->num_cores; core_idx++) {
+        for (job = verifier->core[core_idx].jobs; job != NULL; job = job->next)
+            check_verify_deadline (verifier, job, verifier->time);
+    }
+}
+
+// Get the total number of violations found by a verifier
+
+int count_violations (Verifier *verifier) {
+
+    int violations = 0;     // Total number of violations
+
+    for (int i = 0; i < VERIFY_NUM_CHECKS; i++)
+        violations = violations + verifier->violations[i];
+
+    return violations;
+}
+
+// Print the verification report
+
+void print_verifier_report (Verifier *verifier) {
+
+    printf(" Schedule verification: %s\n", (count_violations (verifier) == 0) ? "PASSED" : "FAILED");
+    printf(" Events checked: %lld, jobs released: %lld, live jobs (max): %d, end time: %lf\n", verifier->events, verifier->jobs, verifier->max_live_jobs, verifier->time);
+    printf(" Violations -- EDF order: %d, deadlines: %d, budgets: %d, sleep states: %d, event stream: %d\n\n",
+           verifier->violations[VERIFY_EDF], verifier->violations[VERIFY_DEADLINE], verifier->violations[VERIFY_BUDGET], verifier->violations[VERIFY_SLEEP], verifier->violations[VERIFY_STREAM]);
+}
+
+// Release a verifier and its live jobs
+
+void free_verifier (Verifier *verifier) {
+
+    Verify_job *job, *next;     // Live job variables
+
+    if (verifier == NULL)
+        return;
+
+    for (int core_idx = 0; core_idx < MAX_CORES; core_idx++) {
+        for (job = verifier->core[core_idx].jobs; job != NULL; job = next) {
+            next = job->next;
+            free (job);
+        }
+    }
+
+    free (verifier);
+}
+
+// -------------------------------------
+// SCHEDULE VERIFIER -- TRACE FILE INPUT
+// -------------------------------------
+
+// The trace files written by the simulator hold one event per line, so they are verified line by line (the file is never held in memory)
+// Only the events of the schedule event stream are read back; the informational events and counters are skipped
+
+// Read a numeric field ("key":value) of a trace file line (default_value if absent)
+
+double read_trace_field (const char *line, const char *key, double default_value) {
+
+    char pattern[64];     // Field pattern
+    const char *field;    // Field in the line
+
+    snprintf (pattern, sizeof (pattern), "\"%s\":", key);
+    field = strstr (line, pattern);
+    if (field == NULL)
+        return default_value;
+
+    return strtod (field + strlen (pattern), NULL);
+}
+
+// Parse a trace file line into a schedule event, returns 1 if the line holds a schedule event
+
+int parse_trace_line (const char *line, Trace_event *event) {
+
+    char pattern[64];         // Event name pattern
+    const char *budget;       // Budget array of a release
+    char *end;                // End of a parsed budget
+
+    event->time = read_trace_field (line, "ts", 0) / TRACE_US_PER_TIME_UNIT;
+    event->core_no = (int) read_trace_field (line, "tid", 0);
+    event->name = NULL;
+
+    // Simulation and core parameters
+    if (strstr (line, "\"ph\":\"M\"") != NULL) {
+        if (strstr (line, "\"name\":\"eemcs_config\"") != NULL) {
+            event->type = TRACE_EVENT_CONFIG;
+            event->value = (int) read_trace_field (line, "npr_length", 0);
+            return 1;
+        }
+        if (strstr (line, "\"name\":\"eemcs_core\"") != NULL) {
+            event->type = TRACE_EVENT_CORE;
+            event->value = (int) read_trace_field (line, "threshold", 0);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Slices
+    if (strstr (line, "\"ph\":\"E\"") != NULL) {
+        event->type = TRACE_EVENT_END;
+        return 1;
+    }
+    if (strstr (line, "\"ph\":\"B\"") != NULL) {
+        event->type = TRACE_EVENT_BEGIN;
+        if (strstr (line, "\"cat\":\"job\"") != NULL) {
+            event->kind = TRACE_SLICE_JOB;
+            event->task_no = (int) read_trace_field (line, "task", 0);
+            event->job_no = (int) read_trace_field (line, "job", 0);
+            event->job_criticality = (int) read_trace_field (line, "criticality", 0);
+            event->real_deadline = read_trace_field (line, "deadline", 0);
+        }
+        else if (strstr (line, "\"cat\":\"idle\"") != NULL)
+            event->kind = TRACE_SLICE_IDLE;
+        else {
+            event->kind = TRACE_SLICE_SLEEP;
+            event->value = (int) read_trace_field (line, "state", 0);
+        }
+        return 1;
+    }
+
+    // Instant events of the schedule event stream (by name)
+    if (strstr (line, "\"ph\":\"i\"") == NULL)
+        return 0;
+
+    for (event->type = TRACE_EVENT_RELEASE; event->type <= TRACE_EVENT_FAST_FORWARD; event->type++) {
+        snprintf (pattern, sizeof (pattern), "\"name\":\"%s\"", get_trace_event_name (event->type));
+        if (strstr (line, pattern) != NULL)
+            break;
+    }
+    if (event->type > TRACE_EVENT_FAST_FORWARD)
+        return 0;
+
+    event->task_no = (int) read_trace_field (line, "task", 0);
+    event->job_no = (int) read_trace_field (line, "job", 0);
+    event->job_criticality = (int) read_trace_field (line, "criticality", 0);
+    event->period = (int) read_trace_field (line, "period", 0);
+    event->real_deadline = read_trace_field (line, "deadline", 0);
+    event->virtual_deadline = read_trace_field (line, "virtual_deadline", 0);
+    event->wakeup_time = read_trace_field (line, "wakeup", 0);
+    event->min_sleep = read_trace_field (line, "min_sleep", 0);
+    event->break_even = read_trace_field (line, "break_even", 0);
+    event->shift = read_trace_field (line, "shift", 0);
+
+    if (event->type == TRACE_EVENT_OVERHEAD)
+        event->value = (int) read_trace_field (line, "overhead", 0);
+    else if (event->type == TRACE_EVENT_MODE_CHANGE || event->type == TRACE_EVENT_DEESCALATION)
+        event->value = (int) read_trace_field (line, "level", 0);
+    else if (event->type == TRACE_EVENT_FAST_FORWARD)
+        event->value = (int) read_trace_field (line, "hyperperiods", 0);
+    else
+        event->value = (int) read_trace_field (line, "state", 0);
+
+    // Remaining budgets of a release
+    for (int i = 0; i < MAX_LEVELS; i++)
+        event->wcet_budget[i] = 0;
+    budget = strstr (line, "\"budget\":[");
+    if (budget != NULL) {
+        budget = budget + strlen ("\"budget\":[");
+        for (int i = 0; i < MAX_LEVELS; i++) {
+            event->wcet_budget[i] = (int) strtol (budget, &end, 10);
+            if (*end != ',')
+                break;
+            budget = end + 1;
+        }
+    }
+
+    return 1;
+}
+
+// Verify a schedule trace file written by the simulator in one pass, prints the report
+// Returns the number of violations, -1 if the file could not be read or holds no schedule event stream
+
+int verify_trace_file (const char *path) {
+
+    FILE *fptr;                          // Trace file
+    Verifier *verifier;                  // Schedule verifier
+    Trace_event event;                   // Event read from the trace file
+    char line[VERIFY_LINE_LENGTH];       // Trace file line
+    int violations = 0;                  // Number of violations found
+
+    fptr = fopen (path, "r");
+    if (fptr == NULL) {
+        printf(" ERROR: Could not open the trace file (%s)\n", path);
+        return -1;
+    }
+
+    verifier = create_verifier ();
+    if (verifier == NULL) {
+        fclose (fptr);
+        return -1;
+    }
+
+    while (fgets (line, sizeof (line), fptr) != NULL) {
+        if (parse_trace_line (line, &event))
+            verify_event (verifier, &event);
+    }
+    fclose (fptr);
+
+    if (verifier->num_cores == 0) {
+        printf(" ERROR: No schedule event stream in the trace file (%s)\n", path);
+        free_verifier (verifier);
+        return -1;
+    }
+
+    finish_verifier (verifier);
+    print_verifier_report (verifier);
+    violations = count_violations (verifier);
+    free_verifier (verifier);
+
+    return violations;
+}